@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// Containers that take an allocator parameter obtain their storage through it:
+//
+//     void* allocate(size_t size);
+//     void* allocate_zeroed(size_t size);
+//     void deallocate(void* ptr, size_t size);
+//     size_t good_size(size_t size) const;
+//
+// Allocators are stored inside the container, so stateless ones like this one cost nothing.
+class DefaultAllocator {
+public:
+    void* allocate(size_t size) const { return kmalloc(size); }
+    void* allocate_zeroed(size_t size) const { return kcalloc(1, size); }
+    void deallocate(void* ptr, size_t size) const { kfree_sized(ptr, size); }
+    size_t good_size(size_t size) const { return kmalloc_good_size(size); }
+};
+
+}
+
+using AK::DefaultAllocator;
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Allocator.h>
+#include <AK/Assertions.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// Allocations are carved out of large chunks, and are only returned to the system all at once when the arena
+// is cleared or destroyed. Blocks that are deallocated before that are kept on per-size free lists and handed
+// out again, so that a container growing or being recreated over and over reuses the same (cache-hot) memory.
+// This is a good fit for the many short-lived containers a parser creates while building one tree.
+class Arena {
+    AK_MAKE_NONCOPYABLE(Arena);
+    AK_MAKE_NONMOVABLE(Arena);
+
+public:
+    static constexpr size_t default_alignment = 16;
+    static constexpr size_t smallest_size_class = 16;
+    static constexpr size_t size_class_count = 16;
+    static constexpr size_t largest_size_class = smallest_size_class << (size_class_count - 1);
+
+    explicit Arena(size_t chunk_size = 64 * KiB)
+        : m_chunk_size(chunk_size)
+    {
+    }
+
+    ~Arena() { clear(); }
+
+    // Rounds the size up to the block size that will actually be reserved for it.
+    static constexpr size_t good_size(size_t size)
+    {
+        if (size > largest_size_class)
+            return size;
+        return smallest_size_class << size_class_index(size);
+    }
+
+    void* allocate(size_t size, size_t alignment = default_alignment)
+    {
+        ++m_allocation_count;
+        if (size <= largest_size_class && alignment <= default_alignment) {
+            auto index = size_class_index(size);
+            if (auto* block = m_free_lists[index]) {
+                m_free_lists[index] = block->next;
+                ++m_reused_count;
+                return block;
+            }
+            size = smallest_size_class << index;
+        }
+        m_bytes_allocated += size;
+
+        auto aligned_cursor = align_up_to(m_cursor, alignment);
+        if (!m_current_chunk || aligned_cursor + size > m_end) {
+            if (!allocate_chunk(size + alignment))
+                return nullptr;
+            aligned_cursor = align_up_to(m_cursor, alignment);
+        }
+        m_cursor = aligned_cursor + size;
+        return reinterpret_cast<void*>(aligned_cursor);
+    }
+
+    // Makes the block available to later allocations of the same size class. The memory itself stays
+    // reserved until the arena is cleared.
+    void deallocate(void* ptr, size_t size)
+    {
+        if (!ptr || size > largest_size_class)
+            return;
+        auto index = size_class_index(size);
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = m_free_lists[index];
+        m_free_lists[index] = block;
+    }
+
+    // Releases every allocation made from this arena.
+    void clear()
+    {
+        while (m_current_chunk) {
+            auto* previous = m_current_chunk->previous;
+            kfree_sized(m_current_chunk, m_current_chunk->size);
+            m_current_chunk = previous;
+        }
+        m_cursor = 0;
+        m_end = 0;
+        for (auto& free_list : m_free_lists)
+            free_list = nullptr;
+        m_allocation_count = 0;
+        m_reused_count = 0;
+        m_bytes_allocated = 0;
+        m_chunk_count = 0;
+    }
+
+    size_t allocation_count() const { return m_allocation_count; }
+    size_t reused_count() const { return m_reused_count; }
+    size_t bytes_allocated() const { return m_bytes_allocated; }
+    size_t chunk_count() const { return m_chunk_count; }
+
+private:
+    struct ChunkHeader {
+        ChunkHeader* previous;
+        size_t size;
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t size_class_index(size_t size)
+    {
+        if (size <= smallest_size_class)
+            return 0;
+        auto bits_needed = [](size_t value) { return sizeof(size_t) * 8 - count_leading_zeroes(value); };
+        return bits_needed(size - 1) - bits_needed(smallest_size_class - 1);
+    }
+
+    bool allocate_chunk(size_t minimum_size)
+    {
+        auto size = max(m_chunk_size, minimum_size + sizeof(ChunkHeader));
+        auto* chunk = static_cast<ChunkHeader*>(kmalloc(size));
+        if (!chunk)
+            return false;
+        chunk->previous = m_current_chunk;
+        chunk->size = size;
+        m_current_chunk = chunk;
+        m_cursor = reinterpret_cast<FlatPtr>(chunk + 1);
+        m_end = reinterpret_cast<FlatPtr>(chunk) + size;
+        ++m_chunk_count;
+        return true;
+    }
+
+    size_t m_chunk_size { 0 };
+    ChunkHeader* m_current_chunk { nullptr };
+    FlatPtr m_cursor { 0 };
+    FlatPtr m_end { 0 };
+    FreeBlock* m_free_lists[size_class_count] {};
+    size_t m_allocation_count { 0 };
+    size_t m_reused_count { 0 };
+    size_t m_bytes_allocated { 0 };
+    size_t m_chunk_count { 0 };
+};
+
+// Binds a container to an Arena, e.g. Vector<int, 0, ArenaAllocator> { arena }.
+// The container must not outlive the arena.
+class ArenaAllocator {
+public:
+    ArenaAllocator(Arena& arena)
+        : m_arena(&arena)
+    {
+    }
+
+    void* allocate(size_t size) const { return m_arena->allocate(size); }
+    void* allocate_zeroed(size_t size) const
+    {
+        auto* ptr = allocate(size);
+        if (ptr)
+            __builtin_memset(ptr, 0, size);
+        return ptr;
+    }
+    void deallocate(void* ptr, size_t size) const { m_arena->deallocate(ptr, size); }
+    size_t good_size(size_t size) const { return Arena::good_size(size); }
+
+    Arena& arena() const { return *m_arena; }
+
+private:
+    Arena* m_arena { nullptr };
+};
+
+}
+
+using AK::Arena;
+using AK::ArenaAllocator;
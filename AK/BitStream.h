@@ -26,13 +26,9 @@ public:
             return 0;
 
         size_t nread = 0;
-        if (bytes.size() >= 1) {
-            if (m_next_byte.has_value()) {
-                bytes[0] = m_next_byte.value();
-                m_next_byte.clear();
-
-                ++nread;
-            }
+        while (nread < bytes.size() && m_buffered_bytes > 0) {
+            bytes[nread++] = static_cast<u8>(m_buffer);
+            drop_first_buffered_byte();
         }
 
         return nread + m_stream.read(bytes.slice(nread));
@@ -48,42 +44,66 @@ public:
         return true;
     }
 
-    bool unreliable_eof() const override { return !m_next_byte.has_value() && m_stream.unreliable_eof(); }
+    bool unreliable_eof() const override { return m_buffered_bytes == 0 && m_stream.unreliable_eof(); }
 
     bool discard_or_error(size_t count) override
     {
-        if (count >= 1) {
-            if (m_next_byte.has_value()) {
-                m_next_byte.clear();
-                --count;
-            }
+        while (count > 0 && m_buffered_bytes > 0) {
+            drop_first_buffered_byte();
+            --count;
         }
 
         return m_stream.discard_or_error(count);
     }
 
+    // Makes sure that at least `count` (at most 57) bits can be peeked at, reading whole bytes from the
+    // underlying stream as needed. Never reads further ahead than that, as the bytes following a bit-packed
+    // section (e.g. the gzip trailer) usually belong to someone else.
+    ALWAYS_INLINE bool ensure_buffered_bits(size_t count)
+    {
+        VERIFY(count <= 57);
+        while (buffered_bit_count() < count) {
+            u8 byte;
+            if (!m_stream.read_or_error({ &byte, sizeof(byte) })) {
+                set_fatal_error();
+                return false;
+            }
+            m_buffer |= static_cast<u64>(byte) << (m_buffered_bytes * 8);
+            ++m_buffered_bytes;
+        }
+        return true;
+    }
+
+    ALWAYS_INLINE size_t buffered_bit_count() const { return m_buffered_bytes * 8 - m_bit_offset; }
+
+    // The buffered bits in little-endian order; bits past buffered_bit_count() are zero.
+    ALWAYS_INLINE u64 peek_buffered_bits() const { return m_buffer >> m_bit_offset; }
+
+    ALWAYS_INLINE void discard_buffered_bits(size_t count)
+    {
+        VERIFY(count <= buffered_bit_count());
+        m_bit_offset += count;
+        auto whole_bytes = m_bit_offset / 8;
+        if (whole_bytes == 0)
+            return;
+        m_buffer = whole_bytes == 8 ? 0 : m_buffer >> (whole_bytes * 8);
+        m_buffered_bytes -= whole_bytes;
+        m_bit_offset %= 8;
+    }
+
     u64 read_bits(size_t count)
     {
         u64 result = 0;
 
         size_t nread = 0;
         while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
+            auto chunk = min<size_t>(count - nread, 32);
+            if (!ensure_buffered_bits(chunk))
                 return 0;
-            }
 
-            if (m_next_byte.has_value()) {
-                auto const bit = (m_next_byte.value() >> m_bit_offset) & 1;
-                result |= bit << nread;
-                ++nread;
-
-                if (m_bit_offset++ == 7)
-                    m_next_byte.clear();
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
-            }
+            result |= (peek_buffered_bits() & ((1ull << chunk) - 1)) << nread;
+            discard_buffered_bits(chunk);
+            nread += chunk;
         }
 
         return result;
@@ -95,30 +115,25 @@ public:
 
         size_t nread = 0;
         while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
-                return 0;
-            }
-
-            if (m_next_byte.has_value()) {
-                // read an entire byte
-                if (((count - nread) >= 8) && m_bit_offset == 0) {
-                    // shift existing bytes over
-                    result <<= 8;
-                    result |= m_next_byte.value();
-                    nread += 8;
-                    m_next_byte.clear();
-                } else {
-                    auto const bit = (m_next_byte.value() >> (7 - m_bit_offset)) & 1;
-                    result <<= 1;
-                    result |= bit;
-                    ++nread;
-                    if (m_bit_offset++ == 7)
-                        m_next_byte.clear();
-                }
+            // read an entire byte
+            if (((count - nread) >= 8) && m_bit_offset == 0) {
+                if (!ensure_buffered_bits(8))
+                    return 0;
+
+                // shift existing bytes over
+                result <<= 8;
+                result |= static_cast<u8>(m_buffer);
+                nread += 8;
+                discard_buffered_bits(8);
             } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
+                if (!ensure_buffered_bits(1))
+                    return 0;
+
+                auto const bit = (static_cast<u8>(m_buffer) >> (7 - m_bit_offset)) & 1;
+                result <<= 1;
+                result |= bit;
+                ++nread;
+                discard_buffered_bits(1);
             }
         }
 
@@ -131,8 +146,8 @@ public:
 
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value())
-            m_next_byte.clear();
+        if (m_bit_offset != 0)
+            drop_first_buffered_byte();
     }
 
     bool handle_any_error() override
@@ -142,7 +157,16 @@ public:
     }
 
 private:
-    Optional<u8> m_next_byte;
+    ALWAYS_INLINE void drop_first_buffered_byte()
+    {
+        m_buffer >>= 8;
+        --m_buffered_bytes;
+        m_bit_offset = 0;
+    }
+
+    // Up to eight bytes read ahead of the bit position, the first one in the lowest bits.
+    u64 m_buffer { 0 };
+    size_t m_buffered_bytes { 0 };
     size_t m_bit_offset { 0 };
     InputStream& m_stream;
 };
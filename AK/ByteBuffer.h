@@ -152,11 +152,21 @@ public:
         m_size = 0;
     }
 
+    void clear_with_capacity()
+    {
+        m_size = 0;
+    }
+
     ALWAYS_INLINE void resize(size_t new_size)
     {
         MUST(try_resize(new_size));
     }
 
+    ALWAYS_INLINE void resize_and_keep_capacity(size_t new_size)
+    {
+        MUST(try_resize_and_keep_capacity(new_size));
+    }
+
     ALWAYS_INLINE void ensure_capacity(size_t new_capacity)
     {
         MUST(try_ensure_capacity(new_capacity));
@@ -173,6 +183,17 @@ public:
         return {};
     }
 
+    // Unlike try_resize(), this never gives up the outline buffer when shrinking, so buffers that are
+    // refilled over and over again don't have to be reallocated every time.
+    ErrorOr<void> try_resize_and_keep_capacity(size_t new_size)
+    {
+        if (new_size <= m_size) {
+            m_size = new_size;
+            return {};
+        }
+        return try_resize(new_size);
+    }
+
     ErrorOr<void> try_ensure_capacity(size_t new_capacity)
     {
         if (new_capacity <= capacity())
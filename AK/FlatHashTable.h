@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Concepts.h>
+#include <AK/Error.h>
+#include <AK/Forward.h>
+#include <AK/HashTable.h>
+#include <AK/Optional.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Traits.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// FlatHashTable keeps a separate array of one-byte control words next to its slots.
+// A control word is either one of the special (negative) states below, or the low
+// seven bits of the hash of the value stored in the corresponding slot.
+// Slots are grouped into aligned groups of 16, and a lookup compares the fragment
+// against a whole group of control words at once, only touching slots that match.
+enum class FlatBucketControl : i8 {
+    Empty = -128,
+    Deleted = -2,
+    End = -1,
+};
+
+namespace Detail {
+
+static constexpr size_t flat_hash_table_group_size = 16;
+
+struct FlatHashTableGroup {
+    explicit FlatHashTableGroup(i8 const* control)
+    {
+        __builtin_memcpy(&m_control, control, sizeof(m_control));
+    }
+
+    u32 match(i8 fragment) const
+    {
+        return SIMD::maskbits(m_control == fragment);
+    }
+
+    u32 match_empty() const
+    {
+        return SIMD::maskbits(m_control == static_cast<i8>(FlatBucketControl::Empty));
+    }
+
+    // Empty and Deleted are the only control words that have the sign bit set.
+    u32 match_empty_or_deleted() const
+    {
+        return SIMD::maskbits(m_control);
+    }
+
+private:
+    SIMD::i8x16 m_control;
+};
+
+}
+
+template<typename TableType, typename T>
+class FlatHashTableIterator {
+    friend TableType;
+
+public:
+    bool operator==(FlatHashTableIterator const& other) const { return m_slot == other.m_slot; }
+    bool operator!=(FlatHashTableIterator const& other) const { return m_slot != other.m_slot; }
+    T& operator*() { return *m_slot; }
+    T* operator->() { return m_slot; }
+    void operator++() { skip_to_next(); }
+
+private:
+    void skip_to_next()
+    {
+        if (!m_slot)
+            return;
+        do {
+            ++m_control;
+            ++m_slot;
+        } while (*m_control < 0 && *m_control != static_cast<i8>(FlatBucketControl::End));
+        if (*m_control == static_cast<i8>(FlatBucketControl::End)) {
+            m_control = nullptr;
+            m_slot = nullptr;
+        }
+    }
+
+    FlatHashTableIterator(i8 const* control, T* slot)
+        : m_control(control)
+        , m_slot(slot)
+    {
+    }
+
+    i8 const* m_control { nullptr };
+    T* m_slot { nullptr };
+};
+
+template<typename T, typename TraitsForT>
+class FlatHashTable {
+    static constexpr size_t group_size = Detail::flat_hash_table_group_size;
+    static constexpr size_t load_factor_in_percent = 80;
+
+public:
+    FlatHashTable() = default;
+    explicit FlatHashTable(size_t capacity) { ensure_capacity(capacity); }
+
+    ~FlatHashTable()
+    {
+        if (!m_slots)
+            return;
+
+        if constexpr (!Detail::IsTriviallyDestructible<T>) {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (is_full(m_control[i]))
+                    m_slots[i].~T();
+            }
+        }
+
+        kfree_sized(m_slots, size_in_bytes(m_capacity));
+    }
+
+    FlatHashTable(FlatHashTable const& other)
+    {
+        ensure_capacity(other.size());
+        for (auto& it : other)
+            set(it);
+    }
+
+    FlatHashTable& operator=(FlatHashTable const& other)
+    {
+        FlatHashTable temporary(other);
+        swap(*this, temporary);
+        return *this;
+    }
+
+    FlatHashTable(FlatHashTable&& other) noexcept
+        : m_slots(exchange(other.m_slots, nullptr))
+        , m_control(exchange(other.m_control, nullptr))
+        , m_size(exchange(other.m_size, 0))
+        , m_capacity(exchange(other.m_capacity, 0))
+        , m_deleted_count(exchange(other.m_deleted_count, 0))
+    {
+    }
+
+    FlatHashTable& operator=(FlatHashTable&& other) noexcept
+    {
+        FlatHashTable temporary { move(other) };
+        swap(*this, temporary);
+        return *this;
+    }
+
+    friend void swap(FlatHashTable& a, FlatHashTable& b) noexcept
+    {
+        swap(a.m_slots, b.m_slots);
+        swap(a.m_control, b.m_control);
+        swap(a.m_size, b.m_size);
+        swap(a.m_capacity, b.m_capacity);
+        swap(a.m_deleted_count, b.m_deleted_count);
+    }
+
+    [[nodiscard]] bool is_empty() const { return m_size == 0; }
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+    void ensure_capacity(size_t capacity)
+    {
+        MUST(try_ensure_capacity(capacity));
+    }
+
+    ErrorOr<void> try_ensure_capacity(size_t capacity)
+    {
+        VERIFY(capacity >= size());
+        auto new_capacity = capacity_for_size(capacity);
+        if (new_capacity <= m_capacity)
+            return {};
+        return try_rehash(new_capacity);
+    }
+
+    [[nodiscard]] bool contains(T const& value) const
+    {
+        return find(value) != end();
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] bool contains(K const& value) const
+    {
+        return find(value) != end();
+    }
+
+    using Iterator = FlatHashTableIterator<FlatHashTable, T>;
+    using ConstIterator = FlatHashTableIterator<const FlatHashTable, const T>;
+
+    [[nodiscard]] Iterator begin() { return Iterator(first_full_slot()); }
+    [[nodiscard]] Iterator end() { return Iterator(nullptr, nullptr); }
+    [[nodiscard]] ConstIterator begin() const { return ConstIterator(first_full_slot()); }
+    [[nodiscard]] ConstIterator end() const { return ConstIterator(nullptr, nullptr); }
+
+    void clear()
+    {
+        *this = FlatHashTable();
+    }
+
+    void clear_with_capacity()
+    {
+        if (!m_slots)
+            return;
+        if constexpr (!Detail::IsTriviallyDestructible<T>) {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (is_full(m_control[i]))
+                    m_slots[i].~T();
+            }
+        }
+        __builtin_memset(m_control, static_cast<u8>(FlatBucketControl::Empty), m_capacity);
+        m_size = 0;
+        m_deleted_count = 0;
+    }
+
+    template<typename U = T>
+    ErrorOr<HashSetResult> try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behavior = HashSetExistingEntryBehavior::Replace)
+    {
+        auto hash = TraitsForT::hash(value);
+        auto index = lookup_with_hash(hash, [&](auto& other) { return TraitsForT::equals(other, value); });
+        if (index.has_value()) {
+            if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep)
+                return HashSetResult::KeptExistingEntry;
+            m_slots[*index] = forward<U>(value);
+            return HashSetResult::ReplacedExistingEntry;
+        }
+
+        if (should_grow())
+            TRY(try_grow());
+
+        auto slot_index = find_slot_for_insertion(hash);
+        new (&m_slots[slot_index]) T(forward<U>(value));
+        if (m_control[slot_index] == static_cast<i8>(FlatBucketControl::Deleted))
+            --m_deleted_count;
+        m_control[slot_index] = fragment_of(hash);
+        ++m_size;
+        return HashSetResult::InsertedNewEntry;
+    }
+
+    template<typename U = T>
+    HashSetResult set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace)
+    {
+        return MUST(try_set(forward<U>(value), existing_entry_behaviour));
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] Iterator find(unsigned hash, TUnaryPredicate predicate)
+    {
+        auto index = lookup_with_hash(hash, move(predicate));
+        if (!index.has_value())
+            return end();
+        return Iterator(&m_control[*index], &m_slots[*index]);
+    }
+
+    [[nodiscard]] Iterator find(T const& value)
+    {
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] ConstIterator find(unsigned hash, TUnaryPredicate predicate) const
+    {
+        auto index = lookup_with_hash(hash, move(predicate));
+        if (!index.has_value())
+            return end();
+        return ConstIterator(&m_control[*index], &m_slots[*index]);
+    }
+
+    [[nodiscard]] ConstIterator find(T const& value) const
+    {
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value)
+    {
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value) const
+    {
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+    }
+
+    bool remove(T const& value)
+    {
+        auto it = find(value);
+        if (it != end()) {
+            remove(it);
+            return true;
+        }
+        return false;
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) bool remove(K const& value)
+    {
+        auto it = find(value);
+        if (it != end()) {
+            remove(it);
+            return true;
+        }
+        return false;
+    }
+
+    void remove(Iterator iterator)
+    {
+        VERIFY(iterator.m_slot);
+        delete_slot(static_cast<size_t>(iterator.m_slot - m_slots));
+    }
+
+    template<typename TUnaryPredicate>
+    bool remove_all_matching(TUnaryPredicate const& predicate)
+    {
+        size_t removed_count = 0;
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (is_full(m_control[i]) && predicate(m_slots[i])) {
+                delete_slot(i);
+                ++removed_count;
+            }
+        }
+        return removed_count;
+    }
+
+private:
+    static constexpr bool is_full(i8 control) { return control >= 0; }
+    static constexpr i8 fragment_of(unsigned hash) { return static_cast<i8>(hash & 0x7f); }
+    static constexpr size_t group_of(unsigned hash) { return hash >> 7; }
+
+    [[nodiscard]] static constexpr size_t size_in_bytes(size_t capacity)
+    {
+        // The control words live directly behind the slots, followed by one End marker for the iterators.
+        return sizeof(T) * capacity + capacity + 1;
+    }
+
+    [[nodiscard]] static size_t capacity_for_size(size_t size)
+    {
+        size_t capacity = group_size;
+        while ((size + 1) * 100 >= capacity * load_factor_in_percent)
+            capacity *= 2;
+        return capacity;
+    }
+
+    [[nodiscard]] size_t group_mask() const { return (m_capacity / group_size) - 1; }
+
+    Iterator first_full_slot()
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (is_full(m_control[i]))
+                return Iterator(&m_control[i], &m_slots[i]);
+        }
+        return end();
+    }
+
+    ConstIterator first_full_slot() const
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (is_full(m_control[i]))
+                return ConstIterator(&m_control[i], &m_slots[i]);
+        }
+        return end();
+    }
+
+    // Groups are probed in triangular order, which visits every group exactly once
+    // since the number of groups is always a power of two.
+    template<typename TUnaryPredicate>
+    [[nodiscard]] Optional<size_t> lookup_with_hash(unsigned hash, TUnaryPredicate predicate) const
+    {
+        if (is_empty())
+            return {};
+
+        auto fragment = fragment_of(hash);
+        auto mask = group_mask();
+        auto group_index = group_of(hash) & mask;
+        for (size_t step = 1;; ++step) {
+            auto const* control = &m_control[group_index * group_size];
+            Detail::FlatHashTableGroup group { control };
+            for (auto matches = group.match(fragment); matches; matches &= matches - 1) {
+                auto index = group_index * group_size + count_trailing_zeroes(matches);
+                if (predicate(m_slots[index]))
+                    return index;
+            }
+            if (group.match_empty())
+                return {};
+            if (step > mask)
+                return {};
+            group_index = (group_index + step) & mask;
+        }
+    }
+
+    [[nodiscard]] size_t find_slot_for_insertion(unsigned hash) const
+    {
+        auto mask = group_mask();
+        auto group_index = group_of(hash) & mask;
+        for (size_t step = 1;; ++step) {
+            Detail::FlatHashTableGroup group { &m_control[group_index * group_size] };
+            if (auto available = group.match_empty_or_deleted())
+                return group_index * group_size + count_trailing_zeroes(available);
+            VERIFY(step <= mask);
+            group_index = (group_index + step) & mask;
+        }
+    }
+
+    void delete_slot(size_t index)
+    {
+        m_slots[index].~T();
+        --m_size;
+
+        // A probe sequence only ever continues past a group that had no empty slot left.
+        // If this group still has one, nothing can have been displaced past it, so the slot
+        // can go straight back to being empty instead of leaving a tombstone behind.
+        Detail::FlatHashTableGroup group { &m_control[index & ~(group_size - 1)] };
+        if (group.match_empty()) {
+            m_control[index] = static_cast<i8>(FlatBucketControl::Empty);
+        } else {
+            m_control[index] = static_cast<i8>(FlatBucketControl::Deleted);
+            ++m_deleted_count;
+        }
+    }
+
+    [[nodiscard]] bool should_grow() const { return ((m_size + m_deleted_count + 1) * 100) >= (m_capacity * load_factor_in_percent); }
+
+    ErrorOr<void> try_grow()
+    {
+        // If most of the load comes from tombstones, rebuilding at the same size is enough.
+        if (m_capacity && m_deleted_count >= m_size)
+            return try_rehash(m_capacity);
+        return try_rehash(max(capacity_for_size(m_size + 1), m_capacity * 2));
+    }
+
+    ErrorOr<void> try_rehash(size_t new_capacity)
+    {
+        VERIFY(is_power_of_two(new_capacity) && new_capacity >= group_size);
+
+        auto* new_storage = static_cast<u8*>(kmalloc(size_in_bytes(new_capacity)));
+        if (!new_storage)
+            return Error::from_errno(ENOMEM);
+
+        auto* old_slots = m_slots;
+        auto* old_control = m_control;
+        auto old_capacity = m_capacity;
+
+        m_slots = reinterpret_cast<T*>(new_storage);
+        m_control = reinterpret_cast<i8*>(new_storage + sizeof(T) * new_capacity);
+        m_capacity = new_capacity;
+        m_deleted_count = 0;
+        __builtin_memset(m_control, static_cast<u8>(FlatBucketControl::Empty), new_capacity);
+        m_control[new_capacity] = static_cast<i8>(FlatBucketControl::End);
+
+        if (!old_slots)
+            return {};
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!is_full(old_control[i]))
+                continue;
+            auto hash = TraitsForT::hash(old_slots[i]);
+            auto index = find_slot_for_insertion(hash);
+            new (&m_slots[index]) T(move(old_slots[i]));
+            m_control[index] = fragment_of(hash);
+            old_slots[i].~T();
+        }
+
+        kfree_sized(old_slots, size_in_bytes(old_capacity));
+        return {};
+    }
+
+    static constexpr bool is_power_of_two(size_t value) { return value && !(value & (value - 1)); }
+
+    T* m_slots { nullptr };
+    i8* m_control { nullptr };
+    size_t m_size { 0 };
+    size_t m_capacity { 0 };
+    size_t m_deleted_count { 0 };
+};
+
+}
+
+using AK::FlatHashTable;
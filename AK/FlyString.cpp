@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/FlyString.h>
 #include <AK/HashTable.h>
 #include <AK/Optional.h>
@@ -11,6 +12,7 @@
 #include <AK/String.h>
 #include <AK/StringUtils.h>
 #include <AK/StringView.h>
+#include <pthread.h>
 
 namespace AK {
 
@@ -24,16 +26,51 @@ struct FlyStringImplTraits : public Traits<StringImpl*> {
     }
 };
 
-static Singleton<HashTable<StringImpl*, FlyStringImplTraits>> s_table;
+// Interned strings are spread over independently locked shards, so threads that intern different strings
+// rarely have to wait for each other. A shard's lock is only held for a single lookup or insertion.
+class FlyStringTable {
+public:
+    static constexpr size_t shard_count = 32;
 
-static HashTable<StringImpl*, FlyStringImplTraits>& fly_impls()
-{
-    return *s_table;
-}
+    struct alignas(64) Shard {
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        HashTable<StringImpl*, FlyStringImplTraits> impls;
+    };
+
+    Shard& shard_for(unsigned hash)
+    {
+        // The tables index their buckets with the low bits of the hash, so pick the shard with the high ones.
+        return m_shards[hash >> (32 - count_trailing_zeroes(shard_count))];
+    }
+
+private:
+    Shard m_shards[shard_count];
+};
+
+static Singleton<FlyStringTable> s_table;
+
+class FlyStringTableLocker {
+public:
+    explicit FlyStringTableLocker(FlyStringTable::Shard& shard)
+        : m_shard(shard)
+    {
+        pthread_mutex_lock(&m_shard.mutex);
+    }
+
+    ~FlyStringTableLocker() { pthread_mutex_unlock(&m_shard.mutex); }
+
+private:
+    FlyStringTable::Shard& m_shard;
+};
 
 void FlyString::did_destroy_impl(Badge<StringImpl>, StringImpl& impl)
 {
-    fly_impls().remove(&impl);
+    auto& shard = s_table->shard_for(impl.hash());
+    FlyStringTableLocker locker(shard);
+    // Look for this exact impl: an equal string may have been interned in its place after our last reference was dropped.
+    auto it = shard.impls.find(impl.hash(), [&](auto* candidate) { return candidate == &impl; });
+    if (it != shard.impls.end())
+        shard.impls.remove(it);
 }
 
 FlyString::FlyString(String const& string)
@@ -44,33 +81,39 @@ FlyString::FlyString(String const& string)
         m_impl = string.impl();
         return;
     }
-    auto it = fly_impls().find(const_cast<StringImpl*>(string.impl()));
-    if (it == fly_impls().end()) {
-        fly_impls().set(const_cast<StringImpl*>(string.impl()));
-        string.impl()->set_fly({}, true);
-        m_impl = string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
+    auto* impl = const_cast<StringImpl*>(string.impl());
+    auto& shard = s_table->shard_for(impl->hash());
+    FlyStringTableLocker locker(shard);
+    auto it = shard.impls.find(impl);
+    if (it != shard.impls.end() && (*it)->try_ref({})) {
+        m_impl = adopt_ref(**it);
+        return;
     }
+    // This also replaces an equal string that is being destroyed on another thread.
+    shard.impls.set(impl);
+    impl->set_fly({}, true);
+    m_impl = impl;
 }
 
 FlyString::FlyString(StringView string)
 {
     if (string.is_null())
         return;
-    auto it = fly_impls().find(string.hash(), [&](auto& candidate) {
-        return string == candidate;
+    auto hash = string.hash();
+    auto& shard = s_table->shard_for(hash);
+    FlyStringTableLocker locker(shard);
+    // Compare views: wrapping the candidate in a String would touch the reference count of a string that may be dying.
+    auto it = shard.impls.find(hash, [&](auto& candidate) {
+        return string == candidate->view();
     });
-    if (it == fly_impls().end()) {
-        auto new_string = string.to_string();
-        fly_impls().set(new_string.impl());
-        new_string.impl()->set_fly({}, true);
-        m_impl = new_string.impl();
-    } else {
-        VERIFY((*it)->is_fly());
-        m_impl = *it;
+    if (it != shard.impls.end() && (*it)->try_ref({})) {
+        m_impl = adopt_ref(**it);
+        return;
     }
+    auto new_string = string.to_string();
+    shard.impls.set(new_string.impl());
+    new_string.impl()->set_fly({}, true);
+    m_impl = new_string.impl();
 }
 
 template<typename T>
@@ -17,6 +17,7 @@ class ByteBuffer;
 
 class Bitmap;
 using ByteBuffer = AK::Detail::ByteBuffer<32>;
+class DefaultAllocator;
 class Error;
 class GenericLexer;
 class IPv4Address;
@@ -73,15 +74,21 @@ class CircularQueue;
 template<typename T>
 struct Traits;
 
-template<typename T, typename TraitsForT = Traits<T>, bool IsOrdered = false>
+template<typename T, typename TraitsForT = Traits<T>, bool IsOrdered = false, typename Allocator = DefaultAllocator>
 class HashTable;
 
 template<typename T, typename TraitsForT = Traits<T>>
 using OrderedHashTable = HashTable<T, TraitsForT, true>;
 
-template<typename K, typename V, typename KeyTraits = Traits<K>, bool IsOrdered = false>
+template<typename K, typename V, typename KeyTraits = Traits<K>, bool IsOrdered = false, typename Allocator = DefaultAllocator>
 class HashMap;
 
+template<typename T, typename TraitsForT = Traits<T>>
+class FlatHashTable;
+
+template<typename K, typename V, typename KeyTraits = Traits<K>>
+class FlatHashMap;
+
 template<typename K, typename V, typename KeyTraits = Traits<K>>
 using OrderedHashMap = HashMap<K, V, KeyTraits, true>;
 
@@ -127,7 +134,7 @@ class OwnPtr;
 template<typename T>
 class WeakPtr;
 
-template<typename T, size_t inline_capacity = 0>
+template<typename T, size_t inline_capacity = 0, typename Allocator = DefaultAllocator>
 requires(!IsRvalueReference<T>) class Vector;
 
 template<typename T, typename ErrorType = Error>
@@ -143,12 +150,15 @@ using AK::ByteBuffer;
 using AK::Bytes;
 using AK::CircularDuplexStream;
 using AK::CircularQueue;
+using AK::DefaultAllocator;
 using AK::DoublyLinkedList;
 using AK::DuplexMemoryStream;
 using AK::Error;
 using AK::ErrorOr;
 using AK::FixedArray;
 using AK::FixedPoint;
+using AK::FlatHashMap;
+using AK::FlatHashTable;
 using AK::FlyString;
 using AK::Function;
 using AK::GenericLexer;
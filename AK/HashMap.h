@@ -13,7 +13,7 @@
 
 namespace AK {
 
-template<typename K, typename V, typename KeyTraits, bool IsOrdered>
+template<typename K, typename V, typename KeyTraits, bool IsOrdered, typename Allocator>
 class HashMap {
 private:
     struct Entry {
@@ -32,6 +32,11 @@ public:
 
     HashMap() = default;
 
+    explicit HashMap(Allocator allocator)
+        : m_table(move(allocator))
+    {
+    }
+
     HashMap(std::initializer_list<Entry> list)
     {
         ensure_capacity(list.size());
@@ -84,7 +89,7 @@ public:
         });
     }
 
-    using HashTableType = HashTable<Entry, EntryTraits, IsOrdered>;
+    using HashTableType = HashTable<Entry, EntryTraits, IsOrdered, Allocator>;
     using IteratorType = typename HashTableType::Iterator;
     using ConstIteratorType = typename HashTableType::ConstIterator;
 
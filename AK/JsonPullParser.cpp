@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/JsonParser.h>
+#include <AK/JsonPullParser.h>
+
+namespace AK {
+
+constexpr bool is_space(int ch)
+{
+    return ch == '\t' || ch == '\n' || ch == '\r' || ch == ' ';
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::next()
+{
+    ignore_while(is_space);
+
+    switch (m_state) {
+    case State::Done:
+        if (!is_eof())
+            return Error::from_string_literal("JsonPullParser: Didn't consume all input"sv);
+        m_token = {};
+        return m_event = Event::EndOfInput;
+
+    case State::FirstKeyOrEndOfObject:
+        if (peek() == '}')
+            return end_container(Container::Object);
+        [[fallthrough]];
+    case State::Key:
+        TRY(consume_string_token());
+        ignore_while(is_space);
+        if (!consume_specific(':'))
+            return Error::from_string_literal("JsonPullParser: Expected ':'"sv);
+        m_state = State::Value;
+        return m_event = Event::Key;
+
+    case State::FirstValueOrEndOfArray:
+        if (peek() == ']')
+            return end_container(Container::Array);
+        [[fallthrough]];
+    case State::Value:
+        return parse_value();
+
+    case State::CommaOrEnd: {
+        VERIFY(!m_containers.is_empty());
+        auto container = m_containers.last();
+        if (peek() == (container == Container::Object ? '}' : ']'))
+            return end_container(container);
+        if (!consume_specific(','))
+            return Error::from_string_literal("JsonPullParser: Expected ','"sv);
+        if (container == Container::Object) {
+            m_state = State::Key;
+        } else {
+            ignore_while(is_space);
+            if (peek() == ']')
+                return Error::from_string_literal("JsonPullParser: Unexpected ']'"sv);
+            m_state = State::Value;
+        }
+        return next();
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ErrorOr<void> JsonPullParser::skip_container()
+{
+    VERIFY(m_event == Event::StartObject || m_event == Event::StartArray);
+    auto target_depth = depth() - 1;
+    while (depth() > target_depth)
+        TRY(next());
+    return {};
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::start_container(Container container)
+{
+    ignore();
+    TRY(m_containers.try_append(container));
+    m_token = {};
+    if (container == Container::Object) {
+        m_state = State::FirstKeyOrEndOfObject;
+        return m_event = Event::StartObject;
+    }
+    m_state = State::FirstValueOrEndOfArray;
+    return m_event = Event::StartArray;
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::end_container(Container container)
+{
+    ignore();
+    m_containers.take_last();
+    m_token = {};
+    m_state = m_containers.is_empty() ? State::Done : State::CommaOrEnd;
+    return m_event = container == Container::Object ? Event::EndObject : Event::EndArray;
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::parse_value()
+{
+    Event event;
+    switch (peek()) {
+    case '{':
+        return start_container(Container::Object);
+    case '[':
+        return start_container(Container::Array);
+    case '"':
+        TRY(consume_string_token());
+        event = Event::String;
+        break;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        event = TRY(consume_number_token());
+        break;
+    case 'f':
+        event = TRY(consume_literal_token("false"sv, Event::False));
+        break;
+    case 't':
+        event = TRY(consume_literal_token("true"sv, Event::True));
+        break;
+    case 'n':
+        event = TRY(consume_literal_token("null"sv, Event::Null));
+        break;
+    default:
+        return Error::from_string_literal("JsonPullParser: Unexpected character"sv);
+    }
+    m_state = m_containers.is_empty() ? State::Done : State::CommaOrEnd;
+    return m_event = event;
+}
+
+ErrorOr<void> JsonPullParser::consume_string_token()
+{
+    if (!consume_specific('"'))
+        return Error::from_string_literal("JsonPullParser: Expected '\"'"sv);
+
+    auto start = m_index;
+    m_token_has_escapes = false;
+    for (;;) {
+        if (is_eof())
+            return Error::from_string_literal("JsonPullParser: EOF while parsing string"sv);
+        char ch = m_input[m_index];
+        if (ch == '"')
+            break;
+        if (is_ascii_c0_control(ch))
+            return Error::from_string_literal("JsonPullParser: Error while parsing string"sv);
+        if (ch == '\\') {
+            // The escape sequence itself is validated when the string is unescaped.
+            m_token_has_escapes = true;
+            ++m_index;
+            if (is_eof())
+                return Error::from_string_literal("JsonPullParser: EOF while parsing string"sv);
+        }
+        ++m_index;
+    }
+    m_token = m_input.substring_view(start, m_index - start);
+    ignore();
+    return {};
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::consume_number_token()
+{
+    auto start = m_index;
+    while (!is_eof()) {
+        char ch = peek();
+        if (!is_ascii_digit(ch) && ch != '-' && ch != '.')
+            break;
+        ++m_index;
+    }
+    m_token = m_input.substring_view(start, m_index - start);
+    return Event::Number;
+}
+
+ErrorOr<JsonPullParser::Event> JsonPullParser::consume_literal_token(StringView literal, Event event)
+{
+    auto start = m_index;
+    if (!consume_specific(literal))
+        return Error::from_string_literal("JsonPullParser: Unexpected character"sv);
+    m_token = m_input.substring_view(start, literal.length());
+    return event;
+}
+
+ErrorOr<String> JsonPullParser::unescaped_string() const
+{
+    VERIFY(m_event == Event::Key || m_event == Event::String);
+    if (!m_token_has_escapes)
+        return String { m_token };
+
+    // Hand the quoted token to the tree parser, which knows how to unescape a string.
+    StringView quoted_token { m_token.characters_without_null_termination() - 1, m_token.length() + 2 };
+    auto value = TRY(JsonParser(quoted_token).parse());
+    return value.as_string();
+}
+
+ErrorOr<JsonValue> JsonPullParser::value() const
+{
+    switch (m_event) {
+    case Event::Key:
+    case Event::String:
+        return JsonValue { TRY(unescaped_string()) };
+    case Event::Number:
+        return JsonParser(m_token).parse();
+    case Event::True:
+        return JsonValue { true };
+    case Event::False:
+        return JsonValue { false };
+    case Event::Null:
+        return JsonValue {};
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/GenericLexer.h>
+#include <AK/JsonValue.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+// A cursor over a JSON document that reports one token at a time instead of building a JsonValue tree.
+// Tokens are views into the input, so nothing is allocated unless a value is explicitly requested.
+//
+//     JsonPullParser parser { mapped_file->bytes() };
+//     for (auto event = TRY(parser.next()); event != JsonPullParser::Event::EndOfInput; event = TRY(parser.next())) {
+//         if (event == JsonPullParser::Event::Key && parser.token() == "pid"sv)
+//             ...
+//     }
+class JsonPullParser : private GenericLexer {
+public:
+    enum class Event {
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+        EndOfInput,
+    };
+
+    explicit JsonPullParser(StringView input)
+        : GenericLexer(input)
+    {
+    }
+
+    explicit JsonPullParser(ReadonlyBytes input)
+        : GenericLexer(StringView { input })
+    {
+    }
+
+    ErrorOr<Event> next();
+
+    // Skips over the remainder of the object or array that was just started.
+    ErrorOr<void> skip_container();
+
+    // Raw text of the current token: the literal for numbers, true, false and null, and the
+    // still-escaped contents between the quotes for keys and strings.
+    StringView token() const { return m_token; }
+    bool token_has_escapes() const { return m_token_has_escapes; }
+
+    // Materializes the current scalar token (including keys) as a JsonValue.
+    ErrorOr<JsonValue> value() const;
+    ErrorOr<String> unescaped_string() const;
+
+    size_t depth() const { return m_containers.size(); }
+    size_t offset() const { return tell(); }
+
+private:
+    enum class State {
+        Value,
+        FirstValueOrEndOfArray,
+        Key,
+        FirstKeyOrEndOfObject,
+        CommaOrEnd,
+        Done,
+    };
+
+    enum class Container : u8 {
+        Object,
+        Array,
+    };
+
+    ErrorOr<Event> start_container(Container);
+    ErrorOr<Event> end_container(Container);
+    ErrorOr<Event> parse_value();
+    ErrorOr<void> consume_string_token();
+    ErrorOr<Event> consume_number_token();
+    ErrorOr<Event> consume_literal_token(StringView literal, Event);
+
+    Vector<Container, 32> m_containers;
+    State m_state { State::Value };
+    Event m_event { Event::EndOfInput };
+    StringView m_token;
+    bool m_token_has_escapes { false };
+};
+
+}
+
+using AK::JsonPullParser;
@@ -8,10 +8,18 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/NumericLimits.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 
+#if defined(__SSE2__) && !defined(KERNEL)
+#    define AK_MEMMEM_HAS_SIMD
+#    include <AK/SIMD.h>
+#    include <AK/SIMDExtras.h>
+#endif
+
 namespace AK {
 
 namespace Detail {
@@ -40,6 +48,140 @@ constexpr void const* bitap_bitwise(void const* haystack, size_t haystack_length
 
     return nullptr;
 }
+
+#ifdef AK_MEMMEM_HAS_SIMD
+// The kernels below look at 16 bytes at a time: each block is compared against a broadcast
+// needle byte, and the resulting byte mask is collapsed into a bitmask with one bit per position.
+ALWAYS_INLINE static SIMD::u8x16 load_block(u8 const* bytes)
+{
+    SIMD::u8x16 block;
+    __builtin_memcpy(&block, bytes, sizeof(block));
+    return block;
+}
+
+// An aligned block never straddles a page, so it can be loaded whenever any byte in it can be read, even if the
+// others lie outside the buffer. The address sanitizer can't know that.
+NO_SANITIZE_ADDRESS inline SIMD::u8x16 load_aligned_block(u8 const* bytes)
+{
+    return *reinterpret_cast<SIMD::u8x16 const*>(bytes);
+}
+
+ALWAYS_INLINE static SIMD::u8x16 broadcast(u8 byte)
+{
+    return SIMD::u8x16 {} + byte;
+}
+
+ALWAYS_INLINE static u32 match_bits(SIMD::u8x16 block, SIMD::u8x16 needle)
+{
+    return SIMD::maskbits(block == needle);
+}
+#endif
+}
+
+// Like memchr(), this doesn't read past the block holding the first match, so the length may be larger than the
+// buffer as long as the needle is in it.
+inline Optional<size_t> memchr_optional(void const* haystack, size_t haystack_length, u8 needle)
+{
+    auto const* bytes = static_cast<u8 const*>(haystack);
+#ifdef AK_MEMMEM_HAS_SIMD
+    if (haystack_length == 0)
+        return {};
+
+    // Positions count from the aligned block that holds the first byte. The end is clamped, as oversized lengths
+    // may not fit.
+    size_t offset = reinterpret_cast<FlatPtr>(bytes) % 16;
+    auto const* blocks = bytes - offset;
+    size_t end = haystack_length + offset < haystack_length ? NumericLimits<size_t>::max() : haystack_length + offset;
+
+    auto needles = Detail::broadcast(needle);
+    size_t position = 0;
+    u32 matches = Detail::match_bits(Detail::load_aligned_block(blocks), needles) & (0xffffu << offset);
+    while (true) {
+        if (end - position < 16)
+            matches &= (1u << (end - position)) - 1;
+        if (matches)
+            return position + count_trailing_zeroes(matches) - offset;
+        position += 16;
+
+        // Check four blocks per iteration, and only work out which one matched once any of them did. An aligned
+        // group of four doesn't straddle a page either.
+        while ((reinterpret_cast<FlatPtr>(blocks + position) % 64 == 0) && (position < end) && (end - position >= 64)) {
+            auto a = Detail::load_aligned_block(blocks + position) == needles;
+            auto b = Detail::load_aligned_block(blocks + position + 16) == needles;
+            auto c = Detail::load_aligned_block(blocks + position + 32) == needles;
+            auto d = Detail::load_aligned_block(blocks + position + 48) == needles;
+            if (SIMD::maskbits(a | b | c | d))
+                break;
+            position += 64;
+        }
+        if (position >= end)
+            return {};
+        matches = Detail::match_bits(Detail::load_aligned_block(blocks + position), needles);
+    }
+#else
+    for (size_t i = 0; i < haystack_length; ++i) {
+        if (bytes[i] == needle)
+            return i;
+    }
+    return {};
+#endif
+}
+
+inline Optional<size_t> memchr_any_of_optional(void const* haystack, size_t haystack_length, ReadonlyBytes needles)
+{
+    if (needles.is_empty())
+        return {};
+    if (needles.size() == 1)
+        return memchr_optional(haystack, haystack_length, needles[0]);
+
+    auto const* bytes = static_cast<u8 const*>(haystack);
+    size_t i = 0;
+#ifdef AK_MEMMEM_HAS_SIMD
+    if (needles.size() <= 16) {
+        Array<SIMD::u8x16, 16> broadcast_needles;
+        for (size_t j = 0; j < needles.size(); ++j)
+            broadcast_needles[j] = Detail::broadcast(needles[j]);
+        for (; i + 16 <= haystack_length; i += 16) {
+            auto block = Detail::load_block(bytes + i);
+            auto matches = block == broadcast_needles[0];
+            for (size_t j = 1; j < needles.size(); ++j)
+                matches |= block == broadcast_needles[j];
+            if (auto bits = SIMD::maskbits(matches))
+                return i + count_trailing_zeroes(bits);
+        }
+    }
+#endif
+    u32 needle_set[256 / 32] {};
+    for (auto needle : needles)
+        needle_set[needle / 32] |= 1u << (needle % 32);
+    for (; i < haystack_length; ++i) {
+        if (needle_set[bytes[i] / 32] & (1u << (bytes[i] % 32)))
+            return i;
+    }
+    return {};
+}
+
+inline size_t memchr_count(void const* haystack, size_t haystack_length, u8 needle)
+{
+    auto const* bytes = static_cast<u8 const*>(haystack);
+    size_t count = 0;
+    size_t i = 0;
+#ifdef AK_MEMMEM_HAS_SIMD
+    auto needles = Detail::broadcast(needle);
+    while (i + 16 <= haystack_length) {
+        // Every match subtracts -1 from its byte lane; the lanes are summed before any of them can overflow.
+        SIMD::u8x16 lane_counts {};
+        for (size_t blocks = 0; blocks < 255 && i + 16 <= haystack_length; ++blocks, i += 16)
+            lane_counts -= (SIMD::u8x16)(Detail::load_block(bytes + i) == needles);
+        auto sums = __builtin_ia32_psadbw128((SIMD::c8x16)lane_counts, SIMD::c8x16 {});
+        count += sums[0] + sums[1];
+    }
+#endif
+    for (; i < haystack_length; ++i) {
+        if (bytes[i] == needle)
+            ++count;
+    }
+    return count;
 }
 
 template<typename HaystackIterT>
@@ -100,6 +242,63 @@ inline Optional<size_t> memmem(HaystackIterT const& haystack_begin, HaystackIter
     return {};
 }
 
+namespace Detail {
+inline Optional<size_t> memmem_scalar(void const* haystack, size_t haystack_length, void const* needle, size_t needle_length)
+{
+    if (needle_length < 32) {
+        auto const* ptr = Detail::bitap_bitwise(haystack, haystack_length, needle, needle_length);
+        if (ptr)
+            return static_cast<size_t>((FlatPtr)ptr - (FlatPtr)haystack);
+        return {};
+    }
+
+    // Fallback to KMP.
+    Array<AK::Span<const u8>, 1> spans { AK::Span<const u8> { (u8 const*)haystack, haystack_length } };
+    return memmem(spans.begin(), spans.end(), { (u8 const*)needle, needle_length });
+}
+
+#ifdef AK_MEMMEM_HAS_SIMD
+// Only positions where both the first and the last byte of the needle line up are compared in full.
+// Inputs where that filter keeps letting through false candidates (e.g. long runs of a single byte)
+// are handed over to the linear-time scalar search instead.
+inline Optional<size_t> memmem_first_and_last_byte_filter(void const* haystack, size_t haystack_length, void const* needle, size_t needle_length)
+{
+    VERIFY(needle_length >= 2 && haystack_length > needle_length);
+    auto const* haystack_bytes = static_cast<u8 const*>(haystack);
+    auto const* needle_bytes = static_cast<u8 const*>(needle);
+    auto first = broadcast(needle_bytes[0]);
+    auto last = broadcast(needle_bytes[needle_length - 1]);
+
+    size_t i = 0;
+    size_t rejected_candidates = 0;
+    while (i + needle_length - 1 + 16 <= haystack_length && rejected_candidates <= 64 + i / 8) {
+        auto candidates = SIMD::maskbits((load_block(haystack_bytes + i) == first) & (load_block(haystack_bytes + i + needle_length - 1) == last));
+        for (; candidates; candidates &= candidates - 1) {
+            auto offset = i + count_trailing_zeroes(candidates);
+            if (__builtin_memcmp(haystack_bytes + offset + 1, needle_bytes + 1, needle_length - 2) == 0)
+                return offset;
+            ++rejected_candidates;
+        }
+        i += 16;
+    }
+
+    if (rejected_candidates > 64 + i / 8) {
+        auto result = memmem_scalar(haystack_bytes + i, haystack_length - i, needle, needle_length);
+        if (result.has_value())
+            return *result + i;
+        return {};
+    }
+
+    // Fewer than 16 candidate positions are left, which is not worth setting up a scalar search for.
+    for (; i + needle_length <= haystack_length; ++i) {
+        if (haystack_bytes[i] == needle_bytes[0] && __builtin_memcmp(haystack_bytes + i + 1, needle_bytes + 1, needle_length - 1) == 0)
+            return i;
+    }
+    return {};
+}
+#endif
+}
+
 inline Optional<size_t> memmem_optional(void const* haystack, size_t haystack_length, void const* needle, size_t needle_length)
 {
     if (needle_length == 0)
@@ -114,16 +313,13 @@ inline Optional<size_t> memmem_optional(void const* haystack, size_t haystack_le
         return {};
     }
 
-    if (needle_length < 32) {
-        auto const* ptr = Detail::bitap_bitwise(haystack, haystack_length, needle, needle_length);
-        if (ptr)
-            return static_cast<size_t>((FlatPtr)ptr - (FlatPtr)haystack);
-        return {};
-    }
-
-    // Fallback to KMP.
-    Array<Span<const u8>, 1> spans { Span<const u8> { (u8 const*)haystack, haystack_length } };
-    return memmem(spans.begin(), spans.end(), { (u8 const*)needle, needle_length });
+#ifdef AK_MEMMEM_HAS_SIMD
+    if (needle_length == 1)
+        return memchr_optional(haystack, haystack_length, *static_cast<u8 const*>(needle));
+    return Detail::memmem_first_and_last_byte_filter(haystack, haystack_length, needle, needle_length);
+#else
+    return Detail::memmem_scalar(haystack, haystack_length, needle, needle_length);
+#endif
 }
 
 inline void const* memmem(void const* haystack, size_t haystack_length, void const* needle, size_t needle_length)
@@ -136,3 +332,5 @@ inline void const* memmem(void const* haystack, size_t haystack_length, void con
 }
 
 }
+
+#undef AK_MEMMEM_HAS_SIMD
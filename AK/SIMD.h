@@ -33,8 +33,10 @@ using i32x2 = i32 __attribute__((vector_size(8)));
 using i32x4 = i32 __attribute__((vector_size(16)));
 using i32x8 = i32 __attribute__((vector_size(32)));
 
-using i64x2 = i64 __attribute__((vector_size(16)));
-using i64x4 = i64 __attribute__((vector_size(32)));
+// the asm intrinsics demand long longs as the 64-bit type, which i64
+// is not on every platform
+using i64x2 = long long __attribute__((vector_size(16)));
+using i64x4 = long long __attribute__((vector_size(32)));
 
 using u8x2 = u8 __attribute__((vector_size(2)));
 using u8x4 = u8 __attribute__((vector_size(4)));
@@ -80,6 +80,18 @@ ALWAYS_INLINE static bool none(i32x4 mask)
     return maskbits(mask) == 0;
 }
 
+ALWAYS_INLINE static u32 maskbits(i8x16 mask)
+{
+#if defined(__SSE2__)
+    return static_cast<u16>(__builtin_ia32_pmovmskb128((c8x16)mask));
+#else
+    u32 bits = 0;
+    for (size_t i = 0; i < 16; ++i)
+        bits |= static_cast<u32>(static_cast<u8>(mask[i]) >> 7) << i;
+    return bits;
+#endif
+}
+
 ALWAYS_INLINE static int maskcount(i32x4 mask)
 {
     constexpr static int count_lut[16] { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
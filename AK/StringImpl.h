@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
@@ -80,6 +81,38 @@ public:
     bool is_fly() const { return m_fly; }
     void set_fly(Badge<FlyString>, bool fly) const { m_fly = fly; }
 
+    // Fly strings are shared between threads through the FlyString table, so their reference count is
+    // updated atomically. Every other string keeps the cheaper non-atomic reference count.
+    ALWAYS_INLINE void ref() const
+    {
+        if (m_fly)
+            atomic_fetch_add(&m_ref_count, 1u, memory_order_relaxed);
+        else
+            RefCounted::ref();
+    }
+
+    ALWAYS_INLINE bool unref() const
+    {
+        if (!m_fly)
+            return RefCounted::unref();
+        if (atomic_fetch_sub(&m_ref_count, 1u, memory_order_acq_rel) != 1)
+            return false;
+        delete this;
+        return true;
+    }
+
+    // Fails if the last reference to this fly string is already gone, and it is about to be destroyed.
+    [[nodiscard]] bool try_ref(Badge<FlyString>) const
+    {
+        VERIFY(m_fly);
+        auto ref_count = atomic_load(&m_ref_count, memory_order_relaxed);
+        while (ref_count != 0) {
+            if (atomic_compare_exchange_strong(&m_ref_count, ref_count, ref_count + 1, memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
 private:
     enum ConstructTheEmptyStringImplTag {
         ConstructTheEmptyStringImpl
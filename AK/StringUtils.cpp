@@ -359,11 +359,8 @@ Optional<size_t> find(StringView haystack, char needle, size_t start)
 {
     if (start >= haystack.length())
         return {};
-    for (size_t i = start; i < haystack.length(); ++i) {
-        if (haystack[i] == needle)
-            return i;
-    }
-    return {};
+    auto index = AK::memchr_optional(haystack.characters_without_null_termination() + start, haystack.length() - start, needle);
+    return index.has_value() ? (*index + start) : index;
 }
 
 Optional<size_t> find(StringView haystack, StringView needle, size_t start)
@@ -406,10 +403,7 @@ Optional<size_t> find_any_of(StringView haystack, StringView needles, SearchDire
     if (haystack.is_empty() || needles.is_empty())
         return {};
     if (direction == SearchDirection::Forward) {
-        for (size_t i = 0; i < haystack.length(); ++i) {
-            if (needles.contains(haystack[i]))
-                return i;
-        }
+        return AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), needles.bytes());
     } else if (direction == SearchDirection::Backward) {
         for (size_t i = haystack.length(); i > 0; --i) {
             if (needles.contains(haystack[i - 1]))
@@ -496,6 +490,8 @@ size_t count(StringView str, StringView needle)
 {
     if (needle.is_empty())
         return str.length();
+    if (needle.length() == 1)
+        return AK::memchr_count(str.characters_without_null_termination(), str.length(), needle[0]);
 
     size_t count = 0;
     for (size_t i = 0; i < str.length() - needle.length() + 1; ++i) {
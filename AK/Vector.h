@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Allocator.h>
 #include <AK/Assertions.h>
 #include <AK/Error.h>
 #include <AK/Find.h>
@@ -41,7 +42,7 @@ struct CanBePlacedInsideVectorHelper<StorageType, false> {
 };
 }
 
-template<typename T, size_t inline_capacity>
+template<typename T, size_t inline_capacity, typename Allocator>
 requires(!IsRvalueReference<T>) class Vector {
 private:
     static constexpr bool contains_reference = IsLvalueReference<T>;
@@ -59,6 +60,12 @@ public:
     {
     }
 
+    explicit Vector(Allocator allocator)
+        : m_capacity(inline_capacity)
+        , m_allocator(move(allocator))
+    {
+    }
+
     Vector(std::initializer_list<T> list) requires(!IsLvalueReference<T>)
     {
         ensure_capacity(list.size());
@@ -70,6 +77,7 @@ public:
         : m_size(other.m_size)
         , m_capacity(other.m_capacity)
         , m_outline_buffer(other.m_outline_buffer)
+        , m_allocator(other.m_allocator)
     {
         if constexpr (inline_capacity > 0) {
             if (!m_outline_buffer) {
@@ -85,6 +93,7 @@ public:
     }
 
     Vector(Vector const& other)
+        : m_allocator(other.m_allocator)
     {
         ensure_capacity(other.size());
         TypedTransfer<StorageType>::copy(data(), other.data(), other.size());
@@ -120,6 +129,7 @@ public:
     bool is_empty() const { return size() == 0; }
     ALWAYS_INLINE size_t size() const { return m_size; }
     size_t capacity() const { return m_capacity; }
+    Allocator const& allocator() const { return m_allocator; }
 
     ALWAYS_INLINE StorageType* data()
     {
@@ -323,6 +333,7 @@ public:
             m_size = other.m_size;
             m_capacity = other.m_capacity;
             m_outline_buffer = other.m_outline_buffer;
+            m_allocator = other.m_allocator;
             if constexpr (inline_capacity > 0) {
                 if (!m_outline_buffer) {
                     for (size_t i = 0; i < m_size; ++i) {
@@ -363,7 +374,7 @@ public:
     {
         clear_with_capacity();
         if (m_outline_buffer) {
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            m_allocator.deallocate(m_outline_buffer, m_capacity * sizeof(StorageType));
             m_outline_buffer = nullptr;
         }
         reset_capacity();
@@ -632,8 +643,8 @@ public:
     {
         if (m_capacity >= needed_capacity)
             return {};
-        size_t new_capacity = kmalloc_good_size(needed_capacity * sizeof(StorageType)) / sizeof(StorageType);
-        auto* new_buffer = static_cast<StorageType*>(kmalloc_array(new_capacity, sizeof(StorageType)));
+        size_t new_capacity = m_allocator.good_size(needed_capacity * sizeof(StorageType)) / sizeof(StorageType);
+        auto* new_buffer = static_cast<StorageType*>(m_allocator.allocate(new_capacity * sizeof(StorageType)));
         if (new_buffer == nullptr)
             return Error::from_errno(ENOMEM);
 
@@ -646,7 +657,7 @@ public:
             }
         }
         if (m_outline_buffer)
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            m_allocator.deallocate(m_outline_buffer, m_capacity * sizeof(StorageType));
         m_outline_buffer = new_buffer;
         m_capacity = new_capacity;
         return {};
@@ -823,6 +834,7 @@ private:
 
     alignas(storage_alignment()) unsigned char m_inline_buffer_storage[storage_size()];
     StorageType* m_outline_buffer { nullptr };
+    [[no_unique_address]] Allocator m_allocator;
 };
 
 template<class... Args>
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Arena.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+TEST_CASE(allocations_are_aligned)
+{
+    Arena arena;
+    for (size_t size = 1; size < 100; ++size) {
+        auto* ptr = arena.allocate(size);
+        EXPECT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<FlatPtr>(ptr) % Arena::default_alignment, 0u);
+    }
+    auto* ptr = arena.allocate(3, 64);
+    EXPECT_EQ(reinterpret_cast<FlatPtr>(ptr) % 64, 0u);
+    EXPECT_EQ(arena.allocation_count(), 100u);
+}
+
+TEST_CASE(chunks)
+{
+    Arena arena { 4 * KiB };
+    for (size_t i = 0; i < 100; ++i)
+        arena.allocate(64);
+    EXPECT(arena.chunk_count() > 1);
+    EXPECT_EQ(arena.bytes_allocated(), 6400u);
+
+    // Allocations larger than a chunk get a chunk of their own.
+    auto* large = static_cast<u8*>(arena.allocate(16 * KiB));
+    __builtin_memset(large, 0xaa, 16 * KiB);
+
+    arena.clear();
+    EXPECT_EQ(arena.chunk_count(), 0u);
+    EXPECT_EQ(arena.allocation_count(), 0u);
+    EXPECT_NE(arena.allocate(8), nullptr);
+}
+
+TEST_CASE(deallocated_blocks_are_reused)
+{
+    Arena arena;
+    auto* first = arena.allocate(100);
+    auto* second = arena.allocate(20);
+    EXPECT_EQ(arena.bytes_allocated(), 128u + 32u);
+
+    // Blocks are only handed out again to allocations of the same size class.
+    arena.deallocate(first, 100);
+    arena.deallocate(second, 20);
+    EXPECT_EQ(arena.allocate(30), second);
+    EXPECT_EQ(arena.allocate(65), first);
+    EXPECT_NE(arena.allocate(100), first);
+    EXPECT_EQ(arena.reused_count(), 2u);
+    EXPECT_EQ(arena.bytes_allocated(), 128u + 32u + 128u);
+}
+
+TEST_CASE(vector)
+{
+    Arena arena;
+    Vector<String, 0, ArenaAllocator> strings { arena };
+    for (int i = 0; i < 1000; ++i)
+        strings.append(String::number(i));
+    EXPECT_EQ(strings.size(), 1000u);
+    EXPECT_EQ(strings[0], "0");
+    EXPECT_EQ(strings[999], "999");
+    EXPECT(arena.allocation_count() > 0);
+
+    auto moved = move(strings);
+    EXPECT_EQ(moved.size(), 1000u);
+    EXPECT_EQ(&moved.allocator().arena(), &arena);
+    moved.append("more");
+
+    auto copied = moved;
+    EXPECT_EQ(copied.size(), 1001u);
+    EXPECT_EQ(&copied.allocator().arena(), &arena);
+}
+
+TEST_CASE(vector_with_inline_capacity)
+{
+    Arena arena;
+    Vector<int, 4, ArenaAllocator> values { arena };
+    for (int i = 0; i < 4; ++i)
+        values.append(i);
+    EXPECT_EQ(arena.allocation_count(), 0u);
+    values.append(4);
+    EXPECT_EQ(arena.allocation_count(), 1u);
+    EXPECT_EQ(values, Vector<int>({ 0, 1, 2, 3, 4 }));
+}
+
+TEST_CASE(hash_table)
+{
+    Arena arena;
+    HashTable<String, Traits<String>, false, ArenaAllocator> table { arena };
+    for (int i = 0; i < 1000; ++i)
+        table.set(String::number(i));
+    EXPECT_EQ(table.size(), 1000u);
+    EXPECT(table.contains("123"));
+    EXPECT(!table.contains("1000"));
+    EXPECT(table.remove("123"));
+    EXPECT(!table.contains("123"));
+
+    table.clear();
+    EXPECT(table.is_empty());
+    table.set("again");
+    EXPECT(table.contains("again"));
+}
+
+TEST_CASE(hash_map)
+{
+    Arena arena;
+    HashMap<int, String, Traits<int>, false, ArenaAllocator> map { arena };
+    for (int i = 0; i < 1000; ++i)
+        map.set(i, String::number(i));
+    EXPECT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.get(500).value(), "500");
+    EXPECT(arena.allocation_count() > 0);
+}
+
+// Mimics the parser: lots of small scopes, each with a few short-lived containers.
+// Every benchmark creates one million containers.
+template<typename MakeContainer, typename Fill>
+static void create_many_containers(MakeContainer make_container, Fill fill, Function<void()> end_of_batch = nullptr)
+{
+    for (size_t batch = 0; batch < 1000; ++batch) {
+        for (size_t i = 0; i < 1000; ++i) {
+            auto container = make_container();
+            fill(container);
+        }
+        if (end_of_batch)
+            end_of_batch();
+    }
+}
+
+static auto const fill_hash_table = [](auto& table) {
+    for (size_t i = 0; i < 8; ++i)
+        table.set(i);
+    EXPECT_EQ(table.size(), 8u);
+};
+
+static auto const fill_vector = [](auto& vector) {
+    for (size_t i = 0; i < 8; ++i)
+        vector.append(i);
+    EXPECT_EQ(vector.size(), 8u);
+};
+
+BENCHMARK_CASE(short_lived_hash_tables_default_allocator)
+{
+    create_many_containers([] { return HashTable<size_t> {}; }, fill_hash_table);
+}
+
+BENCHMARK_CASE(short_lived_hash_tables_arena_allocator)
+{
+    Arena arena;
+    create_many_containers([&] { return HashTable<size_t, Traits<size_t>, false, ArenaAllocator> { arena }; }, fill_hash_table, [&] { arena.clear(); });
+}
+
+BENCHMARK_CASE(short_lived_vectors_default_allocator)
+{
+    create_many_containers([] { return Vector<size_t> {}; }, fill_vector);
+}
+
+BENCHMARK_CASE(short_lived_vectors_arena_allocator)
+{
+    Arena arena;
+    create_many_containers([&] { return Vector<size_t, 0, ArenaAllocator> { arena }; }, fill_vector, [&] { arena.clear(); });
+}
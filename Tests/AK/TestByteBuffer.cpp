@@ -33,6 +33,27 @@ TEST_CASE(equality_operator)
     EXPECT_EQ(d == d, true);
 }
 
+TEST_CASE(resize_and_keep_capacity)
+{
+    auto buffer = ByteBuffer::create_zeroed(4096).release_value();
+    auto const* data = buffer.data();
+    auto capacity = buffer.capacity();
+
+    buffer.resize_and_keep_capacity(4);
+    EXPECT_EQ(buffer.size(), 4u);
+    EXPECT_EQ(buffer.data(), data);
+
+    buffer.clear_with_capacity();
+    EXPECT(buffer.is_empty());
+    EXPECT_EQ(buffer.capacity(), capacity);
+
+    buffer.resize_and_keep_capacity(4096);
+    EXPECT_EQ(buffer.data(), data);
+
+    buffer.resize(4);
+    EXPECT_NE(buffer.data(), data);
+}
+
 /*
  * FIXME: These `negative_*` tests should cause precisely one compilation error
  * each, and always for the specified reason. Currently we do not have a harness
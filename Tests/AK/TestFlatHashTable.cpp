@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/FlatHashMap.h>
+#include <AK/FlatHashTable.h>
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/String.h>
+
+TEST_CASE(construct)
+{
+    using IntTable = FlatHashTable<int>;
+    EXPECT(IntTable().is_empty());
+    EXPECT_EQ(IntTable().size(), 0u);
+    EXPECT(IntTable().begin() == IntTable().end());
+}
+
+TEST_CASE(basic_move)
+{
+    FlatHashTable<int> foo;
+    foo.set(1);
+    EXPECT_EQ(foo.size(), 1u);
+    auto bar = move(foo);
+    EXPECT_EQ(bar.size(), 1u);
+    EXPECT_EQ(foo.size(), 0u);
+    foo = move(bar);
+    EXPECT_EQ(bar.size(), 0u);
+    EXPECT_EQ(foo.size(), 1u);
+    EXPECT(foo.contains(1));
+}
+
+TEST_CASE(copy)
+{
+    FlatHashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+    auto copy = strings;
+    strings.remove("One");
+    EXPECT_EQ(copy.size(), 2u);
+    EXPECT(copy.contains("One"));
+    EXPECT(copy.contains("Two"));
+}
+
+TEST_CASE(set_results)
+{
+    FlatHashTable<String> strings;
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::ReplacedExistingEntry);
+    EXPECT_EQ(strings.set("One", AK::HashSetExistingEntryBehavior::Keep), AK::HashSetResult::KeptExistingEntry);
+    EXPECT_EQ(strings.size(), 1u);
+}
+
+TEST_CASE(range_loop)
+{
+    FlatHashTable<String> strings;
+    strings.set("One");
+    strings.set("Two");
+    strings.set("Three");
+
+    int loop_counter = 0;
+    for (auto& it : strings) {
+        EXPECT_EQ(it.is_null(), false);
+        ++loop_counter;
+    }
+    EXPECT_EQ(loop_counter, 3);
+}
+
+TEST_CASE(many_entries)
+{
+    FlatHashTable<int> table;
+    for (int i = 0; i < 100'000; ++i)
+        EXPECT_EQ(table.set(i), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(table.size(), 100'000u);
+
+    for (int i = 0; i < 100'000; ++i)
+        EXPECT(table.contains(i));
+    EXPECT(!table.contains(-1));
+    EXPECT(!table.contains(100'000));
+
+    size_t loop_counter = 0;
+    for ([[maybe_unused]] auto& it : table)
+        ++loop_counter;
+    EXPECT_EQ(loop_counter, 100'000u);
+
+    for (int i = 0; i < 100'000; i += 2)
+        EXPECT(table.remove(i));
+    EXPECT_EQ(table.size(), 50'000u);
+
+    for (int i = 0; i < 100'000; ++i)
+        EXPECT_EQ(table.contains(i), i % 2 == 1);
+}
+
+TEST_CASE(thrashing)
+{
+    // Repeatedly inserting and removing fills the table with tombstones; make sure they get reclaimed.
+    FlatHashTable<int> table;
+    for (int i = 1; i <= 1000; ++i)
+        table.set(-i);
+    auto capacity = table.capacity();
+    for (int i = 0; i < 100'000; ++i) {
+        table.set(i);
+        table.remove(i);
+    }
+    EXPECT_EQ(table.size(), 1000u);
+    EXPECT_EQ(table.capacity(), capacity);
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT(table.contains(-i));
+}
+
+TEST_CASE(remove_all_matching)
+{
+    FlatHashTable<int> ints;
+    for (int i = 1; i <= 4; ++i)
+        ints.set(i);
+
+    EXPECT_EQ(ints.remove_all_matching([&](int value) { return value % 2 == 0; }), true);
+    EXPECT_EQ(ints.size(), 2u);
+    EXPECT(ints.contains(1));
+    EXPECT(ints.contains(3));
+
+    EXPECT_EQ(ints.remove_all_matching([&](int) { return false; }), false);
+    EXPECT_EQ(ints.remove_all_matching([&](int) { return true; }), true);
+    EXPECT(ints.is_empty());
+}
+
+TEST_CASE(clear_with_capacity)
+{
+    FlatHashTable<String> strings;
+    for (int i = 0; i < 100; ++i)
+        strings.set(String::number(i));
+    auto capacity = strings.capacity();
+    strings.clear_with_capacity();
+    EXPECT(strings.is_empty());
+    EXPECT_EQ(strings.capacity(), capacity);
+    EXPECT(strings.begin() == strings.end());
+    strings.set("again");
+    EXPECT(strings.contains("again"));
+}
+
+TEST_CASE(non_trivial_type)
+{
+    FlatHashTable<NonnullOwnPtr<int>> table;
+    for (int i = 0; i < 100; ++i)
+        table.set(make<int>(i));
+    EXPECT_EQ(table.size(), 100u);
+    table.remove_all_matching([](auto& value) { return *value >= 50; });
+    EXPECT_EQ(table.size(), 50u);
+}
+
+TEST_CASE(hash_map)
+{
+    FlatHashMap<int, String> map;
+    EXPECT_EQ(map.set(1, "One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(map.set(2, "Two"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(map.set(2, "Zwei"), AK::HashSetResult::ReplacedExistingEntry);
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(map.get(1).value(), "One");
+    EXPECT_EQ(map.get(2).value(), "Zwei");
+    EXPECT(!map.get(3).has_value());
+
+    map.ensure(3) = "Three";
+    EXPECT_EQ(map.get(3).value(), "Three");
+
+    EXPECT(map.remove(1));
+    EXPECT(!map.contains(1));
+    EXPECT_EQ(map.keys().size(), 2u);
+}
+
+template<typename TableType>
+static void benchmark_insert(int count)
+{
+    for (int rounds = 10'000'000 / count; rounds > 0; --rounds) {
+        TableType table;
+        for (int i = 0; i < count; ++i)
+            table.set(i);
+    }
+}
+
+template<typename TableType>
+static void benchmark_lookup(int count)
+{
+    TableType table;
+    for (int i = 0; i < count; ++i)
+        table.set(i);
+    size_t found = 0;
+    for (int rounds = 10'000'000 / count; rounds > 0; --rounds) {
+        // Half of the lookups hit, half of them miss.
+        for (int i = 0; i < count; ++i)
+            found += table.contains(i * 2);
+    }
+    EXPECT(found > 0);
+}
+
+template<typename TableType>
+static void benchmark_erase(int count)
+{
+    for (int rounds = 10'000'000 / count; rounds > 0; --rounds) {
+        TableType table;
+        for (int i = 0; i < count; ++i)
+            table.set(i);
+        for (int i = 0; i < count; ++i)
+            table.remove(i);
+        EXPECT(table.is_empty());
+    }
+}
+
+#define BENCHMARK_TABLES(operation, count)                \
+    BENCHMARK_CASE(operation##_##count##_hash_table)      \
+    {                                                     \
+        benchmark_##operation<HashTable<int>>(count);     \
+    }                                                     \
+    BENCHMARK_CASE(operation##_##count##_flat_hash_table) \
+    {                                                     \
+        benchmark_##operation<FlatHashTable<int>>(count); \
+    }
+
+BENCHMARK_TABLES(insert, 1000)
+BENCHMARK_TABLES(insert, 100000)
+BENCHMARK_TABLES(insert, 10000000)
+BENCHMARK_TABLES(lookup, 1000)
+BENCHMARK_TABLES(lookup, 100000)
+BENCHMARK_TABLES(lookup, 10000000)
+BENCHMARK_TABLES(erase, 1000)
+BENCHMARK_TABLES(erase, 100000)
+BENCHMARK_TABLES(erase, 10000000)
@@ -8,6 +8,7 @@
 
 #include <AK/HashMap.h>
 #include <AK/JsonObject.h>
+#include <AK/JsonPullParser.h>
 #include <AK/JsonValue.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
@@ -134,3 +135,144 @@ TEST_CASE(json_parse_long_decimals)
     auto value = JsonValue::from_string("1644452550.6489999294281");
     EXPECT_EQ(value.value().as_double(), 1644452550.6489999294281);
 }
+
+static Vector<JsonPullParser::Event> pull_all_events(StringView input)
+{
+    Vector<JsonPullParser::Event> events;
+    JsonPullParser parser { input };
+    for (;;) {
+        auto event = parser.next();
+        EXPECT(!event.is_error());
+        if (event.is_error())
+            break;
+        events.append(event.value());
+        if (event.value() == JsonPullParser::Event::EndOfInput)
+            break;
+    }
+    return events;
+}
+
+TEST_CASE(json_pull_parser_events)
+{
+    using Event = JsonPullParser::Event;
+    auto events = pull_all_events(R"({"pid": 42, "name": "Shell", "tags": [true, false, null], "children": [], "env": {}})"sv);
+    Vector<Event> expected {
+        Event::StartObject,
+        Event::Key, Event::Number,
+        Event::Key, Event::String,
+        Event::Key, Event::StartArray, Event::True, Event::False, Event::Null, Event::EndArray,
+        Event::Key, Event::StartArray, Event::EndArray,
+        Event::Key, Event::StartObject, Event::EndObject,
+        Event::EndObject,
+        Event::EndOfInput
+    };
+    EXPECT_EQ(events, expected);
+}
+
+TEST_CASE(json_pull_parser_values)
+{
+    JsonPullParser parser { R"({"a\nb": -12, "c": "dA", "e": 1.5})"sv };
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::StartObject);
+
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Key);
+    EXPECT(parser.token_has_escapes());
+    EXPECT_EQ(parser.unescaped_string().value(), "a\nb");
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Number);
+    EXPECT_EQ(parser.token(), "-12"sv);
+    EXPECT_EQ(parser.value().value().to_i32(), -12);
+
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Key);
+    EXPECT(!parser.token_has_escapes());
+    EXPECT_EQ(parser.token(), "c"sv);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::String);
+    EXPECT_EQ(parser.value().value().as_string(), "dA");
+
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Key);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Number);
+    EXPECT_EQ(parser.value().value().as_double(), 1.5);
+
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::EndObject);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::EndOfInput);
+}
+
+TEST_CASE(json_pull_parser_skip_container)
+{
+    JsonPullParser parser { R"([{"skip": [1, 2, {"x": [3]}]}, "kept"])"sv };
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::StartArray);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::StartObject);
+    EXPECT(!parser.skip_container().is_error());
+    EXPECT_EQ(parser.depth(), 1u);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::String);
+    EXPECT_EQ(parser.token(), "kept"sv);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::EndArray);
+    EXPECT_EQ(parser.next().value(), JsonPullParser::Event::EndOfInput);
+}
+
+TEST_CASE(json_pull_parser_errors)
+{
+    auto fails = [](StringView input) {
+        JsonPullParser parser { input };
+        for (;;) {
+            auto event = parser.next();
+            if (event.is_error())
+                return true;
+            if (event.value() == JsonPullParser::Event::EndOfInput)
+                return false;
+        }
+    };
+    EXPECT(fails("[1, 2,]"sv));
+    EXPECT(fails("{\"a\": 1,}"sv));
+    EXPECT(fails("{\"a\" 1}"sv));
+    EXPECT(fails("[1 2]"sv));
+    EXPECT(fails("\"unterminated"sv));
+    EXPECT(fails("[1] 2"sv));
+    EXPECT(fails("[tru]"sv));
+    EXPECT(!fails("  [ 1 , { } ]  "sv));
+}
+
+// Roughly 16 MiB of ProcFS-style process records. The benchmarks build it themselves, so that it only takes up
+// memory while they run. Formatting the records is slow, so only 1 MiB of them is formatted and then repeated.
+static String build_large_json_document()
+{
+    StringBuilder records;
+    for (size_t i = 0; records.length() < 1 * MiB; ++i) {
+        if (i != 0)
+            records.append(',');
+        records.appendff(R"({{"pid":{},"ppid":1,"name":"Process \"{}\"","amount_virtual":{},"cpu":0.{},"pledge":"stdio rpath","threads":[{{"tid":{},"state":"Running"}}]}})", i, i, i * 4096, i % 100, i);
+    }
+
+    StringBuilder builder;
+    builder.append('[');
+    for (size_t i = 0; i < 16; ++i) {
+        if (i != 0)
+            builder.append(',');
+        builder.append(records.string_view());
+    }
+    builder.append(']');
+    return builder.to_string();
+}
+
+BENCHMARK_CASE(json_tree_parser_throughput)
+{
+    auto document = build_large_json_document();
+    auto value = JsonValue::from_string(document);
+    EXPECT(!value.is_error());
+}
+
+BENCHMARK_CASE(json_pull_parser_throughput)
+{
+    auto document = build_large_json_document();
+    JsonPullParser parser { document.view() };
+    u64 total_pids = 0;
+    for (;;) {
+        auto event = parser.next();
+        EXPECT(!event.is_error());
+        if (event.is_error() || event.value() == JsonPullParser::Event::EndOfInput)
+            break;
+        if (event.value() == JsonPullParser::Event::Key && parser.token() == "pid"sv) {
+            EXPECT_EQ(parser.next().value(), JsonPullParser::Event::Number);
+            total_pids += parser.token().to_uint<u64>().value();
+        }
+    }
+    EXPECT(total_pids > 0);
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/MemMem.h>
+#include <AK/StringView.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static Optional<size_t> naive_memmem(ReadonlyBytes haystack, ReadonlyBytes needle)
+{
+    if (needle.size() > haystack.size())
+        return {};
+    for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        if (haystack.slice(i, needle.size()) == needle)
+            return i;
+    }
+    return {};
+}
+
+static ByteBuffer make_haystack(size_t size)
+{
+    // Fill the first few KiB with pseudo-random letters, and repeat them for the rest.
+    auto haystack = ByteBuffer::create_uninitialized(size).release_value();
+    u32 state = 0x12345678;
+    for (size_t i = 0; i < min(size, 4 * KiB); ++i) {
+        state = state * 1103515245 + 12345;
+        haystack[i] = 'a' + (state >> 16) % 4;
+    }
+    for (size_t i = 4 * KiB; i < size; i += 4 * KiB)
+        __builtin_memcpy(haystack.data() + i, haystack.data(), min(size - i, 4 * KiB));
+    return haystack;
+}
+
+TEST_CASE(memchr_every_length_and_position)
+{
+    for (size_t length = 0; length < 200; ++length) {
+        auto haystack = ByteBuffer::create_zeroed(length).release_value();
+        EXPECT(!AK::memchr_optional(haystack.data(), length, 'x').has_value());
+        for (size_t position = 0; position < length; ++position) {
+            haystack[position] = 'x';
+            EXPECT_EQ(AK::memchr_optional(haystack.data(), length, 'x'), position);
+            EXPECT_EQ(AK::memchr_count(haystack.data(), length, 'x'), 1u);
+            haystack[position] = 0;
+        }
+    }
+}
+
+TEST_CASE(memchr_every_alignment)
+{
+    auto buffer = ByteBuffer::create_zeroed(256).release_value();
+    for (size_t start = 0; start < 16; ++start) {
+        for (size_t length = 0; length < 100; ++length) {
+            auto* haystack = buffer.data() + start;
+            // Matches just outside the haystack must be ignored.
+            buffer[start + length] = 'x';
+            if (start > 0)
+                buffer[start - 1] = 'x';
+            EXPECT(!AK::memchr_optional(haystack, length, 'x').has_value());
+            for (size_t position = 0; position < length; ++position) {
+                haystack[position] = 'x';
+                EXPECT_EQ(AK::memchr_optional(haystack, length, 'x'), position);
+                haystack[position] = 0;
+            }
+            buffer[start + length] = 0;
+            if (start > 0)
+                buffer[start - 1] = 0;
+        }
+    }
+}
+
+TEST_CASE(memchr_stops_at_the_first_match)
+{
+    // The match is right before a page that can't be read, and the length claims that the haystack goes on.
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto* pages = static_cast<u8*>(mmap(nullptr, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    VERIFY(pages != MAP_FAILED);
+    VERIFY(mprotect(pages + page_size, page_size, PROT_NONE) == 0);
+    __builtin_memset(pages, 0, page_size);
+    pages[page_size - 1] = 'x';
+
+    for (size_t start = page_size - 200; start < page_size; ++start) {
+        EXPECT_EQ(AK::memchr_optional(pages + start, NumericLimits<size_t>::max(), 'x'), page_size - 1 - start);
+        EXPECT_EQ(AK::memchr_optional(pages + start, 1 * MiB, 'x'), page_size - 1 - start);
+    }
+    munmap(pages, 2 * page_size);
+}
+
+TEST_CASE(memchr_count)
+{
+    auto haystack = make_haystack(100'000);
+    size_t expected = 0;
+    for (auto byte : haystack.bytes())
+        expected += byte == 'b';
+    EXPECT_EQ(AK::memchr_count(haystack.data(), haystack.size(), 'b'), expected);
+    EXPECT_EQ(AK::memchr_count(haystack.data(), haystack.size(), 'z'), 0u);
+
+    // More matches than a single byte lane can count.
+    auto all_the_same = ByteBuffer::create_zeroed(10'000).release_value();
+    EXPECT_EQ(AK::memchr_count(all_the_same.data(), all_the_same.size(), 0), 10'000u);
+}
+
+TEST_CASE(memchr_any_of)
+{
+    auto haystack = "The quick brown fox jumps over the lazy dog, and then some more text follows."sv;
+    EXPECT_EQ(AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), ",."sv.bytes()), 43u);
+    EXPECT_EQ(AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), "!."sv.bytes()), 76u);
+    EXPECT(!AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), "!?"sv.bytes()).has_value());
+    EXPECT(!AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), {}).has_value());
+
+    // Sets with more than 16 members take the table-driven path.
+    auto large_set = "0123456789ABCDEFGHIJ,"sv;
+    EXPECT_EQ(AK::memchr_any_of_optional(haystack.characters_without_null_termination(), haystack.length(), large_set.bytes()), 43u);
+    EXPECT_EQ(haystack.find_any_of(",z"sv), 37u);
+}
+
+TEST_CASE(memmem_matches_naive_search)
+{
+    auto haystack = make_haystack(4096);
+    for (size_t needle_length = 1; needle_length < 48; ++needle_length) {
+        for (size_t start = 0; start + needle_length <= haystack.size(); start += 97) {
+            auto needle = haystack.bytes().slice(start, needle_length);
+            EXPECT_EQ(AK::memmem_optional(haystack.data(), haystack.size(), needle.data(), needle.size()), naive_memmem(haystack, needle));
+        }
+    }
+}
+
+TEST_CASE(memmem_pathological_input)
+{
+    // Every position passes the first/last byte filter, but only the very end matches.
+    auto haystack = ByteBuffer::create_zeroed(100'000).release_value();
+    haystack[haystack.size() - 1] = 1;
+    auto needle = ByteBuffer::create_zeroed(1000).release_value();
+    needle[needle.size() - 1] = 1;
+    EXPECT_EQ(AK::memmem_optional(haystack.data(), haystack.size(), needle.data(), needle.size()), haystack.size() - needle.size());
+
+    needle[0] = 1;
+    EXPECT(!AK::memmem_optional(haystack.data(), haystack.size(), needle.data(), needle.size()).has_value());
+}
+
+TEST_CASE(string_view_find)
+{
+    auto view = "hello world, hello serenity"sv;
+    EXPECT_EQ(view.find('w'), 6u);
+    EXPECT_EQ(view.find('h', 1), 13u);
+    EXPECT(!view.find('z').has_value());
+    EXPECT_EQ(view.find("serenity"sv), 19u);
+    EXPECT_EQ(view.find_all("hello"sv), Vector<size_t>({ 0, 13 }));
+    EXPECT_EQ(view.count("l"sv), 5u);
+}
+
+// Every benchmark scans 256 MiB in total, so 256 / (time in ms) * 1000 gives the throughput in MiB/s.
+static constexpr size_t bytes_scanned_per_benchmark = 256 * MiB;
+
+template<typename Callback>
+static void scan_haystacks(size_t haystack_size, Callback callback)
+{
+    // Put the needle at the very end so every kernel has to look at the whole haystack.
+    auto haystack = make_haystack(haystack_size);
+    haystack[haystack_size - 1] = '\n';
+    for (size_t scanned = 0; scanned < bytes_scanned_per_benchmark; scanned += haystack_size)
+        callback(haystack.bytes());
+}
+
+#define BENCHMARK_SIZES(name, callback)                                  \
+    BENCHMARK_CASE(name##_16b) { scan_haystacks(16, callback); }         \
+    BENCHMARK_CASE(name##_4kib) { scan_haystacks(4 * KiB, callback); }   \
+    BENCHMARK_CASE(name##_1mib) { scan_haystacks(1 * MiB, callback); }   \
+    BENCHMARK_CASE(name##_64mib) { scan_haystacks(64 * MiB, callback); } \
+    BENCHMARK_CASE(name##_256mib) { scan_haystacks(256 * MiB, callback); }
+
+static auto const memchr_kernel = [](ReadonlyBytes haystack) {
+    EXPECT(AK::memchr_optional(haystack.data(), haystack.size(), '\n').has_value());
+};
+static auto const memchr_any_of_kernel = [](ReadonlyBytes haystack) {
+    EXPECT(AK::memchr_any_of_optional(haystack.data(), haystack.size(), "\n\r\t"sv.bytes()).has_value());
+};
+static auto const memmem_kernel = [](ReadonlyBytes haystack) {
+    EXPECT(!AK::memmem_optional(haystack.data(), haystack.size(), "abcdx", 5).has_value());
+};
+static auto const newline_count_kernel = [](ReadonlyBytes haystack) {
+    EXPECT_EQ(AK::memchr_count(haystack.data(), haystack.size(), '\n'), 1u);
+};
+
+BENCHMARK_SIZES(memchr, memchr_kernel)
+BENCHMARK_SIZES(memchr_any_of, memchr_any_of_kernel)
+BENCHMARK_SIZES(memmem, memmem_kernel)
+BENCHMARK_SIZES(newline_count, newline_count_kernel)
+
+BENCHMARK_CASE(memchr_scalar_1mib)
+{
+    scan_haystacks(1 * MiB, [](ReadonlyBytes haystack) {
+        for (auto byte : haystack) {
+            if (byte == '\n')
+                return;
+        }
+        FAIL("needle not found");
+    });
+}
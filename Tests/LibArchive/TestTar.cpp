@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibArchive/TarStream.h>
+#include <LibCompress/Gzip.h>
+#include <LibCore/FileStream.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <unistd.h>
+
+struct Member {
+    StringView path;
+    ByteBuffer contents;
+    u64 header_offset;
+};
+
+// The contents of every member end exactly at a block boundary, except for the last one.
+static Vector<Member> make_members()
+{
+    Vector<Member> members;
+    members.append({ "empty"sv, {}, 0 });
+    auto block = MUST(ByteBuffer::create_uninitialized(Archive::block_size));
+    block.bytes().fill('b');
+    members.append({ "block"sv, move(block), 512 });
+    auto large = MUST(ByteBuffer::create_uninitialized(1 * MiB + 1));
+    for (size_t i = 0; i < large.size(); ++i)
+        large[i] = static_cast<u8>(i % 251);
+    members.append({ "large"sv, move(large), 1536 });
+    return members;
+}
+
+static ByteBuffer make_archive(Vector<Member> const& members)
+{
+    DuplexMemoryStream stream;
+    Archive::TarOutputStream tar_stream { stream };
+    for (auto const& member : members)
+        tar_stream.add_file(member.path, 0644, member.contents);
+    tar_stream.add_directory("dir", 0755);
+    tar_stream.finish();
+    return stream.copy_into_contiguous_buffer();
+}
+
+static ByteBuffer read_contents(Archive::TarInputStream& tar_stream)
+{
+    auto file_stream = tar_stream.file_contents();
+    ByteBuffer contents;
+    Array<u8, 4096> buffer;
+    while (auto nread = file_stream.read(buffer))
+        contents.append(buffer.data(), nread);
+    return contents;
+}
+
+// Reads the contents of every other member, so that the rest are skipped over.
+static void expect_members(InputStream& stream, Vector<Member> const& members)
+{
+    Archive::TarInputStream tar_stream { stream };
+    EXPECT(tar_stream.valid());
+    for (size_t i = 0; i < members.size(); ++i, tar_stream.advance()) {
+        EXPECT(!tar_stream.finished());
+        EXPECT_EQ(tar_stream.header().filename(), members[i].path);
+        EXPECT_EQ(tar_stream.header().size(), members[i].contents.size());
+        EXPECT_EQ(tar_stream.header_offset(), members[i].header_offset);
+        if (i % 2 == 0)
+            EXPECT(read_contents(tar_stream) == members[i].contents);
+    }
+
+    EXPECT(!tar_stream.finished());
+    EXPECT_EQ(tar_stream.header().filename(), "dir/"sv);
+    EXPECT_EQ(tar_stream.header().type_flag(), Archive::TarFileType::Directory);
+    EXPECT_EQ(tar_stream.header_offset(), 1536u + 512u + 1 * MiB + 512u);
+    tar_stream.advance();
+    EXPECT(tar_stream.finished());
+}
+
+TEST_CASE(round_trip)
+{
+    auto members = make_members();
+    auto archive = make_archive(members);
+    // Four headers, the contents padded to whole blocks, and the two blocks that end the archive.
+    EXPECT_EQ(archive.size(), 4 * 512 + 512 + (1 * MiB + 512) + 2 * 512);
+
+    InputMemoryStream stream { archive };
+    expect_members(stream, members);
+}
+
+TEST_CASE(round_trip_through_a_pipe)
+{
+    auto members = make_members();
+    auto archive = make_archive(members);
+
+    // A pipe can't seek, so members that aren't read have to be read through to skip them.
+    auto fds = MUST(Core::System::pipe2(0));
+    auto pid = MUST(Core::System::fork());
+    if (pid == 0) {
+        close(fds[0]);
+        for (auto bytes = archive.bytes(); !bytes.is_empty();)
+            bytes = bytes.slice(MUST(Core::System::write(fds[1], bytes)));
+        _exit(0);
+    }
+    MUST(Core::System::close(fds[1]));
+
+    auto file = Core::File::construct();
+    EXPECT(file->open(fds[0], Core::OpenMode::ReadOnly, Core::File::ShouldCloseFileDescriptor::Yes));
+    Core::InputFileStream stream { file };
+    expect_members(stream, members);
+
+    auto result = MUST(Core::System::waitpid(pid));
+    EXPECT(WIFEXITED(result.status) && WEXITSTATUS(result.status) == 0);
+}
+
+static ByteBuffer read_test_file(StringView file_name)
+{
+    // This makes sure that the tests will run both on target and in Lagom.
+#ifdef __serenity__
+    String path = String::formatted("/usr/Tests/LibArchive/tar-test-files/{}", file_name);
+#else
+    String path = String::formatted("tar-test-files/{}", file_name);
+#endif
+
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+    return MUST(file->read_all());
+}
+
+// The archives were made with GNU tar from a file with ten 4 KiB data regions, one every 64 KiB, and a hole at the
+// end. A small file follows it, to check that the sparse file is skipped correctly.
+// The PAX archives give both members a header of their own, one block of extended header each for the small file.
+static void run_sparse_test(StringView file_name, u64 next_header_offset)
+{
+    auto archive = Compress::GzipDecompressor::decompress_all(read_test_file(file_name));
+    EXPECT(archive.has_value());
+    InputMemoryStream stream { *archive };
+    Archive::TarInputStream tar_stream { stream };
+    EXPECT(tar_stream.valid());
+
+    Archive::TarPaxSparseHeader pax_sparse_header;
+    if (tar_stream.header().type_flag() == Archive::TarFileType::ExtendedHeader) {
+        MUST(tar_stream.for_each_extended_header([&](StringView key, StringView value) {
+            pax_sparse_header.add(key, value);
+        }));
+        tar_stream.advance();
+    }
+
+    auto file_stream = tar_stream.file_contents();
+    auto map = tar_stream.gnu_sparse_map();
+    if (!map.has_value()) {
+        EXPECT(pax_sparse_header.is_sparse());
+        map = MUST(pax_sparse_header.read_map(file_stream));
+    }
+    EXPECT_EQ(pax_sparse_header.name().value_or(tar_stream.header().filename()), "sparse.bin"sv);
+    EXPECT_EQ(map->real_size, 10 * 64 * KiB);
+
+    auto contents = MUST(ByteBuffer::create_zeroed(map->real_size));
+    for (auto const& region : map->regions)
+        EXPECT(file_stream.read_or_error(contents.bytes().slice(region.offset, region.size)));
+    EXPECT(file_stream.unreliable_eof());
+
+    auto expected = MUST(ByteBuffer::create_zeroed(10 * 64 * KiB));
+    for (size_t i = 0; i < 10; ++i)
+        expected.bytes().slice(i * 64 * KiB, 4 * KiB).fill('A' + i);
+    EXPECT(contents == expected);
+
+    tar_stream.advance();
+    if (tar_stream.header().type_flag() == Archive::TarFileType::ExtendedHeader)
+        tar_stream.advance();
+    EXPECT_EQ(tar_stream.header().filename(), "after.txt"sv);
+    EXPECT_EQ(tar_stream.header_offset(), next_header_offset);
+    auto after = read_contents(tar_stream);
+    EXPECT_EQ(StringView { after }, "after\n"sv);
+}
+
+TEST_CASE(gnu_sparse)
+{
+    // The first four regions are in the header, the rest in an extension block after it.
+    run_sparse_test("gnu.tar.gz"sv, 2 * 512 + 40 * KiB);
+}
+
+TEST_CASE(pax_sparse_0_0)
+{
+    // The map makes the extended header two blocks long.
+    run_sparse_test("pax0.0.tar.gz"sv, 4 * 512 + 40 * KiB + 2 * 512);
+}
+
+TEST_CASE(pax_sparse_0_1)
+{
+    run_sparse_test("pax0.1.tar.gz"sv, 3 * 512 + 40 * KiB + 2 * 512);
+}
+
+TEST_CASE(pax_sparse_1_0)
+{
+    // The map takes up the first block of the contents.
+    run_sparse_test("pax1.0.tar.gz"sv, 3 * 512 + 512 + 40 * KiB + 2 * 512);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibArchive/Zip.h>
+
+// Members are stored uncompressed. The archive is only read back, so their CRC-32s don't have to be right.
+static ByteBuffer make_archive()
+{
+    DuplexMemoryStream stream;
+    Archive::ZipOutputStream zip_stream { stream };
+    auto add_member = [&](StringView name, StringView contents, u32 crc32) {
+        zip_stream.add_member({
+            .name = name,
+            .compressed_data = contents.bytes(),
+            .compression_method = Archive::ZipCompressionMethod::Store,
+            .uncompressed_size = static_cast<u32>(contents.length()),
+            .crc32 = crc32,
+            .is_directory = name.ends_with('/'),
+        });
+    };
+    add_member("hello.txt"sv, "Hello, world!\n"sv, 1);
+    add_member("dir/"sv, ""sv, 2);
+    add_member("dir/nested.txt"sv, "Nested\n"sv, 3);
+    add_member("hello.txt"sv, "Hello again!\n"sv, 4);
+    zip_stream.finish();
+    return stream.copy_into_contiguous_buffer();
+}
+
+TEST_CASE(zip_member_at)
+{
+    auto archive = make_archive();
+    auto zip = Archive::Zip::try_create(archive);
+    EXPECT(zip.has_value());
+    EXPECT_EQ(zip->member_count(), 4u);
+
+    auto first = zip->member_at(0);
+    EXPECT_EQ(first.name, "hello.txt"sv);
+    EXPECT_EQ(StringView { first.compressed_data }, "Hello, world!\n"sv);
+    EXPECT_EQ(first.compression_method, Archive::ZipCompressionMethod::Store);
+    EXPECT_EQ(first.uncompressed_size, 14u);
+    EXPECT_EQ(first.crc32, 1u);
+    EXPECT(!first.is_directory);
+
+    auto directory = zip->member_at(1);
+    EXPECT_EQ(directory.name, "dir/"sv);
+    EXPECT(directory.compressed_data.is_empty());
+    EXPECT(directory.is_directory);
+
+    auto nested = zip->member_at(2);
+    EXPECT_EQ(nested.name, "dir/nested.txt"sv);
+    EXPECT_EQ(StringView { nested.compressed_data }, "Nested\n"sv);
+    EXPECT_EQ(nested.crc32, 3u);
+}
+
+TEST_CASE(zip_find_member)
+{
+    auto archive = make_archive();
+    auto zip = Archive::Zip::try_create(archive);
+    EXPECT(zip.has_value());
+
+    auto nested = zip->find_member("dir/nested.txt"sv);
+    EXPECT(nested.has_value());
+    EXPECT_EQ(nested->name, "dir/nested.txt"sv);
+    EXPECT_EQ(StringView { nested->compressed_data }, "Nested\n"sv);
+
+    auto directory = zip->find_member("dir/"sv);
+    EXPECT(directory.has_value());
+    EXPECT(directory->is_directory);
+
+    // The later of two members with the same name wins.
+    auto hello = zip->find_member("hello.txt"sv);
+    EXPECT(hello.has_value());
+    EXPECT_EQ(StringView { hello->compressed_data }, "Hello again!\n"sv);
+    EXPECT_EQ(hello->crc32, 4u);
+}
+
+TEST_CASE(zip_find_missing_member)
+{
+    auto archive = make_archive();
+    auto zip = Archive::Zip::try_create(archive);
+    EXPECT(zip.has_value());
+
+    EXPECT(!zip->find_member("missing.txt"sv).has_value());
+    EXPECT(!zip->find_member("dir"sv).has_value());
+    EXPECT(!zip->find_member("nested.txt"sv).has_value());
+    EXPECT(!zip->find_member(""sv).has_value());
+}
+
+TEST_CASE(zip_for_each_member)
+{
+    auto archive = make_archive();
+    auto zip = Archive::Zip::try_create(archive);
+    EXPECT(zip.has_value());
+
+    Vector<String> names;
+    zip->for_each_member([&](auto const& member) {
+        names.append(member.name);
+        return IterationDecision::Continue;
+    });
+    EXPECT_EQ(names, (Vector<String> { "hello.txt", "dir/", "dir/nested.txt", "hello.txt" }));
+}
@@ -7,7 +7,10 @@
 
 #include <LibTest/TestCase.h>
 #include <errno.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 TEST_CASE(strerror_r_basic)
 {
@@ -29,3 +32,21 @@ TEST_CASE(strtok_r_delimiters_only)
     // The string to which `saved_str` initially points to shouldn't be modified.
     EXPECT_EQ(strcmp(dummy, "a;"), 0);
 }
+
+TEST_CASE(memchr_stops_at_the_first_match)
+{
+    // memchr() may be given a length larger than the object, as long as it holds the byte. Here the byte is right
+    // before a page that can't be read.
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto* pages = static_cast<char*>(mmap(nullptr, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    VERIFY(pages != MAP_FAILED);
+    EXPECT_EQ(mprotect(pages + page_size, page_size, PROT_NONE), 0);
+    memset(pages, 0, page_size);
+    pages[page_size - 1] = 'x';
+
+    for (size_t start = page_size - 200; start < page_size; ++start) {
+        EXPECT_EQ(memchr(pages + start, 'x', SIZE_MAX), pages + page_size - 1);
+        EXPECT_EQ(memchr(pages + start, 'x', page_size), pages + page_size - 1);
+    }
+    EXPECT_EQ(munmap(pages, 2 * page_size), 0);
+}
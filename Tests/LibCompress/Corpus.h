@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibCore/Stream.h>
+
+// A small Canterbury-style corpus: prose, source code, structured text, a raw image and a binary font.
+constexpr Array corpus_file_paths {
+    "Base/usr/share/man/man5/Shell.md"sv,
+    "AK/HashTable.h"sv,
+    "Base/res/js/Spreadsheet/runtime.js"sv,
+    "Base/etc/ca_certs.ini"sv,
+    "Base/res/html/misc/ppmsuite_files/buggie-raw.ppm"sv,
+    "Base/res/fonts/KaticaBold10.font"sv,
+};
+
+struct CorpusFile {
+    StringView path;
+    ByteBuffer contents;
+};
+
+// The corpus files are given by their path in the source tree. Lagom runs the tests from Tests/LibCompress, and
+// on target they are read from the disk image, where Base/ is the root and the AK headers are installed.
+inline ByteBuffer read_corpus_file(StringView source_path)
+{
+#ifdef __serenity__
+    auto path = source_path.starts_with("Base/"sv)
+        ? String(source_path.substring_view(4))
+        : String::formatted("/usr/include/{}", source_path);
+#else
+    auto path = String::formatted("../../{}", source_path);
+#endif
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+    return MUST(file->read_all());
+}
+
+inline Vector<CorpusFile> read_corpus()
+{
+    Vector<CorpusFile> corpus;
+    for (auto path : corpus_file_paths)
+        corpus.append({ path, read_corpus_file(path) });
+    return corpus;
+}
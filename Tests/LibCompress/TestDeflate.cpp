@@ -6,9 +6,12 @@
 
 #include <LibTest/TestCase.h>
 
+#include "Corpus.h"
 #include <AK/Array.h>
+#include <AK/LexicalPath.h>
 #include <AK/MemoryStream.h>
 #include <AK/Random.h>
+#include <AK/Time.h>
 #include <LibCompress/Deflate.h>
 #include <cstring>
 
@@ -154,3 +157,56 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(compressed.has_value());
 }
+
+// The corpus is read once, so that the benchmarks only measure compression.
+static Vector<CorpusFile> s_corpus;
+
+TEST_SETUP
+{
+    s_corpus = read_corpus();
+}
+
+TEST_CASE(deflate_round_trip_corpus)
+{
+    using Level = Compress::DeflateCompressor::CompressionLevel;
+    for (auto const& file : s_corpus) {
+        for (auto level : { Level::STORE, Level::FASTEST, Level::FAST, Level::GOOD }) {
+            auto compressed = Compress::DeflateCompressor::compress_all(file.contents, level);
+            EXPECT(compressed.has_value());
+            auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+            EXPECT(uncompressed.has_value());
+            EXPECT(uncompressed.value() == file.contents);
+        }
+    }
+}
+
+// Reports the compression ratio and throughput of the level for every file, and for the whole corpus.
+static void compress_corpus(StringView level_name, Compress::DeflateCompressor::CompressionLevel level)
+{
+    size_t total_size = 0;
+    size_t total_compressed_size = 0;
+    i64 total_microseconds = 0;
+    for (auto const& file : s_corpus) {
+        auto start = Time::now_monotonic();
+        auto compressed = Compress::DeflateCompressor::compress_all(file.contents, level);
+        auto microseconds = max<i64>((Time::now_monotonic() - start).to_microseconds(), 1);
+        EXPECT(compressed.has_value());
+        if (!compressed.has_value())
+            return;
+
+        outln("{:>20}: {:>7} -> {:>7} bytes, ratio {:.3}, {:.1} MB/s", LexicalPath::basename(file.path), file.contents.size(), compressed->size(),
+            static_cast<double>(file.contents.size()) / compressed->size(), static_cast<double>(file.contents.size()) / microseconds);
+        total_size += file.contents.size();
+        total_compressed_size += compressed->size();
+        total_microseconds += microseconds;
+    }
+    outln("{:>20}: {:>7} -> {:>7} bytes, ratio {:.3}, {:.1} MB/s", String::formatted("total ({})", level_name), total_size, total_compressed_size,
+        static_cast<double>(total_size) / total_compressed_size, static_cast<double>(total_size) / total_microseconds);
+}
+
+BENCHMARK_CASE(deflate_corpus_store) { compress_corpus("store"sv, Compress::DeflateCompressor::CompressionLevel::STORE); }
+BENCHMARK_CASE(deflate_corpus_fastest) { compress_corpus("fastest"sv, Compress::DeflateCompressor::CompressionLevel::FASTEST); }
+BENCHMARK_CASE(deflate_corpus_fast) { compress_corpus("fast"sv, Compress::DeflateCompressor::CompressionLevel::FAST); }
+BENCHMARK_CASE(deflate_corpus_good) { compress_corpus("good"sv, Compress::DeflateCompressor::CompressionLevel::GOOD); }
+BENCHMARK_CASE(deflate_corpus_great) { compress_corpus("great"sv, Compress::DeflateCompressor::CompressionLevel::GREAT); }
+BENCHMARK_CASE(deflate_corpus_best) { compress_corpus("best"sv, Compress::DeflateCompressor::CompressionLevel::BEST); }
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Hex.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Zstd.h>
+#include <LibCore/Stream.h>
+#include <LibCrypto/Hash/SHA2.h>
+
+static ByteBuffer read_test_file(StringView directory, StringView file_name)
+{
+    // This makes sure that the tests will run both on target and in Lagom.
+#ifdef __serenity__
+    String path = String::formatted("/usr/Tests/LibCompress/{}/{}", directory, file_name);
+#else
+    String path = String::formatted("{}/{}", directory, file_name);
+#endif
+
+    auto file = MUST(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+    return MUST(file->read_all());
+}
+
+// The reference frames were made with the zstd command line tool from the files next to them.
+static void run_test(StringView compressed_file_name, StringView uncompressed_directory, StringView uncompressed_file_name)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, compressed_file_name);
+    auto uncompressed = read_test_file(uncompressed_directory, uncompressed_file_name);
+
+    EXPECT(Compress::ZstdDecompressor::is_likely_compressed(compressed));
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == uncompressed);
+}
+
+// The larger reference frames were made from files elsewhere in the tree. Those files keep changing, so only
+// the size and SHA-256 digest of the version that was compressed are kept.
+static void expect_contents(ByteBuffer const& contents, size_t size, StringView sha256_digest)
+{
+    EXPECT_EQ(contents.size(), size);
+    EXPECT_EQ(encode_hex(Crypto::Hash::SHA256::hash(contents).bytes()), sha256_digest);
+}
+
+static void run_test(StringView compressed_file_name, size_t size, StringView sha256_digest)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, compressed_file_name);
+
+    EXPECT(Compress::ZstdDecompressor::is_likely_compressed(compressed));
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.has_value());
+    if (decompressed.has_value())
+        expect_contents(decompressed.value(), size, sha256_digest);
+}
+
+static constexpr auto runtime_js_sha256 = "44e6b17551d2811e843295b1db1f6801ac6321f3826ae82502a7ef7620ebce5a"sv;
+static constexpr auto documentation_md_sha256 = "2a3e11ed9c980c3ac2ebaf69109aa1a90042f86e415a00de0f66fe74a0bda986"sv;
+
+TEST_CASE(zstd_decompress_simple)
+{
+    run_test("hello.txt.zst"sv, "zstd-test-files"sv, "hello.txt"sv);
+}
+
+TEST_CASE(zstd_decompress_lorem)
+{
+    run_test("lorem.txt.zst"sv, "zstd-test-files"sv, "lorem.txt"sv);
+}
+
+TEST_CASE(zstd_decompress_raw_blocks)
+{
+    run_test("random.bin.zst"sv, "zstd-test-files"sv, "random.bin"sv);
+}
+
+TEST_CASE(zstd_decompress_rle_blocks)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, "zeroes.zst"sv);
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.has_value());
+    EXPECT_EQ(decompressed.value().size(), 300000u);
+    for (auto byte : decompressed.value().bytes()) {
+        if (byte != 0) {
+            FAIL("Unexpected non-zero byte");
+            break;
+        }
+    }
+}
+
+TEST_CASE(zstd_decompress_levels)
+{
+    run_test("runtime.js.zst"sv, 44283, runtime_js_sha256);
+    run_test("buggie.ppm.zst"sv, 66061, "d7fe793d0693274b0e2a481470c8ddc6575a9e6aaa68f1b2bc9efb2c34b3278f"sv);
+    run_test("documentation.md.zst"sv, 161690, documentation_md_sha256);
+    run_test("ca-certs.ini.zst"sv, 173614, "83a0e8224820f7f70b25110ae5aa495e913cb0652b482344e7da684aca680ca2"sv);
+}
+
+TEST_CASE(zstd_decompress_streamed_frame)
+{
+    // Frames compressed from a pipe don't know their content size, and have a window descriptor instead.
+    run_test("hash-table.h.zst"sv, 24375, "39763eb91b3ad2a6cc7279069e3259c315d049d10cf304f1cf052751a4e4a831"sv);
+}
+
+TEST_CASE(zstd_decompress_small_window)
+{
+    run_test("runtime.js.small-window.zst"sv, 44283, runtime_js_sha256);
+}
+
+TEST_CASE(zstd_decompress_multiple_frames)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, "multiple-frames.zst"sv);
+    auto expected = read_test_file("zstd-test-files"sv, "hello.txt"sv);
+    expected.append(read_test_file("zstd-test-files"sv, "lorem.txt"sv));
+
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.has_value());
+    EXPECT(decompressed.value() == expected);
+}
+
+TEST_CASE(zstd_decompress_streaming)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, "documentation.md.zst"sv);
+
+    InputMemoryStream memory_stream { compressed };
+    Compress::ZstdDecompressor zstd_stream { memory_stream };
+
+    // Read in odd-sized pieces, so that reads end in the middle of blocks.
+    ByteBuffer decompressed;
+    u8 buffer[1000];
+    while (!zstd_stream.has_any_error() && !zstd_stream.unreliable_eof()) {
+        auto nread = zstd_stream.read({ buffer, sizeof(buffer) });
+        decompressed.append(buffer, nread);
+    }
+    EXPECT(!zstd_stream.handle_any_error());
+    expect_contents(decompressed, 161690, documentation_md_sha256);
+}
+
+TEST_CASE(zstd_decompress_corrupted)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, "lorem.txt.zst"sv);
+
+    // Changing a literal is only caught by the content checksum.
+    auto corrupted = compressed;
+    corrupted[compressed.size() / 2] ^= 0x10;
+    EXPECT(!Compress::ZstdDecompressor::decompress_all(corrupted).has_value());
+
+    auto truncated = compressed.slice(0, compressed.size() - 1);
+    EXPECT(!Compress::ZstdDecompressor::decompress_all(truncated).has_value());
+
+    auto bad_magic = compressed;
+    bad_magic[0] = 0;
+    EXPECT(!Compress::ZstdDecompressor::is_likely_compressed(bad_magic));
+    EXPECT(!Compress::ZstdDecompressor::decompress_all(bad_magic).has_value());
+}
+
+TEST_CASE(zstd_decompress_oversized_rle_literals)
+{
+    // A compressed block whose RLE literals claim to regenerate 0xfffff bytes, far more than a block can hold.
+    Array<u8, 14> const frame {
+        0x28, 0xb5, 0x2f, 0xfd, // Magic number
+        0x00, 0x58,             // Frame header, with a window of 2 MiB
+        0x2d, 0x00, 0x00,       // Last compressed block of 5 bytes
+        0xfd, 0xff, 0xff, 0x41, // RLE literals section
+        0x00,                   // No sequences
+    };
+    EXPECT(!Compress::ZstdDecompressor::decompress_all(frame).has_value());
+}
+
+// Hands out its bytes like a memory stream, but then fails instead of reaching the end.
+class FailingInputStream final : public InputStream {
+public:
+    explicit FailingInputStream(ReadonlyBytes bytes)
+        : m_stream(bytes)
+    {
+    }
+
+    virtual size_t read(Bytes bytes) override
+    {
+        auto nread = m_stream.read(bytes);
+        if (nread == 0 && !bytes.is_empty())
+            set_fatal_error();
+        return nread;
+    }
+
+    virtual bool unreliable_eof() const override { return false; }
+
+    virtual bool read_or_error(Bytes bytes) override
+    {
+        if (read(bytes) < bytes.size()) {
+            set_fatal_error();
+            return false;
+        }
+        return true;
+    }
+
+    virtual bool discard_or_error(size_t count) override
+    {
+        if (!m_stream.discard_or_error(count)) {
+            m_stream.handle_any_error();
+            set_fatal_error();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    InputMemoryStream m_stream;
+};
+
+TEST_CASE(zstd_decompress_input_error_between_frames)
+{
+    auto compressed = read_test_file("zstd-test-files"sv, "hello.txt.zst"sv);
+
+    FailingInputStream input_stream { compressed };
+    Compress::ZstdDecompressor zstd_stream { input_stream };
+
+    u8 buffer[4096];
+    while (!zstd_stream.has_any_error() && !zstd_stream.unreliable_eof())
+        (void)zstd_stream.read({ buffer, sizeof(buffer) });
+
+    // The failed read must not be mistaken for the end of the stream.
+    EXPECT(zstd_stream.handle_any_error());
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
@@ -306,6 +307,42 @@ TEST_CASE(test_AES_CTR_256bit_encrypt_36bytes_with_high_counter)
     test_aes_ctr_encrypt(AS_BB(key), AS_BB(ivec), AS_BB(in), AS_BB(out));
 }
 
+TEST_CASE(test_AES_CTR_long_input)
+{
+    // Long inputs are encrypted several blocks at a time, which has to match encrypting them one block at a time.
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i * 17;
+    auto in = ByteBuffer::create_uninitialized(1000).release_value();
+    for (size_t i = 0; i < in.size(); ++i)
+        in[i] = i ^ (i >> 8);
+
+    for (size_t key_bits : Array<size_t, 3> { 128, 192, 256 }) {
+        Crypto::Cipher::AESCipher::CTRMode cipher(ReadonlyBytes { key, key_bits / 8 }, key_bits, Crypto::Cipher::Intent::Encryption);
+
+        // The counter wraps around its lower 64 bits halfway through.
+        u8 ivec[16] { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0 };
+        auto out = ByteBuffer::create_zeroed(in.size()).release_value();
+        auto out_span = out.bytes();
+        cipher.encrypt(in, out_span, { ivec, sizeof(ivec) });
+
+        auto expected = ByteBuffer::create_zeroed(in.size()).release_value();
+        for (size_t offset = 0; offset < in.size(); offset += 16) {
+            auto block_size = min<size_t>(16, in.size() - offset);
+            auto expected_span = expected.bytes().slice(offset, block_size);
+            Bytes next_ivec { ivec, sizeof(ivec) };
+            cipher.encrypt(in.bytes().slice(offset, block_size), expected_span, { ivec, sizeof(ivec) }, &next_ivec);
+        }
+        EXPECT(out == expected);
+
+        auto decrypted = ByteBuffer::create_zeroed(in.size()).release_value();
+        auto decrypted_span = decrypted.bytes();
+        u8 const original_ivec[16] { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0 };
+        cipher.decrypt(out, decrypted_span, { original_ivec, sizeof(original_ivec) });
+        EXPECT(decrypted == in);
+    }
+}
+
 static auto test_aes_ctr_decrypt = [](auto key, auto ivec, auto in, auto out_expected) {
     // nonce is already included in ivec.
     Crypto::Cipher::AESCipher::CTRMode cipher(key, 8 * key.size(), Crypto::Cipher::Intent::Decryption);
@@ -454,3 +491,46 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+static ByteBuffer make_benchmark_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size).release_value();
+    for (size_t i = 0; i < size; ++i)
+        data[i] = i * 31;
+    return data;
+}
+
+BENCHMARK_CASE(aes_ctr_throughput)
+{
+    Crypto::Cipher::AESCipher::CTRMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto in = make_benchmark_data(1 * MiB);
+    auto out = ByteBuffer::create_uninitialized(in.size()).release_value();
+    auto out_span = out.bytes();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    for (size_t i = 0; i < 16; ++i)
+        cipher.encrypt(in, out_span, iv);
+}
+
+BENCHMARK_CASE(aes_gcm_throughput)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto in = make_benchmark_data(1 * MiB);
+    auto out = ByteBuffer::create_uninitialized(in.size()).release_value();
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    for (size_t i = 0; i < 16; ++i)
+        cipher.encrypt(in, out, iv, "additional data"_b, tag);
+}
+
+BENCHMARK_CASE(aes_cbc_decrypt_throughput)
+{
+    Crypto::Cipher::AESCipher::CBCMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Decryption);
+    auto in = make_benchmark_data(1 * MiB);
+    auto out = cipher.create_aligned_buffer(in.size()).release_value();
+    auto out_span = out.bytes();
+    auto iv = ByteBuffer::create_zeroed(Crypto::Cipher::AESCipher::block_size()).release_value();
+    for (size_t i = 0; i < 16; ++i) {
+        out_span = out.bytes();
+        cipher.decrypt(in, out_span, iv);
+    }
+}
@@ -201,6 +201,37 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+// Numbers of a few hundred words go through the Karatsuba multiplication, so check it against the division.
+TEST_CASE(test_unsigned_bigint_multiplication_karatsuba)
+{
+    for (size_t left_n : { 3000, 9000, 20000 }) {
+        for (size_t right_n : { 1000, 3000, 9000, 20000 }) {
+            auto left = bigint_fibonacci(left_n);
+            auto right = bigint_fibonacci(right_n);
+            auto product = left.multiplied_by(right);
+
+            EXPECT_EQ(product, right.multiplied_by(left));
+            auto division = product.divided_by(right);
+            EXPECT_EQ(division.quotient, left);
+            EXPECT_EQ(division.remainder, Crypto::UnsignedBigInteger { 0 });
+        }
+    }
+}
+
+TEST_CASE(test_unsigned_bigint_squaring)
+{
+    for (size_t n : { 100, 1000, 3000, 9000, 20000 }) {
+        auto value = bigint_fibonacci(n);
+        auto copy = value;
+        copy.resize_with_leading_zeros(value.length() + 3);
+
+        // Multiplying a number by itself takes the squaring path, multiplying it by a copy does not.
+        auto square = value.multiplied_by(value);
+        EXPECT_EQ(square, value.multiplied_by(copy));
+        EXPECT_EQ(square.divided_by(value).quotient, value);
+    }
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -658,3 +689,54 @@ TEST_CASE(test_negative_zero_is_not_allowed)
     EXPECT(zero.unsigned_value().is_zero());
     EXPECT(!zero.is_negative());
 }
+
+static Crypto::UnsignedBigInteger bigint_with_bits(size_t bits, u32 seed)
+{
+    Vector<u8> bytes;
+    bytes.resize(bits / 8);
+    for (auto& byte : bytes) {
+        seed = seed * 1103515245 + 12345;
+        byte = seed >> 24;
+    }
+    bytes[0] |= 0x80;
+    return Crypto::UnsignedBigInteger::import_data(bytes.data(), bytes.size());
+}
+
+static void benchmark_multiplication(size_t bits, size_t iterations)
+{
+    auto left = bigint_with_bits(bits, 1);
+    auto right = bigint_with_bits(bits, 2);
+    auto expected = left.multiplied_by(right);
+    for (size_t i = 0; i < iterations; ++i)
+        EXPECT_EQ(left.multiplied_by(right), expected);
+}
+
+BENCHMARK_CASE(bigint_multiply_1024)
+{
+    benchmark_multiplication(1024, 1000);
+}
+
+BENCHMARK_CASE(bigint_multiply_2048)
+{
+    benchmark_multiplication(2048, 1000);
+}
+
+BENCHMARK_CASE(bigint_multiply_4096)
+{
+    benchmark_multiplication(4096, 200);
+}
+
+BENCHMARK_CASE(bigint_multiply_8192)
+{
+    benchmark_multiplication(8192, 100);
+}
+
+BENCHMARK_CASE(bigint_modular_power_2048)
+{
+    // An even modulus, as odd ones take the Montgomery path that doesn't multiply whole numbers.
+    auto base = bigint_with_bits(2048, 1);
+    auto exponent = bigint_with_bits(256, 2);
+    auto modulus = bigint_with_bits(2048, 3).plus(1).shift_left(1);
+    auto result = Crypto::NumberTheory::ModularPower(base, exponent, modulus);
+    EXPECT(result < modulus);
+}
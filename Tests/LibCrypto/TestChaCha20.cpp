@@ -6,6 +6,7 @@
 
 #include <AK/ByteBuffer.h>
 #include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibTest/TestCase.h>
 
 // https://datatracker.ietf.org/doc/html/rfc7539#appendix-A.2
@@ -139,3 +140,73 @@ TEST_CASE(test_vector_3)
     auto expected = ReadonlyBytes { ciphertext, 127 };
     EXPECT_EQ(result, expected);
 }
+
+TEST_CASE(test_long_input_in_pieces)
+{
+    // Long inputs are encrypted several blocks at a time, which has to match encrypting them one block at a time.
+    // The counter starts right before it carries into the next word.
+    u8 key[32] {};
+    u8 nonce[8] {};
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+
+    auto plaintext = MUST(ByteBuffer::create_uninitialized(1234));
+    for (size_t i = 0; i < plaintext.size(); ++i)
+        plaintext[i] = i * 7;
+
+    auto whole = MUST(ByteBuffer::create_uninitialized(plaintext.size()));
+    auto whole_bytes = whole.bytes();
+    Crypto::Cipher::ChaCha20 whole_cipher(ReadonlyBytes { key, 32 }, ReadonlyBytes { nonce, 8 }, 0xfffffffd);
+    whole_cipher.encrypt(plaintext, whole_bytes);
+
+    auto pieces = MUST(ByteBuffer::create_uninitialized(plaintext.size()));
+    Crypto::Cipher::ChaCha20 pieces_cipher(ReadonlyBytes { key, 32 }, ReadonlyBytes { nonce, 8 }, 0xfffffffd);
+    for (size_t offset = 0; offset < plaintext.size(); offset += 64) {
+        auto size = min<size_t>(64, plaintext.size() - offset);
+        auto piece = pieces.bytes().slice(offset, size);
+        pieces_cipher.encrypt(plaintext.bytes().slice(offset, size), piece);
+    }
+
+    EXPECT_EQ(whole, pieces);
+}
+
+// https://datatracker.ietf.org/doc/html/rfc8439#section-2.8.2
+TEST_CASE(test_aead_vector)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i;
+    u8 nonce[12] { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+    u8 aad[12] { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+    auto plaintext = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it."sv.bytes();
+    u8 ciphertext_start[16] { 0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2 };
+    u8 expected_tag[16] { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+    Crypto::Cipher::ChaCha20Poly1305 aead(ReadonlyBytes { key, 32 });
+    auto ciphertext = MUST(ByteBuffer::create_uninitialized(plaintext.size()));
+    u8 tag[16];
+    aead.encrypt(plaintext, ciphertext, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, Bytes { tag, 16 });
+    EXPECT(memcmp(ciphertext.data(), ciphertext_start, 16) == 0);
+    EXPECT(memcmp(tag, expected_tag, 16) == 0);
+
+    auto decrypted = MUST(ByteBuffer::create_uninitialized(ciphertext.size()));
+    auto consistency = aead.decrypt(ciphertext, decrypted, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, ReadonlyBytes { tag, 16 });
+    EXPECT(consistency == Crypto::VerificationConsistency::Consistent);
+    EXPECT(decrypted.bytes() == plaintext);
+
+    ciphertext[0] ^= 1;
+    consistency = aead.decrypt(ciphertext, decrypted, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, ReadonlyBytes { tag, 16 });
+    EXPECT(consistency == Crypto::VerificationConsistency::Inconsistent);
+}
+
+BENCHMARK_CASE(chacha20_throughput)
+{
+    u8 key[32] {};
+    u8 nonce[12] {};
+    auto in = MUST(ByteBuffer::create_zeroed(1 * MiB));
+    auto out = MUST(ByteBuffer::create_uninitialized(in.size()));
+    auto out_span = out.bytes();
+    Crypto::Cipher::ChaCha20 cipher(ReadonlyBytes { key, 32 }, ReadonlyBytes { nonce, 12 });
+    for (size_t i = 0; i < 16; ++i)
+        cipher.encrypt(in, out_span);
+}
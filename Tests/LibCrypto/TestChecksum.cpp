@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibCrypto/Checksum/XXHash64.h>
 #include <LibTest/TestCase.h>
 
 TEST_CASE(test_adler32)
@@ -33,3 +35,113 @@ TEST_CASE(test_crc32)
     do_test(String("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(String("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+// Straightforward implementations to check the optimized ones against.
+static u32 reference_adler32(ReadonlyBytes input)
+{
+    u32 a = 1;
+    u32 b = 0;
+    for (auto byte : input) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static u32 reference_crc32(ReadonlyBytes input)
+{
+    u32 state = ~0u;
+    for (auto byte : input) {
+        state ^= byte;
+        for (auto i = 0; i < 8; i++)
+            state = (state & 1) ? (0xEDB88320 ^ (state >> 1)) : (state >> 1);
+    }
+    return ~state;
+}
+
+static ByteBuffer make_test_data(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size).release_value();
+    u32 seed = 0x12345678;
+    for (auto& byte : buffer.bytes()) {
+        seed = seed * 1103515245 + 12345;
+        byte = seed >> 24;
+    }
+    return buffer;
+}
+
+TEST_CASE(test_adler32_lengths)
+{
+    auto data = make_test_data(20000);
+    for (size_t size : Array<size_t, 13> { 1, 15, 16, 17, 63, 64, 65, 200, 5551, 5552, 5553, 11104, 20000 })
+        EXPECT_EQ(Crypto::Checksum::Adler32(data.bytes().trim(size)).digest(), reference_adler32(data.bytes().trim(size)));
+
+    // Large sums are what would overflow if the reductions were too far apart.
+    auto ones = ByteBuffer::create_uninitialized(100000).release_value();
+    ones.bytes().fill(0xFF);
+    EXPECT_EQ(Crypto::Checksum::Adler32(ones).digest(), reference_adler32(ones));
+
+    Crypto::Checksum::Adler32 incremental;
+    for (size_t offset = 0; offset < data.size(); offset += 777)
+        incremental.update(data.bytes().slice(offset, min<size_t>(777, data.size() - offset)));
+    EXPECT_EQ(incremental.digest(), reference_adler32(data));
+}
+
+TEST_CASE(test_crc32_lengths)
+{
+    auto data = make_test_data(20000);
+    for (size_t size = 0; size < 300; ++size)
+        EXPECT_EQ(Crypto::Checksum::CRC32(data.bytes().trim(size)).digest(), reference_crc32(data.bytes().trim(size)));
+    for (size_t size : Array<size_t, 5> { 1023, 1024, 1025, 4096, 20000 })
+        EXPECT_EQ(Crypto::Checksum::CRC32(data.bytes().trim(size)).digest(), reference_crc32(data.bytes().trim(size)));
+
+    Crypto::Checksum::CRC32 incremental;
+    for (size_t offset = 0; offset < data.size(); offset += 777)
+        incremental.update(data.bytes().slice(offset, min<size_t>(777, data.size() - offset)));
+    EXPECT_EQ(incremental.digest(), reference_crc32(data));
+}
+
+BENCHMARK_CASE(adler32_throughput)
+{
+    auto data = make_test_data(1 * MiB);
+    u32 digest = 0;
+    for (size_t i = 0; i < 256; ++i)
+        digest ^= Crypto::Checksum::Adler32(data).digest();
+    EXPECT_EQ(digest, 0u);
+}
+
+BENCHMARK_CASE(crc32_throughput)
+{
+    auto data = make_test_data(1 * MiB);
+    u32 digest = 0;
+    for (size_t i = 0; i < 256; ++i)
+        digest ^= Crypto::Checksum::CRC32(data).digest();
+    EXPECT_EQ(digest, 0u);
+}
+
+TEST_CASE(test_xxhash64)
+{
+    auto do_test = [](ReadonlyBytes input, u64 expected_result) {
+        auto digest = Crypto::Checksum::XXHash64(input).digest();
+        EXPECT_EQ(digest, expected_result);
+    };
+
+    do_test(String("").bytes(), 0xEF46DB3751D8E999);
+    do_test(String("a").bytes(), 0xD24EC4F1A98C6E5B);
+    do_test(String("abc").bytes(), 0x44BC2CF5AD770999);
+    do_test(String("message digest").bytes(), 0x066ED728FCEEB3BE);
+    do_test(String("The quick brown fox jumps over the lazy dog").bytes(), 0x0B242D361FDA71BC);
+}
+
+TEST_CASE(test_xxhash64_incremental)
+{
+    auto input = String("The quick brown fox jumps over the lazy dog, and then it does so again and again.").bytes();
+    auto expected = Crypto::Checksum::XXHash64(input).digest();
+
+    for (size_t split = 0; split <= input.size(); ++split) {
+        Crypto::Checksum::XXHash64 checksum;
+        checksum.update(input.trim(split));
+        checksum.update(input.slice(split));
+        EXPECT_EQ(checksum.digest(), expected);
+    }
+}
@@ -224,3 +224,84 @@ TEST_CASE(test_secp256r1)
     ReadonlyBytes expected_public_key { expected_public_key_data, 65 };
     EXPECT_EQ(expected_public_key, generated_public);
 }
+
+TEST_CASE(test_x25519_base_point_table)
+{
+    // generate_public_key() takes a precomputed table for the base point, compute_coordinate() the ladder.
+    u8 base_point_data[32] { 9 };
+    ReadonlyBytes base_point { base_point_data, 32 };
+
+    Crypto::Curves::X25519 curve;
+    for (size_t i = 0; i < 32; ++i) {
+        auto private_key = MUST(curve.generate_private_key());
+        if (i == 0)
+            private_key.bytes().fill(0xff);
+
+        auto public_key = MUST(curve.generate_public_key(private_key));
+        EXPECT_EQ(public_key, MUST(curve.compute_coordinate(private_key, base_point)));
+    }
+}
+
+TEST_CASE(test_secp256r1_generator_table)
+{
+    // clang-format off
+    u8 generator_data[65] {
+        0x04,
+        0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+        0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+        0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+        0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5,
+    };
+
+    // The order minus one, which gives the negated generator.
+    u8 order_minus_one_data[32] {
+        0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84, 0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x50,
+    };
+
+    u8 negated_generator_data[65] {
+        0x04,
+        0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+        0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+        0xB0, 0x1C, 0xBD, 0x1C, 0x01, 0xE5, 0x80, 0x65, 0x71, 0x18, 0x14, 0xB5, 0x83, 0xF0, 0x61, 0xE9,
+        0xD4, 0x31, 0xCC, 0xA9, 0x94, 0xCE, 0xA1, 0x31, 0x34, 0x49, 0xBF, 0x97, 0xC8, 0x40, 0xAE, 0x0A,
+    };
+    // clang-format on
+
+    ReadonlyBytes generator { generator_data, 65 };
+    ReadonlyBytes order_minus_one { order_minus_one_data, 32 };
+    ReadonlyBytes negated_generator { negated_generator_data, 65 };
+
+    Crypto::Curves::SECP256r1 curve;
+    EXPECT_EQ(negated_generator, MUST(curve.generate_public_key(order_minus_one)));
+    EXPECT_EQ(negated_generator, MUST(curve.compute_coordinate(order_minus_one, generator)));
+
+    // generate_public_key() takes a precomputed table for the generator, compute_coordinate() a window of the point.
+    for (size_t i = 0; i < 32; ++i) {
+        auto private_key = MUST(curve.generate_private_key());
+        auto public_key = MUST(curve.generate_public_key(private_key));
+        EXPECT_EQ(public_key, MUST(curve.compute_coordinate(private_key, generator)));
+    }
+}
+
+BENCHMARK_CASE(x25519_key_exchange)
+{
+    Crypto::Curves::X25519 curve;
+    auto private_key = MUST(curve.generate_private_key());
+    auto public_key = MUST(curve.generate_public_key(private_key));
+    for (size_t i = 0; i < 100; ++i) {
+        (void)MUST(curve.generate_public_key(private_key));
+        (void)MUST(curve.compute_coordinate(private_key, public_key));
+    }
+}
+
+BENCHMARK_CASE(secp256r1_key_exchange)
+{
+    Crypto::Curves::SECP256r1 curve;
+    auto private_key = MUST(curve.generate_private_key());
+    auto public_key = MUST(curve.generate_public_key(private_key));
+    for (size_t i = 0; i < 100; ++i) {
+        (void)MUST(curve.generate_public_key(private_key));
+        (void)MUST(curve.compute_coordinate(private_key, public_key));
+    }
+}
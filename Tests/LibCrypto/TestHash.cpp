@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Vector.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/Hash/MD5.h>
@@ -95,6 +97,57 @@ TEST_CASE(test_MD5_consecutive_updates_reuse)
     EXPECT(memcmp(digest0.data, digest1.data, Crypto::Hash::MD5::digest_size()) == 0);
 }
 
+// Hashing messages side by side has to give the same digests as hashing them one at a time, whatever their lengths.
+// The lanes are tested on their own too, as hash_many() doesn't use them on CPUs with the SHA extensions.
+template<typename Hash>
+static void run_hash_many_test()
+{
+    Vector<ByteBuffer> buffers;
+    Vector<ReadonlyBytes> messages;
+    for (size_t i = 0; i < 19; ++i) {
+        auto buffer = ByteBuffer::create_uninitialized(i * 37 + (i % 3) * 256).release_value();
+        for (size_t j = 0; j < buffer.size(); ++j)
+            buffer[j] = i + j * 3;
+        buffers.append(move(buffer));
+    }
+    for (auto& buffer : buffers)
+        messages.append(buffer);
+
+    Vector<typename Hash::DigestType> digests;
+    digests.resize(messages.size());
+    Vector<typename Hash::DigestType> lane_digests;
+    lane_digests.resize(messages.size());
+    Hash::hash_many(messages, digests);
+    Hash::hash_many_in_lanes(messages, lane_digests);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        auto expected = Hash::hash(messages[i].data(), messages[i].size());
+        EXPECT(memcmp(expected.data, digests[i].data, Hash::digest_size()) == 0);
+        EXPECT(memcmp(expected.data, lane_digests[i].data, Hash::digest_size()) == 0);
+    }
+}
+
+// Peeking at a digest must not disturb the hash, as TLS peeks at the handshake hash while it is still being updated.
+template<typename Hash>
+static void run_peek_test()
+{
+    auto message = ByteBuffer::create_uninitialized(300).release_value();
+    for (size_t i = 0; i < message.size(); ++i)
+        message[i] = i * 7;
+    auto expected = Hash::hash(message.data(), message.size());
+
+    for (size_t split : { 0, 1, 55, 64, 100, 111, 128, 200 }) {
+        Hash hasher;
+        hasher.update(message.data(), split);
+        auto partial = hasher.peek();
+        auto expected_partial = Hash::hash(message.data(), split);
+        EXPECT(memcmp(expected_partial.data, partial.data, Hash::digest_size()) == 0);
+
+        hasher.update(message.data() + split, message.size() - split);
+        auto digest = hasher.digest();
+        EXPECT(memcmp(expected.data, digest.data, Hash::digest_size()) == 0);
+    }
+}
+
 TEST_CASE(test_SHA1_name)
 {
     Crypto::Hash::SHA1 sha;
@@ -142,6 +195,31 @@ TEST_CASE(test_SHA1_hash_successive_updates)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA1_hash_million_a)
+{
+    u8 result[] {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+    };
+    // The chunks are not a multiple of the block size, so blocks span across updates.
+    auto chunk = ByteBuffer::create_uninitialized(1000).release_value();
+    chunk.bytes().fill('a');
+    Crypto::Hash::SHA1 hasher;
+    for (size_t i = 0; i < 1000; ++i)
+        hasher.update(chunk);
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA1_hash_many)
+{
+    run_hash_many_test<Crypto::Hash::SHA1>();
+}
+
+TEST_CASE(test_SHA1_peek)
+{
+    run_peek_test<Crypto::Hash::SHA1>();
+}
+
 TEST_CASE(test_SHA256_name)
 {
     Crypto::Hash::SHA256 sha;
@@ -166,6 +244,30 @@ TEST_CASE(test_SHA256_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA256_hash_million_a)
+{
+    u8 result[] {
+        0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+    };
+    auto chunk = ByteBuffer::create_uninitialized(1000).release_value();
+    chunk.bytes().fill('a');
+    Crypto::Hash::SHA256 hasher;
+    for (size_t i = 0; i < 1000; ++i)
+        hasher.update(chunk);
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_many)
+{
+    run_hash_many_test<Crypto::Hash::SHA256>();
+}
+
+TEST_CASE(test_SHA256_peek)
+{
+    run_peek_test<Crypto::Hash::SHA256>();
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
@@ -191,6 +293,11 @@ TEST_CASE(test_SHA384_hash_bug)
     EXPECT_EQ(result_bytes, digest.bytes());
 }
 
+TEST_CASE(test_SHA384_peek)
+{
+    run_peek_test<Crypto::Hash::SHA384>();
+}
+
 TEST_CASE(test_SHA512_name)
 {
     Crypto::Hash::SHA512 sha;
@@ -216,6 +323,11 @@ TEST_CASE(test_SHA512_hash_bug)
     EXPECT_EQ(result_bytes, digest.bytes());
 }
 
+TEST_CASE(test_SHA512_peek)
+{
+    run_peek_test<Crypto::Hash::SHA512>();
+}
+
 TEST_CASE(test_SHA512_hash_empty_string)
 {
     u8 result[] {
@@ -225,6 +337,20 @@ TEST_CASE(test_SHA512_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA512::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA512_hash_million_a)
+{
+    u8 result[] {
+        0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64, 0x4e, 0x2e, 0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63, 0x8e, 0x1f, 0x98, 0xb1, 0x3b, 0x20, 0x44, 0x28, 0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9, 0x73, 0xeb, 0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a, 0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b, 0xeb, 0x00, 0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e, 0x4e, 0xad, 0xb2, 0x17, 0xad, 0x8c, 0xc0, 0x9b
+    };
+    auto chunk = ByteBuffer::create_uninitialized(1000).release_value();
+    chunk.bytes().fill('a');
+    Crypto::Hash::SHA512 hasher;
+    for (size_t i = 0; i < 1000; ++i)
+        hasher.update(chunk);
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA512::digest_size()) == 0);
+}
+
 TEST_CASE(test_ghash_test_name)
 {
     Crypto::Authentication::GHash ghash("WellHelloFriends");
@@ -250,3 +376,83 @@ TEST_CASE(test_ghash_galois_field_multiply2)
     Crypto::Authentication::galois_multiply(z, x, y);
     EXPECT(memcmp(result, z, 4 * sizeof(u32)) == 0);
 }
+
+TEST_CASE(test_ghash_long_input)
+{
+    // Long inputs take the path that multiplies several blocks at once, check it against one block at a time.
+    u8 key[16];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i * 13;
+    Crypto::Authentication::GHash ghash(ReadonlyBytes { key, sizeof(key) });
+
+    auto data = ByteBuffer::create_uninitialized(1000).release_value();
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (i * 7) ^ (i >> 3);
+    auto aad = data.bytes().slice(0, 20);
+    auto cipher = data.bytes().slice(20);
+
+    u32 h[4];
+    for (size_t i = 0; i < 4; ++i)
+        h[i] = AK::convert_between_host_and_big_endian(ByteReader::load32(key + i * 4));
+    u32 expected[4] { 0, 0, 0, 0 };
+    auto fold_block = [&](u8 const* block) {
+        for (size_t i = 0; i < 4; ++i)
+            expected[i] ^= AK::convert_between_host_and_big_endian(ByteReader::load32(block + i * 4));
+        Crypto::Authentication::galois_multiply(expected, h, expected);
+    };
+    auto fold_padded = [&](ReadonlyBytes bytes) {
+        for (size_t offset = 0; offset < bytes.size(); offset += 16) {
+            u8 block[16] {};
+            bytes.slice(offset, min<size_t>(16, bytes.size() - offset)).copy_to({ block, sizeof(block) });
+            fold_block(block);
+        }
+    };
+    fold_padded(aad);
+    fold_padded(cipher);
+    u8 lengths[16];
+    ByteReader::store(lengths, AK::convert_between_host_and_big_endian<u64>(8 * aad.size()));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_big_endian<u64>(8 * cipher.size()));
+    fold_block(lengths);
+
+    auto tag = ghash.process(aad, cipher);
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(AK::convert_between_host_and_big_endian(ByteReader::load32(tag.data + i * 4)), expected[i]);
+}
+
+// These mirror what the checksum utility does: hash big files one after another, or many files at once.
+static ByteBuffer make_benchmark_data(size_t size)
+{
+    auto data = ByteBuffer::create_uninitialized(size).release_value();
+    for (size_t i = 0; i < size; ++i)
+        data[i] = i * 31;
+    return data;
+}
+
+BENCHMARK_CASE(sha1_throughput)
+{
+    auto data = make_benchmark_data(1 * MiB);
+    Crypto::Hash::SHA1 hasher;
+    for (size_t i = 0; i < 64; ++i)
+        hasher.update(data);
+    (void)hasher.digest();
+}
+
+BENCHMARK_CASE(sha256_throughput)
+{
+    auto data = make_benchmark_data(1 * MiB);
+    Crypto::Hash::SHA256 hasher;
+    for (size_t i = 0; i < 64; ++i)
+        hasher.update(data);
+    (void)hasher.digest();
+}
+
+BENCHMARK_CASE(sha256_hash_many_throughput)
+{
+    auto data = make_benchmark_data(1 * MiB);
+    Vector<ReadonlyBytes> messages;
+    for (size_t i = 0; i < 64; ++i)
+        messages.append(data);
+    Vector<Crypto::Hash::SHA256::DigestType> digests;
+    digests.resize(messages.size());
+    Crypto::Hash::SHA256::hash_many(messages, digests);
+}
@@ -303,3 +303,37 @@ TEST_CASE(test_vector_11)
     auto expected = ReadonlyBytes { expected_result, 16 };
     EXPECT_EQ(result, expected);
 }
+
+TEST_CASE(test_update_in_pieces)
+{
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i * 13 + 1;
+
+    auto message = MUST(ByteBuffer::create_uninitialized(1000));
+    for (size_t i = 0; i < message.size(); ++i)
+        message[i] = i * 7;
+
+    Crypto::Authentication::Poly1305 whole_mac(ReadonlyBytes { key, 32 });
+    whole_mac.update(message);
+    auto whole = MUST(whole_mac.digest());
+
+    // Pieces that don't line up with the 16-byte blocks.
+    Crypto::Authentication::Poly1305 pieces_mac(ReadonlyBytes { key, 32 });
+    for (size_t offset = 0, size = 1; offset < message.size(); offset += size, size = size * 2 + 1)
+        pieces_mac.update(message.bytes().slice(offset, min(size, message.size() - offset)));
+    auto pieces = MUST(pieces_mac.digest());
+
+    EXPECT_EQ(whole, pieces);
+}
+
+BENCHMARK_CASE(poly1305_throughput)
+{
+    u8 key[32] {};
+    auto message = MUST(ByteBuffer::create_zeroed(1 * MiB));
+    for (size_t i = 0; i < 16; ++i) {
+        Crypto::Authentication::Poly1305 mac(ReadonlyBytes { key, 32 });
+        mac.update(message);
+        (void)MUST(mac.digest());
+    }
+}
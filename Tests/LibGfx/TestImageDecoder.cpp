@@ -119,6 +119,17 @@ TEST_CASE(test_png)
     EXPECT(frame.duration == 0);
 }
 
+BENCHMARK_CASE(png_decode)
+{
+    // A large screenshot, so that most of the time goes into inflating the image data.
+    auto file = Core::MappedFile::map("/res/html/misc/serenity-screenshot.png").release_value();
+    for (size_t i = 0; i < 10; ++i) {
+        auto png = Gfx::PNGImageDecoderPlugin((u8 const*)file->data(), file->size());
+        auto frame = png.frame(0).release_value_but_fixme_should_propagate_errors();
+        EXPECT_EQ(frame.image->width(), 1024);
+    }
+}
+
 TEST_CASE(test_ppm)
 {
     auto file = Core::MappedFile::map("/res/html/misc/ppmsuite_files/buggie-raw.ppm").release_value();
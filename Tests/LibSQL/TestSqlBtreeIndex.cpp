@@ -123,6 +123,8 @@ constexpr static u32 pointers[] = {
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Serializer&);
 void insert_and_get_to_and_from_btree(int);
 void insert_into_and_scan_btree(int);
+void insert_and_find_smallest_not_below_in_btree(int);
+void insert_sequential_keys_into_btree(int);
 
 NonnullRefPtr<SQL::BTree> setup_btree(SQL::Serializer& serializer)
 {
@@ -135,8 +137,8 @@ NonnullRefPtr<SQL::BTree> setup_btree(SQL::Serializer& serializer)
         serializer.heap().set_user_value(0, root_pointer);
     }
     auto btree = SQL::BTree::construct(serializer, tuple_descriptor, true, root_pointer);
-    btree->on_new_root = [&]() {
-        serializer.heap().set_user_value(0, btree->root());
+    btree->on_new_root = [&serializer, tree = btree.ptr()]() {
+        serializer.heap().set_user_value(0, tree->root());
     };
     return btree;
 }
@@ -224,6 +226,87 @@ void insert_into_and_scan_btree(int num_keys)
     }
 }
 
+void insert_and_find_smallest_not_below_in_btree(int num_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    SQL::Serializer serializer(heap);
+    auto btree = setup_btree(serializer);
+
+    for (auto ix = 0; ix < num_keys; ix++) {
+        SQL::Key k(btree->descriptor());
+        k[0] = keys[ix];
+        k.set_pointer(pointers[ix]);
+        btree->insert(k);
+    }
+
+    for (auto probe = 0; probe <= 100; probe++) {
+        Optional<int> expected;
+        int expected_count = 0;
+        for (auto ix = 0; ix < num_keys; ix++) {
+            if (keys[ix] < probe)
+                continue;
+            expected_count++;
+            if (!expected.has_value() || (keys[ix] < expected.value()))
+                expected = keys[ix];
+        }
+
+        SQL::Key k(btree->descriptor());
+        k[0] = probe;
+        auto iter = btree->find_smallest_not_below(k);
+        EXPECT_EQ(iter.is_end(), !expected.has_value());
+        if (iter.is_end())
+            continue;
+        EXPECT_EQ((int)(*iter)[0], expected.value());
+
+        int count = 0;
+        for (; !iter.is_end(); iter++)
+            count++;
+        EXPECT_EQ(count, expected_count);
+    }
+}
+
+void insert_sequential_keys_into_btree(int num_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = ix;
+            k.set_pointer(ix + 1);
+            EXPECT(btree->insert(k));
+        }
+        EXPECT(!heap->flush().is_error());
+    }
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_btree(serializer);
+
+        for (auto ix = 0; ix < num_keys; ix++) {
+            SQL::Key k(btree->descriptor());
+            k[0] = ix;
+            auto pointer_opt = btree->get(k);
+            EXPECT(pointer_opt.has_value());
+            if (pointer_opt.has_value())
+                EXPECT_EQ(pointer_opt.value(), (u32)(ix + 1));
+        }
+
+        int count = 0;
+        for (auto iter = btree->begin(); !iter.is_end(); iter++, count++)
+            EXPECT_EQ((int)(*iter)[0], count);
+        EXPECT_EQ(count, num_keys);
+    }
+}
+
 TEST_CASE(btree_one_key)
 {
     insert_and_get_to_and_from_btree(1);
@@ -318,3 +401,18 @@ TEST_CASE(btree_scan_50_keys)
 {
     insert_into_and_scan_btree(50);
 }
+
+TEST_CASE(btree_find_smallest_not_below_one_key)
+{
+    insert_and_find_smallest_not_below_in_btree(1);
+}
+
+TEST_CASE(btree_find_smallest_not_below_50_keys)
+{
+    insert_and_find_smallest_not_below_in_btree(50);
+}
+
+TEST_CASE(btree_5000_sequential_keys)
+{
+    insert_sequential_keys_into_btree(5000);
+}
@@ -12,6 +12,7 @@
 #include <LibSQL/Heap.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
+#include <LibSQL/TupleDescriptor.h>
 #include <LibSQL/Value.h>
 #include <LibTest/TestCase.h>
 
@@ -225,3 +226,144 @@ TEST_CASE(insert_100_into_table)
 {
     insert_and_verify(100);
 }
+
+TEST_CASE(page_cache_serves_repeated_reads)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        (void)setup_table(db);
+        insert_into_table(db, 100);
+        commit(db);
+    }
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        verify_table_contents(db, 100);
+        auto misses_after_first_scan = db->page_cache_statistics().misses;
+        verify_table_contents(db, 100);
+        auto statistics = db->page_cache_statistics();
+        EXPECT_EQ(statistics.misses, misses_after_first_scan);
+        EXPECT(statistics.hits >= 100u);
+        EXPECT_EQ(statistics.evictions, 0u);
+    }
+}
+
+TEST_CASE(page_cache_does_not_count_write_ahead_log_reads)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto db = SQL::Database::construct("/tmp/test.db");
+    EXPECT(!db->open().is_error());
+    (void)setup_table(db);
+    insert_into_table(db, 100);
+    auto before = db->page_cache_statistics();
+    verify_table_contents(db, 100);
+    auto statistics = db->page_cache_statistics();
+    EXPECT_EQ(statistics.hits, before.hits);
+    EXPECT_EQ(statistics.misses, before.misses);
+    EXPECT(statistics.write_ahead_log_reads >= before.write_ahead_log_reads + 100);
+}
+
+TEST_CASE(page_cache_evicts_beyond_capacity)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        (void)setup_table(db);
+        insert_into_table(db, 100);
+        commit(db);
+    }
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        db->set_page_cache_capacity(8);
+        verify_table_contents(db, 100);
+        verify_table_contents(db, 100);
+        auto statistics = db->page_cache_statistics();
+        EXPECT_EQ(statistics.cached_pages, 8u);
+        EXPECT_EQ(statistics.capacity, 8u);
+        EXPECT(statistics.evictions > 0u);
+    }
+}
+
+// The benchmarks run once with the page cache disabled, which is how every block used to be read, and once with it.
+static constexpr int benchmark_row_count = 200;
+static constexpr int benchmark_rounds = 200;
+
+static NonnullRefPtr<SQL::BTree> setup_benchmark_btree(SQL::Serializer& serializer)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> tuple_descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    tuple_descriptor->append({ "schema", "table", "key_value", SQL::SQLType::Integer, SQL::Order::Ascending });
+
+    auto root_pointer = serializer.heap().user_value(0);
+    if (!root_pointer) {
+        root_pointer = serializer.heap().new_record_pointer();
+        serializer.heap().set_user_value(0, root_pointer);
+    }
+    auto btree = SQL::BTree::construct(serializer, tuple_descriptor, true, root_pointer);
+    btree->on_new_root = [&]() {
+        serializer.heap().set_user_value(0, btree->root());
+    };
+    return btree;
+}
+
+static void point_lookups(size_t page_cache_capacity)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        EXPECT(!heap->open().is_error());
+        SQL::Serializer serializer(heap);
+        auto btree = setup_benchmark_btree(serializer);
+        for (auto ix = 0; ix < benchmark_row_count; ix++) {
+            SQL::Key key(btree->descriptor());
+            key[0] = ix;
+            key.set_pointer(ix + 1);
+            btree->insert(key);
+        }
+        EXPECT(!heap->flush().is_error());
+    }
+
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+    heap->set_page_cache_capacity(page_cache_capacity);
+    SQL::Serializer serializer(heap);
+    auto btree = setup_benchmark_btree(serializer);
+    for (auto round = 0; round < benchmark_rounds; round++) {
+        for (auto ix = 0; ix < benchmark_row_count; ix++) {
+            SQL::Key key(btree->descriptor());
+            key[0] = (ix * 7919) % benchmark_row_count;
+            auto pointer = btree->get(key);
+            EXPECT(pointer.has_value());
+        }
+    }
+}
+
+BENCHMARK_CASE(point_lookups_without_page_cache) { point_lookups(0); }
+BENCHMARK_CASE(point_lookups_with_page_cache) { point_lookups(SQL::Heap::default_page_cache_capacity); }
+
+static void table_scans(size_t page_cache_capacity)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        (void)setup_table(db);
+        insert_into_table(db, benchmark_row_count);
+        commit(db);
+    }
+
+    auto db = SQL::Database::construct("/tmp/test.db");
+    EXPECT(!db->open().is_error());
+    db->set_page_cache_capacity(page_cache_capacity);
+    auto table = MUST(db->get_table("TestSchema", "TestTable"));
+    for (auto round = 0; round < benchmark_rounds; round++) {
+        auto rows = MUST(db->select_all(*table));
+        EXPECT_EQ(rows.size(), static_cast<size_t>(benchmark_row_count));
+    }
+}
+
+BENCHMARK_CASE(table_scans_without_page_cache) { table_scans(0); }
+BENCHMARK_CASE(table_scans_with_page_cache) { table_scans(SQL::Heap::default_page_cache_capacity); }
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Join.h>
+#include <LibSQL/Tuple.h>
+#include <LibSQL/TupleDescriptor.h>
+#include <LibSQL/Value.h>
+#include <LibTest/TestCase.h>
+
+namespace {
+
+NonnullRefPtr<SQL::TupleDescriptor> make_descriptor(String const& table_name)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    descriptor->append({ "SCHEMA", table_name, "KEY", SQL::SQLType::Integer, SQL::Order::Ascending });
+    descriptor->append({ "SCHEMA", table_name, "NAME", SQL::SQLType::Text, SQL::Order::Ascending });
+    return descriptor;
+}
+
+SQL::JoinRow make_row(NonnullRefPtr<SQL::TupleDescriptor> const& descriptor, Optional<int> key, String const& name)
+{
+    SQL::Tuple row(descriptor);
+    if (key.has_value())
+        row[0] = key.value();
+    else
+        row[0] = SQL::Value::null();
+    row[1] = name;
+    return { row[0], row };
+}
+
+// Outer rows have keys 0, 1, 2, ... and inner rows have every other key, some of them twice.
+void make_rows(int count, Vector<SQL::JoinRow>& outer, Vector<SQL::JoinRow>& inner)
+{
+    auto outer_descriptor = make_descriptor("OUTER");
+    auto inner_descriptor = make_descriptor("INNER");
+    for (auto ix = 0; ix < count; ix++) {
+        outer.append(make_row(outer_descriptor, ix, String::formatted("Outer_{}", ix)));
+        if (ix % 2 == 0)
+            inner.append(make_row(inner_descriptor, ix, String::formatted("Inner_{}", ix)));
+        if (ix % 6 == 0)
+            inner.append(make_row(inner_descriptor, ix, String::formatted("Again_{}", ix)));
+    }
+    outer.append(make_row(outer_descriptor, {}, "Outer_null"));
+    inner.append(make_row(inner_descriptor, {}, "Inner_null"));
+}
+
+size_t expected_matches(int count)
+{
+    return (count + 1) / 2 + (count + 5) / 6;
+}
+
+Vector<String> hash_join(Vector<SQL::JoinRow> outer, Vector<SQL::JoinRow> inner, size_t memory_budget, bool expect_spill)
+{
+    Vector<String> joined;
+    SQL::JoinCallback callback = [&](SQL::Tuple const& outer_row, SQL::Tuple const& inner_row) -> SQL::ResultOr<void> {
+        EXPECT_EQ(outer_row[0].to_int().value(), inner_row[0].to_int().value());
+        joined.append(String::formatted("{}|{}", outer_row[1].to_string(), inner_row[1].to_string()));
+        return {};
+    };
+
+    // The hash table goes over the memory budget by at most one row.
+    size_t largest_row_size = 0;
+    for (auto& row : inner)
+        largest_row_size = max(largest_row_size, row.key.length() + row.row.length());
+
+    SQL::HashJoin join(memory_budget);
+    for (auto& row : inner)
+        EXPECT(!join.add_build_row(move(row)).is_error());
+    EXPECT_EQ(join.has_spilled(), expect_spill);
+    for (auto& row : outer)
+        EXPECT(!join.probe(move(row), callback).is_error());
+    EXPECT(!join.finish(callback).is_error());
+    EXPECT(join.peak_memory_used() <= memory_budget + largest_row_size);
+    return joined;
+}
+
+Vector<String> merge_join(Vector<SQL::JoinRow> outer, Vector<SQL::JoinRow> inner)
+{
+    Vector<String> joined;
+    SQL::JoinCallback callback = [&](SQL::Tuple const& outer_row, SQL::Tuple const& inner_row) -> SQL::ResultOr<void> {
+        EXPECT_EQ(outer_row[0].to_int().value(), inner_row[0].to_int().value());
+        joined.append(String::formatted("{}|{}", outer_row[1].to_string(), inner_row[1].to_string()));
+        return {};
+    };
+    EXPECT(!SQL::merge_join(outer, inner, callback).is_error());
+    return joined;
+}
+
+}
+
+TEST_CASE(hash_join)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(100, outer, inner);
+    auto joined = hash_join(outer, inner, SQL::Database::default_join_memory_budget, false);
+    EXPECT_EQ(joined.size(), expected_matches(100));
+
+    // Without spilling, the matches come in the order of the outer rows.
+    EXPECT_EQ(joined[0], "Outer_0|Inner_0");
+    EXPECT_EQ(joined[1], "Outer_0|Again_0");
+    EXPECT_EQ(joined[2], "Outer_2|Inner_2");
+    for (auto& row : joined)
+        EXPECT(!row.contains("null"sv));
+}
+
+TEST_CASE(hash_join_spilling_to_disk)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(1000, outer, inner);
+    auto in_memory = hash_join(outer, inner, SQL::Database::default_join_memory_budget, false);
+    auto spilled = hash_join(outer, inner, 1024, true);
+    EXPECT_EQ(spilled.size(), expected_matches(1000));
+
+    quick_sort(in_memory);
+    quick_sort(spilled);
+    EXPECT_EQ(spilled, in_memory);
+}
+
+TEST_CASE(hash_join_partitioning_again)
+{
+    // With 16 partitions, the rows of every partition still take up more than the memory budget.
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(5000, outer, inner);
+    auto in_memory = hash_join(outer, inner, SQL::Database::default_join_memory_budget, false);
+    auto spilled = hash_join(outer, inner, 512, true);
+    EXPECT_EQ(spilled.size(), expected_matches(5000));
+
+    quick_sort(in_memory);
+    quick_sort(spilled);
+    EXPECT_EQ(spilled, in_memory);
+}
+
+TEST_CASE(hash_join_spilling_one_key)
+{
+    // Partitioning can't split up rows with the same key, so they are joined a part at a time.
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    auto outer_descriptor = make_descriptor("OUTER");
+    auto inner_descriptor = make_descriptor("INNER");
+    for (auto ix = 0; ix < 100; ix++)
+        outer.append(make_row(outer_descriptor, ix, String::formatted("Outer_{}", ix)));
+    outer.append(make_row(outer_descriptor, 7, "Outer_7_again"));
+    for (auto ix = 0; ix < 500; ix++)
+        inner.append(make_row(inner_descriptor, 7, String::formatted("Inner_{}", ix)));
+
+    auto in_memory = hash_join(outer, inner, SQL::Database::default_join_memory_budget, false);
+    auto spilled = hash_join(outer, inner, 1024, true);
+    EXPECT_EQ(spilled.size(), 1000u);
+
+    quick_sort(in_memory);
+    quick_sort(spilled);
+    EXPECT_EQ(spilled, in_memory);
+}
+
+TEST_CASE(hash_join_empty_sides)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(10, outer, inner);
+    EXPECT(hash_join(outer, {}, SQL::Database::default_join_memory_budget, false).is_empty());
+    EXPECT(hash_join({}, inner, SQL::Database::default_join_memory_budget, false).is_empty());
+    EXPECT(hash_join({}, inner, 1, true).is_empty());
+}
+
+TEST_CASE(merge_join)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(100, outer, inner);
+    auto expected = hash_join(outer, inner, SQL::Database::default_join_memory_budget, false);
+
+    auto joined = merge_join(outer, inner);
+    EXPECT_EQ(joined.size(), expected_matches(100));
+    EXPECT_EQ(joined[0], "Outer_0|Inner_0");
+    EXPECT_EQ(joined[1], "Outer_0|Again_0");
+
+    quick_sort(joined);
+    quick_sort(expected);
+    EXPECT_EQ(joined, expected);
+}
+
+TEST_CASE(merge_join_unsorted_input)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(100, outer, inner);
+    auto expected = merge_join(outer, inner);
+
+    outer.reverse();
+    inner.reverse();
+    auto joined = merge_join(outer, inner);
+
+    // The keys come in order, but rows with the same key may not.
+    EXPECT_EQ(joined.size(), expected.size());
+    quick_sort(joined);
+    quick_sort(expected);
+    EXPECT_EQ(joined, expected);
+}
+
+constexpr int benchmark_rows = 100000;
+
+BENCHMARK_CASE(hash_join_100000_rows)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(benchmark_rows, outer, inner);
+    EXPECT_EQ(hash_join(move(outer), move(inner), SQL::Database::default_join_memory_budget, false).size(), expected_matches(benchmark_rows));
+}
+
+BENCHMARK_CASE(hash_join_100000_rows_spilling_to_disk)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(benchmark_rows, outer, inner);
+    EXPECT_EQ(hash_join(move(outer), move(inner), 1 * MiB, true).size(), expected_matches(benchmark_rows));
+}
+
+BENCHMARK_CASE(merge_join_100000_rows_sorted)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(benchmark_rows, outer, inner);
+    EXPECT_EQ(merge_join(move(outer), move(inner)).size(), expected_matches(benchmark_rows));
+}
+
+BENCHMARK_CASE(merge_join_100000_rows_unsorted)
+{
+    Vector<SQL::JoinRow> outer;
+    Vector<SQL::JoinRow> inner;
+    make_rows(benchmark_rows, outer, inner);
+    outer.reverse();
+    inner.reverse();
+    EXPECT_EQ(merge_join(move(outer), move(inner)).size(), expected_matches(benchmark_rows));
+}
@@ -7,8 +7,11 @@
 
 #include <unistd.h>
 
+#include <AK/HashTable.h>
 #include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/AST/Parser.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Result.h>
@@ -614,6 +617,473 @@ TEST_CASE(select_with_offset_out_of_bounds)
     EXPECT_EQ(result.size(), 0u);
 }
 
+void insert_rows(NonnullRefPtr<SQL::Database> database, int from, int to)
+{
+    for (auto count = from; count < to; count++) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        EXPECT(result.size() == 1);
+    }
+}
+
+Vector<String> explain(NonnullRefPtr<SQL::Database> database, String const& sql)
+{
+    auto result = execute(database, sql);
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Explain);
+    Vector<String> lines;
+    for (auto& row : result)
+        lines.append(row.row[0].to_string());
+    return lines;
+}
+
+TEST_CASE(create_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    insert_rows(database, 0, 10);
+
+    auto result = execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+    auto table_or_error = database->get_table("TESTSCHEMA", "TESTTABLE");
+    EXPECT(!table_or_error.is_error());
+    EXPECT_EQ(table_or_error.value()->indexes().size(), 1u);
+    EXPECT_EQ(table_or_error.value()->indexes()[0].name(), "INTINDEX");
+
+    auto error_result = try_execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT(error_result.is_error());
+    EXPECT_EQ(error_result.release_error().error(), SQL::SQLErrorCode::IndexExists);
+
+    result = execute(database, "CREATE INDEX IF NOT EXISTS TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+
+    error_result = try_execute(database, "CREATE INDEX TestSchema.BadIndex ON TestTable ( BadColumn );");
+    EXPECT(error_result.is_error());
+    EXPECT_EQ(error_result.release_error().error(), SQL::SQLErrorCode::ColumnDoesNotExist);
+
+    error_result = try_execute(database, "CREATE INDEX TestSchema.BadIndex ON BadTable ( IntColumn );");
+    EXPECT(error_result.is_error());
+    EXPECT_EQ(error_result.release_error().error(), SQL::SQLErrorCode::TableDoesNotExist);
+}
+
+TEST_CASE(create_unique_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    insert_rows(database, 0, 10);
+    execute(database, "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Other', 5 );");
+
+    auto error_result = try_execute(database, "CREATE UNIQUE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT(error_result.is_error());
+    auto table_or_error = database->get_table("TESTSCHEMA", "TESTTABLE");
+    EXPECT(!table_or_error.is_error());
+    EXPECT(table_or_error.value()->indexes().is_empty());
+
+    auto result = execute(database, "CREATE UNIQUE INDEX TestSchema.TextIndex ON TestTable ( TextColumn, IntColumn );");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+    error_result = try_execute(database, "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_3', 3 );");
+    EXPECT(error_result.is_error());
+    insert_rows(database, 10, 11);
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable;");
+    EXPECT_EQ(result.size(), 12u);
+}
+
+TEST_CASE(select_with_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+
+    // Rows inserted before the index is created are added to it when it's built,
+    // rows inserted afterwards as they go in.
+    insert_rows(database, 0, 100);
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    insert_rows(database, 100, 200);
+
+    auto expect_int_column_values = [&](String const& where, Vector<int> expected) {
+        auto result = execute(database, String::formatted("SELECT IntColumn FROM TestSchema.TestTable WHERE {} ORDER BY IntColumn;", where));
+        EXPECT_EQ(result.size(), expected.size());
+        for (auto ix = 0u; ix < min(result.size(), expected.size()); ix++)
+            EXPECT_EQ(result[ix].row[0].to_int().value(), expected[ix]);
+    };
+
+    expect_int_column_values("IntColumn = 42", { 42 });
+    expect_int_column_values("IntColumn = 142", { 142 });
+    expect_int_column_values("142 = IntColumn", { 142 });
+    expect_int_column_values("IntColumn = 500", {});
+    expect_int_column_values("(IntColumn > 95) AND (IntColumn <= 103)", { 96, 97, 98, 99, 100, 101, 102, 103 });
+    expect_int_column_values("IntColumn >= 197", { 197, 198, 199 });
+    expect_int_column_values("IntColumn < 3", { 0, 1, 2 });
+    expect_int_column_values("3 > IntColumn", { 0, 1, 2 });
+    expect_int_column_values("IntColumn < 3.4", { 0, 1, 2 });
+    expect_int_column_values("(IntColumn > 150) AND (TextColumn = 'Test_160')", { 160 });
+    expect_int_column_values("(IntColumn < 10) AND ((IntColumn + 1) > 8)", { 8, 9 });
+
+    auto lines = explain(database, "EXPLAIN QUERY PLAN SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn = 42;");
+    EXPECT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+}
+
+TEST_CASE(select_with_index_after_reopening_database)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    {
+        auto database = SQL::Database::construct(db_name);
+        EXPECT(!database->open().is_error());
+        create_table(database);
+        execute(database, "CREATE UNIQUE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+        insert_rows(database, 0, 500);
+        EXPECT(!database->commit().is_error());
+    }
+    {
+        auto database = SQL::Database::construct(db_name);
+        EXPECT(!database->open().is_error());
+
+        auto lines = explain(database, "EXPLAIN SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 321;");
+        EXPECT_EQ(lines[0], "SEARCH TESTSCHEMA.TESTTABLE USING UNIQUE INDEX INTINDEX (INTCOLUMN=?)");
+
+        auto result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 321;");
+        EXPECT_EQ(result.size(), 1u);
+        EXPECT_EQ(result[0].row[0].to_string(), "Test_321");
+
+        result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE (IntColumn >= 250) AND (IntColumn < 260);");
+        EXPECT_EQ(result.size(), 10u);
+
+        auto error_result = try_execute(database, "INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test', 321 );");
+        EXPECT(error_result.is_error());
+    }
+}
+
+TEST_CASE(explain_select)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+
+    auto lines = explain(database, "EXPLAIN SELECT * FROM TestSchema.TestTable;");
+    EXPECT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0], "SCAN TESTSCHEMA.TESTTABLE");
+
+    lines = explain(database, "EXPLAIN SELECT * FROM TestSchema.TestTable WHERE TextColumn = 'Test_1' ORDER BY IntColumn LIMIT 5;");
+    EXPECT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "SCAN TESTSCHEMA.TESTTABLE");
+    EXPECT_EQ(lines[1], "FILTER TESTSCHEMA.TESTTABLE (1 TERM)");
+    EXPECT_EQ(lines[2], "SORT FOR ORDER BY");
+    EXPECT_EQ(lines[3], "LIMIT");
+
+    lines = explain(database, "EXPLAIN SELECT * FROM TestSchema.TestTable WHERE (IntColumn > 10) AND (IntColumn < 20);");
+    EXPECT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN>? AND INTCOLUMN<?)");
+    EXPECT_EQ(lines[1], "FILTER TESTSCHEMA.TESTTABLE (2 TERMS)");
+
+    lines = explain(database, "EXPLAIN SELECT * FROM TestSchema.TestTable WHERE 10 <= IntColumn;");
+    EXPECT_EQ(lines[0], "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN>=?)");
+
+    // The planner only knows how to search the index with constants.
+    lines = explain(database, "EXPLAIN SELECT * FROM TestSchema.TestTable WHERE IntColumn = IntColumn + 1;");
+    EXPECT_EQ(lines[0], "SCAN TESTSCHEMA.TESTTABLE");
+
+    auto error_result = try_execute(database, "EXPLAIN DESCRIBE TABLE TestSchema.TestTable;");
+    EXPECT(error_result.is_error());
+    EXPECT_EQ(error_result.release_error().error(), SQL::SQLErrorCode::NotYetImplemented);
+}
+
+TEST_CASE(select_cross_join_with_pushed_down_filters)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    for (auto count = 0; count < 20; count++) {
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES ( 'Test_{}', {} );", count, count * 2));
+    }
+    execute(database, "CREATE INDEX TestSchema.IntIndex2 ON TestTable2 ( IntColumn );");
+
+    auto sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+               "WHERE (TestTable1.IntColumn < 5) AND (TestTable2.IntColumn = 8) AND (TextColumn1 != TextColumn2) "
+               "ORDER BY TextColumn1;"sv;
+    auto lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines.size(), 7u);
+    EXPECT_EQ(lines[0], "SCAN TESTSCHEMA.TESTTABLE1");
+    EXPECT_EQ(lines[1], "FILTER TESTSCHEMA.TESTTABLE1 (1 TERM)");
+    EXPECT_EQ(lines[2], "SEARCH TESTSCHEMA.TESTTABLE2 USING INDEX INTINDEX2 (INTCOLUMN=?)");
+    EXPECT_EQ(lines[3], "FILTER TESTSCHEMA.TESTTABLE2 (1 TERM)");
+    EXPECT_EQ(lines[4], "NESTED LOOP JOIN TESTSCHEMA.TESTTABLE2");
+    EXPECT_EQ(lines[5], "FILTER JOIN (1 TERM)");
+    EXPECT_EQ(lines[6], "SORT FOR ORDER BY");
+
+    auto result = execute(database, sql);
+    EXPECT_EQ(result.size(), 4u);
+    for (auto ix = 0u; ix < result.size(); ix++) {
+        EXPECT_EQ(result[ix].row[0].to_string(), String::formatted("Test_{}", ix));
+        EXPECT_EQ(result[ix].row[1].to_string(), "Test_4");
+    }
+
+    // An unqualified column that exists in both tables can't be pushed down, and
+    // still fails the same way it always did.
+    auto error_result = try_execute(database, "SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 WHERE IntColumn = 8;");
+    EXPECT(error_result.is_error());
+    EXPECT_EQ(error_result.release_error().error(), SQL::SQLErrorCode::AmbiguousColumnName);
+}
+
+void insert_join_rows(NonnullRefPtr<SQL::Database> database, int count)
+{
+    for (auto ix = 0; ix < count; ix++) {
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix));
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix * 2));
+    }
+}
+
+Vector<String> join_result(NonnullRefPtr<SQL::Database> database, String const& sql)
+{
+    auto result = execute(database, sql);
+    Vector<String> rows;
+    for (auto& row : result)
+        rows.append(String::formatted("{}|{}", row.row[0].to_string(), row.row[1].to_string()));
+    quick_sort(rows);
+    return rows;
+}
+
+TEST_CASE(select_join_on)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    insert_join_rows(database, 20);
+
+    auto sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+               "JOIN TestSchema.TestTable2 ON TestTable1.IntColumn = TestTable2.IntColumn "
+               "ORDER BY TestTable1.IntColumn;"sv;
+    auto lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "SCAN TESTSCHEMA.TESTTABLE1");
+    EXPECT_EQ(lines[1], "SCAN TESTSCHEMA.TESTTABLE2");
+    EXPECT_EQ(lines[2], "HASH JOIN TESTSCHEMA.TESTTABLE2 ON TESTTABLE2.INTCOLUMN = TESTTABLE1.INTCOLUMN");
+    EXPECT_EQ(lines[3], "SORT FOR ORDER BY");
+
+    auto result = execute(database, sql);
+    EXPECT_EQ(result.size(), 10u);
+    for (auto ix = 0u; ix < result.size(); ix++) {
+        EXPECT_EQ(result[ix].row[0].to_string(), String::formatted("Test_{}", ix * 2));
+        EXPECT_EQ(result[ix].row[1].to_string(), String::formatted("Test_{}", ix));
+    }
+
+    // The same join written with a WHERE clause is planned the same way.
+    auto where_sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+                     "WHERE TestTable2.IntColumn = TestTable1.IntColumn;"sv;
+    lines = explain(database, String::formatted("EXPLAIN {}", where_sql));
+    EXPECT_EQ(lines[2], "HASH JOIN TESTSCHEMA.TESTTABLE2 ON TESTTABLE2.INTCOLUMN = TESTTABLE1.INTCOLUMN");
+    EXPECT_EQ(join_result(database, where_sql), join_result(database, sql));
+
+    // Other terms of the join constraint are checked once the rows are joined.
+    sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+          "INNER JOIN TestSchema.TestTable2 ON (TestTable1.IntColumn = TestTable2.IntColumn) AND (TextColumn1 != TextColumn2);"sv;
+    lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[3], "FILTER JOIN (1 TERM)");
+    EXPECT_EQ(execute(database, sql).size(), 9u);
+
+    // A join without an equality between columns falls back to a nested loop.
+    sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+          "CROSS JOIN TestSchema.TestTable2 WHERE TestTable1.IntColumn > TestTable2.IntColumn;"sv;
+    lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines[2], "NESTED LOOP JOIN TESTSCHEMA.TESTTABLE2");
+    EXPECT_EQ(lines[3], "FILTER JOIN (1 TERM)");
+    EXPECT_EQ(execute(database, sql).size(), 100u);
+}
+
+TEST_CASE(select_hash_join_spilling_to_disk)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    for (auto ix = 0; ix < 100; ix++) {
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable1 ( TextColumn1, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix % 30));
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable2 ( TextColumn2, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix % 20));
+    }
+
+    auto sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+               "JOIN TestSchema.TestTable2 ON TestTable1.IntColumn = TestTable2.IntColumn;"sv;
+    auto in_memory = join_result(database, sql);
+
+    // The keys from 0 to 19 appear 5 times in the second table, and 4 (up to 9) or 3 times in the first.
+    EXPECT_EQ(in_memory.size(), (10u * 4u + 10u * 3u) * 5u);
+
+    database->set_join_memory_budget(1);
+    EXPECT_EQ(join_result(database, sql), in_memory);
+}
+
+TEST_CASE(select_merge_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    insert_join_rows(database, 20);
+    auto sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+               "JOIN TestSchema.TestTable2 ON TestTable1.IntColumn = TestTable2.IntColumn;"sv;
+    auto hash_joined = join_result(database, sql);
+    EXPECT_EQ(hash_joined.size(), 10u);
+
+    execute(database, "CREATE INDEX TestSchema.IntIndex2 ON TestTable2 ( IntColumn );");
+    auto lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[1], "SCAN TESTSCHEMA.TESTTABLE2 USING INDEX INTINDEX2");
+    EXPECT_EQ(lines[2], "MERGE JOIN TESTSCHEMA.TESTTABLE2 ON TESTTABLE2.INTCOLUMN = TESTTABLE1.INTCOLUMN");
+
+    // A merge join returns the rows in key order.
+    auto result = execute(database, sql);
+    EXPECT_EQ(result.size(), 10u);
+    for (auto ix = 0u; ix < result.size(); ix++)
+        EXPECT_EQ(result[ix].row[1].to_string(), String::formatted("Test_{}", ix));
+    EXPECT_EQ(join_result(database, sql), hash_joined);
+
+    // The index can be searched for the join as well.
+    sql = "SELECT TextColumn1, TextColumn2 FROM TestSchema.TestTable1 "
+          "JOIN TestSchema.TestTable2 ON TestTable1.IntColumn = TestTable2.IntColumn WHERE TestTable2.IntColumn < 10;"sv;
+    lines = explain(database, String::formatted("EXPLAIN {}", sql));
+    EXPECT_EQ(lines[1], "SEARCH TESTSCHEMA.TESTTABLE2 USING INDEX INTINDEX2 (INTCOLUMN<?)");
+    EXPECT_EQ(lines[3], "MERGE JOIN TESTSCHEMA.TESTTABLE2 ON TESTTABLE2.INTCOLUMN = TESTTABLE1.INTCOLUMN");
+    EXPECT_EQ(execute(database, sql).size(), 5u);
+}
+
+TEST_CASE(select_outer_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = try_execute(database, "SELECT * FROM TestSchema.TestTable1 LEFT JOIN TestSchema.TestTable2 ON TestTable1.IntColumn = TestTable2.IntColumn;");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::NotYetImplemented);
+}
+
+NonnullOwnPtr<SQL::AST::Cursor> open_cursor(NonnullRefPtr<SQL::Database> database, String const& sql)
+{
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+    auto statement = parser.next_statement();
+    EXPECT(!parser.has_errors());
+    auto cursor = verify_cast<SQL::AST::Select>(*statement).cursor(move(database));
+    EXPECT(!cursor.is_error());
+    return cursor.release_value();
+}
+
+u64 page_reads(SQL::Database const& database)
+{
+    auto statistics = database.page_cache_statistics();
+    return statistics.hits + statistics.misses + statistics.write_ahead_log_reads;
+}
+
+TEST_CASE(select_with_cursor)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    for (auto ix = 0; ix < 20; ix++)
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix));
+
+    auto cursor = open_cursor(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 10 ORDER BY IntColumn DESC;");
+    for (auto ix = 19; ix >= 10; ix--) {
+        auto row = cursor->next();
+        EXPECT(!row.is_error());
+        EXPECT(row.value().has_value());
+        EXPECT_EQ(row.value().value()[0].to_string(), String::formatted("Test_{}", ix));
+        EXPECT_EQ(row.value().value()[1].to_int().value(), ix);
+    }
+    auto row = cursor->next();
+    EXPECT(!row.is_error());
+    EXPECT(!row.value().has_value());
+}
+
+TEST_CASE(select_with_cursor_while_inserting_into_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    for (auto ix = 0; ix < 200; ix++)
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Before_{}', {} );", ix, ix * 2));
+
+    auto cursor = open_cursor(database, "SELECT TextColumn, IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 0;");
+    HashTable<String> seen;
+    int last_value = -1;
+    auto read_rows = [&](size_t count) {
+        for (auto ix = 0u; ix < count; ix++) {
+            auto row = cursor->next();
+            EXPECT(!row.is_error());
+            if (!row.value().has_value())
+                return;
+            auto text = row.value().value()[0].to_string();
+            auto value = row.value().value()[1].to_int().value();
+            EXPECT(value >= last_value);
+            EXPECT_EQ(seen.set(text), AK::HashSetResult::InsertedNewEntry);
+            last_value = value;
+        }
+    };
+    read_rows(50);
+
+    // Every insert between rows moves the entries of the index around, and
+    // splits its nodes every now and then. Each row is still read once, and
+    // rows that go in after the last row that was read show up too.
+    Vector<String> expected;
+    for (auto ix = 0; ix < 200; ix++) {
+        auto insert = [&](String const& text, int value) {
+            execute(database, String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( '{}', {} );", text, value));
+            if (value > last_value)
+                expected.append(text);
+        };
+        insert(String::formatted("During_{}", ix), 399 - ix * 2);
+        insert(String::formatted("Duplicate_{}", ix), ix * 2);
+        read_rows(1);
+    }
+    read_rows(NumericLimits<size_t>::max());
+
+    for (auto ix = 0; ix < 200; ix++)
+        EXPECT(seen.contains(String::formatted("Before_{}", ix)));
+    EXPECT(expected.size() > 50u);
+    for (auto& text : expected)
+        EXPECT(seen.contains(text));
+}
+
+TEST_CASE(select_with_limit_stops_reading_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    for (auto ix = 0; ix < 100; ix++)
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", ix, ix));
+
+    auto reads_before = page_reads(*database);
+    EXPECT_EQ(execute(database, "SELECT * FROM TestSchema.TestTable LIMIT 5;").size(), 5u);
+    auto limited_reads = page_reads(*database) - reads_before;
+
+    reads_before = page_reads(*database);
+    EXPECT_EQ(execute(database, "SELECT * FROM TestSchema.TestTable;").size(), 100u);
+    auto full_reads = page_reads(*database) - reads_before;
+
+    // Every row is read from its own block, and the scan stops after the limit.
+    EXPECT(full_reads >= 100u);
+    EXPECT(limited_reads <= 5u + (full_reads - 100u));
+
+    // Sorting has to read all rows before the first one can be produced.
+    reads_before = page_reads(*database);
+    EXPECT_EQ(execute(database, "SELECT * FROM TestSchema.TestTable ORDER BY IntColumn LIMIT 5;").size(), 5u);
+    EXPECT_EQ(page_reads(*database) - reads_before, full_reads);
+}
+
 TEST_CASE(describe_table)
 {
     ScopeGuard guard([]() { unlink(db_name); });
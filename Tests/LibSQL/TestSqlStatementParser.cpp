@@ -131,6 +131,59 @@ TEST_CASE(create_table)
     validate("CREATE TABLE test ( column1 varchar(1e3) );", {}, "TEST", { { "COLUMN1", "VARCHAR", { 1000 } } });
 }
 
+TEST_CASE(create_index)
+{
+    EXPECT(parse("CREATE INDEX").is_error());
+    EXPECT(parse("CREATE INDEX index_name").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name ();").is_error());
+    EXPECT(parse("CREATE INDEX index_name table_name ( column1 );").is_error());
+    EXPECT(parse("CREATE UNIQUE index_name ON table_name ( column1 );").is_error());
+    EXPECT(parse("CREATE INDEX IF index_name ON table_name ( column1 );").is_error());
+    EXPECT(parse("CREATE INDEX IF NOT index_name ON table_name ( column1 );").is_error());
+
+    struct Column {
+        StringView name;
+        SQL::Order order { SQL::Order::Ascending };
+    };
+
+    auto validate = [](StringView sql, StringView expected_schema, StringView expected_index, StringView expected_table, Vector<Column> expected_columns, bool expected_is_unique = false, bool expected_is_error_if_index_exists = true) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::CreateIndex>(*statement));
+
+        const auto& index = static_cast<const SQL::AST::CreateIndex&>(*statement);
+        EXPECT_EQ(index.schema_name(), expected_schema);
+        EXPECT_EQ(index.index_name(), expected_index);
+        EXPECT_EQ(index.table_name(), expected_table);
+        EXPECT_EQ(index.is_unique(), expected_is_unique);
+        EXPECT_EQ(index.is_error_if_index_exists(), expected_is_error_if_index_exists);
+
+        const auto& columns = index.indexed_columns();
+        EXPECT_EQ(columns.size(), expected_columns.size());
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            const auto& column = columns[i];
+            const auto& expected_column = expected_columns[i];
+            EXPECT(is<SQL::AST::ColumnNameExpression>(*column.expression()));
+            EXPECT_EQ(static_cast<const SQL::AST::ColumnNameExpression&>(*column.expression()).column_name(), expected_column.name);
+            EXPECT_EQ(column.order(), expected_column.order);
+        }
+    };
+
+    validate("CREATE INDEX index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } });
+    validate("CREATE INDEX schema_name.index_name ON table_name ( column1 );", "SCHEMA_NAME", "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } });
+    validate("CREATE INDEX index_name ON table_name ( column1, column2 DESC );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" }, { "COLUMN2", SQL::Order::Descending } });
+    validate("CREATE UNIQUE INDEX index_name ON table_name ( column1 ASC );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } }, true, true);
+    validate("CREATE INDEX IF NOT EXISTS index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } }, false, false);
+    validate("CREATE UNIQUE INDEX IF NOT EXISTS index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } }, true, false);
+}
+
 TEST_CASE(alter_table)
 {
     // This test case only contains common error cases of the AlterTable subclasses.
@@ -687,6 +740,62 @@ TEST_CASE(select)
     validate("SELECT * FROM table_name LIMIT 15 OFFSET 16;", all, from, false, 0, false, {}, true, true);
 }
 
+TEST_CASE(select_join)
+{
+    EXPECT(parse("SELECT * FROM table1 JOIN;").is_error());
+    EXPECT(parse("SELECT * FROM table1 JOIN table2 ON;").is_error());
+    EXPECT(parse("SELECT * FROM table1 INNER table2;").is_error());
+    EXPECT(parse("SELECT * FROM table1 LEFT OUTER table2;").is_error());
+    EXPECT(parse("SELECT * FROM table1 CROSS JOIN table2 ON").is_error());
+
+    struct Join {
+        SQL::AST::JoinOperator join_operator;
+        StringView table_name;
+        bool has_join_constraint;
+    };
+
+    auto validate = [](StringView sql, Vector<StringView> expected_tables, Vector<Vector<Join>> expected_joins) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::Select>(*statement));
+
+        const auto& select = static_cast<const SQL::AST::Select&>(*statement);
+        const auto& table_or_subquery_list = select.table_or_subquery_list();
+        EXPECT_EQ(table_or_subquery_list.size(), expected_tables.size());
+        for (size_t i = 0; i < table_or_subquery_list.size(); ++i) {
+            const auto& table = table_or_subquery_list[i];
+            EXPECT(table.is_table());
+            EXPECT_EQ(table.table_name(), expected_tables[i]);
+
+            const auto& join_clauses = table.join_clauses();
+            EXPECT_EQ(join_clauses.size(), expected_joins[i].size());
+            for (size_t j = 0; j < join_clauses.size(); ++j) {
+                const auto& join_clause = join_clauses[j];
+                const auto& expected_join = expected_joins[i][j];
+                EXPECT_EQ(join_clause.join_operator(), expected_join.join_operator);
+                EXPECT_EQ(join_clause.table_or_subquery()->table_name(), expected_join.table_name);
+                EXPECT_EQ(join_clause.table_or_subquery()->join_clauses().size(), 0u);
+                EXPECT_EQ(!join_clause.join_constraint().is_null(), expected_join.has_join_constraint);
+            }
+        }
+    };
+
+    validate("SELECT * FROM table1 JOIN table2;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::Inner, "TABLE2"sv, false } } });
+    validate("SELECT * FROM table1 AS t1 JOIN table2 AS t2 ON t1.a = t2.b;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::Inner, "TABLE2"sv, true } } });
+    validate("SELECT * FROM table1 INNER JOIN table2 ON a = b;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::Inner, "TABLE2"sv, true } } });
+    validate("SELECT * FROM table1 CROSS JOIN table2;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::Cross, "TABLE2"sv, false } } });
+    validate("SELECT * FROM table1 LEFT JOIN table2 ON a = b;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::LeftOuter, "TABLE2"sv, true } } });
+    validate("SELECT * FROM table1 LEFT OUTER JOIN table2 ON a = b;", { "TABLE1"sv }, { { { SQL::AST::JoinOperator::LeftOuter, "TABLE2"sv, true } } });
+    validate("SELECT * FROM table1 JOIN table2 ON a = b JOIN table3 ON b = c WHERE a > 1;", { "TABLE1"sv },
+        { { { SQL::AST::JoinOperator::Inner, "TABLE2"sv, true }, { SQL::AST::JoinOperator::Inner, "TABLE3"sv, true } } });
+    validate("SELECT * FROM table1 JOIN table2 ON a = b, table3;", { "TABLE1"sv, "TABLE3"sv },
+        { { { SQL::AST::JoinOperator::Inner, "TABLE2"sv, true } }, {} });
+}
+
 TEST_CASE(common_table_expression)
 {
     EXPECT(parse("WITH").is_error());
@@ -776,3 +885,27 @@ TEST_CASE(describe_table)
     validate("DESCRIBE TABLE TableName;", {}, "TABLENAME");
     validate("DESCRIBE TABLE SchemaName.TableName;", "SCHEMANAME", "TABLENAME");
 }
+
+TEST_CASE(explain)
+{
+    EXPECT(parse("EXPLAIN").is_error());
+    EXPECT(parse("EXPLAIN;").is_error());
+    EXPECT(parse("EXPLAIN QUERY SELECT * FROM table_name;").is_error());
+    EXPECT(parse("EXPLAIN PLAN SELECT * FROM table_name;").is_error());
+
+    auto validate = [](StringView sql) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::Explain>(*statement));
+
+        const auto& explain_statement = static_cast<const SQL::AST::Explain&>(*statement);
+        EXPECT(is<SQL::AST::Select>(*explain_statement.statement()));
+    };
+
+    validate("EXPLAIN SELECT * FROM table_name;");
+    validate("EXPLAIN QUERY PLAN SELECT * FROM table_name WHERE column1 = 1;");
+}
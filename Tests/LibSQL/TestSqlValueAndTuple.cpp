@@ -8,6 +8,7 @@
 
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
+#include <LibSQL/RowPage.h>
 #include <LibSQL/Tuple.h>
 #include <LibSQL/Value.h>
 #include <LibTest/TestCase.h>
@@ -566,3 +567,36 @@ TEST_CASE(compare_tuples)
     EXPECT(tuple3 >= tuple1);
     EXPECT(tuple3 > tuple1);
 }
+
+TEST_CASE(row_page)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    descriptor->append({ "schema", "table", "col1", SQL::SQLType::Text, SQL::Order::Ascending });
+    descriptor->append({ "schema", "table", "col2", SQL::SQLType::Integer, SQL::Order::Ascending });
+    descriptor->append({ "schema", "table", "col3", SQL::SQLType::Float, SQL::Order::Ascending });
+
+    SQL::RowPageWriter writer;
+    for (auto ix = 0; ix < 10; ix++) {
+        SQL::Tuple tuple(descriptor);
+        tuple["col1"] = String::formatted("Test_{}", ix);
+        tuple["col2"] = ix;
+        tuple["col3"] = ix + 0.5;
+        writer.append(tuple);
+    }
+    EXPECT_EQ(writer.row_count(), 10u);
+
+    auto rows = SQL::read_row_page(writer.finish());
+    EXPECT_EQ(writer.row_count(), 0u);
+    EXPECT_EQ(rows.size(), 10u);
+    for (auto ix = 0; ix < 10; ix++) {
+        EXPECT_EQ(rows[ix].size(), 3u);
+        EXPECT(rows[ix][0].type() == SQL::SQLType::Text);
+        EXPECT_EQ(rows[ix][0].to_string(), String::formatted("Test_{}", ix));
+        EXPECT(rows[ix][1].type() == SQL::SQLType::Integer);
+        EXPECT_EQ(rows[ix][1].to_int().value(), ix);
+        EXPECT(rows[ix][2].type() == SQL::SQLType::Float);
+        EXPECT_EQ(rows[ix][2].to_double().value(), ix + 0.5);
+    }
+
+    EXPECT(SQL::read_row_page(writer.finish()).is_empty());
+}
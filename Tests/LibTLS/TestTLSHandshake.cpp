@@ -4,13 +4,24 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/Base64.h>
+#include <AK/Endian.h>
+#include <AK/Random.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
+#include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/ASN1.h>
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/SHA2.h>
 #include <LibTLS/TLSv12.h>
 #include <LibTest/TestCase.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 static char const* ca_certs_file = "./ca_certs.ini";
 static int port = 443;
@@ -113,3 +124,545 @@ TEST_CASE(test_TLS_hello_handshake)
 
     loop.exec();
 }
+
+// The TLS 1.2 PRF with SHA-256, see RFC 5246 section 5.
+static ByteBuffer pseudorandom_function(ReadonlyBytes secret, StringView label, ReadonlyBytes seed, size_t length)
+{
+    auto label_and_seed = MUST(ByteBuffer::copy(label.bytes()));
+    label_and_seed.append(seed);
+
+    Crypto::Authentication::HMAC<Crypto::Hash::SHA256> hmac(secret);
+    ByteBuffer output;
+    auto a = hmac.process(label_and_seed.bytes());
+    while (output.size() < length) {
+        hmac.update(a.bytes());
+        hmac.update(label_and_seed.bytes());
+        auto block = hmac.digest();
+        output.append(block.bytes().trim(length - output.size()));
+        a = hmac.process(a.bytes());
+    }
+    return output;
+}
+
+static bool read_exactly(int fd, Bytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nread = ::read(fd, bytes.data(), bytes.size());
+        if (nread <= 0)
+            return false;
+        bytes = bytes.slice(nread);
+    }
+    return true;
+}
+
+static void write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = ::write(fd, bytes.data(), bytes.size());
+        if (nwritten <= 0)
+            return;
+        bytes = bytes.slice(nwritten);
+    }
+}
+
+static void write_record(int fd, u8 type, ReadonlyBytes payload)
+{
+    u8 header[5] { type, 3, 3, static_cast<u8>(payload.size() >> 8), static_cast<u8>(payload.size()) };
+    auto buffer = MUST(ByteBuffer::copy(header, sizeof(header)));
+    buffer.append(payload);
+    write_all(fd, buffer);
+}
+
+struct Record {
+    u8 type { 0 };
+    ByteBuffer payload;
+};
+
+static Optional<Record> read_record(int fd)
+{
+    u8 header[5];
+    if (!read_exactly(fd, { header, sizeof(header) }))
+        return {};
+    auto payload = MUST(ByteBuffer::create_uninitialized((header[3] << 8) | header[4]));
+    if (!read_exactly(fd, payload.bytes()))
+        return {};
+    return Record { header[0], move(payload) };
+}
+
+// The AES-128-GCM keys of both sides of a connection, see RFC 5288 section 3. Encrypted records are the explicit part
+// of the nonce (8), the ciphertext, and the tag (16). Both sides start with sequence number 0 for their Finished
+// message, and we also use the sequence number as the explicit nonce.
+class ServerConnection {
+public:
+    // The key block holds the client and server key (16 each), and the client and server implicit nonce (4 each).
+    ServerConnection(int fd, ReadonlyBytes key_block)
+        : m_fd(fd)
+        , m_client_cipher(key_block.slice(0, 16), 128, Crypto::Cipher::Intent::Decryption)
+        , m_server_cipher(key_block.slice(16, 16), 128, Crypto::Cipher::Intent::Encryption)
+    {
+        key_block.slice(32, 4).copy_to({ m_client_salt, sizeof(m_client_salt) });
+        key_block.slice(36, 4).copy_to({ m_server_salt, sizeof(m_server_salt) });
+    }
+
+    int fd() const { return m_fd; }
+
+    // Returns a whole record, header included, so that several of them can be sent at once.
+    ByteBuffer seal(u8 type, ReadonlyBytes plaintext)
+    {
+        auto sequence_number = m_server_sequence_number++;
+        auto payload_size = 8 + plaintext.size() + 16;
+        auto record = MUST(ByteBuffer::create_zeroed(5 + payload_size));
+        u8 header[5] { type, 3, 3, static_cast<u8>(payload_size >> 8), static_cast<u8>(payload_size) };
+        memcpy(record.data(), header, sizeof(header));
+        auto explicit_nonce = AK::convert_between_host_and_network_endian(sequence_number);
+        memcpy(record.offset_pointer(5), &explicit_nonce, 8);
+
+        auto aad = additional_data(sequence_number, type, plaintext.size());
+        auto iv = nonce(m_server_salt, record.bytes().slice(5, 8));
+        m_server_cipher.encrypt(plaintext, record.bytes().slice(13, plaintext.size()), { iv.data(), iv.size() }, { aad.data(), aad.size() }, record.bytes().slice(13 + plaintext.size()));
+        return record;
+    }
+
+    Optional<ByteBuffer> open(Record const& record)
+    {
+        auto& payload = record.payload;
+        if (payload.size() < 8 + 16)
+            return {};
+        auto plaintext_size = payload.size() - 8 - 16;
+        auto aad = additional_data(m_client_sequence_number++, record.type, plaintext_size);
+        auto iv = nonce(m_client_salt, payload.bytes().slice(0, 8));
+        auto plaintext = MUST(ByteBuffer::create_uninitialized(plaintext_size));
+        auto consistency = m_client_cipher.decrypt(payload.bytes().slice(8, plaintext_size), plaintext.bytes(), { iv.data(), iv.size() }, { aad.data(), aad.size() }, payload.bytes().slice(8 + plaintext_size));
+        if (consistency != Crypto::VerificationConsistency::Consistent)
+            return {};
+        return plaintext;
+    }
+
+    // Returns the contents of the next record, or nothing once the client has closed the connection.
+    Optional<ByteBuffer> read_application_data()
+    {
+        auto record = read_record(m_fd);
+        if (!record.has_value() || record->type != 23)
+            return {};
+        return open(*record);
+    }
+
+    void write_application_data(ReadonlyBytes data)
+    {
+        write_all(m_fd, seal(23, data));
+    }
+
+private:
+    static Array<u8, 13> additional_data(u64 sequence_number, u8 type, size_t length)
+    {
+        Array<u8, 13> aad {};
+        auto network_sequence_number = AK::convert_between_host_and_network_endian(sequence_number);
+        memcpy(aad.data(), &network_sequence_number, 8);
+        aad[8] = type;
+        aad[9] = 3;
+        aad[10] = 3;
+        aad[11] = length >> 8;
+        aad[12] = length;
+        return aad;
+    }
+
+    static Array<u8, 16> nonce(u8 const (&salt)[4], ReadonlyBytes explicit_nonce)
+    {
+        Array<u8, 16> iv {};
+        memcpy(iv.data(), salt, 4);
+        memcpy(iv.data() + 4, explicit_nonce.data(), 8);
+        return iv;
+    }
+
+    int m_fd { -1 };
+    Crypto::Cipher::AESCipher::GCMMode m_client_cipher;
+    Crypto::Cipher::AESCipher::GCMMode m_server_cipher;
+    u8 m_client_salt[4];
+    u8 m_server_salt[4];
+    u64 m_client_sequence_number { 0 };
+    u64 m_server_sequence_number { 0 };
+};
+
+// Just enough of a TLS server to resume a single session with the abbreviated handshake of RFC 5246 section 7.3,
+// which it turns down with an alert if the client doesn't offer the session. Once the handshake is done, the
+// connection is handed to serve_application_data, if there is one. The server runs on a thread of its own, as
+// connect() doesn't return before the handshake is done.
+class SessionResumingServer {
+public:
+    static constexpr auto cipher = TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256;
+
+    explicit SessionResumingServer(Function<void(ServerConnection&)> serve_application_data = {})
+        : m_serve_application_data(move(serve_application_data))
+    {
+        m_master_key = MUST(ByteBuffer::create_uninitialized(48));
+        fill_with_random(m_master_key.data(), m_master_key.size());
+        fill_with_random(m_session_id, sizeof(m_session_id));
+
+        m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        VERIFY(m_listen_fd >= 0);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        VERIFY(bind(m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        VERIFY(listen(m_listen_fd, 1) == 0);
+        socklen_t address_size = sizeof(address);
+        VERIFY(getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size) == 0);
+        m_port = ntohs(address.sin_port);
+
+        VERIFY(pthread_create(&m_thread, nullptr, [](void* server) -> void* {
+            static_cast<SessionResumingServer*>(server)->serve();
+            return nullptr;
+        }, this) == 0);
+    }
+
+    ~SessionResumingServer()
+    {
+        wait();
+        close(m_listen_fd);
+    }
+
+    u16 port() const { return m_port; }
+
+    TLS::Session session(TLS::CertificateTrust trust) const
+    {
+        TLS::Session session;
+        session.host = "127.0.0.1";
+        session.port = m_port;
+        session.cipher = cipher;
+        session.master_key = m_master_key;
+        memcpy(session.session_id, m_session_id, sizeof(m_session_id));
+        session.session_id_size = sizeof(m_session_id);
+        session.trust = move(trust);
+        session.expiry_timestamp = Core::DateTime::now().timestamp() + TLS::SessionCache::default_session_lifetime_in_seconds;
+        return session;
+    }
+
+    // Waits for the client to go away.
+    void wait()
+    {
+        if (exchange(m_is_joined, true))
+            return;
+        pthread_join(m_thread, nullptr);
+    }
+
+    bool client_offered_session() const { return m_client_offered_session; }
+    bool client_finished_handshake() const { return m_client_finished_handshake; }
+
+private:
+    void serve()
+    {
+        int fd = accept(m_listen_fd, nullptr, nullptr);
+        VERIFY(fd >= 0);
+        serve_client(fd);
+        // Wait for the client to close the connection.
+        while (read_record(fd).has_value())
+            ;
+        close(fd);
+    }
+
+    void serve_client(int fd)
+    {
+        // ClientHello: type (1), length (3), version (2), random (32), session ID length (1), session ID
+        auto client_hello = read_record(fd);
+        if (!client_hello.has_value() || client_hello->type != 22 || client_hello->payload.size() < 39)
+            return;
+        auto& hello = client_hello->payload;
+        auto client_random = hello.bytes().slice(6, 32);
+        auto session_id = hello.bytes().slice(39, min<size_t>(hello[38], hello.size() - 39));
+        if (session_id != ReadonlyBytes { m_session_id, sizeof(m_session_id) }) {
+            u8 handshake_failure[] { 2, 40 };
+            write_record(fd, 21, { handshake_failure, sizeof(handshake_failure) });
+            return;
+        }
+        m_client_offered_session = true;
+        auto transcript = hello;
+
+        u8 server_random[32];
+        fill_with_random(server_random, sizeof(server_random));
+        ByteBuffer server_hello;
+        u8 server_hello_header[] { 2, 0, 0, 2 + 32 + 1 + 32 + 2 + 1, 3, 3 };
+        server_hello.append(server_hello_header, sizeof(server_hello_header));
+        server_hello.append(server_random, sizeof(server_random));
+        server_hello.append(static_cast<u8>(sizeof(m_session_id)));
+        server_hello.append(m_session_id, sizeof(m_session_id));
+        server_hello.append(static_cast<u8>(to_underlying(cipher) >> 8));
+        server_hello.append(static_cast<u8>(to_underlying(cipher)));
+        server_hello.append(0);
+        write_record(fd, 22, server_hello);
+        transcript.append(server_hello);
+
+        auto seed = MUST(ByteBuffer::copy(server_random, sizeof(server_random)));
+        seed.append(client_random);
+        auto key_block = pseudorandom_function(m_master_key, "key expansion"sv, seed, 40);
+        ServerConnection connection(fd, key_block);
+
+        u8 change_cipher_spec[] { 1 };
+        write_record(fd, 20, { change_cipher_spec, sizeof(change_cipher_spec) });
+
+        auto server_finished = finished_message("server finished"sv, transcript);
+        transcript.append(server_finished);
+        write_all(fd, connection.seal(22, server_finished));
+
+        auto client_change_cipher_spec = read_record(fd);
+        if (!client_change_cipher_spec.has_value() || client_change_cipher_spec->type != 20)
+            return;
+        auto client_finished = read_record(fd);
+        if (!client_finished.has_value() || client_finished->type != 22)
+            return;
+        auto plaintext = connection.open(*client_finished);
+        auto expected = finished_message("client finished"sv, transcript);
+        m_client_finished_handshake = plaintext.has_value() && *plaintext == expected;
+
+        if (m_client_finished_handshake && m_serve_application_data)
+            m_serve_application_data(connection);
+    }
+
+    ByteBuffer finished_message(StringView label, ByteBuffer const& transcript) const
+    {
+        u8 header[] { 20, 0, 0, 12 };
+        auto message = MUST(ByteBuffer::copy(header, sizeof(header)));
+        message.append(pseudorandom_function(m_master_key, label, Crypto::Hash::SHA256::hash(transcript).bytes(), 12).bytes());
+        return message;
+    }
+
+    Function<void(ServerConnection&)> m_serve_application_data;
+    ByteBuffer m_master_key;
+    u8 m_session_id[32];
+    int m_listen_fd { -1 };
+    u16 m_port { 0 };
+    pthread_t m_thread;
+    bool m_is_joined { false };
+    bool m_client_offered_session { false };
+    bool m_client_finished_handshake { false };
+};
+
+static TLS::Options make_options(Core::EventLoop& loop)
+{
+    TLS::Options options;
+    options.set_root_certificates(s_root_ca_certificates);
+    options.set_alert_handler([&](TLS::AlertDescription) {
+        FAIL("Connection failure");
+        loop.quit(1);
+    });
+    return options;
+}
+
+static TLS::CertificateTrust make_trust()
+{
+    return {
+        .validate_certificates = true,
+        .allow_self_signed_certificates = false,
+        .root_certificates_digest = TLS::CertificateTrust::digest_root_certificates(s_root_ca_certificates),
+    };
+}
+
+TEST_CASE(test_TLS_session_resumption)
+{
+    Core::EventLoop loop;
+    SessionResumingServer server;
+    TLS::SessionCache::the().store(server.session(make_trust()));
+
+    {
+        auto tls = MUST(TLS::TLSv12::connect("127.0.0.1", server.port(), make_options(loop)));
+        // The server has no certificate to send, so only the abbreviated handshake gets us here.
+        EXPECT(tls->is_resumed_session());
+        EXPECT(tls->is_established());
+        tls->close();
+    }
+    server.wait();
+    EXPECT(server.client_offered_session());
+    EXPECT(server.client_finished_handshake());
+    EXPECT(TLS::SessionCache::the().find("127.0.0.1", server.port()).has_value());
+}
+
+TEST_CASE(test_TLS_session_resumption_needs_same_trust)
+{
+    Core::EventLoop loop;
+    SessionResumingServer server;
+
+    // The session was established by a connection that accepted self-signed certificates, so it can't be
+    // resumed by one that doesn't.
+    auto trust = make_trust();
+    trust.allow_self_signed_certificates = true;
+    TLS::SessionCache::the().store(server.session(move(trust)));
+
+    auto options = make_options(loop);
+    options.set_alert_handler([](TLS::AlertDescription) {});
+    EXPECT(TLS::TLSv12::connect("127.0.0.1", server.port(), move(options)).is_error());
+    server.wait();
+    EXPECT(!server.client_offered_session());
+
+    TLS::SessionCache::the().remove("127.0.0.1", server.port());
+}
+
+static ByteBuffer make_random_data(size_t size)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(size));
+    fill_with_random(data.data(), data.size());
+    return data;
+}
+
+// Appends all application data that is waiting to be read to the buffer.
+static void read_pending_data(TLS::TLSv12& tls, ByteBuffer& buffer)
+{
+    auto pending = MUST(tls.pending_bytes());
+    auto bytes = MUST(tls.read(buffer.must_get_bytes_for_writing(pending)));
+    EXPECT_EQ(bytes.size(), pending);
+    buffer.resize(buffer.size() + bytes.size());
+}
+
+static NonnullOwnPtr<TLS::TLSv12> connect_to(SessionResumingServer& server, Core::EventLoop& loop)
+{
+    TLS::SessionCache::the().store(server.session(make_trust()));
+    auto tls = MUST(TLS::TLSv12::connect("127.0.0.1", server.port(), make_options(loop)));
+    TLS::SessionCache::the().remove("127.0.0.1", server.port());
+    return tls;
+}
+
+TEST_CASE(test_TLS_small_writes_share_a_record)
+{
+    Core::EventLoop loop;
+    auto data = make_random_data(1000);
+    ByteBuffer received;
+    size_t record_count = 0;
+    SessionResumingServer server([&](ServerConnection& connection) {
+        while (received.size() < data.size()) {
+            auto record = connection.read_application_data();
+            if (!record.has_value())
+                return;
+            received.append(*record);
+            ++record_count;
+        }
+        connection.write_application_data("done"sv.bytes());
+    });
+
+    {
+        auto tls = connect_to(server, loop);
+        tls->on_ready_to_read = [&] { loop.quit(0); };
+        // The writes of one event loop iteration are sent together.
+        for (size_t offset = 0; offset < data.size(); offset += 10)
+            EXPECT_EQ(MUST(tls->write(data.bytes().slice(offset, 10))), 10u);
+        loop.exec();
+        tls->close();
+    }
+    server.wait();
+    EXPECT_EQ(record_count, 1u);
+    EXPECT(received == data);
+}
+
+TEST_CASE(test_TLS_records_of_all_sizes)
+{
+    Core::EventLoop loop;
+    auto data = make_random_data(40000);
+    Vector<size_t> record_sizes;
+    ByteBuffer received_by_server;
+    SessionResumingServer server([&](ServerConnection& connection) {
+        while (received_by_server.size() < data.size()) {
+            auto record = connection.read_application_data();
+            if (!record.has_value())
+                return;
+            received_by_server.append(*record);
+            record_sizes.append(record->size());
+        }
+
+        // Send the data back in records of different sizes, and cut the last one in two, so that the client has
+        // to decrypt several records from one read and keep a partial record around for the next one.
+        ByteBuffer records;
+        records.append(connection.seal(23, data.bytes().slice(0, 1)));
+        records.append(connection.seal(23, data.bytes().slice(1, 16 * KiB)));
+        records.append(connection.seal(23, data.bytes().slice(1 + 16 * KiB)));
+        auto split_offset = records.size() - 1000;
+        write_all(connection.fd(), records.bytes().trim(split_offset));
+        usleep(10000);
+        write_all(connection.fd(), records.bytes().slice(split_offset));
+    });
+
+    ByteBuffer received_by_client;
+    {
+        auto tls = connect_to(server, loop);
+        tls->on_ready_to_read = [&] {
+            read_pending_data(*tls, received_by_client);
+            if (received_by_client.size() == data.size())
+                loop.quit(0);
+        };
+        // Full records are encrypted and sent right away, the rest is sent once the event loop runs.
+        EXPECT_EQ(MUST(tls->write(data)), data.size());
+        loop.exec();
+        tls->close();
+    }
+    server.wait();
+    EXPECT(received_by_server == data);
+    EXPECT_EQ(record_sizes, (Vector<size_t> { 16 * KiB, 16 * KiB, 40000 - 32 * KiB }));
+    EXPECT(received_by_client == data);
+}
+
+TEST_CASE(test_TLS_writes_to_full_socket)
+{
+    Core::EventLoop loop;
+    // More than the socket buffers can take while the server isn't reading.
+    auto data = make_random_data(8 * MiB);
+    Atomic<bool> client_has_written { false };
+    ByteBuffer received;
+    SessionResumingServer server([&](ServerConnection& connection) {
+        while (!client_has_written)
+            usleep(1000);
+        while (received.size() < data.size()) {
+            auto record = connection.read_application_data();
+            if (!record.has_value())
+                return;
+            received.append(*record);
+        }
+        connection.write_application_data("done"sv.bytes());
+    });
+
+    {
+        auto tls = connect_to(server, loop);
+        tls->on_ready_to_read = [&] { loop.quit(0); };
+        // The socket fills up long before we're done, and what it doesn't take is sent later.
+        for (size_t offset = 0; offset < data.size(); offset += 64 * KiB)
+            EXPECT_EQ(MUST(tls->write(data.bytes().slice(offset, 64 * KiB))), 64 * KiB);
+        client_has_written = true;
+        loop.exec();
+        tls->close();
+    }
+    server.wait();
+    EXPECT_EQ(received.size(), data.size());
+    EXPECT(received == data);
+}
+
+TEST_CASE(test_TLS_reads_wait_for_the_client)
+{
+    Core::EventLoop loop;
+    auto data = make_random_data(2 * MiB);
+    SessionResumingServer server([&](ServerConnection& connection) {
+        for (size_t offset = 0; offset < data.size(); offset += 16 * KiB)
+            connection.write_application_data(data.bytes().slice(offset, 16 * KiB));
+    });
+
+    ByteBuffer received;
+    {
+        auto tls = connect_to(server, loop);
+        auto read_and_check_if_done = [&] {
+            read_pending_data(*tls, received);
+            if (received.size() == data.size())
+                loop.quit(0);
+        };
+
+        // Don't read anything for a while. Only about 256 KiB should be read from the socket meanwhile, the rest
+        // has to wait there.
+        tls->on_ready_to_read = [] {};
+        auto timer = Core::Timer::create_single_shot(200, [&] { loop.quit(0); });
+        timer->start();
+        loop.exec();
+        EXPECT(MUST(tls->pending_bytes()) < 320 * KiB);
+
+        tls->on_ready_to_read = [&] { read_and_check_if_done(); };
+        read_and_check_if_done();
+        loop.unquit();
+        if (received.size() < data.size())
+            loop.exec();
+        tls->close();
+    }
+    server.wait();
+    EXPECT(received == data);
+}
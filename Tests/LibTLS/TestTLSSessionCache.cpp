@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/DateTime.h>
+#include <LibTLS/SessionCache.h>
+#include <LibTest/TestCase.h>
+
+static TLS::Session make_session(String host, u8 id, time_t lifetime = TLS::SessionCache::default_session_lifetime_in_seconds)
+{
+    TLS::Session session;
+    session.host = move(host);
+    session.port = 443;
+    session.cipher = TLS::CipherSuite::ECDHE_RSA_WITH_AES_128_GCM_SHA256;
+    session.master_key = MUST(ByteBuffer::create_zeroed(48));
+    session.master_key[0] = id;
+    session.session_id[0] = id;
+    session.session_id_size = sizeof(session.session_id);
+    session.expiry_timestamp = Core::DateTime::now().timestamp() + lifetime;
+    return session;
+}
+
+TEST_CASE(test_session_cache_find)
+{
+    TLS::SessionCache cache;
+    EXPECT(!cache.find("example.com", 443).has_value());
+
+    cache.store(make_session("example.com", 1));
+    cache.store(make_session("example.org", 2));
+
+    auto session = cache.find("example.com", 443);
+    EXPECT(session.has_value());
+    EXPECT_EQ(session->session_id[0], 1);
+    EXPECT_EQ(session->master_key[0], 1);
+    EXPECT_EQ(cache.find("example.org", 443)->session_id[0], 2);
+    EXPECT(!cache.find("example.net", 443).has_value());
+
+    // A new session replaces the old one.
+    cache.store(make_session("example.com", 3));
+    EXPECT_EQ(cache.find("example.com", 443)->session_id[0], 3);
+    EXPECT_EQ(cache.size(), 2u);
+
+    // Sessions are per port.
+    EXPECT(!cache.find("example.com", 8443).has_value());
+    cache.remove("example.com", 8443);
+    EXPECT(cache.find("example.com", 443).has_value());
+
+    cache.remove("example.com", 443);
+    EXPECT(!cache.find("example.com", 443).has_value());
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST_CASE(test_session_cache_ticket_only)
+{
+    TLS::SessionCache cache;
+
+    auto session = make_session("example.com", 1);
+    session.session_id_size = 0;
+    cache.store(session);
+    EXPECT(!cache.find("example.com", 443).has_value());
+
+    session.ticket = MUST(ByteBuffer::copy("ticket"sv.bytes()));
+    cache.store(session);
+    EXPECT(cache.find("example.com", 443).has_value());
+    EXPECT_EQ(cache.find("example.com", 443)->ticket.bytes(), "ticket"sv.bytes());
+}
+
+TEST_CASE(test_session_cache_expiry)
+{
+    TLS::SessionCache cache;
+    cache.store(make_session("example.com", 1, -1));
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT(!cache.find("example.com", 443).has_value());
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_CASE(test_session_cache_eviction)
+{
+    TLS::SessionCache cache;
+    for (size_t i = 0; i < TLS::SessionCache::max_session_count - 1; ++i)
+        cache.store(make_session(String::formatted("host{}.example.com", i), i, 1000 + i));
+    cache.store(make_session("short-lived.example.com", 1, 10));
+    EXPECT_EQ(cache.size(), TLS::SessionCache::max_session_count);
+
+    // The session that expires first makes room for the newcomer.
+    cache.store(make_session("example.com", 2));
+    EXPECT_EQ(cache.size(), TLS::SessionCache::max_session_count);
+    EXPECT(cache.find("example.com", 443).has_value());
+    EXPECT(!cache.find("short-lived.example.com", 443).has_value());
+    EXPECT(cache.find("host0.example.com", 443).has_value());
+}
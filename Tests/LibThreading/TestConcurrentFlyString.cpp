@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/FlyString.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/String.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Thread.h>
+
+static constexpr size_t thread_count = 8;
+
+template<typename Callback>
+static void run_on_threads(size_t count, Callback callback)
+{
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (size_t i = 0; i < count; ++i) {
+        threads.append(Threading::Thread::construct([i, &callback] {
+            callback(i);
+            return 0;
+        }));
+    }
+    for (auto& thread : threads)
+        thread.start();
+    for (auto& thread : threads)
+        EXPECT(!thread.join().is_error());
+}
+
+static Vector<String> make_strings(StringView prefix, size_t count)
+{
+    Vector<String> strings;
+    strings.ensure_capacity(count);
+    for (size_t i = 0; i < count; ++i)
+        strings.unchecked_append(String::formatted("{}-{}", prefix, i));
+    return strings;
+}
+
+TEST_CASE(concurrent_interning_agrees_on_one_impl)
+{
+    auto strings = make_strings("shared"sv, 1000);
+    Vector<Vector<FlyString>> results;
+    results.resize(thread_count);
+
+    run_on_threads(thread_count, [&](size_t thread_index) {
+        auto& interned = results[thread_index];
+        interned.ensure_capacity(strings.size());
+        // Alternate between the StringView and String paths, and walk the strings in different orders.
+        for (size_t i = 0; i < strings.size(); ++i) {
+            auto index = (i * (thread_index * 2 + 1)) % strings.size();
+            if (i % 2)
+                interned.unchecked_append(FlyString { strings[index].view() });
+            else
+                interned.unchecked_append(FlyString { strings[index] });
+        }
+    });
+
+    for (size_t thread_index = 0; thread_index < thread_count; ++thread_index) {
+        for (size_t i = 0; i < strings.size(); ++i) {
+            auto index = (i * (thread_index * 2 + 1)) % strings.size();
+            EXPECT_EQ(results[thread_index][i], strings[index]);
+            EXPECT_EQ(results[thread_index][i].impl(), FlyString { strings[index] }.impl());
+        }
+    }
+}
+
+TEST_CASE(interning_races_with_destruction)
+{
+    // Every thread keeps interning and dropping the same few strings, so the last reference to an interned
+    // string is regularly released on one thread while another thread is looking it up.
+    auto strings = make_strings("churn"sv, 16);
+    run_on_threads(thread_count, [&](size_t thread_index) {
+        for (size_t i = 0; i < 20'000; ++i) {
+            auto& string = strings[(i + thread_index) % strings.size()];
+            FlyString first { string.view() };
+            FlyString second { string.view() };
+            EXPECT_EQ(first.impl(), second.impl());
+            EXPECT_EQ(first, string);
+        }
+    });
+
+    // None of the strings are alive anymore, so interning them again has to create fresh ones.
+    for (auto& string : strings) {
+        FlyString fly { string };
+        EXPECT_EQ(fly.impl(), string.impl());
+    }
+}
+
+// Every benchmark interns 1M strings in total, spread evenly over its threads.
+static constexpr size_t interned_per_benchmark = 1'000'000;
+
+static void intern_existing_strings(size_t threads)
+{
+    auto strings = make_strings("existing"sv, 10'000);
+    Vector<FlyString> keep_alive;
+    for (auto& string : strings)
+        keep_alive.append(string);
+
+    run_on_threads(threads, [&](size_t thread_index) {
+        for (size_t i = 0; i < interned_per_benchmark / threads; ++i) {
+            FlyString fly { strings[(i * 7 + thread_index) % strings.size()].view() };
+            EXPECT(!fly.is_null());
+        }
+    });
+}
+
+static void intern_new_strings(size_t threads)
+{
+    Vector<Vector<String>> strings;
+    for (size_t i = 0; i < threads; ++i)
+        strings.append(make_strings(String::formatted("new-{}", i), interned_per_benchmark / threads));
+
+    run_on_threads(threads, [&](size_t thread_index) {
+        Vector<FlyString> interned;
+        interned.ensure_capacity(strings[thread_index].size());
+        for (auto& string : strings[thread_index])
+            interned.unchecked_append(string.view());
+    });
+}
+
+BENCHMARK_CASE(intern_existing_1_thread) { intern_existing_strings(1); }
+BENCHMARK_CASE(intern_existing_2_threads) { intern_existing_strings(2); }
+BENCHMARK_CASE(intern_existing_4_threads) { intern_existing_strings(4); }
+BENCHMARK_CASE(intern_existing_8_threads) { intern_existing_strings(8); }
+
+BENCHMARK_CASE(intern_new_1_thread) { intern_new_strings(1); }
+BENCHMARK_CASE(intern_new_2_threads) { intern_new_strings(2); }
+BENCHMARK_CASE(intern_new_4_threads) { intern_new_strings(4); }
+BENCHMARK_CASE(intern_new_8_threads) { intern_new_strings(8); }
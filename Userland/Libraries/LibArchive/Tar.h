@@ -25,6 +25,7 @@ enum class TarFileType : char {
     Directory = '5',
     FIFO = '6',
     ContiguousFile = '7',
+    GNUSparseFile = 'S',
     GlobalExtendedHeader = 'g',
     ExtendedHeader = 'x'
 };
@@ -75,6 +76,32 @@ static void set_octal_field(char (&field)[N], TSource&& source)
     set_field(field, String::formatted("{:o}", forward<TSource>(source)));
 }
 
+// Old GNU sparse files describe their first data regions where the header otherwise keeps its prefix, and the
+// rest in extension blocks that follow the header. An entry with an empty offset ends the list.
+struct [[gnu::packed]] TarGNUSparseEntry {
+    char offset[12];
+    char size[12];
+};
+
+struct [[gnu::packed]] TarGNUSparseHeader {
+    char access_time[12];
+    char change_time[12];
+    char offset[12];
+    char long_names[4];
+    char unused;
+    TarGNUSparseEntry entries[4];
+    char is_extended;
+    char real_size[12];
+    char padding[5];
+};
+
+struct [[gnu::packed]] TarGNUSparseExtension {
+    TarGNUSparseEntry entries[21];
+    char is_extended;
+    char padding[7];
+};
+static_assert(sizeof(TarGNUSparseExtension) == block_size);
+
 class [[gnu::packed]] TarFileHeader {
 public:
     StringView filename() const { return get_field_as_string_view(m_filename); }
@@ -95,6 +122,8 @@ public:
     int minor() const { return get_field_as_integral(m_minor); }
     // FIXME: support ustar filename prefix
     StringView prefix() const { return get_field_as_string_view(m_prefix); }
+    // Only meaningful for GNUSparseFile, which doesn't have a prefix.
+    TarGNUSparseHeader const& gnu_sparse_header() const { return *reinterpret_cast<TarGNUSparseHeader const*>(m_prefix); }
 
     void set_filename(String const& filename) { set_field(m_filename, filename); }
     void set_mode(mode_t mode) { set_octal_field(m_mode, mode); }
@@ -137,5 +166,6 @@ private:
     char m_minor[8] { 0 };
     char m_prefix[155] { 0 }; // zero out the prefix for archiving
 };
+static_assert(sizeof(TarGNUSparseHeader) == 155);
 
 }
@@ -7,6 +7,7 @@
  */
 
 #include <AK/Array.h>
+#include <AK/StringBuilder.h>
 #include <LibArchive/TarStream.h>
 #include <string.h>
 
@@ -69,12 +70,55 @@ bool TarFileStream::discard_or_error(size_t count)
 TarInputStream::TarInputStream(InputStream& stream)
     : m_stream(stream)
 {
-    if (!m_stream.read_or_error(Bytes(&m_header, sizeof(m_header)))) {
+    if (!read_header()) {
         m_finished = true;
         m_stream.handle_any_error(); // clear out errors so we dont assert
         return;
     }
-    VERIFY(m_stream.discard_or_error(block_size - sizeof(TarFileHeader)));
+}
+
+bool TarInputStream::read_header()
+{
+    m_gnu_sparse_map.clear();
+    m_extension_block_count = 0;
+
+    // Read the whole header block at once, rather than the header and then its padding.
+    Array<u8, block_size> block;
+    if (!m_stream.read_or_error(block))
+        return false;
+    memcpy(&m_header, block.data(), sizeof(m_header));
+
+    if (valid() && m_header.type_flag() == TarFileType::GNUSparseFile)
+        return read_gnu_sparse_map();
+    return true;
+}
+
+bool TarInputStream::read_gnu_sparse_map()
+{
+    auto const& sparse_header = m_header.gnu_sparse_header();
+    TarSparseMap map;
+    map.real_size = get_field_as_integral(sparse_header.real_size);
+
+    auto append_regions = [&](auto const& entries) {
+        for (auto const& entry : entries) {
+            if (entry.offset[0] == 0)
+                break;
+            map.regions.append({ get_field_as_integral(entry.offset), get_field_as_integral(entry.size) });
+        }
+    };
+
+    append_regions(sparse_header.entries);
+    for (bool is_extended = sparse_header.is_extended != 0; is_extended;) {
+        TarGNUSparseExtension extension;
+        if (!m_stream.read_or_error(Bytes { &extension, sizeof(extension) }))
+            return false;
+        ++m_extension_block_count;
+        append_regions(extension.entries);
+        is_extended = extension.is_extended != 0;
+    }
+
+    m_gnu_sparse_map = move(map);
+    return true;
 }
 
 static constexpr unsigned long block_ceiling(unsigned long offset)
@@ -88,10 +132,12 @@ void TarInputStream::advance()
         return;
 
     m_generation++;
+    // Skipping over the contents seeks past them if the underlying stream can, so listing an archive only reads its headers.
     VERIFY(m_stream.discard_or_error(block_ceiling(m_header.size()) - m_file_offset));
+    m_header_offset += block_size * (1 + m_extension_block_count) + block_ceiling(m_header.size());
     m_file_offset = 0;
 
-    if (!m_stream.read_or_error(Bytes(&m_header, sizeof(m_header)))) {
+    if (!read_header()) {
         m_finished = true;
         return;
     }
@@ -99,8 +145,6 @@ void TarInputStream::advance()
         m_finished = true;
         return;
     }
-
-    VERIFY(m_stream.discard_or_error(block_size - sizeof(TarFileHeader)));
 }
 
 bool TarInputStream::valid() const
@@ -123,6 +167,85 @@ TarFileStream TarInputStream::file_contents()
     return TarFileStream(*this);
 }
 
+void TarPaxSparseHeader::add(StringView key, StringView value)
+{
+    if (!key.starts_with("GNU.sparse."sv))
+        return;
+    m_is_sparse = true;
+
+    auto number = value.to_uint<u64>();
+    if (key == "GNU.sparse.name"sv) {
+        m_name = value;
+    } else if (key == "GNU.sparse.size"sv || key == "GNU.sparse.realsize"sv) {
+        m_is_malformed |= !number.has_value();
+        m_map.real_size = number.value_or(0);
+    } else if (key == "GNU.sparse.major"sv) {
+        m_map_is_in_contents = value == "1"sv;
+    } else if (key == "GNU.sparse.offset"sv) {
+        // Format 0.0 repeats the offset and size keys for every region.
+        m_is_malformed |= !number.has_value() || m_pending_offset.has_value();
+        m_pending_offset = number;
+    } else if (key == "GNU.sparse.numbytes"sv) {
+        m_is_malformed |= !number.has_value() || !m_pending_offset.has_value();
+        if (number.has_value() && m_pending_offset.has_value())
+            m_map.regions.append({ *m_pending_offset, *number });
+        m_pending_offset.clear();
+    } else if (key == "GNU.sparse.map"sv) {
+        // Format 0.1 lists the offsets and sizes of all regions, separated by commas.
+        auto numbers = value.split_view(',');
+        m_is_malformed |= numbers.size() % 2 != 0;
+        for (size_t i = 0; i + 1 < numbers.size(); i += 2) {
+            auto offset = numbers[i].to_uint<u64>();
+            auto size = numbers[i + 1].to_uint<u64>();
+            m_is_malformed |= !offset.has_value() || !size.has_value();
+            m_map.regions.append({ offset.value_or(0), size.value_or(0) });
+        }
+    }
+}
+
+ErrorOr<TarSparseMap> TarPaxSparseHeader::read_map(TarFileStream& stream) const
+{
+    if (m_is_malformed || m_pending_offset.has_value())
+        return Error::from_string_literal("Malformed sparse file map");
+    if (!m_map_is_in_contents)
+        return m_map;
+
+    // The map is a line with the number of regions, then a line with each offset and size. It is padded to whole
+    // blocks, so a number may continue in the next block.
+    TarSparseMap map;
+    map.real_size = m_map.real_size;
+    Optional<u64> region_count;
+    Optional<u64> offset;
+    StringBuilder line;
+    Array<u8, block_size> block;
+    while (!region_count.has_value() || map.regions.size() < *region_count) {
+        if (!stream.read_or_error(block))
+            return Error::from_string_literal("Sparse file map ends early");
+        for (size_t i = 0; i < block.size() && (!region_count.has_value() || map.regions.size() < *region_count); ++i) {
+            if (block[i] != '\n') {
+                // No 64-bit number has more digits than this.
+                if (line.length() == 20)
+                    return Error::from_string_literal("Malformed sparse file map");
+                line.append(block[i]);
+                continue;
+            }
+            auto number = line.string_view().to_uint<u64>();
+            if (!number.has_value())
+                return Error::from_string_literal("Malformed sparse file map");
+            line.clear();
+            if (!region_count.has_value()) {
+                region_count = number;
+            } else if (!offset.has_value()) {
+                offset = number;
+            } else {
+                map.regions.append({ *offset, *number });
+                offset.clear();
+            }
+        }
+    }
+    return map;
+}
+
 TarOutputStream::TarOutputStream(OutputStream& stream)
     : m_stream(stream)
 {
@@ -158,11 +281,11 @@ void TarOutputStream::add_file(String const& path, mode_t mode, ReadonlyBytes by
     VERIFY(m_stream.write_or_error(ReadonlyBytes { &header, sizeof(header) }));
     constexpr Array<u8, block_size> padding { 0 };
     VERIFY(m_stream.write_or_error(ReadonlyBytes { &padding, block_size - sizeof(header) }));
-    size_t n_written = 0;
-    while (n_written < bytes.size()) {
-        n_written += m_stream.write(bytes.slice(n_written, min(bytes.size() - n_written, block_size)));
-    }
-    VERIFY(m_stream.write_or_error(ReadonlyBytes { &padding, block_size - (n_written % block_size) }));
+    // Write the contents in large chunks instead of one block at a time, as every write may end up as a syscall.
+    constexpr size_t max_chunk_size = 1 * MiB;
+    for (size_t offset = 0; offset < bytes.size(); offset += max_chunk_size)
+        VERIFY(m_stream.write_or_error(bytes.slice(offset, min(bytes.size() - offset, max_chunk_size))));
+    VERIFY(m_stream.write_or_error(ReadonlyBytes { &padding, block_ceiling(bytes.size()) - bytes.size() }));
 }
 
 void TarOutputStream::finish()
@@ -7,14 +7,27 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/Span.h>
 #include <AK/Stream.h>
+#include <AK/Vector.h>
 #include <LibArchive/Tar.h>
 
 namespace Archive {
 
 class TarInputStream;
 
+// A sparse file only stores its data regions, one after the other. Everything between them reads as zeroes.
+struct TarSparseMap {
+    struct Region {
+        u64 offset { 0 };
+        u64 size { 0 };
+    };
+
+    u64 real_size { 0 };
+    Vector<Region> regions;
+};
+
 class TarFileStream : public InputStream {
 public:
     size_t read(Bytes) override;
@@ -38,14 +51,24 @@ public:
     bool finished() const { return m_finished; }
     bool valid() const;
     TarFileHeader const& header() const { return m_header; }
+    // The offset of the current header from the start of the archive.
+    u64 header_offset() const { return m_header_offset; }
     TarFileStream file_contents();
+    // The data regions of an old GNU sparse file, read from its header and the extension blocks after it.
+    Optional<TarSparseMap> const& gnu_sparse_map() const { return m_gnu_sparse_map; }
 
     template<VoidFunction<StringView, StringView> F>
     ErrorOr<void> for_each_extended_header(F func);
 
 private:
+    bool read_header();
+    bool read_gnu_sparse_map();
+
     TarFileHeader m_header;
     InputStream& m_stream;
+    Optional<TarSparseMap> m_gnu_sparse_map;
+    u64 m_extension_block_count { 0 };
+    u64 m_header_offset { 0 };
     unsigned long m_file_offset { 0 };
     int m_generation { 0 };
     bool m_finished { false };
@@ -53,6 +76,26 @@ private:
     friend class TarFileStream;
 };
 
+// Collects the GNU.sparse.* keys from the extended header of a PAX sparse file. Formats 0.0 and 0.1 keep the map
+// there, format 1.0 keeps it in decimal at the start of the member's contents.
+class TarPaxSparseHeader {
+public:
+    void add(StringView key, StringView value);
+    bool is_sparse() const { return m_is_sparse; }
+    // The member itself is stored under a made up name.
+    Optional<String> const& name() const { return m_name; }
+    // Reads past the map in the contents when there is one, leaving the stream at the data regions.
+    ErrorOr<TarSparseMap> read_map(TarFileStream&) const;
+
+private:
+    bool m_is_sparse { false };
+    bool m_is_malformed { false };
+    bool m_map_is_in_contents { false };
+    Optional<String> m_name;
+    Optional<u64> m_pending_offset;
+    TarSparseMap m_map;
+};
+
 class TarOutputStream {
 public:
     TarOutputStream(OutputStream&);
@@ -44,6 +44,11 @@ Optional<Zip> Zip::try_create(ReadonlyBytes buffer)
     if (end_of_central_directory.disk_number != 0 || end_of_central_directory.central_directory_start_disk != 0 || end_of_central_directory.disk_records_count != end_of_central_directory.total_records_count)
         return {}; // TODO: support multi-volume zip archives
 
+    Vector<MemberLocation> members;
+    members.ensure_capacity(end_of_central_directory.total_records_count);
+    HashMap<StringView, size_t> member_indices;
+    member_indices.ensure_capacity(end_of_central_directory.total_records_count);
+
     size_t member_offset = end_of_central_directory.central_directory_offset;
     for (size_t i = 0; i < end_of_central_directory.total_records_count; i++) {
         CentralDirectoryRecord central_directory_record {};
@@ -70,40 +75,48 @@ Optional<Zip> Zip::try_create(ReadonlyBytes buffer)
             return {};
         if (buffer.size() - (local_file_header.compressed_data - buffer.data()) < central_directory_record.compressed_size)
             return {};
+
+        members.unchecked_append({ member_offset, static_cast<size_t>(local_file_header.compressed_data - buffer.data()) });
+        member_indices.set({ central_directory_record.name, central_directory_record.name_length }, i);
         member_offset += central_directory_record.size();
     }
 
     return Zip {
-        end_of_central_directory.total_records_count,
-        end_of_central_directory.central_directory_offset,
+        move(members),
+        move(member_indices),
         buffer,
     };
 }
 
+ZipMember Zip::member_at(size_t index) const
+{
+    auto const& location = m_members[index];
+    CentralDirectoryRecord central_directory_record {};
+    VERIFY(central_directory_record.read(m_input_data.slice(location.central_directory_record_offset)));
+
+    ZipMember member;
+    member.name = String { reinterpret_cast<char const*>(central_directory_record.name), central_directory_record.name_length };
+    member.compressed_data = m_input_data.slice(location.compressed_data_offset, central_directory_record.compressed_size);
+    member.compression_method = central_directory_record.compression_method;
+    member.uncompressed_size = central_directory_record.uncompressed_size;
+    member.crc32 = central_directory_record.crc32;
+    member.is_directory = central_directory_record.external_attributes & zip_directory_external_attribute || member.name.ends_with('/'); // FIXME: better directory detection
+    return member;
+}
+
+Optional<ZipMember> Zip::find_member(StringView name) const
+{
+    auto index = m_member_indices.get(name);
+    if (!index.has_value())
+        return {};
+    return member_at(*index);
+}
+
 bool Zip::for_each_member(Function<IterationDecision(ZipMember const&)> callback)
 {
-    size_t member_offset = m_members_start_offset;
-    for (size_t i = 0; i < m_member_count; i++) {
-        CentralDirectoryRecord central_directory_record {};
-        VERIFY(central_directory_record.read(m_input_data.slice(member_offset)));
-        LocalFileHeader local_file_header {};
-        VERIFY(local_file_header.read(m_input_data.slice(central_directory_record.local_file_header_offset)));
-
-        ZipMember member;
-        char null_terminated_name[central_directory_record.name_length + 1];
-        memcpy(null_terminated_name, central_directory_record.name, central_directory_record.name_length);
-        null_terminated_name[central_directory_record.name_length] = 0;
-        member.name = String { null_terminated_name };
-        member.compressed_data = { local_file_header.compressed_data, central_directory_record.compressed_size };
-        member.compression_method = central_directory_record.compression_method;
-        member.uncompressed_size = central_directory_record.uncompressed_size;
-        member.crc32 = central_directory_record.crc32;
-        member.is_directory = central_directory_record.external_attributes & zip_directory_external_attribute || member.name.ends_with('/'); // FIXME: better directory detection
-
-        if (callback(member) == IterationDecision::Break)
+    for (size_t i = 0; i < m_members.size(); i++) {
+        if (callback(member_at(i)) == IterationDecision::Break)
             return false;
-
-        member_offset += central_directory_record.size();
     }
     return true;
 }
@@ -9,6 +9,7 @@
 
 #include <AK/Array.h>
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/IterationDecision.h>
 #include <AK/Stream.h>
 #include <AK/String.h>
@@ -238,17 +239,30 @@ public:
     static Optional<Zip> try_create(ReadonlyBytes buffer);
     bool for_each_member(Function<IterationDecision(ZipMember const&)>);
 
+    size_t member_count() const { return m_members.size(); }
+    ZipMember member_at(size_t index) const;
+    // Looks a member up by its full name in the archive. If several members share a name, the last one wins.
+    Optional<ZipMember> find_member(StringView name) const;
+
 private:
     static bool find_end_of_central_directory_offset(ReadonlyBytes, size_t& offset);
 
-    Zip(u16 member_count, size_t members_start_offset, ReadonlyBytes input_data)
-        : m_member_count { member_count }
-        , m_members_start_offset { members_start_offset }
+    // Where a member's central directory record and compressed data live in the input, found while validating the
+    // archive, so that members can be accessed in any order without walking the central directory again.
+    struct MemberLocation {
+        size_t central_directory_record_offset { 0 };
+        size_t compressed_data_offset { 0 };
+    };
+
+    Zip(Vector<MemberLocation> members, HashMap<StringView, size_t> member_indices, ReadonlyBytes input_data)
+        : m_members { move(members) }
+        , m_member_indices { move(member_indices) }
         , m_input_data { input_data }
     {
     }
-    u16 m_member_count { 0 };
-    size_t m_members_start_offset { 0 };
+    Vector<MemberLocation> m_members;
+    // The names point into the input data.
+    HashMap<StringView, size_t> m_member_indices;
     ReadonlyBytes m_input_data;
 };
 
@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/BinarySearch.h>
 #include <AK/QuickSort.h>
 #include <LibCompress/Brotli.h>
 #include <LibCompress/BrotliDictionary.h>
@@ -13,19 +12,24 @@ namespace Compress {
 
 ErrorOr<size_t> BrotliDecompressionStream::CanonicalCode::read_symbol(LittleEndianInputBitStream& input_stream)
 {
-    size_t code_bits = 1;
+    if (m_lookup_table.is_empty())
+        return Error::from_string_literal("no matching code found");
 
-    while (code_bits < (1 << 16)) {
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+    // Only ask for as many bits as the code we are reading is known to have, as the end of the stream may be near.
+    auto bits_needed = m_lookup_table.min_code_length();
 
-        code_bits = (code_bits << 1) | TRY(input_stream.read_bit());
-    }
+    for (;;) {
+        TRY(input_stream.ensure_buffered_bits(bits_needed));
 
-    return Error::from_string_literal("no matching code found");
+        auto const entry = m_lookup_table.lookup(input_stream.peek_buffered_bits());
+        if (entry.code_length <= input_stream.buffered_bit_count()) {
+            if (entry.value == PrefixCodeLookupTable::invalid_symbol)
+                return Error::from_string_literal("no matching code found");
+            input_stream.discard_buffered_bits(entry.code_length);
+            return entry.value;
+        }
+        bits_needed = entry.code_length;
+    }
 }
 
 BrotliDecompressionStream::BrotliDecompressionStream(Stream& stream)
@@ -181,6 +185,7 @@ ErrorOr<void> BrotliDecompressionStream::read_prefix_code(CanonicalCode& code, s
         TRY(read_complex_prefix_code(code, alphabet_size, hskip));
     }
 
+    code.build_lookup_table();
     return {};
 }
 
@@ -290,6 +295,8 @@ ErrorOr<void> BrotliDecompressionStream::read_complex_prefix_code(CanonicalCode&
         }
     }
 
+    temp_code.build_lookup_table();
+
     // Read the actual prefix code_value
     sum = 0;
     size_t i = 0;
@@ -8,6 +8,7 @@
 
 #include <AK/CircularQueue.h>
 #include <AK/FixedArray.h>
+#include <LibCompress/PrefixCodeLookupTable.h>
 #include <LibCore/InputBitStream.h>
 #include <LibCore/Stream.h>
 
@@ -39,11 +40,15 @@ public:
         {
             m_symbol_codes.clear();
             m_symbol_values.clear();
+            m_lookup_table.clear();
         }
 
     private:
+        void build_lookup_table() { m_lookup_table.build(m_symbol_codes.span(), m_symbol_values.span()); }
+
         Vector<size_t> m_symbol_codes;
         Vector<size_t> m_symbol_values;
+        PrefixCodeLookupTable m_lookup_table;
     };
 
     struct Block {
@@ -8,7 +8,7 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/MemoryStream.h>
 #include <string.h>
 
@@ -63,13 +63,16 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
-        code.m_symbol_values.append(last_non_zero);
+        Array<u16, 1> symbol_codes { 0b10 };
+        Array<u16, 1> symbol_values { static_cast<u16>(last_non_zero) };
+        code.m_lookup_table.build(symbol_codes.span(), symbol_values.span());
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
         return code;
     }
 
+    Vector<u16, 288> symbol_codes;
+    Vector<u16, 288> symbol_values;
     auto next_code = 0;
     for (size_t code_length = 1; code_length <= 15; ++code_length) {
         next_code <<= 1;
@@ -82,8 +85,8 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
-            code.m_symbol_values.append(symbol);
+            symbol_codes.append(start_bit | next_code);
+            symbol_values.append(symbol);
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
@@ -95,23 +98,27 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return {};
     }
 
+    code.m_lookup_table.build(symbol_codes.span(), symbol_values.span());
     return code;
 }
 
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
-    u32 code_bits = 1;
+    // Only ask for as many bits as the code we are reading is known to have, as the end of the stream may be near.
+    auto bits_needed = m_lookup_table.min_code_length();
 
     for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
+        if (!stream.ensure_buffered_bits(bits_needed))
             return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
 
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+        auto const entry = m_lookup_table.lookup(stream.peek_buffered_bits());
+        if (entry.code_length <= stream.buffered_bit_count()) {
+            if (entry.value == PrefixCodeLookupTable::invalid_symbol)
+                return UINT32_MAX;
+            stream.discard_buffered_bits(entry.code_length);
+            return entry.value;
+        }
+        bits_needed = entry.code_length;
     }
 }
 
@@ -514,6 +521,8 @@ DeflateCompressor::DeflateCompressor(OutputStream& stream, CompressionLevel comp
 {
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
+    for (auto& slot : m_hash_head)
+        slot = empty_slot;
 }
 
 DeflateCompressor::~DeflateCompressor()
@@ -554,6 +563,48 @@ u16 DeflateCompressor::hash_sequence(u8 const* bytes)
     return ((bytes[0] | bytes[1] << 8 | bytes[2] << 16 | bytes[3] << 24) * knuth_constant) >> (32 - hash_bits);
 }
 
+ALWAYS_INLINE void DeflateCompressor::insert_hash(size_t position, u16 hash)
+{
+    auto window_position = position % window_size;
+    m_hash_prev[window_position] = m_hash_head[hash];
+    m_hash_head[hash] = window_position;
+}
+
+// Moves the chains along with the window when the current block becomes the previous one, and forgets the block
+// that falls out of the window.
+void DeflateCompressor::slide_hash_chains()
+{
+    auto slide = [](u16 position) -> u16 {
+        return position != empty_slot && position >= block_size ? position - block_size : empty_slot;
+    };
+    for (auto& slot : m_hash_head)
+        slot = slide(slot);
+    for (size_t position = 0; position < block_size; position++)
+        m_hash_prev[position] = slide(m_hash_prev[position + block_size]);
+}
+
+// Returns how long the match at candidate is, given that its first known_length bytes are already known to match
+ALWAYS_INLINE size_t DeflateCompressor::common_length(size_t start, size_t candidate, size_t known_length, size_t maximum_match_length) const
+{
+    auto length = known_length;
+
+    // compare a word at a time, the first mismatching byte is the lowest set byte of the difference
+    while (length + sizeof(u64) <= maximum_match_length) {
+        u64 start_word;
+        u64 candidate_word;
+        __builtin_memcpy(&start_word, &m_rolling_window[start + length], sizeof(u64));
+        __builtin_memcpy(&candidate_word, &m_rolling_window[candidate + length], sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(start_word ^ candidate_word);
+        if (difference != 0)
+            return length + count_trailing_zeroes(difference) / 8;
+        length += sizeof(u64);
+    }
+
+    while (length < maximum_match_length && m_rolling_window[start + length] == m_rolling_window[candidate + length])
+        length++;
+    return length;
+}
+
 size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate, size_t previous_match_length, size_t maximum_match_length)
 {
     VERIFY(previous_match_length < maximum_match_length);
@@ -565,10 +616,7 @@ size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate
     }
 
     // Find the actual length
-    auto match_length = previous_match_length + 1;
-    while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length]) {
-        match_length++;
-    }
+    auto match_length = common_length(start, candidate, previous_match_length + 1, maximum_match_length);
 
     VERIFY(match_length > previous_match_length);
     VERIFY(match_length <= maximum_match_length);
@@ -594,7 +642,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -604,8 +652,8 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             match_position = candidate;
             previous_match_length = match_length;
 
-            if (match_length == maximum_match_length)
-                return match_length; // bail if we got the maximum possible length
+            if (match_length >= min(m_compression_constants.great_match_length, maximum_match_length))
+                return match_length; // bail if we got a great match, or the maximum possible length
         }
 
         candidate = m_hash_prev[candidate % window_size];
@@ -692,34 +740,36 @@ void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, Array
     }
 }
 
-void DeflateCompressor::lz77_compress_block()
+ALWAYS_INLINE void DeflateCompressor::emit_literal(u16 literal)
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
-        slot = empty_slot;
-    }
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = 0;
+    m_symbol_buffer[index].literal = literal;
+    m_symbol_frequencies[literal]++;
+}
 
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
+ALWAYS_INLINE void DeflateCompressor::emit_back_reference(u16 distance, u16 length)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = distance;
+    m_symbol_buffer[index].length = length;
+    m_symbol_frequencies[length_to_symbol[length]]++;
+    m_distance_frequencies[distance_to_base(distance)]++;
+}
 
-    auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
-    };
+void DeflateCompressor::lz77_compress_block()
+{
+    // make the dictionary searchable, it only precedes the first block
+    for (size_t position = block_size - m_dictionary_size; position < block_size; position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+    m_dictionary_size = 0;
 
-    auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
-    };
+    if (m_compression_level == CompressionLevel::FASTEST) {
+        lz77_compress_block_greedy();
+        return;
+    }
 
     size_t previous_match_length = 0;
     size_t previous_match_position = 0;
@@ -733,7 +783,7 @@ void DeflateCompressor::lz77_compress_block()
         auto hash = hash_sequence(&m_rolling_window[current_position]);
         size_t match_position;
         auto match_length = find_back_match(current_position, hash, previous_match_length,
-            min(m_compression_constants.great_match_length, block_end - current_position), match_position);
+            min(max_match_length, block_end - current_position), match_position);
 
         insert_hash(current_position, hash);
 
@@ -777,6 +827,34 @@ void DeflateCompressor::lz77_compress_block()
     }
 }
 
+// Takes the first match that is long enough, and only ever looks at the most recent candidate. The positions that a
+// match covers are not added to the hash chains either.
+void DeflateCompressor::lz77_compress_block_greedy()
+{
+    auto block_end = block_size + m_pending_block_size;
+    size_t current_position = block_size;
+    while (current_position + min_match_length <= block_end) {
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        auto candidate = m_hash_head[hash];
+        insert_hash(current_position, hash);
+
+        size_t match_length = 0;
+        if (candidate != empty_slot && current_position - candidate <= max_distance)
+            match_length = common_length(current_position, candidate, 0, min(max_match_length, block_end - current_position));
+
+        if (match_length < min_match_length) {
+            emit_literal(m_rolling_window[current_position++]);
+            continue;
+        }
+        emit_back_reference(current_position - candidate, match_length);
+        current_position += match_length;
+    }
+
+    // output remaining literals
+    while (current_position < block_end)
+        emit_literal(m_rolling_window[current_position++]);
+}
+
 size_t DeflateCompressor::huffman_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths)
 {
     size_t length = 0;
@@ -1047,6 +1125,7 @@ void DeflateCompressor::flush()
     m_distance_frequencies.fill(0);
     // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
     pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+    slide_hash_chains();
 }
 
 void DeflateCompressor::final_flush()
@@ -1056,6 +1135,33 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
+void DeflateCompressor::final_sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        flush();
+    m_finished = true;
+
+    m_output_stream.write_bit(false);    // not the final block
+    m_output_stream.write_bits(0b00, 2); // no compression
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    m_output_stream << len;
+    LittleEndian<u16> nlen = 0xffff;
+    m_output_stream << nlen;
+    if (m_output_stream.handle_any_error())
+        set_fatal_error();
+}
+
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_pending_block_size == 0 && m_pending_symbol_size == 0);
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+    dictionary.copy_to({ m_rolling_window + block_size - dictionary.size(), dictionary.size() });
+    m_dictionary_size = dictionary.size();
+}
+
 Optional<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     DuplexMemoryStream output_stream;
@@ -13,6 +13,7 @@
 #include <AK/Endian.h>
 #include <AK/Vector.h>
 #include <LibCompress/DeflateTables.h>
+#include <LibCompress/PrefixCodeLookupTable.h>
 
 namespace Compress {
 
@@ -28,9 +29,8 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
-    Vector<u16> m_symbol_values;
+    // Decompression
+    PrefixCodeLookupTable m_lookup_table;
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -112,6 +112,7 @@ public:
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_distance = 32 * KiB; // back references cannot reach further back than this
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
@@ -124,6 +125,7 @@ public:
     // These constants were shamelessly "borrowed" from zlib
     static constexpr CompressionConstants compression_constants[] = {
         { 0, 0, 0, 0 },
+        { 0, 0, max_match_length, 1 }, // greedy matching against only the most recent candidate
         { 4, 4, 8, 4 },
         { 8, 16, 128, 128 },
         { 32, 258, 258, 4096 },
@@ -132,6 +134,7 @@ public:
 
     enum class CompressionLevel : int {
         STORE = 0,
+        FASTEST,
         FAST,
         GOOD,
         GREAT,
@@ -145,6 +148,14 @@ public:
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
 
+    // Ends the stream without a final block, and pads it to a byte boundary with an empty uncompressed block.
+    // The output of another compressor can then be appended to continue the same deflate stream.
+    void final_sync_flush();
+
+    // Lets the first block refer back to the end of the dictionary, which should be the data that precedes
+    // this stream's input. It has to be set before anything is written.
+    void set_dictionary(ReadonlyBytes dictionary);
+
     static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
 private:
@@ -152,9 +163,15 @@ private:
 
     // LZ77 Compression
     static u16 hash_sequence(u8 const* bytes);
+    void insert_hash(size_t position, u16 hash);
+    void slide_hash_chains();
+    size_t common_length(size_t start, size_t candidate, size_t known_length, size_t max_match_length) const;
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
+    void emit_literal(u16 literal);
+    void emit_back_reference(u16 distance, u16 length);
     void lz77_compress_block();
+    void lz77_compress_block_greedy();
 
     // Huffman Coding
     struct code_length_symbol {
@@ -182,6 +199,7 @@ private:
 
     u8 m_rolling_window[window_size];
     size_t m_pending_block_size { 0 };
+    size_t m_dictionary_size { 0 }; // the dictionary sits right before the first pending block
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -194,7 +212,8 @@ private:
     Array<u16, max_huffman_literals> m_symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
     Array<u16, max_huffman_distances> m_distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
 
-    // LZ77 Chained hash table
+    // LZ77 Chained hash table, indexed by position in the rolling window. The chains are kept across blocks, and slide
+    // down along with the window, so that a block can refer back into the previous one.
     u16 m_hash_head[1 << hash_bits];
     u16 m_hash_prev[window_size];
 };
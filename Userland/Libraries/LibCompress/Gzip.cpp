@@ -7,9 +7,11 @@
 
 #include <LibCompress/Gzip.h>
 
+#include <AK/Atomic.h>
 #include <AK/MemoryStream.h>
 #include <AK/String.h>
 #include <LibCore/DateTime.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
@@ -225,7 +227,7 @@ GzipCompressor::GzipCompressor(OutputStream& stream)
 {
 }
 
-size_t GzipCompressor::write(ReadonlyBytes bytes)
+static void write_header(OutputStream& stream)
 {
     BlockHeader header;
     header.identification_1 = 0x1f;
@@ -235,15 +237,25 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.modification_time = 0;
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
-    m_output_stream << Bytes { &header, sizeof(header) };
+    stream << Bytes { &header, sizeof(header) };
+}
+
+static void write_trailer(OutputStream& stream, u32 crc32, size_t size)
+{
+    LittleEndian<u32> digest = crc32;
+    LittleEndian<u32> size_modulo_2_32 = size;
+    stream << digest << size_modulo_2_32;
+}
+
+size_t GzipCompressor::write(ReadonlyBytes bytes)
+{
+    write_header(m_output_stream);
     DeflateCompressor compressed_stream { m_output_stream };
     VERIFY(compressed_stream.write_or_error(bytes));
     compressed_stream.final_flush();
     Crypto::Checksum::CRC32 crc32;
     crc32.update(bytes);
-    LittleEndian<u32> digest = crc32.digest();
-    LittleEndian<u32> size = bytes.size();
-    m_output_stream << digest << size;
+    write_trailer(m_output_stream, crc32.digest(), bytes.size());
     return bytes.size();
 }
 
@@ -270,4 +282,77 @@ Optional<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
     return output_stream.copy_into_contiguous_buffer();
 }
 
+Optional<ByteBuffer> GzipCompressor::compress_all_parallel(ReadonlyBytes bytes, size_t thread_count, size_t chunk_size)
+{
+    VERIFY(chunk_size > 0);
+    auto chunk_count = ceil_div(bytes.size(), chunk_size);
+    thread_count = min(thread_count, chunk_count);
+    if (thread_count <= 1)
+        return compress_all(bytes);
+
+    // Every chunk is deflated on its own, with the data in front of it as the dictionary. All chunks but the last one
+    // end on a byte boundary without a final block, so concatenating them yields a single deflate stream.
+    Vector<Optional<ByteBuffer>> compressed_chunks;
+    compressed_chunks.resize(chunk_count);
+    Atomic<size_t> next_chunk_index { 0 };
+    auto compress_chunks = [&] {
+        for (;;) {
+            auto index = next_chunk_index.fetch_add(1);
+            if (index >= chunk_count)
+                return;
+            auto offset = index * chunk_size;
+            auto chunk = bytes.slice(offset, min(chunk_size, bytes.size() - offset));
+
+            DuplexMemoryStream output_stream;
+            DeflateCompressor deflate_stream { output_stream };
+            deflate_stream.set_dictionary(bytes.slice(0, offset));
+            deflate_stream.write_or_error(chunk);
+            if (index == chunk_count - 1)
+                deflate_stream.final_flush();
+            else
+                deflate_stream.final_sync_flush();
+
+            if (!deflate_stream.handle_any_error())
+                compressed_chunks[index] = output_stream.copy_into_contiguous_buffer();
+        }
+    };
+
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    for (size_t i = 0; i < thread_count - 1; ++i) {
+        auto worker = Threading::Thread::construct([&] {
+            compress_chunks();
+            return 0;
+        },
+            "Gzip compressor"sv);
+        worker->start();
+        workers.append(move(worker));
+    }
+
+    // The checksum covers the whole input, so compute it here before pitching in with the compression.
+    Crypto::Checksum::CRC32 crc32;
+    crc32.update(bytes);
+    compress_chunks();
+
+    for (auto& worker : workers)
+        (void)worker->join();
+
+    size_t output_size = sizeof(BlockHeader) + 2 * sizeof(u32);
+    for (auto& chunk : compressed_chunks) {
+        if (!chunk.has_value())
+            return {};
+        output_size += chunk->size();
+    }
+    auto output = ByteBuffer::create_uninitialized(output_size);
+    if (output.is_error())
+        return {};
+
+    OutputMemoryStream output_stream { output.value() };
+    write_header(output_stream);
+    for (auto& chunk : compressed_chunks)
+        output_stream << chunk->bytes();
+    write_trailer(output_stream, crc32.digest(), bytes.size());
+    VERIFY(output_stream.is_end());
+    return output.release_value();
+}
+
 }
@@ -89,6 +89,11 @@ public:
 
     static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes);
 
+    // Compresses chunks of the input on several threads at once, each primed with the data in front of it, and
+    // joins them into a single gzip member. The output is only slightly larger than that of compress_all().
+    static constexpr size_t default_parallel_chunk_size = 128 * KiB;
+    static Optional<ByteBuffer> compress_all_parallel(ReadonlyBytes bytes, size_t thread_count, size_t chunk_size = default_parallel_chunk_size);
+
 private:
     OutputStream& m_output_stream;
 };
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace Compress {
+
+// Decodes a prefix code (as used by DEFLATE and Brotli) from the next bits of an lsb-first bit stream with one
+// or two table lookups, instead of walking the code one bit at a time.
+//
+// The primary table is indexed by the next primary_bits bits; every code that fits is replicated across all
+// the entries that start with it. Longer codes share a primary entry with all codes of the same prefix, which
+// links to a secondary table indexed by the bits that follow (see https://www.hanshq.net/zip.html#huffdec).
+class PrefixCodeLookupTable {
+public:
+    static constexpr size_t primary_bits = 9;
+    static constexpr size_t max_code_length = 15;
+    static constexpr u16 invalid_symbol = 0xFFFF;
+
+    struct Entry {
+        u16 value { invalid_symbol }; // the symbol, or the offset of the secondary table
+        u8 code_length { 0 };         // the number of bits that make up the code (or that prove it invalid)
+        u8 secondary_bits { 0 };      // non-zero for entries linking to a secondary table
+    };
+
+    // Each code is given msb-first, marked by a leading 1 bit (i.e. 0b1 is the empty code, 0b101 is the
+    // two-bit code 01), in ascending order, next to the symbol it decodes to.
+    template<typename CodeType, typename SymbolType>
+    void build(Span<CodeType> codes, Span<SymbolType> symbols)
+    {
+        VERIFY(codes.size() == symbols.size());
+        m_entries.clear();
+        m_primary_bits = 0;
+        m_min_code_length = 0;
+        if (codes.is_empty())
+            return;
+
+        auto length_of = [](size_t code) { return static_cast<u8>(sizeof(size_t) * 8 - 1 - count_leading_zeroes(code)); };
+        auto lsb_first = [](size_t code, u8 length) {
+            size_t reversed = 0;
+            for (u8 i = 0; i < length; ++i)
+                reversed |= ((code >> i) & 1) << (length - 1 - i);
+            return reversed;
+        };
+
+        m_min_code_length = length_of(codes[0]);
+        auto max_length = length_of(codes[codes.size() - 1]);
+        VERIFY(max_length <= max_code_length);
+        m_primary_bits = min<u8>(max_length, primary_bits);
+        auto primary_mask = (1u << m_primary_bits) - 1;
+
+        m_entries.resize(1u << m_primary_bits);
+        for (auto& entry : m_entries)
+            entry.code_length = m_primary_bits;
+
+        // Size the secondary tables to fit the longest code sharing each prefix.
+        for (auto code : codes) {
+            auto length = length_of(code);
+            if (length <= m_primary_bits)
+                continue;
+            auto& entry = m_entries[lsb_first(code, length) & primary_mask];
+            entry.secondary_bits = max<u8>(entry.secondary_bits, length - m_primary_bits);
+        }
+        for (size_t prefix = 0; prefix <= primary_mask; ++prefix) {
+            auto secondary_bits = m_entries[prefix].secondary_bits;
+            if (secondary_bits == 0)
+                continue;
+            auto offset = m_entries.size();
+            m_entries[prefix].value = offset;
+            m_entries[prefix].code_length = m_primary_bits + secondary_bits;
+            m_entries.resize(offset + (1u << secondary_bits));
+            for (size_t i = offset; i < m_entries.size(); ++i)
+                m_entries[i].code_length = m_primary_bits + secondary_bits;
+        }
+
+        for (size_t i = 0; i < codes.size(); ++i) {
+            auto length = length_of(codes[i]);
+            auto bits = lsb_first(codes[i], length);
+            Entry leaf { static_cast<u16>(symbols[i]), length, 0 };
+
+            if (length <= m_primary_bits) {
+                for (size_t index = bits; index <= primary_mask; index += 1u << length)
+                    m_entries[index] = leaf;
+                continue;
+            }
+
+            auto const& link = m_entries[bits & primary_mask];
+            auto secondary_length = length - m_primary_bits;
+            for (size_t index = bits >> m_primary_bits; index < (1u << link.secondary_bits); index += 1u << secondary_length)
+                m_entries[link.value + index] = leaf;
+        }
+    }
+
+    // Looks up the code that `bits` start with. Entries with a code_length longer than the number of bits that
+    // were actually available have to be looked up again once more bits are at hand.
+    ALWAYS_INLINE Entry lookup(u64 bits) const
+    {
+        auto entry = m_entries[bits & ((1u << m_primary_bits) - 1)];
+        if (entry.secondary_bits != 0)
+            entry = m_entries[entry.value + ((bits >> m_primary_bits) & ((1u << entry.secondary_bits) - 1))];
+        return entry;
+    }
+
+    size_t min_code_length() const { return m_min_code_length; }
+    bool is_empty() const { return m_entries.is_empty(); }
+    void clear()
+    {
+        m_entries.clear();
+        m_primary_bits = 0;
+        m_min_code_length = 0;
+    }
+
+private:
+    Vector<Entry> m_entries;
+    u8 m_primary_bits { 0 };
+    u8 m_min_code_length { 0 };
+};
+
+}
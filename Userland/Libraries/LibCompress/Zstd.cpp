@@ -0,0 +1,960 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Zstd.h>
+#include <string.h>
+
+namespace Compress {
+
+static constexpr size_t max_huffman_bits = 11;
+static constexpr size_t max_literal_length_symbol = 35;
+static constexpr size_t max_match_length_symbol = 52;
+static constexpr size_t max_offset_symbol = 31;
+static constexpr size_t max_literal_length_accuracy_log = 9;
+static constexpr size_t max_match_length_accuracy_log = 9;
+static constexpr size_t max_offset_accuracy_log = 8;
+static constexpr size_t max_huffman_weight_accuracy_log = 6;
+
+static constexpr Array<u32, 36> literal_length_baselines {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+    8192, 16384, 32768, 65536
+};
+static constexpr Array<u8, 36> literal_length_extra_bits {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+    13, 14, 15, 16
+};
+static constexpr Array<u32, 53> match_length_baselines {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+    19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+    35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+    4099, 8195, 16387, 32771, 65539
+};
+static constexpr Array<u8, 53> match_length_extra_bits {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16
+};
+
+// The predefined distributions from RFC 8878 section 3.1.1.3.2.2.
+static constexpr Array<i16, 36> predefined_literal_length_distribution {
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+    -1, -1, -1, -1
+};
+static constexpr Array<i16, 53> predefined_match_length_distribution {
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+    -1, -1, -1, -1, -1
+};
+static constexpr Array<i16, 29> predefined_offset_distribution {
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1
+};
+
+static u64 read_little_endian(ReadonlyBytes bytes)
+{
+    u64 value = 0;
+    for (size_t i = 0; i < bytes.size(); ++i)
+        value |= static_cast<u64>(bytes[i]) << (i * 8);
+    return value;
+}
+
+// Reads the FSE table descriptions, least significant bit first. Reading past the end yields zeroes, the
+// caller checks how far it got afterwards.
+class ForwardBitReader {
+public:
+    explicit ForwardBitReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    u32 peek(size_t count) const
+    {
+        VERIFY(count <= 24);
+        u32 value = 0;
+        auto byte_index = m_bit_position / 8;
+        for (size_t i = 0; i < 4 && byte_index + i < m_bytes.size(); ++i)
+            value |= static_cast<u32>(m_bytes[byte_index + i]) << (i * 8);
+        return (value >> (m_bit_position % 8)) & ((1u << count) - 1);
+    }
+
+    void consume(size_t count) { m_bit_position += count; }
+
+    u32 read(size_t count)
+    {
+        auto value = peek(count);
+        consume(count);
+        return value;
+    }
+
+    size_t bit_position() const { return m_bit_position; }
+
+private:
+    ReadonlyBytes m_bytes;
+    size_t m_bit_position { 0 };
+};
+
+// Reads the Huffman and FSE coded streams. These are written forwards but read backwards, starting with the
+// most significant bit of the last byte after its padding (the highest set bit).
+class BackwardBitReader {
+public:
+    static ErrorOr<BackwardBitReader> create(ReadonlyBytes bytes)
+    {
+        if (bytes.is_empty() || bytes.last() == 0)
+            return Error::from_string_literal("zstd: Bitstream is missing its end marker");
+
+        BackwardBitReader reader;
+        reader.m_bytes = bytes;
+        reader.m_remaining_bytes = bytes.size() - 1;
+        reader.m_bit_count = sizeof(u32) * 8 - 1 - count_leading_zeroes(static_cast<u32>(bytes.last()));
+        if (reader.m_bit_count > 0)
+            reader.m_container = static_cast<u64>(bytes.last()) << (64 - reader.m_bit_count);
+        reader.refill();
+        return reader;
+    }
+
+    ALWAYS_INLINE void refill()
+    {
+        if (m_bit_count > 56)
+            return;
+        if (m_remaining_bytes >= 8) {
+            auto byte_count = (64 - m_bit_count) / 8;
+            u64 word;
+            ByteReader::load(m_bytes.data() + m_remaining_bytes - 8, word);
+            word = AK::convert_between_host_and_little_endian(word);
+            m_container |= (word >> (64 - byte_count * 8)) << (64 - m_bit_count - byte_count * 8);
+            m_remaining_bytes -= byte_count;
+            m_bit_count += byte_count * 8;
+            return;
+        }
+        while (m_bit_count <= 56 && m_remaining_bytes > 0) {
+            --m_remaining_bytes;
+            m_container |= static_cast<u64>(m_bytes[m_remaining_bytes]) << (56 - m_bit_count);
+            m_bit_count += 8;
+        }
+    }
+
+    // Bits past the start of the stream read as zero.
+    ALWAYS_INLINE u64 peek(size_t count) const
+    {
+        if (count == 0)
+            return 0;
+        return m_container >> (64 - count);
+    }
+
+    ALWAYS_INLINE void consume(size_t count)
+    {
+        if (count < m_bit_count) {
+            m_container <<= count;
+            m_bit_count -= count;
+            return;
+        }
+        m_overflow_bit_count += count - m_bit_count;
+        m_container = 0;
+        m_bit_count = 0;
+    }
+
+    // Reads at most 56 bits.
+    ALWAYS_INLINE u64 read(size_t count)
+    {
+        if (m_bit_count < count)
+            refill();
+        auto value = peek(count);
+        consume(count);
+        return value;
+    }
+
+    size_t bit_count() const { return m_bit_count; }
+    bool has_overflowed() const { return m_overflow_bit_count > 0; }
+    bool is_finished() const { return m_remaining_bytes == 0 && m_bit_count == 0 && m_overflow_bit_count == 0; }
+
+private:
+    BackwardBitReader() = default;
+
+    ReadonlyBytes m_bytes;
+    size_t m_remaining_bytes { 0 };
+    u64 m_container { 0 }; // the next bit to be read is the most significant one
+    size_t m_bit_count { 0 };
+    size_t m_overflow_bit_count { 0 };
+};
+
+static ErrorOr<void> build_fse_table(ZstdDecompressor::FSETable& table, Span<i16 const> distribution, size_t accuracy_log)
+{
+    size_t const size = 1u << accuracy_log;
+    table.accuracy_log = accuracy_log;
+    table.entries.resize(size);
+
+    // Symbols with a "less than 1" probability get a single cell each at the end of the table.
+    Array<u16, 256> next_state {};
+    size_t high_threshold = size - 1;
+    for (size_t symbol = 0; symbol < distribution.size(); ++symbol) {
+        if (distribution[symbol] == -1) {
+            table.entries[high_threshold--].symbol = symbol;
+            next_state[symbol] = 1;
+        } else {
+            next_state[symbol] = distribution[symbol];
+        }
+    }
+
+    size_t const step = (size >> 1) + (size >> 3) + 3;
+    size_t const mask = size - 1;
+    size_t position = 0;
+    for (size_t symbol = 0; symbol < distribution.size(); ++symbol) {
+        for (i16 i = 0; i < distribution[symbol]; ++i) {
+            table.entries[position].symbol = symbol;
+            do {
+                position = (position + step) & mask;
+            } while (position > high_threshold);
+        }
+    }
+    if (position != 0)
+        return Error::from_string_literal("zstd: Invalid FSE distribution");
+
+    for (auto& entry : table.entries) {
+        u16 state = next_state[entry.symbol]++;
+        auto number_of_bits = accuracy_log - (sizeof(u32) * 8 - 1 - count_leading_zeroes(static_cast<u32>(state)));
+        entry.number_of_bits = number_of_bits;
+        entry.baseline = (state << number_of_bits) - size;
+    }
+
+    return {};
+}
+
+template<size_t Size>
+static ZstdDecompressor::FSETable build_predefined_table(Array<i16, Size> const& distribution, size_t accuracy_log)
+{
+    ZstdDecompressor::FSETable table;
+    MUST(build_fse_table(table, distribution.span(), accuracy_log));
+    return table;
+}
+
+static ZstdDecompressor::FSETable const& predefined_literal_length_table()
+{
+    static auto const table = build_predefined_table(predefined_literal_length_distribution, 6);
+    return table;
+}
+
+static ZstdDecompressor::FSETable const& predefined_match_length_table()
+{
+    static auto const table = build_predefined_table(predefined_match_length_distribution, 6);
+    return table;
+}
+
+static ZstdDecompressor::FSETable const& predefined_offset_table()
+{
+    static auto const table = build_predefined_table(predefined_offset_distribution, 5);
+    return table;
+}
+
+// Reads an FSE table description (RFC 8878 section 4.1.1) and returns the number of bytes it took up.
+static ErrorOr<size_t> read_fse_table(ZstdDecompressor::FSETable& table, ReadonlyBytes bytes, size_t max_symbol, size_t max_accuracy_log)
+{
+    ForwardBitReader reader { bytes };
+
+    size_t accuracy_log = reader.read(4) + 5;
+    if (accuracy_log > max_accuracy_log)
+        return Error::from_string_literal("zstd: FSE accuracy log is too large");
+
+    Array<i16, 256> distribution {};
+    size_t symbol = 0;
+    i32 remaining = (1 << accuracy_log) + 1;
+    i32 threshold = 1 << accuracy_log;
+    size_t number_of_bits = accuracy_log + 1;
+
+    while (remaining > 1 && symbol <= max_symbol) {
+        i32 max = 2 * threshold - 1 - remaining;
+        i32 value = reader.peek(number_of_bits);
+        i32 count;
+        if ((value & (threshold - 1)) < max) {
+            count = value & (threshold - 1);
+            reader.consume(number_of_bits - 1);
+        } else {
+            count = value & (2 * threshold - 1);
+            if (count >= threshold)
+                count -= max;
+            reader.consume(number_of_bits);
+        }
+
+        // The value is the probability plus one, so that -1 ("less than one") can be encoded.
+        --count;
+        remaining -= count < 0 ? -count : count;
+        distribution[symbol++] = count;
+
+        if (count == 0) {
+            // A zero probability is followed by the number of further zero probabilities, two bits at a time.
+            for (;;) {
+                auto repeat = reader.read(2);
+                if (symbol + repeat > max_symbol + 1)
+                    return Error::from_string_literal("zstd: FSE distribution has too many symbols");
+                symbol += repeat;
+                if (repeat != 3)
+                    break;
+            }
+        }
+
+        while (remaining < threshold) {
+            --number_of_bits;
+            threshold >>= 1;
+        }
+    }
+
+    if (remaining != 1)
+        return Error::from_string_literal("zstd: Invalid FSE distribution");
+
+    auto size = (reader.bit_position() + 7) / 8;
+    if (size > bytes.size())
+        return Error::from_string_literal("zstd: FSE table description is truncated");
+
+    TRY(build_fse_table(table, distribution.span().trim(symbol), accuracy_log));
+    return size;
+}
+
+ZstdDecompressor::ZstdDecompressor(InputStream& stream)
+    : m_input_stream(stream)
+{
+}
+
+ZstdDecompressor::~ZstdDecompressor() = default;
+
+bool ZstdDecompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= 4 && read_little_endian(bytes.trim(4)) == frame_magic;
+}
+
+size_t ZstdDecompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (has_any_error() || m_state == State::Finished)
+            break;
+
+        if (m_output_offset < m_window_end) {
+            auto nread = min(bytes.size() - total_read, m_window_end - m_output_offset);
+            memcpy(bytes.offset(total_read), m_window.offset_pointer(m_output_offset), nread);
+            m_output_offset += nread;
+            total_read += nread;
+            continue;
+        }
+
+        ErrorOr<void> result;
+        switch (m_state) {
+        case State::FrameHeader:
+            result = read_frame_header();
+            break;
+        case State::Block:
+            result = read_block();
+            break;
+        case State::Checksum:
+            result = read_checksum();
+            break;
+        case State::Finished:
+            VERIFY_NOT_REACHED();
+        }
+
+        if (result.is_error()) {
+            set_fatal_error();
+            break;
+        }
+    }
+    return total_read;
+}
+
+ErrorOr<void> ZstdDecompressor::read_from_input(Bytes bytes)
+{
+    if (!m_input_stream.read_or_error(bytes))
+        return Error::from_string_literal("zstd: Unexpected end of input");
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::read_frame_header()
+{
+    u8 magic_bytes[4];
+    size_t magic_size = 0;
+    while (magic_size < sizeof(magic_bytes)) {
+        auto nread = m_input_stream.read({ magic_bytes + magic_size, sizeof(magic_bytes) - magic_size });
+        if (nread == 0)
+            break;
+        magic_size += nread;
+    }
+    // Running out of input between frames ends the stream, but failing to
+    // read from it doesn't.
+    if (magic_size == 0 && m_input_stream.has_any_error())
+        return Error::from_string_literal("zstd: Failed to read from input");
+    if (magic_size == 0 && m_input_stream.unreliable_eof()) {
+        m_state = State::Finished;
+        return {};
+    }
+    if (magic_size < sizeof(magic_bytes))
+        return Error::from_string_literal("zstd: Unexpected end of input");
+
+    auto magic = read_little_endian({ magic_bytes, sizeof(magic_bytes) });
+    if ((magic & ~0xFu) == skippable_frame_magic) {
+        u8 size[4];
+        TRY(read_from_input({ size, sizeof(size) }));
+        if (!m_input_stream.discard_or_error(read_little_endian({ size, sizeof(size) })))
+            return Error::from_string_literal("zstd: Unexpected end of input");
+        return {};
+    }
+    if (magic != frame_magic)
+        return Error::from_string_literal("zstd: Invalid magic number");
+
+    u8 descriptor;
+    TRY(read_from_input({ &descriptor, 1 }));
+    auto content_size_flag = descriptor >> 6;
+    bool single_segment = descriptor & 0x20;
+    if (descriptor & 0x08)
+        return Error::from_string_literal("zstd: Reserved frame header bit is set");
+    m_has_checksum = descriptor & 0x04;
+    auto dictionary_id_flag = descriptor & 0x03;
+
+    u64 window_size = 0;
+    if (!single_segment) {
+        u8 window_descriptor;
+        TRY(read_from_input({ &window_descriptor, 1 }));
+        auto window_log = 10 + (window_descriptor >> 3);
+        u64 window_base = 1ull << window_log;
+        window_size = window_base + (window_base / 8) * (window_descriptor & 7);
+    }
+
+    static constexpr size_t dictionary_id_sizes[] = { 0, 1, 2, 4 };
+    u8 dictionary_id[4];
+    TRY(read_from_input({ dictionary_id, dictionary_id_sizes[dictionary_id_flag] }));
+    if (read_little_endian({ dictionary_id, dictionary_id_sizes[dictionary_id_flag] }) != 0)
+        return Error::from_string_literal("zstd: Dictionaries are not supported");
+
+    static constexpr size_t content_size_sizes[] = { 0, 2, 4, 8 };
+    auto content_size_size = content_size_flag == 0 && single_segment ? 1 : content_size_sizes[content_size_flag];
+    m_content_size.clear();
+    if (content_size_size > 0) {
+        u8 content_size[8];
+        TRY(read_from_input({ content_size, content_size_size }));
+        u64 value = read_little_endian({ content_size, content_size_size });
+        if (content_size_size == 2)
+            value += 256;
+        m_content_size = value;
+    }
+
+    if (single_segment)
+        window_size = m_content_size.value();
+    if (window_size > max_window_size)
+        return Error::from_string_literal("zstd: Window size is too large");
+
+    m_window_size = window_size;
+    m_window_end = 0;
+    m_output_offset = 0;
+    m_frame_output_size = 0;
+    m_checksum = {};
+    m_repeated_offsets[0] = 1;
+    m_repeated_offsets[1] = 4;
+    m_repeated_offsets[2] = 8;
+    m_huffman_table = {};
+    m_literal_length_table = {};
+    m_offset_table = {};
+    m_match_length_table = {};
+
+    m_state = State::Block;
+    return {};
+}
+
+void ZstdDecompressor::slide_window()
+{
+    // Everything up to m_window_end has been read already, only the window has to stay around.
+    VERIFY(m_output_offset == m_window_end);
+    if (m_window_end - min(m_window_end, m_window_size) < max(m_window_size, max_block_size))
+        return;
+
+    memmove(m_window.data(), m_window.offset_pointer(m_window_end - m_window_size), m_window_size);
+    m_window_end = m_window_size;
+    m_output_offset = m_window_size;
+}
+
+ErrorOr<void> ZstdDecompressor::read_block()
+{
+    u8 header_bytes[3];
+    TRY(read_from_input({ header_bytes, sizeof(header_bytes) }));
+    auto header = read_little_endian({ header_bytes, sizeof(header_bytes) });
+    bool is_last_block = header & 1;
+    auto block_type = (header >> 1) & 3;
+    size_t block_size = header >> 3;
+
+    auto block_maximum_size = min(m_window_size, max_block_size);
+    if (block_size > block_maximum_size)
+        return Error::from_string_literal("zstd: Block is too large");
+
+    slide_window();
+    auto needed_size = m_window_end + block_maximum_size;
+    if (needed_size > m_window.size()) {
+        auto largest_size = 2 * max(m_window_size, max_block_size) + max_block_size;
+        TRY(m_window.try_resize(max(needed_size, min(m_window.size() * 2, largest_size))));
+    }
+
+    auto block_start = m_window_end;
+    switch (block_type) {
+    case 0: // Raw_Block
+        TRY(read_from_input({ m_window.offset_pointer(m_window_end), block_size }));
+        m_window_end += block_size;
+        break;
+    case 1: { // RLE_Block
+        u8 byte;
+        TRY(read_from_input({ &byte, 1 }));
+        memset(m_window.offset_pointer(m_window_end), byte, block_size);
+        m_window_end += block_size;
+        break;
+    }
+    case 2: // Compressed_Block
+        if (m_block.size() < max_block_size)
+            TRY(m_block.try_resize(max_block_size));
+        TRY(read_from_input(m_block.bytes().trim(block_size)));
+        TRY(decompress_block(m_block.bytes().trim(block_size)));
+        break;
+    default:
+        return Error::from_string_literal("zstd: Reserved block type");
+    }
+
+    auto block_output = m_window.bytes().slice(block_start, m_window_end - block_start);
+    if (m_has_checksum)
+        m_checksum.update(block_output);
+    m_frame_output_size += block_output.size();
+
+    if (m_content_size.has_value() && m_frame_output_size > m_content_size.value())
+        return Error::from_string_literal("zstd: Frame is larger than its declared size");
+
+    if (is_last_block) {
+        if (m_content_size.has_value() && m_frame_output_size != m_content_size.value())
+            return Error::from_string_literal("zstd: Frame is smaller than its declared size");
+        m_state = m_has_checksum ? State::Checksum : State::FrameHeader;
+    }
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::read_checksum()
+{
+    u8 checksum[4];
+    TRY(read_from_input({ checksum, sizeof(checksum) }));
+    if (read_little_endian({ checksum, sizeof(checksum) }) != static_cast<u32>(m_checksum.digest()))
+        return Error::from_string_literal("zstd: Checksum mismatch");
+
+    m_state = State::FrameHeader;
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::decompress_block(ReadonlyBytes block)
+{
+    ReadonlyBytes literals;
+    auto literals_section_size = TRY(decode_literals(block, literals));
+    TRY(decode_sequences(block.slice(literals_section_size), literals));
+    return {};
+}
+
+ErrorOr<size_t> ZstdDecompressor::decode_literals(ReadonlyBytes block, ReadonlyBytes& literals)
+{
+    if (block.is_empty())
+        return Error::from_string_literal("zstd: Literals section is truncated");
+
+    auto literals_type = block[0] & 3;
+    auto size_format = (block[0] >> 2) & 3;
+
+    if (literals_type == 0 || literals_type == 1) {
+        // Raw_Literals_Block or RLE_Literals_Block
+        size_t header_size = size_format == 1 ? 2 : size_format == 3 ? 3 : 1;
+        if (block.size() < header_size)
+            return Error::from_string_literal("zstd: Literals section is truncated");
+        auto header = read_little_endian(block.trim(header_size));
+        size_t regenerated_size = header_size == 1 ? header >> 3 : header >> 4;
+        if (regenerated_size > max_block_size)
+            return Error::from_string_literal("zstd: Too many literals");
+
+        if (literals_type == 0) {
+            if (block.size() < header_size + regenerated_size)
+                return Error::from_string_literal("zstd: Literals section is truncated");
+            literals = block.slice(header_size, regenerated_size);
+            return header_size + regenerated_size;
+        }
+
+        if (block.size() < header_size + 1)
+            return Error::from_string_literal("zstd: Literals section is truncated");
+        if (m_literals.size() < max_block_size)
+            TRY(m_literals.try_resize(max_block_size));
+        memset(m_literals.data(), block[header_size], regenerated_size);
+        literals = m_literals.bytes().trim(regenerated_size);
+        return header_size + 1;
+    }
+
+    // Compressed_Literals_Block or Treeless_Literals_Block
+    static constexpr size_t header_sizes[] = { 3, 3, 4, 5 };
+    static constexpr size_t size_bits[] = { 10, 10, 14, 18 };
+    size_t header_size = header_sizes[size_format];
+    if (block.size() < header_size)
+        return Error::from_string_literal("zstd: Literals section is truncated");
+    auto header = read_little_endian(block.trim(header_size));
+    auto size_mask = (1u << size_bits[size_format]) - 1;
+    size_t regenerated_size = (header >> 4) & size_mask;
+    size_t compressed_size = (header >> (4 + size_bits[size_format])) & size_mask;
+    bool has_four_streams = size_format != 0;
+
+    if (regenerated_size > max_block_size)
+        return Error::from_string_literal("zstd: Too many literals");
+    if (block.size() < header_size + compressed_size)
+        return Error::from_string_literal("zstd: Literals section is truncated");
+
+    auto data = block.slice(header_size, compressed_size);
+    if (literals_type == 2)
+        data = data.slice(TRY(read_huffman_table(data)));
+    else if (m_huffman_table.entries.is_empty())
+        return Error::from_string_literal("zstd: Treeless literals without a previous Huffman table");
+
+    if (m_literals.size() < max_block_size)
+        TRY(m_literals.try_resize(max_block_size));
+
+    auto decode_stream = [&](ReadonlyBytes stream, Bytes output) -> ErrorOr<void> {
+        auto reader = TRY(BackwardBitReader::create(stream));
+        auto const max_number_of_bits = m_huffman_table.max_number_of_bits;
+        auto const* entries = m_huffman_table.entries.data();
+
+        size_t i = 0;
+        while (i < output.size()) {
+            reader.refill();
+            // Every symbol takes up to max_number_of_bits bits, so this many can be decoded without refilling.
+            auto count = min(output.size() - i, max<size_t>(1, reader.bit_count() / max_number_of_bits));
+            for (auto end = i + count; i < end; ++i) {
+                auto const& entry = entries[reader.peek(max_number_of_bits)];
+                output[i] = entry.symbol;
+                reader.consume(entry.number_of_bits);
+            }
+        }
+
+        if (!reader.is_finished())
+            return Error::from_string_literal("zstd: Literals stream is corrupted");
+        return {};
+    };
+
+    auto output = m_literals.bytes().trim(regenerated_size);
+    if (!has_four_streams) {
+        TRY(decode_stream(data, output));
+    } else {
+        if (data.size() < 6)
+            return Error::from_string_literal("zstd: Literals jump table is truncated");
+        size_t stream_sizes[4];
+        stream_sizes[0] = read_little_endian(data.slice(0, 2));
+        stream_sizes[1] = read_little_endian(data.slice(2, 2));
+        stream_sizes[2] = read_little_endian(data.slice(4, 2));
+        auto total_size = stream_sizes[0] + stream_sizes[1] + stream_sizes[2] + 6;
+        if (total_size > data.size())
+            return Error::from_string_literal("zstd: Literals jump table is corrupted");
+        stream_sizes[3] = data.size() - total_size;
+
+        auto segment_size = (regenerated_size + 3) / 4;
+        if (regenerated_size < 3 * segment_size)
+            return Error::from_string_literal("zstd: Too few literals for four streams");
+
+        size_t stream_offset = 6;
+        for (size_t i = 0; i < 4; ++i) {
+            auto output_size = i < 3 ? segment_size : regenerated_size - 3 * segment_size;
+            TRY(decode_stream(data.slice(stream_offset, stream_sizes[i]), output.slice(i * segment_size, output_size)));
+            stream_offset += stream_sizes[i];
+        }
+    }
+
+    literals = output;
+    return header_size + compressed_size;
+}
+
+ErrorOr<size_t> ZstdDecompressor::read_huffman_table(ReadonlyBytes data)
+{
+    if (data.is_empty())
+        return Error::from_string_literal("zstd: Huffman tree description is truncated");
+
+    Array<u8, 256> weights {};
+    size_t weight_count = 0;
+    size_t description_size;
+
+    auto header = data[0];
+    if (header < 128) {
+        // The weights are FSE compressed, with two states taking turns.
+        description_size = 1 + header;
+        if (data.size() < description_size)
+            return Error::from_string_literal("zstd: Huffman tree description is truncated");
+
+        FSETable table;
+        auto compressed = data.slice(1, header);
+        auto table_size = TRY(read_fse_table(table, compressed, 255, max_huffman_weight_accuracy_log));
+        auto reader = TRY(BackwardBitReader::create(compressed.slice(table_size)));
+
+        size_t states[2];
+        states[0] = reader.read(table.accuracy_log);
+        states[1] = reader.read(table.accuracy_log);
+        for (size_t current = 0;; current ^= 1) {
+            if (weight_count >= 255)
+                return Error::from_string_literal("zstd: Too many Huffman weights");
+            auto const& entry = table.entries[states[current]];
+            weights[weight_count++] = entry.symbol;
+            states[current] = entry.baseline + reader.read(entry.number_of_bits);
+            if (reader.has_overflowed()) {
+                if (weight_count >= 255)
+                    return Error::from_string_literal("zstd: Too many Huffman weights");
+                weights[weight_count++] = table.entries[states[current ^ 1]].symbol;
+                break;
+            }
+        }
+    } else {
+        // The weights are stored directly, four bits each.
+        weight_count = header - 127;
+        description_size = 1 + (weight_count + 1) / 2;
+        if (data.size() < description_size)
+            return Error::from_string_literal("zstd: Huffman tree description is truncated");
+        for (size_t i = 0; i < weight_count; ++i)
+            weights[i] = i % 2 == 0 ? data[1 + i / 2] >> 4 : data[1 + i / 2] & 0xF;
+    }
+
+    // The weight of the last symbol is implied: it completes the sum of 2^(weight - 1) to a power of two.
+    u32 weight_sum = 0;
+    for (size_t i = 0; i < weight_count; ++i) {
+        if (weights[i] > max_huffman_bits)
+            return Error::from_string_literal("zstd: Invalid Huffman weight");
+        if (weights[i] > 0)
+            weight_sum += 1u << (weights[i] - 1);
+    }
+    if (weight_sum == 0)
+        return Error::from_string_literal("zstd: Invalid Huffman weights");
+
+    size_t max_number_of_bits = sizeof(u32) * 8 - count_leading_zeroes(weight_sum);
+    if (max_number_of_bits > max_huffman_bits)
+        return Error::from_string_literal("zstd: Huffman codes are too long");
+    u32 remainder = (1u << max_number_of_bits) - weight_sum;
+    if (!is_power_of_two(remainder))
+        return Error::from_string_literal("zstd: Invalid Huffman weights");
+    weights[weight_count++] = sizeof(u32) * 8 - count_leading_zeroes(remainder);
+
+    // Codes are assigned from the lowest weight (longest code) up, and in symbol order within one weight.
+    auto& table = m_huffman_table;
+    table.max_number_of_bits = max_number_of_bits;
+    table.entries.resize(1u << max_number_of_bits);
+    size_t position = 0;
+    for (size_t weight = 1; weight <= max_number_of_bits; ++weight) {
+        for (size_t symbol = 0; symbol < weight_count; ++symbol) {
+            if (weights[symbol] != weight)
+                continue;
+            HuffmanTable::Entry entry { static_cast<u8>(symbol), static_cast<u8>(max_number_of_bits + 1 - weight) };
+            for (size_t i = 0; i < (1u << (weight - 1)); ++i)
+                table.entries[position++] = entry;
+        }
+    }
+    VERIFY(position == table.entries.size());
+
+    return description_size;
+}
+
+ErrorOr<size_t> ZstdDecompressor::read_sequence_table(FSETable& table, u8 mode, ReadonlyBytes data, FSETable const& predefined, size_t max_symbol, size_t max_accuracy_log)
+{
+    switch (mode) {
+    case 0: // Predefined_Mode
+        table = predefined;
+        return 0;
+    case 1: // RLE_Mode
+        if (data.is_empty())
+            return Error::from_string_literal("zstd: Sequences section is truncated");
+        if (data[0] > max_symbol)
+            return Error::from_string_literal("zstd: Invalid RLE sequence symbol");
+        table.accuracy_log = 0;
+        table.entries.clear_with_capacity();
+        table.entries.append({ 0, data[0], 0 });
+        return 1;
+    case 2: // FSE_Compressed_Mode
+        return read_fse_table(table, data, max_symbol, max_accuracy_log);
+    case 3: // Repeat_Mode
+        if (table.entries.is_empty())
+            return Error::from_string_literal("zstd: Repeated sequence table without a previous one");
+        return 0;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ErrorOr<void> ZstdDecompressor::decode_sequences(ReadonlyBytes data, ReadonlyBytes literals)
+{
+    if (data.is_empty())
+        return Error::from_string_literal("zstd: Sequences section is truncated");
+
+    size_t sequence_count;
+    size_t offset;
+    if (data[0] < 128) {
+        sequence_count = data[0];
+        offset = 1;
+    } else if (data[0] < 255) {
+        if (data.size() < 2)
+            return Error::from_string_literal("zstd: Sequences section is truncated");
+        sequence_count = ((data[0] - 128) << 8) + data[1];
+        offset = 2;
+    } else {
+        if (data.size() < 3)
+            return Error::from_string_literal("zstd: Sequences section is truncated");
+        sequence_count = data[1] + (data[2] << 8) + 0x7F00;
+        offset = 3;
+    }
+
+    size_t literals_offset = 0;
+    if (sequence_count > 0) {
+        if (data.size() <= offset)
+            return Error::from_string_literal("zstd: Sequences section is truncated");
+        auto modes = data[offset++];
+        if (modes & 3)
+            return Error::from_string_literal("zstd: Reserved sequence compression mode bits are set");
+
+        offset += TRY(read_sequence_table(m_literal_length_table, modes >> 6, data.slice(offset), predefined_literal_length_table(), max_literal_length_symbol, max_literal_length_accuracy_log));
+        offset += TRY(read_sequence_table(m_offset_table, (modes >> 4) & 3, data.slice(offset), predefined_offset_table(), max_offset_symbol, max_offset_accuracy_log));
+        offset += TRY(read_sequence_table(m_match_length_table, (modes >> 2) & 3, data.slice(offset), predefined_match_length_table(), max_match_length_symbol, max_match_length_accuracy_log));
+
+        auto reader = TRY(BackwardBitReader::create(data.slice(offset)));
+        auto const* literal_length_entries = m_literal_length_table.entries.data();
+        auto const* offset_entries = m_offset_table.entries.data();
+        auto const* match_length_entries = m_match_length_table.entries.data();
+        size_t literal_length_state = reader.read(m_literal_length_table.accuracy_log);
+        size_t offset_state = reader.read(m_offset_table.accuracy_log);
+        size_t match_length_state = reader.read(m_match_length_table.accuracy_log);
+
+        for (size_t i = 0; i < sequence_count; ++i) {
+            auto const& literal_length_entry = literal_length_entries[literal_length_state];
+            auto const& offset_entry = offset_entries[offset_state];
+            auto const& match_length_entry = match_length_entries[match_length_state];
+
+            // The extra bits come in the order offset, match length, literal length.
+            auto offset_code = offset_entry.symbol;
+            size_t offset_value = (1ull << offset_code) + reader.read(offset_code);
+            size_t match_length = match_length_baselines[match_length_entry.symbol] + reader.read(match_length_extra_bits[match_length_entry.symbol]);
+            size_t literal_length = literal_length_baselines[literal_length_entry.symbol] + reader.read(literal_length_extra_bits[literal_length_entry.symbol]);
+
+            // Offset values 1 to 3 refer to the repeated offsets, shifted by one if there are no literals.
+            size_t match_offset;
+            if (offset_value > 3) {
+                match_offset = offset_value - 3;
+                m_repeated_offsets[2] = m_repeated_offsets[1];
+                m_repeated_offsets[1] = m_repeated_offsets[0];
+                m_repeated_offsets[0] = match_offset;
+            } else {
+                auto index = offset_value - 1 + (literal_length == 0 ? 1 : 0);
+                if (index == 0) {
+                    match_offset = m_repeated_offsets[0];
+                } else {
+                    match_offset = index == 3 ? m_repeated_offsets[0] - 1 : m_repeated_offsets[index];
+                    if (index != 1)
+                        m_repeated_offsets[2] = m_repeated_offsets[1];
+                    m_repeated_offsets[1] = m_repeated_offsets[0];
+                    m_repeated_offsets[0] = match_offset;
+                }
+            }
+
+            TRY(execute_sequence(literals, literals_offset, literal_length, match_length, match_offset));
+
+            if (i + 1 < sequence_count) {
+                // The states are updated in the order literal length, match length, offset.
+                literal_length_state = literal_length_entry.baseline + reader.read(literal_length_entry.number_of_bits);
+                match_length_state = match_length_entry.baseline + reader.read(match_length_entry.number_of_bits);
+                offset_state = offset_entry.baseline + reader.read(offset_entry.number_of_bits);
+            }
+        }
+
+        if (!reader.is_finished())
+            return Error::from_string_literal("zstd: Sequences stream is corrupted");
+    } else if (data.size() != offset) {
+        return Error::from_string_literal("zstd: Unexpected data after the literals");
+    }
+
+    // Whatever literals are left over come last.
+    return execute_sequence(literals, literals_offset, literals.size() - literals_offset, 0, 0);
+}
+
+ErrorOr<void> ZstdDecompressor::execute_sequence(ReadonlyBytes literals, size_t& literals_offset, size_t literal_length, size_t match_length, size_t match_offset)
+{
+    if (literal_length > literals.size() - literals_offset)
+        return Error::from_string_literal("zstd: Sequence uses more literals than there are");
+    if (m_window_end + literal_length + match_length > m_window.size())
+        return Error::from_string_literal("zstd: Block is too large");
+
+    auto* output = m_window.offset_pointer(m_window_end);
+    memcpy(output, literals.data() + literals_offset, literal_length);
+    literals_offset += literal_length;
+    output += literal_length;
+    m_window_end += literal_length;
+
+    if (match_length == 0)
+        return {};
+    if (match_offset == 0 || match_offset > m_window_end)
+        return Error::from_string_literal("zstd: Match offset is out of bounds");
+
+    auto const* source = output - match_offset;
+    if (match_offset >= match_length) {
+        memcpy(output, source, match_length);
+    } else {
+        for (size_t i = 0; i < match_length; ++i)
+            output[i] = source[i];
+    }
+    m_window_end += match_length;
+    return {};
+}
+
+Optional<ByteBuffer> ZstdDecompressor::decompress_all(ReadonlyBytes bytes)
+{
+    InputMemoryStream memory_stream { bytes };
+    ZstdDecompressor zstd_stream { memory_stream };
+    DuplexMemoryStream output_stream;
+
+    u8 buffer[4096];
+    while (!zstd_stream.has_any_error() && !zstd_stream.unreliable_eof()) {
+        auto const nread = zstd_stream.read({ buffer, sizeof(buffer) });
+        output_stream.write_or_error({ buffer, nread });
+    }
+
+    if (zstd_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+bool ZstdDecompressor::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool ZstdDecompressor::discard_or_error(size_t count)
+{
+    u8 buffer[4096];
+
+    size_t ndiscarded = 0;
+    while (ndiscarded < count) {
+        if (unreliable_eof()) {
+            set_fatal_error();
+            return false;
+        }
+
+        ndiscarded += read({ buffer, min<size_t>(count - ndiscarded, sizeof(buffer)) });
+    }
+
+    return true;
+}
+
+bool ZstdDecompressor::unreliable_eof() const { return m_state == State::Finished; }
+
+bool ZstdDecompressor::handle_any_error()
+{
+    bool handled_errors = m_input_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <AK/Vector.h>
+#include <LibCrypto/Checksum/XXHash64.h>
+
+namespace Compress {
+
+// Decompresses Zstandard frames (RFC 8878), including concatenated and skippable ones.
+// Frames that require a dictionary are not supported.
+class ZstdDecompressor final : public InputStream {
+public:
+    static constexpr u32 frame_magic = 0xFD2FB528;
+    static constexpr u32 skippable_frame_magic = 0x184D2A50; // the lowest four bits may take any value
+    static constexpr size_t max_block_size = 128 * KiB;
+    static constexpr size_t max_window_size = 128 * MiB;
+
+    ZstdDecompressor(InputStream&);
+    ~ZstdDecompressor();
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool discard_or_error(size_t) override;
+
+    bool unreliable_eof() const override;
+    bool handle_any_error() override;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes bytes);
+
+    // A table for decoding the symbols of a finite state entropy (tANS) code, see RFC 8878 section 4.1.
+    struct FSETable {
+        struct Entry {
+            u16 baseline { 0 };
+            u8 symbol { 0 };
+            u8 number_of_bits { 0 };
+        };
+
+        Vector<Entry> entries;
+        size_t accuracy_log { 0 };
+    };
+
+    // A table for decoding the Huffman-coded literals, indexed by the next max_number_of_bits bits.
+    struct HuffmanTable {
+        struct Entry {
+            u8 symbol { 0 };
+            u8 number_of_bits { 0 };
+        };
+
+        Vector<Entry> entries;
+        size_t max_number_of_bits { 0 };
+    };
+
+private:
+    enum class State {
+        FrameHeader,
+        Block,
+        Checksum,
+        Finished,
+    };
+
+    ErrorOr<void> read_frame_header();
+    ErrorOr<void> read_block();
+    ErrorOr<void> read_checksum();
+
+    ErrorOr<void> decompress_block(ReadonlyBytes);
+    ErrorOr<size_t> decode_literals(ReadonlyBytes, ReadonlyBytes& literals);
+    ErrorOr<size_t> read_huffman_table(ReadonlyBytes);
+    ErrorOr<void> decode_sequences(ReadonlyBytes, ReadonlyBytes literals);
+    static ErrorOr<size_t> read_sequence_table(FSETable&, u8 mode, ReadonlyBytes, FSETable const& predefined, size_t max_symbol, size_t max_accuracy_log);
+    ErrorOr<void> execute_sequence(ReadonlyBytes literals, size_t& literals_offset, size_t literal_length, size_t match_length, size_t match_offset);
+
+    ErrorOr<void> read_from_input(Bytes);
+    void slide_window();
+
+    InputStream& m_input_stream;
+    State m_state { State::FrameHeader };
+
+    // Per frame.
+    size_t m_window_size { 0 };
+    Optional<u64> m_content_size;
+    bool m_has_checksum { false };
+    Crypto::Checksum::XXHash64 m_checksum;
+    u64 m_frame_output_size { 0 };
+    size_t m_repeated_offsets[3] { 1, 4, 8 };
+    HuffmanTable m_huffman_table;
+    FSETable m_literal_length_table;
+    FSETable m_offset_table;
+    FSETable m_match_length_table;
+
+    // Decompressed data up to m_window_end. Everything before m_output_offset has been handed out already,
+    // and is only kept around as the window that later sequences may copy from.
+    ByteBuffer m_window;
+    size_t m_window_end { 0 };
+    size_t m_output_offset { 0 };
+
+    ByteBuffer m_block;
+    ByteBuffer m_literals;
+};
+
+}
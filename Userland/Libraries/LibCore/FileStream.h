@@ -40,8 +40,15 @@ public:
         if (has_any_error())
             return 0;
 
-        auto const buffer = m_file->read(bytes.size());
-        return buffer.bytes().copy_to(bytes);
+        size_t nread = 0;
+        while (nread < bytes.size()) {
+            auto chunk_size = min(bytes.size() - nread, static_cast<size_t>(NumericLimits<int>::max()));
+            auto nread_from_file = m_file->read(bytes.offset_pointer(nread), static_cast<int>(chunk_size));
+            if (nread_from_file <= 0)
+                break;
+            nread += nread_from_file;
+        }
+        return nread;
     }
 
     bool read_or_error(Bytes bytes) override
@@ -59,7 +66,23 @@ public:
         return m_file->seek(offset, whence);
     }
 
-    bool discard_or_error(size_t count) override { return m_file->seek(count, SeekMode::FromCurrentPosition); }
+    bool discard_or_error(size_t count) override
+    {
+        if (m_file->seek(count, SeekMode::FromCurrentPosition))
+            return true;
+
+        // Pipes and other files that can't seek have to be read through instead.
+        u8 buffer[16 * KiB];
+        while (count > 0) {
+            auto nread = read({ buffer, min(count, sizeof(buffer)) });
+            if (nread == 0) {
+                set_fatal_error();
+                return false;
+            }
+            count -= nread;
+        }
+        return true;
+    }
 
     bool unreliable_eof() const override { return m_file->eof(); }
 
@@ -29,9 +29,25 @@ char const* IODevice::error_string() const
 
 int IODevice::read(u8* buffer, int length)
 {
-    auto read_buffer = read(length);
-    memcpy(buffer, read_buffer.data(), length);
-    return read_buffer.size();
+    if (m_fd < 0 || length <= 0)
+        return 0;
+
+    if (!m_buffered_data.is_empty()) {
+        auto size = min(static_cast<size_t>(length), m_buffered_data.size());
+        memcpy(buffer, m_buffered_data.data(), size);
+        m_buffered_data.remove(0, size);
+        return size;
+    }
+
+    // Nothing is buffered, so read straight into the caller's buffer instead of going through the read buffer.
+    int nread = ::read(m_fd, buffer, length);
+    if (nread < 0) {
+        set_error(errno);
+        return 0;
+    }
+    if (nread == 0)
+        set_eof(true);
+    return nread;
 }
 
 ByteBuffer IODevice::read(size_t max_size)
@@ -150,22 +150,26 @@ public:
     virtual bool is_readable() const override { return m_stream.is_readable(); }
     virtual ErrorOr<Bytes> read(Bytes bytes) override
     {
-        if (m_current_byte.has_value() && is_aligned_to_byte_boundary()) {
-            bytes[0] = m_current_byte.release_value();
-            return m_stream.read(bytes.slice(1));
-        }
         align_to_byte_boundary();
-        return m_stream.read(bytes);
+        size_t nread = 0;
+        while (nread < bytes.size() && m_buffered_bytes > 0) {
+            bytes[nread++] = static_cast<u8>(m_buffer);
+            drop_first_buffered_byte();
+        }
+        auto read_from_stream = TRY(m_stream.read(bytes.slice(nread)));
+        return bytes.trim(nread + read_from_stream.size());
     }
     virtual bool is_writable() const override { return m_stream.is_writable(); }
     virtual ErrorOr<size_t> write(ReadonlyBytes bytes) override { return m_stream.write(bytes); }
     virtual bool write_or_error(ReadonlyBytes bytes) override { return m_stream.write_or_error(bytes); }
-    virtual bool is_eof() const override { return m_stream.is_eof() && !m_current_byte.has_value(); }
+    virtual bool is_eof() const override { return m_stream.is_eof() && m_buffered_bytes == 0; }
     virtual bool is_open() const override { return m_stream.is_open(); }
     virtual void close() override
     {
         m_stream.close();
-        align_to_byte_boundary();
+        m_buffer = 0;
+        m_buffered_bytes = 0;
+        m_bit_offset = 0;
     }
 
     ErrorOr<bool> read_bit()
@@ -181,56 +185,61 @@ public:
         if constexpr (IsSame<bool, T>) {
             VERIFY(count == 1);
         }
-        T result = 0;
+        u64 result = 0;
 
         size_t nread = 0;
         while (nread < count) {
-            if (m_current_byte.has_value()) {
-                if constexpr (!IsSame<bool, T> && !IsSame<u8, T>) {
-                    // read as many bytes as possible directly
-                    if (((count - nread) >= 8) && is_aligned_to_byte_boundary()) {
-                        // shift existing data over
-                        result |= (m_current_byte.value() << nread);
-                        nread += 8;
-                        m_current_byte.clear();
-                    } else {
-                        auto const bit = (m_current_byte.value() >> m_bit_offset) & 1;
-                        result |= (bit << nread);
-                        ++nread;
-                        if (m_bit_offset++ == 7)
-                            m_current_byte.clear();
-                    }
-                } else {
-                    // Always take this branch for booleans or u8: there's no purpose in reading more than a single bit
-                    auto const bit = (m_current_byte.value() >> m_bit_offset) & 1;
-                    if constexpr (IsSame<bool, T>)
-                        result = bit;
-                    else
-                        result |= (bit << nread);
-                    ++nread;
-                    if (m_bit_offset++ == 7)
-                        m_current_byte.clear();
-                }
-            } else {
-                auto temp_buffer = TRY(ByteBuffer::create_uninitialized(1));
-                auto read_bytes = TRY(m_stream.read(temp_buffer.bytes()));
-                if (read_bytes.is_empty())
-                    return Error::from_string_literal("eof");
-                m_current_byte = temp_buffer[0];
-                m_bit_offset = 0;
-            }
+            auto chunk = min<size_t>(count - nread, 32);
+            TRY(ensure_buffered_bits(chunk));
+            result |= (peek_buffered_bits() & ((1ull << chunk) - 1)) << nread;
+            discard_buffered_bits(chunk);
+            nread += chunk;
         }
 
-        return result;
+        return static_cast<T>(result);
+    }
+
+    /// Makes sure that at least `count` (at most 57) bits can be peeked at, reading whole bytes
+    /// from the underlying stream as needed, but never more than that.
+    ALWAYS_INLINE ErrorOr<void> ensure_buffered_bits(size_t count)
+    {
+        VERIFY(count <= 57);
+        while (buffered_bit_count() < count) {
+            u8 byte;
+            auto read_bytes = TRY(m_stream.read({ &byte, sizeof(byte) }));
+            if (read_bytes.is_empty())
+                return Error::from_string_literal("eof");
+            m_buffer |= static_cast<u64>(byte) << (m_buffered_bytes * 8);
+            ++m_buffered_bytes;
+        }
+        return {};
+    }
+
+    ALWAYS_INLINE size_t buffered_bit_count() const { return m_buffered_bytes * 8 - m_bit_offset; }
+
+    /// The buffered bits in stream order; bits past buffered_bit_count() are zero.
+    ALWAYS_INLINE u64 peek_buffered_bits() const { return m_buffer >> m_bit_offset; }
+
+    ALWAYS_INLINE void discard_buffered_bits(size_t count)
+    {
+        VERIFY(count <= buffered_bit_count());
+        m_bit_offset += count;
+        auto whole_bytes = m_bit_offset / 8;
+        if (whole_bytes == 0)
+            return;
+        m_buffer = whole_bytes == 8 ? 0 : m_buffer >> (whole_bytes * 8);
+        m_buffered_bytes -= whole_bytes;
+        m_bit_offset %= 8;
     }
 
     /// Discards any sub-byte stream positioning the input stream may be keeping track of.
     /// Non-bitwise reads will implicitly call this.
     u8 align_to_byte_boundary()
     {
-        u8 remaining_bits = m_current_byte.value_or(0) >> m_bit_offset;
-        m_current_byte.clear();
-        m_bit_offset = 0;
+        if (is_aligned_to_byte_boundary())
+            return 0;
+        u8 remaining_bits = static_cast<u8>(m_buffer) >> m_bit_offset;
+        drop_first_buffered_byte();
         return remaining_bits;
     }
 
@@ -238,7 +247,16 @@ public:
     ALWAYS_INLINE bool is_aligned_to_byte_boundary() const { return m_bit_offset == 0; }
 
 private:
-    Optional<u8> m_current_byte;
+    ALWAYS_INLINE void drop_first_buffered_byte()
+    {
+        m_buffer >>= 8;
+        --m_buffered_bytes;
+        m_bit_offset = 0;
+    }
+
+    /// Up to eight bytes read ahead of the bit position, the first one in the lowest bits.
+    u64 m_buffer { 0 };
+    size_t m_buffered_bytes { 0 };
     size_t m_bit_offset { 0 };
     Stream& m_stream;
 };
@@ -532,6 +532,10 @@ public:
         if (!buffer.size())
             return Error::from_errno(ENOBUFS);
 
+        // Going through the internal buffer would only cost us a copy if the caller wants at least as much as it holds.
+        if (m_buffered_size == 0 && buffer.size() >= m_buffer.size())
+            return read_directly(buffer);
+
         // Fill the internal buffer if it has run dry.
         if (m_buffered_size == 0)
             TRY(populate_read_buffer());
@@ -699,6 +703,20 @@ public:
     }
 
 private:
+    ErrorOr<Bytes> read_directly(Bytes buffer)
+    {
+        do {
+            auto result = stream().read(buffer);
+            if (result.is_error() && result.error().is_errno()) {
+                if (result.error().code() == EINTR)
+                    continue;
+                if (result.error().code() == EAGAIN)
+                    return Bytes {};
+            }
+            return result;
+        } while (true);
+    }
+
     ErrorOr<ReadonlyBytes> populate_read_buffer()
     {
         if (m_buffered_size == m_buffer.size())
@@ -10,217 +10,317 @@
 
 namespace Crypto::Authentication {
 
+static u64 read_u64(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load64(data));
+}
+
+static u32 read_u32(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+// The arithmetic follows poly1305-donna: every block is added to the accumulator, which is then multiplied by r,
+// all modulo 2^130 - 5. As 2^130 = 5 (mod 2^130 - 5), the parts of a product above 2^130 are multiplied by 5 and
+// folded back into the lower limbs.
+#ifdef __SIZEOF_INT128__
+using DoubleWord = unsigned __int128;
+
+static constexpr u64 mask_44_bits = (1ull << 44) - 1;
+static constexpr u64 mask_42_bits = (1ull << 42) - 1;
+
 Poly1305::Poly1305(ReadonlyBytes key)
 {
-    for (size_t i = 0; i < 16; i += 4) {
-        m_state.r[i / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(key.offset(i)));
-    }
+    auto t0 = read_u64(key.offset(0));
+    auto t1 = read_u64(key.offset(8));
 
     // r[3], r[7], r[11], and r[15] are required to have their top four bits clear (be smaller than 16)
     // r[4], r[8], and r[12] are required to have their bottom two bits clear (be divisible by 4)
-    m_state.r[0] &= 0x0FFFFFFF;
-    m_state.r[1] &= 0x0FFFFFFC;
-    m_state.r[2] &= 0x0FFFFFFC;
-    m_state.r[3] &= 0x0FFFFFFC;
+    m_state.r[0] = t0 & 0xffc0fffffff;
+    m_state.r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+    m_state.r[2] = (t1 >> 24) & 0x00ffffffc0f;
 
-    for (size_t i = 16; i < 32; i += 4) {
-        m_state.s[(i - 16) / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(key.offset(i)));
-    }
+    for (size_t i = 0; i < 4; ++i)
+        m_state.s[i] = read_u32(key.offset(16 + i * 4));
 }
 
-void Poly1305::update(ReadonlyBytes message)
+void Poly1305::process_blocks(u8 const* data, size_t block_count, bool is_last_partial_block)
 {
-    size_t offset = 0;
-    while (offset < message.size()) {
-        u32 n = min(message.size() - offset, 16 - m_state.block_count);
-        memcpy(m_state.blocks + m_state.block_count, message.offset_pointer(offset), n);
-        m_state.block_count += n;
-        offset += n;
-
-        if (m_state.block_count == 16) {
-            process_block();
-            m_state.block_count = 0;
-        }
+    // Add one bit beyond the number of octets. The last partial block has its 0x01 byte added already.
+    u64 high_bit = is_last_partial_block ? 0 : 1ull << 40;
+
+    auto r0 = m_state.r[0];
+    auto r1 = m_state.r[1];
+    auto r2 = m_state.r[2];
+    auto s1 = r1 * (5 << 2);
+    auto s2 = r2 * (5 << 2);
+
+    auto h0 = m_state.h[0];
+    auto h1 = m_state.h[1];
+    auto h2 = m_state.h[2];
+
+    for (size_t block = 0; block < block_count; ++block, data += 16) {
+        auto t0 = read_u64(data);
+        auto t1 = read_u64(data + 8);
+
+        h0 += t0 & mask_44_bits;
+        h1 += ((t0 >> 44) | (t1 << 20)) & mask_44_bits;
+        h2 += ((t1 >> 24) & mask_42_bits) | high_bit;
+
+        DoubleWord d0 = (DoubleWord)h0 * r0 + (DoubleWord)h1 * s2 + (DoubleWord)h2 * s1;
+        DoubleWord d1 = (DoubleWord)h0 * r1 + (DoubleWord)h1 * r0 + (DoubleWord)h2 * s2;
+        DoubleWord d2 = (DoubleWord)h0 * r2 + (DoubleWord)h1 * r1 + (DoubleWord)h2 * r0;
+
+        u64 carry = (u64)(d0 >> 44);
+        h0 = (u64)d0 & mask_44_bits;
+        d1 += carry;
+        carry = (u64)(d1 >> 44);
+        h1 = (u64)d1 & mask_44_bits;
+        d2 += carry;
+        carry = (u64)(d2 >> 42);
+        h2 = (u64)d2 & mask_42_bits;
+        h0 += carry * 5;
+        carry = h0 >> 44;
+        h0 &= mask_44_bits;
+        h1 += carry;
     }
+
+    m_state.h[0] = h0;
+    m_state.h[1] = h1;
+    m_state.h[2] = h2;
 }
 
-void Poly1305::process_block()
+ErrorOr<ByteBuffer> Poly1305::digest()
 {
-    u32 a[5];
-    u8 n = m_state.block_count;
-
-    // Add one bit beyond the number of octets.  For a 16-byte block,
-    // this is equivalent to adding 2^128 to the number.  For the shorter
-    // block, it can be 2^120, 2^112, or any power of two that is evenly
-    // divisible by 8, all the way down to 2^8.
-    m_state.blocks[n++] = 0x01;
-
-    // If the block is not 17 bytes long (the last block), pad it with zeros.
-    // This is meaningless if you are treating the blocks as numbers.
-    while (n < 17) {
-        m_state.blocks[n++] = 0x00;
+    if (m_state.block_count != 0) {
+        m_state.blocks[m_state.block_count] = 0x01;
+        __builtin_memset(m_state.blocks + m_state.block_count + 1, 0, 16 - m_state.block_count - 1);
+        process_blocks(m_state.blocks, 1, true);
     }
 
-    // Read the block as a little-endian number.
-    for (size_t i = 0; i < 16; i += 4) {
-        a[i / 4] = AK::convert_between_host_and_little_endian(ByteReader::load32(m_state.blocks + i));
-    }
-    a[4] = m_state.blocks[16];
-
-    // Add this number to the accumulator.
-    m_state.a[0] += a[0];
-    m_state.a[1] += a[1];
-    m_state.a[2] += a[2];
-    m_state.a[3] += a[3];
-    m_state.a[4] += a[4];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    a[0] = m_state.a[0] & 0xFFFFFFFF;
-    a[1] = m_state.a[1] & 0xFFFFFFFF;
-    a[2] = m_state.a[2] & 0xFFFFFFFF;
-    a[3] = m_state.a[3] & 0xFFFFFFFF;
-    a[4] = m_state.a[4] & 0xFFFFFFFF;
-
-    // Multiply by r
-    m_state.a[0] = (u64)a[0] * m_state.r[0];
-    m_state.a[1] = (u64)a[0] * m_state.r[1] + (u64)a[1] * m_state.r[0];
-    m_state.a[2] = (u64)a[0] * m_state.r[2] + (u64)a[1] * m_state.r[1] + (u64)a[2] * m_state.r[0];
-    m_state.a[3] = (u64)a[0] * m_state.r[3] + (u64)a[1] * m_state.r[2] + (u64)a[2] * m_state.r[1] + (u64)a[3] * m_state.r[0];
-    m_state.a[4] = (u64)a[1] * m_state.r[3] + (u64)a[2] * m_state.r[2] + (u64)a[3] * m_state.r[1] + (u64)a[4] * m_state.r[0];
-    m_state.a[5] = (u64)a[2] * m_state.r[3] + (u64)a[3] * m_state.r[2] + (u64)a[4] * m_state.r[1];
-    m_state.a[6] = (u64)a[3] * m_state.r[3] + (u64)a[4] * m_state.r[2];
-    m_state.a[7] = (u64)a[4] * m_state.r[3];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-    m_state.a[5] += m_state.a[4] >> 32;
-    m_state.a[6] += m_state.a[5] >> 32;
-    m_state.a[7] += m_state.a[6] >> 32;
-
-    // Save the high part of the accumulator
-    a[0] = m_state.a[4] & 0xFFFFFFFC;
-    a[1] = m_state.a[5] & 0xFFFFFFFF;
-    a[2] = m_state.a[6] & 0xFFFFFFFF;
-    a[3] = m_state.a[7] & 0xFFFFFFFF;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
-
-    // Fast modular reduction (first pass)
-    m_state.a[0] += a[0];
-    m_state.a[0] += (a[0] >> 2) | (a[1] << 30);
-    m_state.a[1] += a[1];
-    m_state.a[1] += (a[1] >> 2) | (a[2] << 30);
-    m_state.a[2] += a[2];
-    m_state.a[2] += (a[2] >> 2) | (a[3] << 30);
-    m_state.a[3] += a[3];
-    m_state.a[3] += (a[3] >> 2);
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Save the high part of the accumulator
-    a[0] = m_state.a[4] & 0xFFFFFFFC;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
-
-    // Fast modular reduction (second pass)
-    m_state.a[0] += a[0];
-    m_state.a[0] += a[0] >> 2;
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    m_state.a[0] &= 0xFFFFFFFF;
-    m_state.a[1] &= 0xFFFFFFFF;
-    m_state.a[2] &= 0xFFFFFFFF;
-    m_state.a[3] &= 0xFFFFFFFF;
-    m_state.a[4] &= 0x00000003;
+    auto h0 = m_state.h[0];
+    auto h1 = m_state.h[1];
+    auto h2 = m_state.h[2];
+
+    // Fully carry h.
+    u64 carry = h1 >> 44;
+    h1 &= mask_44_bits;
+    h2 += carry;
+    carry = h2 >> 42;
+    h2 &= mask_42_bits;
+    h0 += carry * 5;
+    carry = h0 >> 44;
+    h0 &= mask_44_bits;
+    h1 += carry;
+    carry = h1 >> 44;
+    h1 &= mask_44_bits;
+    h2 += carry;
+    carry = h2 >> 42;
+    h2 &= mask_42_bits;
+    h0 += carry * 5;
+    carry = h0 >> 44;
+    h0 &= mask_44_bits;
+    h1 += carry;
+
+    // Compute h + -p, and select it if it doesn't underflow, without branching.
+    u64 g0 = h0 + 5;
+    carry = g0 >> 44;
+    g0 &= mask_44_bits;
+    u64 g1 = h1 + carry;
+    carry = g1 >> 44;
+    g1 &= mask_44_bits;
+    u64 g2 = h2 + carry - (1ull << 42);
+
+    u64 mask = (g2 >> 63) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+
+    // Finally, the value of the secret key "s" is added to the accumulator,
+    // and the 128 least significant bits are serialized in little-endian
+    // order to form the tag.
+    u64 t0 = m_state.s[0] | ((u64)m_state.s[1] << 32);
+    u64 t1 = m_state.s[2] | ((u64)m_state.s[3] << 32);
+
+    h0 += t0 & mask_44_bits;
+    carry = h0 >> 44;
+    h0 &= mask_44_bits;
+    h1 += (((t0 >> 44) | (t1 << 20)) & mask_44_bits) + carry;
+    carry = h1 >> 44;
+    h1 &= mask_44_bits;
+    h2 += ((t1 >> 24) & mask_42_bits) + carry;
+    h2 &= mask_42_bits;
+
+    u64 tag[2] {
+        AK::convert_between_host_and_little_endian(h0 | (h1 << 44)),
+        AK::convert_between_host_and_little_endian((h1 >> 20) | (h2 << 24)),
+    };
+
+    return ByteBuffer::copy(tag, sizeof(tag));
 }
+#else
+static constexpr u32 mask_26_bits = (1u << 26) - 1;
 
-ErrorOr<ByteBuffer> Poly1305::digest()
+Poly1305::Poly1305(ReadonlyBytes key)
 {
-    if (m_state.block_count != 0)
-        process_block();
-
-    u32 b[4];
-
-    // Save the accumulator
-    b[0] = m_state.a[0] & 0xFFFFFFFF;
-    b[1] = m_state.a[1] & 0xFFFFFFFF;
-    b[2] = m_state.a[2] & 0xFFFFFFFF;
-    b[3] = m_state.a[3] & 0xFFFFFFFF;
+    // r[3], r[7], r[11], and r[15] are required to have their top four bits clear (be smaller than 16)
+    // r[4], r[8], and r[12] are required to have their bottom two bits clear (be divisible by 4)
+    m_state.r[0] = read_u32(key.offset(0)) & 0x3ffffff;
+    m_state.r[1] = (read_u32(key.offset(3)) >> 2) & 0x3ffff03;
+    m_state.r[2] = (read_u32(key.offset(6)) >> 4) & 0x3ffc0ff;
+    m_state.r[3] = (read_u32(key.offset(9)) >> 6) & 0x3f03fff;
+    m_state.r[4] = (read_u32(key.offset(12)) >> 8) & 0x00fffff;
+
+    for (size_t i = 0; i < 4; ++i)
+        m_state.s[i] = read_u32(key.offset(16 + i * 4));
+}
 
-    // Compute a + 5
-    m_state.a[0] += 5;
+void Poly1305::process_blocks(u8 const* data, size_t block_count, bool is_last_partial_block)
+{
+    // Add one bit beyond the number of octets. The last partial block has its 0x01 byte added already.
+    u32 high_bit = is_last_partial_block ? 0 : 1u << 24;
+
+    u32 r0 = m_state.r[0], r1 = m_state.r[1], r2 = m_state.r[2], r3 = m_state.r[3], r4 = m_state.r[4];
+    u32 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    u32 h0 = m_state.h[0], h1 = m_state.h[1], h2 = m_state.h[2], h3 = m_state.h[3], h4 = m_state.h[4];
+
+    for (size_t block = 0; block < block_count; ++block, data += 16) {
+        h0 += read_u32(data) & mask_26_bits;
+        h1 += (read_u32(data + 3) >> 2) & mask_26_bits;
+        h2 += (read_u32(data + 6) >> 4) & mask_26_bits;
+        h3 += (read_u32(data + 9) >> 6) & mask_26_bits;
+        h4 += (read_u32(data + 12) >> 8) | high_bit;
+
+        u64 d0 = (u64)h0 * r0 + (u64)h1 * s4 + (u64)h2 * s3 + (u64)h3 * s2 + (u64)h4 * s1;
+        u64 d1 = (u64)h0 * r1 + (u64)h1 * r0 + (u64)h2 * s4 + (u64)h3 * s3 + (u64)h4 * s2;
+        u64 d2 = (u64)h0 * r2 + (u64)h1 * r1 + (u64)h2 * r0 + (u64)h3 * s4 + (u64)h4 * s3;
+        u64 d3 = (u64)h0 * r3 + (u64)h1 * r2 + (u64)h2 * r1 + (u64)h3 * r0 + (u64)h4 * s4;
+        u64 d4 = (u64)h0 * r4 + (u64)h1 * r3 + (u64)h2 * r2 + (u64)h3 * r1 + (u64)h4 * r0;
+
+        u32 carry = (u32)(d0 >> 26);
+        h0 = (u32)d0 & mask_26_bits;
+        d1 += carry;
+        carry = (u32)(d1 >> 26);
+        h1 = (u32)d1 & mask_26_bits;
+        d2 += carry;
+        carry = (u32)(d2 >> 26);
+        h2 = (u32)d2 & mask_26_bits;
+        d3 += carry;
+        carry = (u32)(d3 >> 26);
+        h3 = (u32)d3 & mask_26_bits;
+        d4 += carry;
+        carry = (u32)(d4 >> 26);
+        h4 = (u32)d4 & mask_26_bits;
+        h0 += carry * 5;
+        carry = h0 >> 26;
+        h0 &= mask_26_bits;
+        h1 += carry;
+    }
 
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
+    m_state.h[0] = h0;
+    m_state.h[1] = h1;
+    m_state.h[2] = h2;
+    m_state.h[3] = h3;
+    m_state.h[4] = h4;
+}
 
-    // Select mask based on (a + 5) >= 2^130
-    u32 mask = ((m_state.a[4] & 0x04) >> 2) - 1;
+ErrorOr<ByteBuffer> Poly1305::digest()
+{
+    if (m_state.block_count != 0) {
+        m_state.blocks[m_state.block_count] = 0x01;
+        __builtin_memset(m_state.blocks + m_state.block_count + 1, 0, 16 - m_state.block_count - 1);
+        process_blocks(m_state.blocks, 1, true);
+    }
 
-    // Select based on mask
-    m_state.a[0] = (m_state.a[0] & ~mask) | (b[0] & mask);
-    m_state.a[1] = (m_state.a[1] & ~mask) | (b[1] & mask);
-    m_state.a[2] = (m_state.a[2] & ~mask) | (b[2] & mask);
-    m_state.a[3] = (m_state.a[3] & ~mask) | (b[3] & mask);
+    u32 h0 = m_state.h[0], h1 = m_state.h[1], h2 = m_state.h[2], h3 = m_state.h[3], h4 = m_state.h[4];
+
+    // Fully carry h.
+    u32 carry = h1 >> 26;
+    h1 &= mask_26_bits;
+    h2 += carry;
+    carry = h2 >> 26;
+    h2 &= mask_26_bits;
+    h3 += carry;
+    carry = h3 >> 26;
+    h3 &= mask_26_bits;
+    h4 += carry;
+    carry = h4 >> 26;
+    h4 &= mask_26_bits;
+    h0 += carry * 5;
+    carry = h0 >> 26;
+    h0 &= mask_26_bits;
+    h1 += carry;
+
+    // Compute h + -p, and select it if it doesn't underflow, without branching.
+    u32 g0 = h0 + 5;
+    carry = g0 >> 26;
+    g0 &= mask_26_bits;
+    u32 g1 = h1 + carry;
+    carry = g1 >> 26;
+    g1 &= mask_26_bits;
+    u32 g2 = h2 + carry;
+    carry = g2 >> 26;
+    g2 &= mask_26_bits;
+    u32 g3 = h3 + carry;
+    carry = g3 >> 26;
+    g3 &= mask_26_bits;
+    u32 g4 = h4 + carry - (1u << 26);
+
+    u32 mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // Pack h into 32-bit words.
+    u32 words[4] {
+        h0 | (h1 << 26),
+        (h1 >> 6) | (h2 << 20),
+        (h2 >> 12) | (h3 << 14),
+        (h3 >> 18) | (h4 << 8),
+    };
 
     // Finally, the value of the secret key "s" is added to the accumulator,
     // and the 128 least significant bits are serialized in little-endian
     // order to form the tag.
-    m_state.a[0] += m_state.s[0];
-    m_state.a[1] += m_state.s[1];
-    m_state.a[2] += m_state.s[2];
-    m_state.a[3] += m_state.s[3];
-
-    // Carry
-    m_state.a[1] += m_state.a[0] >> 32;
-    m_state.a[2] += m_state.a[1] >> 32;
-    m_state.a[3] += m_state.a[2] >> 32;
-    m_state.a[4] += m_state.a[3] >> 32;
-
-    // Only consider the least significant bits
-    b[0] = m_state.a[0] & 0xFFFFFFFF;
-    b[1] = m_state.a[1] & 0xFFFFFFFF;
-    b[2] = m_state.a[2] & 0xFFFFFFFF;
-    b[3] = m_state.a[3] & 0xFFFFFFFF;
-
-    ByteBuffer output = TRY(ByteBuffer::create_uninitialized(16));
-
-    for (auto i = 0; i < 4; i++) {
-        ByteReader::store(output.offset_pointer(i * 4), AK::convert_between_host_and_little_endian(b[i]));
+    u64 sum = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        sum += (u64)words[i] + m_state.s[i];
+        words[i] = AK::convert_between_host_and_little_endian((u32)sum);
+        sum >>= 32;
     }
 
-    return output;
+    return ByteBuffer::copy(words, sizeof(words));
+}
+#endif
+
+void Poly1305::update(ReadonlyBytes message)
+{
+    auto const* data = message.data();
+    auto size = message.size();
+
+    if (m_state.block_count != 0) {
+        auto n = min(size, 16 - m_state.block_count);
+        __builtin_memcpy(m_state.blocks + m_state.block_count, data, n);
+        m_state.block_count += n;
+        data += n;
+        size -= n;
+
+        if (m_state.block_count < 16)
+            return;
+        process_blocks(m_state.blocks, 1);
+        m_state.block_count = 0;
+    }
+
+    // Whole blocks are read straight from the message, with the accumulator kept in registers in between.
+    auto block_count = size / 16;
+    process_blocks(data, block_count);
+    data += block_count * 16;
+    size -= block_count * 16;
+
+    __builtin_memcpy(m_state.blocks, data, size);
+    m_state.block_count = size;
 }
 
 }
@@ -10,11 +10,13 @@
 
 namespace Crypto::Authentication {
 
+// The key r and the accumulator h are kept in 44-bit limbs where 64-bit multiplication results can be widened
+// to 128 bits, and in 26-bit limbs otherwise.
 struct State {
-    u32 r[4] {};
+    u64 r[5] {};
+    u64 h[5] {};
     u32 s[4] {};
-    u64 a[8] {};
-    u8 blocks[17] {};
+    u8 blocks[16] {};
     u8 block_count {};
 };
 
@@ -26,7 +28,7 @@ public:
     ErrorOr<ByteBuffer> digest();
 
 private:
-    void process_block();
+    void process_blocks(u8 const* data, size_t block_count, bool is_last_partial_block = false);
 
     State m_state;
 };
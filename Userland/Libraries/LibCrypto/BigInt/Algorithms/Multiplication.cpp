@@ -1,6 +1,7 @@
 /*
  * Copyright (c) 2020, Itamar S. <itamar8910@gmail.com>
  * Copyright (c) 2020-2021, Dex♪ <dexes.ttp@gmail.com>
+ * Copyright (c) 2022, the SerenityOS developers.
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
@@ -9,38 +10,244 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+using DoubleWord = u64;
+static_assert(sizeof(DoubleWord) == 2 * sizeof(Word));
+
+// Below this many words, the quadratic algorithms beat Karatsuba's extra additions.
+static constexpr size_t karatsuba_threshold = 32;
+
+// Adds value into accumulator, which must be at least as long, and returns the carry out of the accumulator.
+static Word add_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    Word carry = 0;
+    for (size_t i = 0; i < value_length; ++i) {
+        DoubleWord sum = static_cast<DoubleWord>(accumulator[i]) + value[i] + carry;
+        accumulator[i] = static_cast<Word>(sum);
+        carry = static_cast<Word>(sum >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+    for (size_t i = value_length; carry && i < accumulator_length; ++i) {
+        accumulator[i] += carry;
+        carry = accumulator[i] == 0 ? 1 : 0;
+    }
+    return carry;
+}
+
+// Subtracts value from accumulator, which must be at least as long and hold the larger number.
+static void subtract_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    Word borrow = 0;
+    for (size_t i = 0; i < value_length; ++i) {
+        DoubleWord difference = static_cast<DoubleWord>(accumulator[i]) - value[i] - borrow;
+        accumulator[i] = static_cast<Word>(difference);
+        borrow = (difference >> UnsignedBigInteger::BITS_IN_WORD) ? 1 : 0;
+    }
+    for (size_t i = value_length; borrow && i < accumulator_length; ++i) {
+        borrow = accumulator[i] == 0 ? 1 : 0;
+        accumulator[i] -= 1;
+    }
+    VERIFY(!borrow);
+}
+
+/**
+ * Complexity: O(N*M) where N and M are the number of words in each number
+ * Schoolbook multiplication, one word of `left` at a time.
+ * Writes left_length + right_length words to output.
+ */
+static void multiply_words(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    for (size_t i = 0; i < left_length; ++i) {
+        DoubleWord left_word = left[i];
+        if (left_word == 0)
+            continue;
+        // left_word * right[j] + output[i + j] + carry always fits in a DoubleWord.
+        DoubleWord carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            DoubleWord product = left_word * right[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right_length] = static_cast<Word>(carry);
+    }
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^2) where N is the number of words in the number, with about half the multiplications
+ * Every cross product value[i] * value[j] appears twice in the square, so it is only computed once and
+ * doubled, before the products value[i] * value[i] on the diagonal are added.
+ * Writes 2 * length words to output.
+ */
+static void square_words(Word const* value, size_t length, Word* output)
+{
+    __builtin_memset(output, 0, 2 * length * sizeof(Word));
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord word = value[i];
+        DoubleWord carry = 0;
+        for (size_t j = i + 1; j < length; ++j) {
+            DoubleWord product = word * value[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + length] = static_cast<Word>(carry);
+    }
+
+    Word shifted_out = 0;
+    for (size_t i = 0; i < 2 * length; ++i) {
+        Word word = output[i];
+        output[i] = (word << 1) | shifted_out;
+        shifted_out = word >> (UnsignedBigInteger::BITS_IN_WORD - 1);
+    }
+
+    Word carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        DoubleWord square = static_cast<DoubleWord>(value[i]) * value[i] + output[2 * i] + carry;
+        output[2 * i] = static_cast<Word>(square);
+        DoubleWord high = (square >> UnsignedBigInteger::BITS_IN_WORD) + output[2 * i + 1];
+        output[2 * i + 1] = static_cast<Word>(high);
+        carry = static_cast<Word>(high >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+}
+
+// The scratch space karatsuba_multiply_words() needs for operands of the given length.
+static size_t karatsuba_scratch_size(size_t length)
+{
+    if (length < karatsuba_threshold)
+        return 0;
+    auto high_length = length - length / 2;
+    return 4 * (high_length + 1) + karatsuba_scratch_size(high_length + 1);
+}
+
+/**
+ * Complexity: O(N^1.585) where N is the number of words in each number
+ * Splitting both numbers into a low and a high half, left * right is
+ *     (left_high * right_high) << 2h + ((left_low + left_high) * (right_low + right_high) - left_low * right_low - left_high * right_high) << h + left_low * right_low
+ * which only takes three multiplications of half the size.
+ * Both numbers have `length` words; `left == right` squares. Writes 2 * length words to output.
+ */
+static void karatsuba_multiply_words(Word const* left, Word const* right, size_t length, Word* output, Word* scratch)
+{
+    bool squaring = left == right;
+    if (length < karatsuba_threshold) {
+        if (squaring)
+            square_words(left, length, output);
+        else
+            multiply_words(left, length, right, length, output);
+        return;
+    }
+
+    auto low_length = length / 2;
+    auto high_length = length - low_length;
+
+    // low * low goes into the lower half of the output, high * high into the upper half.
+    karatsuba_multiply_words(left, right, low_length, output, scratch);
+    karatsuba_multiply_words(left + low_length, right + low_length, high_length, output + 2 * low_length, scratch);
+
+    // Lay out scratch as [left sum][right sum][middle product][scratch for the middle product].
+    auto sum_length = high_length + 1;
+    auto* left_sum = scratch;
+    auto* right_sum = scratch + sum_length;
+    auto* middle = scratch + 2 * sum_length;
+    auto* remaining_scratch = scratch + 4 * sum_length;
+
+    __builtin_memcpy(left_sum, left + low_length, high_length * sizeof(Word));
+    left_sum[high_length] = add_words(left_sum, high_length, left, low_length);
+    if (!squaring) {
+        __builtin_memcpy(right_sum, right + low_length, high_length * sizeof(Word));
+        right_sum[high_length] = add_words(right_sum, high_length, right, low_length);
+    }
+
+    karatsuba_multiply_words(left_sum, squaring ? left_sum : right_sum, sum_length, middle, remaining_scratch);
+
+    subtract_words(middle, 2 * sum_length, output, 2 * low_length);
+    subtract_words(middle, 2 * sum_length, output + 2 * low_length, 2 * high_length);
+
+    // The carry out of the top can only be zero, since the product fits into the output.
+    add_words(output + low_length, 2 * length - low_length, middle, 2 * sum_length);
+}
+
+/**
+ * Complexity: O(N * M^0.585) where N is the number of words in the longer number, and M in the shorter one
+ * Numbers of very different lengths are multiplied one piece of the longer number at a time.
+ */
+static void multiply_words_with_scratch(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output, Word* scratch)
+{
+    if (left_length < right_length) {
+        swap(left, right);
+        swap(left_length, right_length);
+    }
+
+    if (right_length < karatsuba_threshold) {
+        if (left == right && left_length == right_length)
+            square_words(left, left_length, output);
+        else
+            multiply_words(left, left_length, right, right_length, output);
+        return;
+    }
+
+    if (left_length == right_length) {
+        karatsuba_multiply_words(left, right, left_length, output, scratch);
+        return;
+    }
+
+    // Lay out scratch as [piece product][scratch for the piece product].
+    auto* piece_product = scratch;
+    auto* remaining_scratch = scratch + 2 * right_length;
+
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    for (size_t offset = 0; offset < left_length; offset += right_length) {
+        auto piece_length = min(right_length, left_length - offset);
+        if (piece_length == right_length)
+            karatsuba_multiply_words(left + offset, right, right_length, piece_product, remaining_scratch);
+        else
+            multiply_words_with_scratch(left + offset, piece_length, right, right_length, piece_product, remaining_scratch);
+        add_words(output + offset, left_length + right_length - offset, piece_product, piece_length + right_length);
+    }
+}
+
+static size_t multiplication_scratch_size(size_t left_length, size_t right_length)
+{
+    auto shorter_length = min(left_length, right_length);
+    if (shorter_length < karatsuba_threshold)
+        return 0;
+    if (left_length == right_length)
+        return karatsuba_scratch_size(shorter_length);
+    return 2 * shorter_length + max(karatsuba_scratch_size(shorter_length), multiplication_scratch_size(shorter_length, max(left_length, right_length) % shorter_length));
+}
+
+/**
+ * Complexity: O(N^1.585) where N is the number of words in the larger number
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Word by word schoolbook multiplication for small numbers, and Karatsuba multiplication once both numbers
+ * have at least karatsuba_threshold words. Squaring takes its own path, as only half the products are needed.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
     UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    [[maybe_unused]] UnsignedBigInteger& temp_shift_plus,
+    [[maybe_unused]] UnsignedBigInteger& temp_shift,
     UnsignedBigInteger& output)
 {
+    VERIFY(&output != &left && &output != &right);
+
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+
     output.set_to_0();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    // The Karatsuba multiplication keeps its intermediate results in here.
+    auto& scratch = temp_shift_result;
+    scratch.set_to_0();
+    scratch.resize_with_leading_zeros(multiplication_scratch_size(left_length, right_length));
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    output.resize_with_leading_zeros(left_length + right_length);
+    multiply_words_with_scratch(left.m_words.data(), left_length, right.m_words.data(), right_length, output.m_words.data(), scratch.m_words.data());
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+    if (output.m_words.last() == 0)
+        output.m_words.resize_and_keep_capacity(output.length() - 1);
 }
 
 }
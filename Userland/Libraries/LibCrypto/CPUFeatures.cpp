@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <LibCrypto/CPUFeatures.h>
+
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+static CPUFeatures detect_cpu_features()
+{
+    CPUFeatures features;
+#if ARCH(X86_64)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        features.aes_ni = (ecx & bit_AES) != 0;
+        features.pclmul = (ecx & bit_PCLMUL) != 0;
+        features.ssse3 = (ecx & bit_SSSE3) != 0;
+        features.sse4_1 = (ecx & bit_SSE4_1) != 0;
+
+        // The 256-bit registers are only usable if the OS saves them on context switches.
+        bool os_saves_ymm_registers = false;
+        if ((ecx & bit_OSXSAVE) != 0) {
+            u32 xcr0_low, xcr0_high;
+            asm volatile("xgetbv"
+                         : "=a"(xcr0_low), "=d"(xcr0_high)
+                         : "c"(0));
+            os_saves_ymm_registers = (xcr0_low & 0b110) == 0b110;
+        }
+
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            features.sha = (ebx & bit_SHA) != 0;
+            features.avx2 = (ebx & bit_AVX2) != 0 && os_saves_ymm_registers;
+        }
+    }
+#endif
+    return features;
+}
+
+CPUFeatures const& cpu_features()
+{
+    static CPUFeatures const features = detect_cpu_features();
+    return features;
+}
+
+}
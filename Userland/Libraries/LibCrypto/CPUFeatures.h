@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+
+namespace Crypto {
+
+// The instruction set extensions that the accelerated algorithms may use, as reported by the CPU.
+// They are queried once, and are all false on other architectures.
+//
+// Code that is compiled both with and without AVX, like the algorithms that run in the lanes of u32x4 and u32x8
+// vectors, spells out its vector operations instead of calling helpers that take or return vectors. Such helpers
+// would have a different calling convention with and without AVX, which GCC warns about.
+struct CPUFeatures {
+    bool aes_ni { false };
+    bool pclmul { false };
+    bool ssse3 { false };
+    bool sse4_1 { false };
+    bool sha { false };
+    bool avx2 { false };
+};
+
+CPUFeatures const& cpu_features();
+
+}
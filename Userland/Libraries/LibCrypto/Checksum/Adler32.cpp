@@ -4,17 +4,92 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/SIMD.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
 namespace Crypto::Checksum {
 
+static constexpr u32 modulus = 65521;
+
+// The largest number of bytes that can be summed before b may overflow a u32, see zlib's NMAX.
+static constexpr size_t max_bytes_between_reductions = 5552;
+
+static constexpr size_t block_size = 16;
+
+using AK::SIMD::u16x8;
+using AK::SIMD::u32x4;
+using AK::SIMD::u8x16;
+
+// Zero-extends the 16 bytes at `data` into four vectors of four u32s each, by interleaving them with zeroes.
+static ALWAYS_INLINE void load_widened(u8 const* data, u32x4& first, u32x4& second, u32x4& third, u32x4& fourth)
+{
+    u8x16 bytes;
+    __builtin_memcpy(&bytes, data, sizeof(bytes));
+
+    u8x16 const zero_bytes {};
+    auto low = (u16x8)__builtin_shufflevector(bytes, zero_bytes, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    auto high = (u16x8)__builtin_shufflevector(bytes, zero_bytes, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+    u16x8 const zero_words {};
+    first = (u32x4)__builtin_shufflevector(low, zero_words, 0, 8, 1, 9, 2, 10, 3, 11);
+    second = (u32x4)__builtin_shufflevector(low, zero_words, 4, 12, 5, 13, 6, 14, 7, 15);
+    third = (u32x4)__builtin_shufflevector(high, zero_words, 0, 8, 1, 9, 2, 10, 3, 11);
+    fourth = (u32x4)__builtin_shufflevector(high, zero_words, 4, 12, 5, 13, 6, 14, 7, 15);
+}
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    auto const* bytes = data.data();
+    auto size = data.size();
+
+    while (size > 0) {
+        auto chunk_size = min(size, max_bytes_between_reductions);
+        auto blocks = chunk_size / block_size;
+        size -= chunk_size;
+
+        if (blocks > 0) {
+            // Every lane of `sums` adds up the bytes at one position within the blocks, and every lane of
+            // `prefix_sums` adds up `sums` as it was before each block. That is enough to recover b, since every
+            // byte is added to b once for itself and once for every byte position that follows it.
+            u32x4 sums[4] {};
+            u32x4 prefix_sums {};
+            for (size_t block = 0; block < blocks; ++block) {
+                prefix_sums += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+                u32x4 first, second, third, fourth;
+                load_widened(bytes, first, second, third, fourth);
+                sums[0] += first;
+                sums[1] += second;
+                sums[2] += third;
+                sums[3] += fourth;
+                bytes += block_size;
+            }
+
+            u64 sum = 0;
+            u64 weighted_sum = 0;
+            u64 prefix_sum = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                prefix_sum += prefix_sums[i];
+                for (size_t j = 0; j < 4; ++j) {
+                    sum += sums[i][j];
+                    weighted_sum += static_cast<u64>(block_size - i * 4 - j) * sums[i][j];
+                }
+            }
+
+            auto byte_count = blocks * block_size;
+            m_state_b = (m_state_b + byte_count * m_state_a + block_size * prefix_sum + weighted_sum) % modulus;
+            m_state_a = (m_state_a + sum) % modulus;
+            chunk_size -= byte_count;
+        }
+
+        for (size_t i = 0; i < chunk_size; i++) {
+            m_state_a += bytes[i];
+            m_state_b += m_state_a;
+        }
+        bytes += chunk_size;
+        m_state_a %= modulus;
+        m_state_b %= modulus;
     }
 };
 
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Checksum/XXHash64.h>
+#include <string.h>
+
+namespace Crypto::Checksum {
+
+static constexpr u64 prime_1 = 0x9E3779B185EBCA87ull;
+static constexpr u64 prime_2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr u64 prime_3 = 0x165667B19E3779F9ull;
+static constexpr u64 prime_4 = 0x85EBCA77C2B2AE63ull;
+static constexpr u64 prime_5 = 0x27D4EB2F165667C5ull;
+
+static constexpr u64 rotate_left(u64 value, size_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static u64 read_u64(u8 const* data)
+{
+    u64 value;
+    ByteReader::load(data, value);
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+static u32 read_u32(u8 const* data)
+{
+    u32 value;
+    ByteReader::load(data, value);
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+static constexpr u64 round(u64 accumulator, u64 input)
+{
+    accumulator += input * prime_2;
+    accumulator = rotate_left(accumulator, 31);
+    return accumulator * prime_1;
+}
+
+static constexpr u64 merge_round(u64 hash, u64 accumulator)
+{
+    hash ^= round(0, accumulator);
+    return hash * prime_1 + prime_4;
+}
+
+void XXHash64::reset_accumulators()
+{
+    m_accumulators[0] = m_seed + prime_1 + prime_2;
+    m_accumulators[1] = m_seed + prime_2;
+    m_accumulators[2] = m_seed;
+    m_accumulators[3] = m_seed - prime_1;
+}
+
+void XXHash64::consume_stripe(u8 const* stripe)
+{
+    for (size_t i = 0; i < 4; ++i)
+        m_accumulators[i] = round(m_accumulators[i], read_u64(stripe + i * 8));
+}
+
+void XXHash64::update(ReadonlyBytes data)
+{
+    m_total_size += data.size();
+
+    if (m_buffered_size > 0) {
+        auto to_copy = min(data.size(), stripe_size - m_buffered_size);
+        memcpy(m_buffer + m_buffered_size, data.data(), to_copy);
+        m_buffered_size += to_copy;
+        data = data.slice(to_copy);
+        if (m_buffered_size < stripe_size)
+            return;
+        consume_stripe(m_buffer);
+        m_buffered_size = 0;
+    }
+
+    while (data.size() >= stripe_size) {
+        consume_stripe(data.data());
+        data = data.slice(stripe_size);
+    }
+
+    memcpy(m_buffer, data.data(), data.size());
+    m_buffered_size = data.size();
+}
+
+u64 XXHash64::digest()
+{
+    u64 hash;
+    if (m_total_size >= stripe_size) {
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7) + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+        for (auto accumulator : m_accumulators)
+            hash = merge_round(hash, accumulator);
+    } else {
+        hash = m_seed + prime_5;
+    }
+    hash += m_total_size;
+
+    size_t offset = 0;
+    for (; offset + 8 <= m_buffered_size; offset += 8) {
+        hash ^= round(0, read_u64(m_buffer + offset));
+        hash = rotate_left(hash, 27) * prime_1 + prime_4;
+    }
+    if (offset + 4 <= m_buffered_size) {
+        hash ^= read_u32(m_buffer + offset) * prime_1;
+        hash = rotate_left(hash, 23) * prime_2 + prime_3;
+        offset += 4;
+    }
+    for (; offset < m_buffered_size; ++offset) {
+        hash ^= m_buffer[offset] * prime_5;
+        hash = rotate_left(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/ChecksumFunction.h>
+
+namespace Crypto::Checksum {
+
+// XXH64, as used for the content checksum of zstd frames.
+class XXHash64 : public ChecksumFunction<u64> {
+public:
+    XXHash64()
+    {
+        reset_accumulators();
+    }
+
+    XXHash64(ReadonlyBytes data)
+    {
+        reset_accumulators();
+        update(data);
+    }
+
+    XXHash64(u64 seed, ReadonlyBytes data)
+        : m_seed(seed)
+    {
+        reset_accumulators();
+        update(data);
+    }
+
+    virtual void update(ReadonlyBytes data) override;
+    virtual u64 digest() override;
+
+private:
+    static constexpr size_t stripe_size = 32;
+
+    void reset_accumulators();
+    void consume_stripe(u8 const*);
+
+    u64 m_seed { 0 };
+    u64 m_accumulators[4];
+    u8 m_buffer[stripe_size];
+    size_t m_buffered_size { 0 };
+    u64 m_total_size { 0 };
+};
+
+}
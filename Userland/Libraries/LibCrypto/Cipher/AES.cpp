@@ -4,10 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
+#include <AK/SIMD.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <LibCrypto/CPUFeatures.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -197,8 +205,122 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+// AES-NI runs a whole round in one instruction. The round keys are the ones computed for the tables above, only
+// their words have to be put back into byte order. The decryption keys already are the ones of the equivalent
+// inverse cipher that AESDEC expects.
+static bool has_aes_ni()
+{
+    return cpu_features().aes_ni && cpu_features().ssse3;
+}
+
+using AK::SIMD::i64x2;
+using AK::SIMD::u8x16;
+
+// Independent blocks are interleaved, so that the latency of one round is hidden behind the others.
+static constexpr size_t aes_ni_interleaved_blocks = 8;
+
+[[gnu::target("aes,ssse3")]] static ALWAYS_INLINE i64x2 load(u8 const* data)
+{
+    i64x2 value;
+    __builtin_memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+[[gnu::target("aes,ssse3")]] static ALWAYS_INLINE void store(u8* data, i64x2 value)
+{
+    __builtin_memcpy(data, &value, sizeof(value));
+}
+
+[[gnu::target("aes,ssse3")]] static ALWAYS_INLINE void load_round_keys(AESCipherKey const& key, i64x2 (&round_keys)[15])
+{
+    for (size_t i = 0; i <= key.rounds(); ++i) {
+        auto bytes = (u8x16)load(reinterpret_cast<u8 const*>(key.round_keys() + 4 * i));
+        round_keys[i] = (i64x2)__builtin_shufflevector(bytes, bytes, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    }
+}
+
+[[gnu::target("aes,ssse3")]] static ALWAYS_INLINE i64x2 encrypt_with_aes_ni(i64x2 state, i64x2 const (&round_keys)[15], size_t rounds)
+{
+    state ^= round_keys[0];
+    for (size_t i = 1; i < rounds; ++i)
+        state = __builtin_ia32_aesenc128(state, round_keys[i]);
+    return __builtin_ia32_aesenclast128(state, round_keys[rounds]);
+}
+
+[[gnu::target("aes,ssse3")]] static void encrypt_block_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    i64x2 round_keys[15];
+    load_round_keys(key, round_keys);
+    store(out, encrypt_with_aes_ni(load(in), round_keys, key.rounds()));
+}
+
+[[gnu::target("aes,ssse3")]] static void decrypt_block_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    i64x2 round_keys[15];
+    load_round_keys(key, round_keys);
+    auto state = load(in) ^ round_keys[0];
+    for (size_t i = 1; i < key.rounds(); ++i)
+        state = __builtin_ia32_aesdec128(state, round_keys[i]);
+    store(out, __builtin_ia32_aesdeclast128(state, round_keys[key.rounds()]));
+}
+
+[[gnu::target("aes,ssse3")]] static size_t encrypt_counter_blocks_with_aes_ni(AESCipherKey const& key, Bytes counter, ReadonlyBytes in, Bytes out)
+{
+    i64x2 round_keys[15];
+    load_round_keys(key, round_keys);
+    auto rounds = key.rounds();
+
+    auto high = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.data()));
+    auto low = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.data() + 8));
+    auto next_counter_block = [&] {
+        i64x2 block = { static_cast<long long>(AK::convert_between_host_and_big_endian(high)), static_cast<long long>(AK::convert_between_host_and_big_endian(low)) };
+        if (++low == 0)
+            ++high;
+        return block;
+    };
+
+    auto block_count = out.size() / AESCipherBlock::block_size();
+    auto const* input = in.is_empty() ? nullptr : in.data();
+    auto* output = out.data();
+
+    size_t block = 0;
+    for (; block + aes_ni_interleaved_blocks <= block_count; block += aes_ni_interleaved_blocks) {
+        i64x2 states[aes_ni_interleaved_blocks];
+        for (auto& state : states)
+            state = next_counter_block() ^ round_keys[0];
+        for (size_t round = 1; round < rounds; ++round) {
+            for (auto& state : states)
+                state = __builtin_ia32_aesenc128(state, round_keys[round]);
+        }
+        for (size_t i = 0; i < aes_ni_interleaved_blocks; ++i) {
+            auto key_stream = __builtin_ia32_aesenclast128(states[i], round_keys[rounds]);
+            auto offset = (block + i) * AESCipherBlock::block_size();
+            store(output + offset, input ? key_stream ^ load(input + offset) : key_stream);
+        }
+    }
+
+    for (; block < block_count; ++block) {
+        auto key_stream = encrypt_with_aes_ni(next_counter_block(), round_keys, rounds);
+        auto offset = block * AESCipherBlock::block_size();
+        store(output + offset, input ? key_stream ^ load(input + offset) : key_stream);
+    }
+
+    ByteReader::store(counter.data(), AK::convert_between_host_and_big_endian(high));
+    ByteReader::store(counter.data() + 8, AK::convert_between_host_and_big_endian(low));
+    return block_count * AESCipherBlock::block_size();
+}
+#endif
+
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        encrypt_block_with_aes_ni(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -291,6 +413,13 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        decrypt_block_with_aes_ni(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -378,6 +507,17 @@ void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
     // clang-format on
 }
 
+size_t AESCipher::encrypt_counter_blocks(Bytes counter, ReadonlyBytes in, Bytes out)
+{
+    VERIFY(counter.size() == AESCipherBlock::block_size());
+    VERIFY(in.is_empty() || in.size() >= out.size());
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni())
+        return encrypt_counter_blocks_with_aes_ni(key(), counter, in, out);
+#endif
+    return 0;
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
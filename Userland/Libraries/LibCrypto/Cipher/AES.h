@@ -120,6 +120,11 @@ public:
     virtual void encrypt_block(BlockType const& in, BlockType& out) override;
     virtual void decrypt_block(BlockType const& in, BlockType& out) override;
 
+    // Encrypts out.size() / block_size() consecutive counter blocks starting at `counter`, a big-endian 128-bit
+    // number that is incremented past them, and XORs `in` into the key stream unless it is empty.
+    // Returns the number of bytes written, which is zero when this is not any faster than encrypt_block().
+    size_t encrypt_counter_blocks(Bytes counter, ReadonlyBytes in, Bytes out);
+
 #ifndef KERNEL
     virtual String class_name() const override
     {
@@ -6,6 +6,9 @@
 
 #include <AK/ByteReader.h>
 #include <AK/Endian.h>
+#include <AK/Platform.h>
+#include <AK/SIMD.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Cipher/ChaCha20.h>
 
 namespace Crypto::Cipher {
@@ -48,7 +51,7 @@ ChaCha20::ChaCha20(ReadonlyBytes key, ReadonlyBytes nonce, u32 initial_counter)
 
     // NOTE: In the case of an 8-byte nonce, we skip the 13th word
     u32 nonce_offset = nonce.size() == 8 ? 1 : 0;
-    for (u32 i = 0; i < 12; i += 4) {
+    for (u32 i = 0; i < nonce.size(); i += 4) {
         m_state[(i / 4) + 13 + nonce_offset] = AK::convert_between_host_and_little_endian(ByteReader::load32(nonce.offset(i)));
     }
 }
@@ -111,21 +114,120 @@ void ChaCha20::do_quarter_round(u32& a, u32& b, u32& c, u32& d)
     rotl(b, 7);
 }
 
+// Generates as many consecutive blocks as there are lanes, with every block in its own lane of the vectors, and
+// XORs them into `input`.
+template<typename VectorType>
+static ALWAYS_INLINE void xor_blocks_in_lanes(u32 const (&state)[16], u8 const* input, u8* output)
+{
+    constexpr size_t lane_count = sizeof(VectorType) / sizeof(u32);
+
+    VectorType initial[16];
+    for (size_t i = 0; i < 16; ++i)
+        initial[i] = VectorType {} + state[i];
+
+    // Words 12 and 13 hold a 64-bit block counter, see ChaCha20::run_cipher().
+    u64 counter = state[12] | (static_cast<u64>(state[13]) << 32);
+    for (size_t lane = 0; lane < lane_count; ++lane) {
+        initial[12][lane] = static_cast<u32>(counter + lane);
+        initial[13][lane] = static_cast<u32>((counter + lane) >> 32);
+    }
+
+    VectorType x[16];
+    for (size_t i = 0; i < 16; ++i)
+        x[i] = initial[i];
+
+#define QUARTER_ROUND(a, b, c, d)           \
+    do {                                    \
+        x[a] += x[b];                       \
+        x[d] ^= x[a];                       \
+        x[d] = (x[d] << 16) | (x[d] >> 16); \
+        x[c] += x[d];                       \
+        x[b] ^= x[c];                       \
+        x[b] = (x[b] << 12) | (x[b] >> 20); \
+        x[a] += x[b];                       \
+        x[d] ^= x[a];                       \
+        x[d] = (x[d] << 8) | (x[d] >> 24);  \
+        x[c] += x[d];                       \
+        x[b] ^= x[c];                       \
+        x[b] = (x[b] << 7) | (x[b] >> 25);  \
+    } while (0)
+
+    for (size_t i = 0; i < 20; i += 2) {
+        QUARTER_ROUND(0, 4, 8, 12);
+        QUARTER_ROUND(1, 5, 9, 13);
+        QUARTER_ROUND(2, 6, 10, 14);
+        QUARTER_ROUND(3, 7, 11, 15);
+
+        QUARTER_ROUND(0, 5, 10, 15);
+        QUARTER_ROUND(1, 6, 11, 12);
+        QUARTER_ROUND(2, 7, 8, 13);
+        QUARTER_ROUND(3, 4, 9, 14);
+    }
+
+#undef QUARTER_ROUND
+
+    // Going through memory is the cheapest way to transpose the words back into blocks.
+    u32 words[16][lane_count];
+    for (size_t i = 0; i < 16; ++i) {
+        x[i] += initial[i];
+        __builtin_memcpy(words[i], &x[i], sizeof(x[i]));
+    }
+
+    for (size_t lane = 0; lane < lane_count; ++lane) {
+        for (size_t i = 0; i < 16; ++i) {
+            auto offset = lane * 64 + i * 4;
+            auto word = ByteReader::load32(input + offset) ^ AK::convert_between_host_and_little_endian(words[i][lane]);
+            ByteReader::store(output + offset, word);
+        }
+    }
+}
+
+static void xor_four_blocks(u32 const (&state)[16], u8 const* input, u8* output)
+{
+    xor_blocks_in_lanes<AK::SIMD::u32x4>(state, input, output);
+}
+
+#if ARCH(X86_64)
+[[gnu::target("avx2")]] static void xor_eight_blocks(u32 const (&state)[16], u8 const* input, u8* output)
+{
+    xor_blocks_in_lanes<AK::SIMD::u32x8>(state, input, output);
+}
+#endif
+
+void ChaCha20::advance_counter(size_t block_count)
+{
+    // Increment the block counter, and carry over to block 13
+    u64 counter = m_state[12] | (static_cast<u64>(m_state[13]) << 32);
+    counter += block_count;
+    m_state[12] = static_cast<u32>(counter);
+    m_state[13] = static_cast<u32>(counter >> 32);
+}
+
 void ChaCha20::run_cipher(ReadonlyBytes input, Bytes& output)
 {
     size_t offset = 0;
+
+    // Whole runs of blocks are generated several at a time, one in every lane of the vectors.
+    size_t blocks_per_run = 4;
+    auto* xor_blocks = xor_four_blocks;
+#if ARCH(X86_64)
+    if (cpu_features().avx2) {
+        blocks_per_run = 8;
+        xor_blocks = xor_eight_blocks;
+    }
+#endif
+    while (input.size() - offset >= blocks_per_run * 64) {
+        xor_blocks(m_state, input.offset_pointer(offset), output.offset_pointer(offset));
+        advance_counter(blocks_per_run);
+        offset += blocks_per_run * 64;
+    }
+
     size_t block_offset = 0;
     while (offset < input.size()) {
         if (block_offset == 0 || block_offset >= 64) {
             // Generate a new XOR block
             generate_block();
-
-            // Increment the block counter, and carry over to block 13
-            m_state[12]++;
-            if (m_state[12] == 0) {
-                m_state[13]++;
-            }
-
+            advance_counter(1);
             block_offset = 0;
         }
 
@@ -23,6 +23,7 @@ public:
 private:
     void run_cipher(ReadonlyBytes input, Bytes& output);
     void generate_block();
+    void advance_counter(size_t block_count);
     ALWAYS_INLINE void do_quarter_round(u32& a, u32& b, u32& c, u32& d);
 
     u32 m_state[16] {};
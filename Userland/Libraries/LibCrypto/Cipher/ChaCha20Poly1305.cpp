@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+
+namespace Crypto::Cipher {
+
+ChaCha20Poly1305::ChaCha20Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == key_size);
+    key.copy_to({ m_key, key_size });
+}
+
+// https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
+void ChaCha20Poly1305::compute_tag(ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes ciphertext, Bytes tag)
+{
+    VERIFY(tag.size() >= tag_size);
+
+    // The one-time Poly1305 key is the start of the keystream block with counter 0.
+    u8 zeroes[32] {};
+    u8 one_time_key[32];
+    Bytes one_time_key_bytes { one_time_key, sizeof(one_time_key) };
+    ChaCha20 { ReadonlyBytes { m_key, key_size }, nonce, 0 }.encrypt({ zeroes, sizeof(zeroes) }, one_time_key_bytes);
+
+    Authentication::Poly1305 mac { one_time_key_bytes };
+    mac.update(aad);
+    mac.update({ zeroes, (16 - aad.size() % 16) % 16 });
+    mac.update(ciphertext);
+    mac.update({ zeroes, (16 - ciphertext.size() % 16) % 16 });
+
+    LittleEndian<u64> lengths[2] { aad.size(), ciphertext.size() };
+    mac.update({ lengths, sizeof(lengths) });
+
+    auto digest = MUST(mac.digest());
+    digest.bytes().copy_to(tag);
+    secure_zero(one_time_key, sizeof(one_time_key));
+}
+
+void ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag)
+{
+    VERIFY(nonce.size() == nonce_size);
+    VERIFY(out.size() >= in.size());
+
+    // The plaintext is encrypted starting with the block counter 1.
+    ChaCha20 { ReadonlyBytes { m_key, key_size }, nonce, 1 }.encrypt(in, out);
+    compute_tag(nonce, aad, out.trim(in.size()), tag);
+}
+
+VerificationConsistency ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag)
+{
+    VERIFY(nonce.size() == nonce_size);
+    VERIFY(out.size() >= in.size());
+
+    u8 expected_tag[tag_size];
+    compute_tag(nonce, aad, in, { expected_tag, tag_size });
+    if (tag.size() != tag_size || !timing_safe_compare(expected_tag, tag.data(), tag_size))
+        return VerificationConsistency::Inconsistent;
+
+    ChaCha20 { ReadonlyBytes { m_key, key_size }, nonce, 1 }.decrypt(in, out);
+    return VerificationConsistency::Consistent;
+}
+
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <LibCrypto/Verification.h>
+
+namespace Crypto::Cipher {
+
+// The ChaCha20 and Poly1305 AEAD construction, see RFC 8439 section 2.8.
+class ChaCha20Poly1305 {
+public:
+    static constexpr size_t key_size = 32;
+    static constexpr size_t nonce_size = 12;
+    static constexpr size_t tag_size = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key);
+
+    void encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag);
+    VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag);
+
+private:
+    void compute_tag(ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes ciphertext, Bytes tag);
+
+    u8 m_key[key_size];
+};
+
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
 #include <LibCrypto/Cipher/Mode/Mode.h>
@@ -171,6 +172,13 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        // Ciphers that can produce many blocks of key stream at once do so for all the whole blocks.
+        if constexpr (IsSame<IncrementFunctionType, IncrementInplace> && requires { cipher.encrypt_counter_blocks(iv, ReadonlyBytes {}, out); }) {
+            auto whole_blocks_length = length - length % block_size;
+            offset = cipher.encrypt_counter_blocks(iv, in ? in->trim(whole_blocks_length) : ReadonlyBytes {}, out.trim(whole_blocks_length));
+            length -= offset;
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/ByteReader.h>
 #include <AK/Endian.h>
 #include <AK/Random.h>
@@ -16,8 +17,6 @@ namespace Crypto::Curves {
 
 static constexpr u256 REDUCE_PRIME { u128 { 0x0000000000000001ull, 0xffffffff00000000ull }, u128 { 0xffffffffffffffffull, 0x00000000fffffffe } };
 static constexpr u256 REDUCE_ORDER { u128 { 0x0c46353d039cdaafull, 0x4319055258e8617bull }, u128 { 0x0000000000000000ull, 0x00000000ffffffff } };
-static constexpr u256 PRIME_INVERSE_MOD_R { u128 { 0x0000000000000001ull, 0x0000000100000000ull }, u128 { 0x0000000000000000ull, 0xffffffff00000002ull } };
-static constexpr u256 PRIME { u128 { 0xffffffffffffffffull, 0x00000000ffffffffull }, u128 { 0x0000000000000000ull, 0xffffffff00000001ull } };
 static constexpr u256 R2_MOD_PRIME { u128 { 0x0000000000000003ull, 0xfffffffbffffffffull }, u128 { 0xfffffffffffffffeull, 0x00000004fffffffdull } };
 static constexpr u256 ONE { 1u };
 static constexpr u256 B_MONTGOMERY { u128 { 0xd89cdf6229c4bddfull, 0xacf005cd78843090ull }, u128 { 0xe5a220abf7212ed6ull, 0xdc30061d04874834ull } };
@@ -55,12 +54,6 @@ static u256 select(u256 const& left, u256 const& right, bool condition)
     return (left & mask) | (right & ~mask);
 }
 
-static u512 multiply(u256 const& left, u256 const& right)
-{
-    auto result = left.wide_multiply(right);
-    return { result.low, result.high };
-}
-
 static u256 modular_reduce(u256 const& value)
 {
     // Add -prime % 2^256 = 2^224-2^192-2^96+1
@@ -115,6 +108,60 @@ static u256 modular_sub(u256 const& left, u256 const& right)
     return output - sub;
 }
 
+#ifdef __SIZEOF_INT128__
+using DoubleWord = unsigned __int128;
+
+static constexpr u64 PRIME_WORDS[4] { 0xffffffffffffffffull, 0x00000000ffffffffull, 0x0000000000000000ull, 0xffffffff00000001ull };
+
+static u256 modular_multiply(u256 const& left, u256 const& right)
+{
+    // Montgomery multiplication one 64-bit word at a time (the CIOS method), which interleaves the reduction with
+    // the multiplication so that the intermediate result never grows beyond six words.
+    // This requires that the inputs to this function are in Montgomery form.
+    u64 const a[4] { left.low().low(), left.low().high(), left.high().low(), left.high().high() };
+    u64 const b[4] { right.low().low(), right.low().high(), right.high().low(), right.high().high() };
+    u64 t[6] {};
+
+    for (size_t i = 0; i < 4; ++i) {
+        // t += a * b[i]
+        DoubleWord carry = 0;
+        for (size_t j = 0; j < 4; ++j) {
+            carry += static_cast<DoubleWord>(a[j]) * b[i] + t[j];
+            t[j] = static_cast<u64>(carry);
+            carry >>= 64;
+        }
+        carry += t[4];
+        t[4] = static_cast<u64>(carry);
+        t[5] = static_cast<u64>(carry >> 64);
+
+        // t = (t + m * p) / 2^64, where m clears the lowest word. As p = -1 mod 2^64, m is just that word.
+        u64 m = t[0];
+        carry = (static_cast<DoubleWord>(m) * PRIME_WORDS[0] + t[0]) >> 64;
+        for (size_t j = 1; j < 4; ++j) {
+            carry += static_cast<DoubleWord>(m) * PRIME_WORDS[j] + t[j];
+            t[j - 1] = static_cast<u64>(carry);
+            carry >>= 64;
+        }
+        carry += t[4];
+        t[3] = static_cast<u64>(carry);
+        t[4] = t[5] + static_cast<u64>(carry >> 64);
+    }
+
+    // The result is below 2^256 + p, so if it overflowed, subtracting p once by adding 2^256 - p is enough.
+    u64 overflow = t[4];
+    u256 addend { u128 { overflow, -(overflow << 32) }, u128 { -overflow, (overflow << 32) - (overflow << 1) } };
+    return u256 { u128 { t[0], t[1] }, u128 { t[2], t[3] } } + addend;
+}
+#else
+static constexpr u256 PRIME_INVERSE_MOD_R { u128 { 0x0000000000000001ull, 0x0000000100000000ull }, u128 { 0x0000000000000000ull, 0xffffffff00000002ull } };
+static constexpr u256 PRIME { u128 { 0xffffffffffffffffull, 0x00000000ffffffffull }, u128 { 0x0000000000000000ull, 0xffffffff00000001ull } };
+
+static u512 multiply(u256 const& left, u256 const& right)
+{
+    auto result = left.wide_multiply(right);
+    return { result.low, result.high };
+}
+
 static u256 modular_multiply(u256 const& left, u256 const& right)
 {
     // Modular multiplication using the Montgomery method: https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
@@ -136,6 +183,7 @@ static u256 modular_multiply(u256 const& left, u256 const& right)
     // output = t / R
     return modular_add(mult.high(), mp.high(), carry);
 }
+#endif
 
 static u256 modular_square(u256 const& value)
 {
@@ -204,12 +252,7 @@ static u256 modular_inverse(u256 const& value)
 static void point_double(JacobianPoint& output_point, JacobianPoint const& point)
 {
     // Based on "Point Doubling" from http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
-
-    // if (Y == 0)
-    //   return POINT_AT_INFINITY
-    if (point.y.is_zero_constant_time()) {
-        VERIFY_NOT_REACHED();
-    }
+    // The point at infinity (0, 0, 0) maps to itself, so there is no need to special-case it.
 
     u256 temp;
 
@@ -258,13 +301,8 @@ static void point_double(JacobianPoint& output_point, JacobianPoint const& point
 static void point_add(JacobianPoint& output_point, JacobianPoint const& point_a, JacobianPoint const& point_b)
 {
     // Based on "Point Addition" from  http://point-at-infinity.org/ecc/Prime_Curve_Jacobian_Coordinates.html
-    if (point_a.x.is_zero_constant_time() && point_a.y.is_zero_constant_time() && point_a.z.is_zero_constant_time()) {
-        output_point.x = point_b.x;
-        output_point.y = point_b.y;
-        output_point.z = point_b.z;
-        return;
-    }
-
+    // To stay constant time, this does not handle the point at infinity, or adding a point to itself or its
+    // negation. The scalar multiplications below never do either, and select around the point at infinity.
     u256 temp;
 
     temp = modular_square(point_b.z);
@@ -281,20 +319,6 @@ static void point_add(JacobianPoint& output_point, JacobianPoint const& point_a,
     u256 s2 = modular_multiply(point_b.y, temp);
     s2 = modular_multiply(s2, point_a.z);
 
-    // if (U1 == U2)
-    //   if (S1 != S2)
-    //     return POINT_AT_INFINITY
-    //   else
-    //     return POINT_DOUBLE(X1, Y1, Z1)
-    if (u1.is_equal_to_constant_time(u2)) {
-        if (s1.is_equal_to_constant_time(s2)) {
-            point_double(output_point, point_a);
-            return;
-        } else {
-            VERIFY_NOT_REACHED();
-        }
-    }
-
     // H = U2 - U1
     u256 h = modular_sub(u2, u1);
     u256 h2 = modular_square(h);
@@ -304,12 +328,11 @@ static void point_add(JacobianPoint& output_point, JacobianPoint const& point_a,
     // X3 = R^2 - H^3 - 2*U1*H^2
     u256 x3 = modular_square(r);
     x3 = modular_sub(x3, h3);
-    temp = modular_multiply(u1, h2);
-    temp = modular_add(temp, temp);
+    u256 u1h2 = modular_multiply(u1, h2);
+    temp = modular_add(u1h2, u1h2);
     x3 = modular_sub(x3, temp);
     // Y3 = R*(U1*H^2 - X3) - S1*H^3
-    u256 y3 = modular_multiply(u1, h2);
-    y3 = modular_sub(y3, x3);
+    u256 y3 = modular_sub(u1h2, x3);
     y3 = modular_multiply(y3, r);
     temp = modular_multiply(s1, h3);
     y3 = modular_sub(y3, temp);
@@ -322,17 +345,60 @@ static void point_add(JacobianPoint& output_point, JacobianPoint const& point_a,
     output_point.z = z3;
 }
 
+static void point_add_affine(JacobianPoint& output_point, JacobianPoint const& point_a, AffinePoint const& point_b)
+{
+    // The same as point_add() with Z2 = 1, which saves four multiplications and a squaring.
+    u256 temp;
+
+    temp = modular_square(point_a.z);
+    // U2 = X2*Z1^2
+    u256 u2 = modular_multiply(point_b.x, temp);
+    // S2 = Y2*Z1^3
+    u256 s2 = modular_multiply(point_b.y, temp);
+    s2 = modular_multiply(s2, point_a.z);
+
+    // H = U2 - X1
+    u256 h = modular_sub(u2, point_a.x);
+    u256 h2 = modular_square(h);
+    u256 h3 = modular_multiply(h2, h);
+    // R = S2 - Y1
+    u256 r = modular_sub(s2, point_a.y);
+    // X3 = R^2 - H^3 - 2*X1*H^2
+    u256 x3 = modular_square(r);
+    x3 = modular_sub(x3, h3);
+    u256 x1h2 = modular_multiply(point_a.x, h2);
+    temp = modular_add(x1h2, x1h2);
+    x3 = modular_sub(x3, temp);
+    // Y3 = R*(X1*H^2 - X3) - Y1*H^3
+    u256 y3 = modular_sub(x1h2, x3);
+    y3 = modular_multiply(y3, r);
+    temp = modular_multiply(point_a.y, h3);
+    y3 = modular_sub(y3, temp);
+    // Z3 = H*Z1
+    u256 z3 = modular_multiply(h, point_a.z);
+    // return (X3, Y3, Z3)
+    output_point.x = x3;
+    output_point.y = y3;
+    output_point.z = z3;
+}
+
+static void select_point(JacobianPoint& output_point, JacobianPoint const& point, bool condition)
+{
+    // If condition = 1, output_point = point
+    output_point.x = select(output_point.x, point.x, condition);
+    output_point.y = select(output_point.y, point.y, condition);
+    output_point.z = select(output_point.z, point.z, condition);
+}
+
 static void convert_jacobian_to_affine(JacobianPoint& point)
 {
     u256 temp;
+    u256 z_inverse = modular_inverse(point.z);
     // X' = X/Z^2
-    temp = modular_square(point.z);
-    temp = modular_inverse(temp);
+    temp = modular_square(z_inverse);
     point.x = modular_multiply(point.x, temp);
     // Y' = Y/Z^3
-    temp = modular_square(point.z);
-    temp = modular_multiply(temp, point.z);
-    temp = modular_inverse(temp);
+    temp = modular_multiply(temp, z_inverse);
     point.y = modular_multiply(point.y, temp);
 }
 
@@ -355,28 +421,161 @@ static bool is_point_on_curve(JacobianPoint const& point)
     return temp.is_zero_constant_time();
 }
 
-ErrorOr<ByteBuffer> SECP256r1::generate_private_key()
+// The scalar is processed WINDOW_BITS bits at a time, adding one of the multiples 0 to 2^WINDOW_BITS - 1 of the point
+// after every WINDOW_BITS doublings.
+static constexpr size_t WINDOW_BITS = 4;
+static constexpr size_t WINDOW_SIZE = 1 << WINDOW_BITS;
+
+// The generator is multiplied with a comb instead: the scalar is split into COMB_BLOCKS blocks of 64 bits, each of
+// which has its own table of the sums of WINDOW_BITS generator multiples spaced COMB_SPACING bits apart. One pass
+// over the columns of bits then takes COMB_SPACING - 1 doublings and COMB_BLOCKS additions per column.
+static constexpr size_t COMB_BLOCKS = 4;
+static constexpr size_t COMB_SPACING = 256 / COMB_BLOCKS / WINDOW_BITS;
+
+using GeneratorTable = Array<Array<AffinePoint, WINDOW_SIZE>, COMB_BLOCKS>;
+
+static constexpr u256 GENERATOR_X { u128 { 0xf4a13945d898c296ull, 0x77037d812deb33a0ull }, u128 { 0xf8bce6e563a440f2ull, 0x6b17d1f2e12c4247ull } };
+static constexpr u256 GENERATOR_Y { u128 { 0xcbb6406837bf51f5ull, 0x2bce33576b315eceull }, u128 { 0x8ee7eb4a7c0f9e16ull, 0x4fe342e2fe1a7f9bull } };
+
+static void export_words(u256 const& value, u64 (&words)[4])
 {
-    auto buffer = TRY(ByteBuffer::create_uninitialized(32));
-    fill_with_random(buffer.data(), buffer.size());
-    return buffer;
+    words[0] = value.low().low();
+    words[1] = value.low().high();
+    words[2] = value.high().low();
+    words[3] = value.high().high();
 }
 
-ErrorOr<ByteBuffer> SECP256r1::generate_public_key(ReadonlyBytes a)
+static u8 scalar_bit(u64 const (&words)[4], size_t bit)
 {
-    // clang-format off
-    u8 generator_bytes[65] {
-        0x04,
-        0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
-        0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
-        0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
-        0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5,
-    };
-    // clang-format on
-    return compute_coordinate(a, { generator_bytes, 65 });
+    return (words[bit / 64] >> (bit % 64)) & 1;
 }
 
-ErrorOr<ByteBuffer> SECP256r1::compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes point_bytes)
+static GeneratorTable const& generator_table()
+{
+    static GeneratorTable const s_table = [] {
+        // Sum up every combination of the generator multiples in a block, and then bring them all to Z=1 together,
+        // which only takes a single inversion.
+        Array<Array<JacobianPoint, WINDOW_SIZE>, COMB_BLOCKS> points;
+        JacobianPoint multiple { to_montgomery(GENERATOR_X), to_montgomery(GENERATOR_Y), to_montgomery(ONE) };
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            for (size_t tooth = 0; tooth < WINDOW_BITS; ++tooth) {
+                auto bit = 1u << tooth;
+                points[block][bit] = multiple;
+                for (size_t digit = 1; digit < bit; ++digit)
+                    point_add(points[block][bit | digit], points[block][digit], multiple);
+
+                for (size_t i = 0; i < COMB_SPACING; ++i)
+                    point_double(multiple, multiple);
+            }
+        }
+
+        Array<u256, COMB_BLOCKS * WINDOW_SIZE> products;
+        u256 product = to_montgomery(ONE);
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            for (size_t digit = 1; digit < WINDOW_SIZE; ++digit) {
+                products[block * WINDOW_SIZE + digit] = product;
+                product = modular_multiply(product, points[block][digit].z);
+            }
+        }
+
+        GeneratorTable affine_points;
+        u256 inverse = modular_inverse(product);
+        for (size_t block = COMB_BLOCKS; block-- > 0;) {
+            for (size_t digit = WINDOW_SIZE; --digit > 0;) {
+                auto& point = points[block][digit];
+                // inverse is 1/(Z of this point and all before it), so multiplying out the others leaves 1/Z.
+                u256 z_inverse = modular_multiply(inverse, products[block * WINDOW_SIZE + digit]);
+                inverse = modular_multiply(inverse, point.z);
+
+                u256 temp = modular_square(z_inverse);
+                affine_points[block][digit].x = modular_multiply(point.x, temp);
+                temp = modular_multiply(temp, z_inverse);
+                affine_points[block][digit].y = modular_multiply(point.y, temp);
+            }
+            // There is no affine point at infinity, the multiplication skips digits of zero instead.
+            affine_points[block][0] = affine_points[block][1];
+        }
+        return affine_points;
+    }();
+    return s_table;
+}
+
+// Returns scalar * G, with the scalar already reduced modulo the order.
+static JacobianPoint multiply_generator(u256 const& scalar)
+{
+    auto const& table = generator_table();
+    u64 words[4];
+    export_words(scalar, words);
+
+    JacobianPoint result;
+    JacobianPoint temp_result;
+    bool result_is_infinity = true;
+
+    for (size_t column = COMB_SPACING; column-- > 0;) {
+        point_double(result, result);
+
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            size_t digit = 0;
+            for (size_t tooth = 0; tooth < WINDOW_BITS; ++tooth)
+                digit |= scalar_bit(words, block * 64 + tooth * COMB_SPACING + column) << tooth;
+
+            // Look at every entry, so that the memory access pattern does not depend on the scalar
+            AffinePoint entry;
+            for (size_t i = 0; i < WINDOW_SIZE; ++i) {
+                entry.x = select(entry.x, table[block][i].x, i == digit);
+                entry.y = select(entry.y, table[block][i].y, i == digit);
+            }
+
+            point_add_affine(temp_result, result, entry);
+            JacobianPoint entry_point { entry.x, entry.y, to_montgomery(ONE) };
+            select_point(temp_result, entry_point, result_is_infinity);
+            select_point(result, temp_result, digit != 0);
+            result_is_infinity &= digit == 0;
+        }
+    }
+
+    return result;
+}
+
+// Returns scalar * point, with the scalar already reduced modulo the order.
+static JacobianPoint multiply_point(u256 const& scalar, JacobianPoint const& point)
+{
+    u64 words[4];
+    export_words(scalar, words);
+
+    Array<JacobianPoint, WINDOW_SIZE> table;
+    table[1] = point;
+    for (size_t i = 2; i < WINDOW_SIZE; i += 2) {
+        point_double(table[i], table[i / 2]);
+        point_add(table[i + 1], table[i], point);
+    }
+    table[0] = point;
+
+    JacobianPoint result;
+    JacobianPoint temp_result;
+    bool result_is_infinity = true;
+
+    for (size_t window = 256 / WINDOW_BITS; window-- > 0;) {
+        for (size_t i = 0; i < WINDOW_BITS; ++i)
+            point_double(result, result);
+
+        size_t digit = (words[window * WINDOW_BITS / 64] >> (window * WINDOW_BITS % 64)) & (WINDOW_SIZE - 1);
+
+        // Look at every entry, so that the memory access pattern does not depend on the scalar
+        JacobianPoint entry;
+        for (size_t i = 0; i < WINDOW_SIZE; ++i)
+            select_point(entry, table[i], i == digit);
+
+        point_add(temp_result, result, entry);
+        select_point(temp_result, entry, result_is_infinity);
+        select_point(result, temp_result, digit != 0);
+        result_is_infinity &= digit == 0;
+    }
+
+    return result;
+}
+
+static ErrorOr<u256> import_scalar(ReadonlyBytes scalar_bytes)
 {
     VERIFY(scalar_bytes.size() == 32);
 
@@ -385,6 +584,49 @@ ErrorOr<ByteBuffer> SECP256r1::compute_coordinate(ReadonlyBytes scalar_bytes, Re
     scalar = modular_reduce_order(scalar);
     if (scalar.is_zero_constant_time())
         return Error::from_string_literal("SECP256r1: scalar is zero");
+    return scalar;
+}
+
+static ErrorOr<ByteBuffer> export_point(JacobianPoint& point)
+{
+    // Convert from Jacobian coordinates back to Affine coordinates
+    convert_jacobian_to_affine(point);
+
+    // Make sure the resulting point is on the curve
+    VERIFY(is_point_on_curve(point));
+
+    // Convert the result back from Montgomery form
+    point.x = from_montgomery(point.x);
+    point.y = from_montgomery(point.y);
+    // Final modular reduction on the coordinates
+    point.x = modular_reduce(point.x);
+    point.y = modular_reduce(point.y);
+
+    // Export the values into an output buffer
+    auto buf = TRY(ByteBuffer::create_uninitialized(65));
+    buf[0] = 0x04;
+    export_big_endian(point.x, buf.bytes().slice(1, 32));
+    export_big_endian(point.y, buf.bytes().slice(33, 32));
+    return buf;
+}
+
+ErrorOr<ByteBuffer> SECP256r1::generate_private_key()
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(32));
+    fill_with_random(buffer.data(), buffer.size());
+    return buffer;
+}
+
+ErrorOr<ByteBuffer> SECP256r1::generate_public_key(ReadonlyBytes a)
+{
+    u256 scalar = TRY(import_scalar(a));
+    auto result = multiply_generator(scalar);
+    return export_point(result);
+}
+
+ErrorOr<ByteBuffer> SECP256r1::compute_coordinate(ReadonlyBytes scalar_bytes, ReadonlyBytes point_bytes)
+{
+    u256 scalar = TRY(import_scalar(scalar_bytes));
 
     // Make sure the point is uncompressed
     if (point_bytes.size() != 65 || point_bytes[0] != 0x04)
@@ -405,41 +647,9 @@ ErrorOr<ByteBuffer> SECP256r1::compute_coordinate(ReadonlyBytes scalar_bytes, Re
     if (!is_point_on_curve(point))
         return Error::from_string_literal("SECP256r1: point is not on the curve");
 
-    JacobianPoint result;
-    JacobianPoint temp_result;
-
     // Calculate the scalar times point multiplication in constant time
-    for (auto i = 0; i < 256; i++) {
-        point_add(temp_result, result, point);
-
-        auto condition = (scalar & 1u) == 1u;
-        result.x = select(result.x, temp_result.x, condition);
-        result.y = select(result.y, temp_result.y, condition);
-        result.z = select(result.z, temp_result.z, condition);
-
-        point_double(point, point);
-        scalar >>= 1u;
-    }
-
-    // Convert from Jacobian coordinates back to Affine coordinates
-    convert_jacobian_to_affine(result);
-
-    // Make sure the resulting point is on the curve
-    VERIFY(is_point_on_curve(result));
-
-    // Convert the result back from Montgomery form
-    result.x = from_montgomery(result.x);
-    result.y = from_montgomery(result.y);
-    // Final modular reduction on the coordinates
-    result.x = modular_reduce(result.x);
-    result.y = modular_reduce(result.y);
-
-    // Export the values into an output buffer
-    auto buf = TRY(ByteBuffer::create_uninitialized(65));
-    buf[0] = 0x04;
-    export_big_endian(result.x, buf.bytes().slice(1, 32));
-    export_big_endian(result.y, buf.bytes().slice(33, 32));
-    return buf;
+    auto result = multiply_point(scalar, point);
+    return export_point(result);
 }
 
 ErrorOr<ByteBuffer> SECP256r1::derive_premaster_key(ReadonlyBytes shared_point)
@@ -4,10 +4,12 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/ByteReader.h>
 #include <AK/Endian.h>
 #include <AK/Random.h>
 #include <LibCrypto/Curves/Curve25519.h>
+#include <LibCrypto/Curves/Ed25519.h>
 #include <LibCrypto/Curves/X25519.h>
 
 namespace Crypto::Curves {
@@ -17,6 +19,468 @@ static constexpr u8 BYTES = 32;
 static constexpr u8 WORDS = 8;
 static constexpr u32 A24 = 121666;
 
+ErrorOr<ByteBuffer> X25519::generate_private_key()
+{
+    auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
+    fill_with_random(buffer.data(), buffer.size());
+    return buffer;
+}
+
+#ifdef __SIZEOF_INT128__
+// With 128-bit products available, field elements are kept in radix 2^51: five 64-bit limbs, whose spare bits absorb
+// the carries of a few additions. That takes far fewer multiplications than Curve25519's eight 32-bit words.
+using DoubleWord = unsigned __int128;
+
+static constexpr u64 LIMB_MASK = (1ull << 51) - 1;
+
+namespace {
+struct FieldElement {
+    u64 limbs[5] {};
+};
+
+struct ExtendedPoint {
+    FieldElement x;
+    FieldElement y;
+    FieldElement z;
+    FieldElement t;
+};
+
+// A point with Z = 1, stored as (y + x, y - x, 2 * d * x * y) which is what the addition formula needs.
+struct PrecomputedPoint {
+    FieldElement y_plus_x;
+    FieldElement y_minus_x;
+    FieldElement xy2d;
+};
+}
+
+static FieldElement carry(FieldElement const& value)
+{
+    // Brings every limb below 2^51, except for the lowest one, which stays below 2^52.
+    FieldElement result = value;
+    for (auto i = 0; i < 4; i++) {
+        result.limbs[i + 1] += result.limbs[i] >> 51;
+        result.limbs[i] &= LIMB_MASK;
+    }
+    result.limbs[0] += 19 * (result.limbs[4] >> 51);
+    result.limbs[4] &= LIMB_MASK;
+    return result;
+}
+
+static FieldElement reduce(DoubleWord (&products)[5])
+{
+    FieldElement result;
+    for (auto i = 0; i < 4; i++) {
+        products[i + 1] += static_cast<u64>(products[i] >> 51);
+        result.limbs[i] = static_cast<u64>(products[i]) & LIMB_MASK;
+    }
+    result.limbs[4] = static_cast<u64>(products[4]) & LIMB_MASK;
+
+    // Reduce bits 255 and above (2^255 = 19 mod p)
+    DoubleWord temp = (products[4] >> 51) * 19 + result.limbs[0];
+    result.limbs[0] = static_cast<u64>(temp) & LIMB_MASK;
+    result.limbs[1] += static_cast<u64>(temp >> 51);
+    return result;
+}
+
+static FieldElement import_field_element(u8 const* data)
+{
+    u64 words[4];
+    for (auto i = 0; i < 4; i++)
+        words[i] = AK::convert_between_host_and_little_endian(ByteReader::load64(data + i * sizeof(u64)));
+
+    // Bit 255 is masked off
+    return { {
+        words[0] & LIMB_MASK,
+        ((words[0] >> 51) | (words[1] << 13)) & LIMB_MASK,
+        ((words[1] >> 38) | (words[2] << 26)) & LIMB_MASK,
+        ((words[2] >> 25) | (words[3] << 39)) & LIMB_MASK,
+        (words[3] >> 12) & LIMB_MASK,
+    } };
+}
+
+static FieldElement import_field_element(u32 const* words)
+{
+    u8 data[BYTES];
+    for (auto i = 0; i < WORDS; i++)
+        ByteReader::store(data + i * sizeof(u32), AK::convert_between_host_and_little_endian(words[i]));
+    return import_field_element(data);
+}
+
+static void export_field_element(FieldElement const& value, u8* data)
+{
+    // After two carries the value is below 2^255, so it is only at least p if value + 19 carries into bit 255.
+    auto result = carry(carry(value));
+    FieldElement reduced = result;
+    reduced.limbs[0] += 19;
+    for (auto i = 0; i < 4; i++) {
+        reduced.limbs[i + 1] += reduced.limbs[i] >> 51;
+        reduced.limbs[i] &= LIMB_MASK;
+    }
+    u64 mask = 0 - (reduced.limbs[4] >> 51);
+    reduced.limbs[4] &= LIMB_MASK;
+    for (auto i = 0; i < 5; i++)
+        result.limbs[i] = (result.limbs[i] & ~mask) | (reduced.limbs[i] & mask);
+
+    u64 words[4] {
+        result.limbs[0] | (result.limbs[1] << 51),
+        (result.limbs[1] >> 13) | (result.limbs[2] << 38),
+        (result.limbs[2] >> 26) | (result.limbs[3] << 25),
+        (result.limbs[3] >> 39) | (result.limbs[4] << 12),
+    };
+    for (auto i = 0; i < 4; i++)
+        ByteReader::store(data + i * sizeof(u64), AK::convert_between_host_and_little_endian(words[i]));
+}
+
+static FieldElement modular_add(FieldElement const& left, FieldElement const& right)
+{
+    // The result is not carried, so it may only be used as an input to other operations.
+    FieldElement result;
+    for (auto i = 0; i < 5; i++)
+        result.limbs[i] = left.limbs[i] + right.limbs[i];
+    return result;
+}
+
+static FieldElement modular_subtract(FieldElement const& left, FieldElement const& right)
+{
+    // Add 8 * p first, so that no limb can go negative as long as the limbs of right are below 2^54.
+    FieldElement result;
+    result.limbs[0] = left.limbs[0] + 0x3fffffffffff68 - right.limbs[0];
+    for (auto i = 1; i < 5; i++)
+        result.limbs[i] = left.limbs[i] + 0x3ffffffffffff8 - right.limbs[i];
+    return carry(result);
+}
+
+static FieldElement modular_multiply(FieldElement const& left, FieldElement const& right)
+{
+    // Schoolbook multiplication, where the limbs that end up at 2^255 and above are multiplied by 19 right away.
+    auto const& a = left.limbs;
+    auto const& b = right.limbs;
+    u64 b1 = b[1] * 19, b2 = b[2] * 19, b3 = b[3] * 19, b4 = b[4] * 19;
+
+    DoubleWord products[5] {
+        static_cast<DoubleWord>(a[0]) * b[0] + static_cast<DoubleWord>(a[1]) * b4 + static_cast<DoubleWord>(a[2]) * b3 + static_cast<DoubleWord>(a[3]) * b2 + static_cast<DoubleWord>(a[4]) * b1,
+        static_cast<DoubleWord>(a[0]) * b[1] + static_cast<DoubleWord>(a[1]) * b[0] + static_cast<DoubleWord>(a[2]) * b4 + static_cast<DoubleWord>(a[3]) * b3 + static_cast<DoubleWord>(a[4]) * b2,
+        static_cast<DoubleWord>(a[0]) * b[2] + static_cast<DoubleWord>(a[1]) * b[1] + static_cast<DoubleWord>(a[2]) * b[0] + static_cast<DoubleWord>(a[3]) * b4 + static_cast<DoubleWord>(a[4]) * b3,
+        static_cast<DoubleWord>(a[0]) * b[3] + static_cast<DoubleWord>(a[1]) * b[2] + static_cast<DoubleWord>(a[2]) * b[1] + static_cast<DoubleWord>(a[3]) * b[0] + static_cast<DoubleWord>(a[4]) * b4,
+        static_cast<DoubleWord>(a[0]) * b[4] + static_cast<DoubleWord>(a[1]) * b[3] + static_cast<DoubleWord>(a[2]) * b[2] + static_cast<DoubleWord>(a[3]) * b[1] + static_cast<DoubleWord>(a[4]) * b[0],
+    };
+    return reduce(products);
+}
+
+static FieldElement modular_square(FieldElement const& value)
+{
+    // Like modular_multiply(), but every product of two different limbs is only computed once.
+    auto const& a = value.limbs;
+    u64 a0_2 = a[0] * 2, a1_2 = a[1] * 2;
+    u64 a3_19 = a[3] * 19, a4_19 = a[4] * 19;
+
+    DoubleWord products[5] {
+        static_cast<DoubleWord>(a[0]) * a[0] + static_cast<DoubleWord>(a1_2) * a4_19 + static_cast<DoubleWord>(a[2] * 2) * a3_19,
+        static_cast<DoubleWord>(a0_2) * a[1] + static_cast<DoubleWord>(a[2] * 2) * a4_19 + static_cast<DoubleWord>(a[3]) * a3_19,
+        static_cast<DoubleWord>(a0_2) * a[2] + static_cast<DoubleWord>(a[1]) * a[1] + static_cast<DoubleWord>(a[3] * 2) * a4_19,
+        static_cast<DoubleWord>(a0_2) * a[3] + static_cast<DoubleWord>(a1_2) * a[2] + static_cast<DoubleWord>(a[4]) * a4_19,
+        static_cast<DoubleWord>(a0_2) * a[4] + static_cast<DoubleWord>(a1_2) * a[3] + static_cast<DoubleWord>(a[2]) * a[2],
+    };
+    return reduce(products);
+}
+
+static FieldElement modular_multiply_single(FieldElement const& value, u32 factor)
+{
+    DoubleWord products[5];
+    for (auto i = 0; i < 5; i++)
+        products[i] = static_cast<DoubleWord>(value.limbs[i]) * factor;
+    return reduce(products);
+}
+
+static FieldElement to_power_of_2n(FieldElement const& value, u8 n)
+{
+    auto result = modular_square(value);
+    for (auto i = 1; i < n; i++)
+        result = modular_square(result);
+    return result;
+}
+
+static FieldElement modular_multiply_inverse(FieldElement const& value)
+{
+    // Fermat's little theorem, with the same addition chain as Curve25519::modular_multiply_inverse()
+    auto u = modular_multiply(modular_square(value), value);
+    u = modular_square(u);
+    auto v = modular_multiply(u, value);
+    u = modular_multiply(to_power_of_2n(v, 3), v);
+    u = modular_square(u);
+    v = modular_multiply(u, value);
+    u = modular_multiply(to_power_of_2n(v, 7), v);
+    u = modular_square(u);
+    v = modular_multiply(u, value);
+    u = modular_multiply(to_power_of_2n(v, 15), v);
+    u = modular_square(u);
+    v = modular_multiply(u, value);
+    u = to_power_of_2n(v, 31);
+    v = modular_multiply(u, v);
+    u = modular_multiply(to_power_of_2n(v, 62), v);
+    u = modular_square(u);
+    v = modular_multiply(u, value);
+    u = modular_multiply(to_power_of_2n(v, 125), v);
+    u = modular_square(modular_square(u));
+    u = modular_multiply(u, value);
+    u = modular_square(modular_square(u));
+    u = modular_multiply(u, value);
+    u = modular_square(u);
+    return modular_multiply(u, value);
+}
+
+static void conditional_swap(FieldElement& first, FieldElement& second, u64 condition)
+{
+    u64 mask = ~condition + 1;
+    for (auto i = 0; i < 5; i++) {
+        u64 temp = mask & (first.limbs[i] ^ second.limbs[i]);
+        first.limbs[i] ^= temp;
+        second.limbs[i] ^= temp;
+    }
+}
+
+static void conditional_move(PrecomputedPoint& output, PrecomputedPoint const& point, u64 condition)
+{
+    // If condition = 1, output = point
+    u64 mask = ~condition + 1;
+    for (auto i = 0; i < 5; i++) {
+        output.y_plus_x.limbs[i] ^= mask & (output.y_plus_x.limbs[i] ^ point.y_plus_x.limbs[i]);
+        output.y_minus_x.limbs[i] ^= mask & (output.y_minus_x.limbs[i] ^ point.y_minus_x.limbs[i]);
+        output.xy2d.limbs[i] ^= mask & (output.xy2d.limbs[i] ^ point.xy2d.limbs[i]);
+    }
+}
+
+// The base point 9 is the image of the Ed25519 base point, and the scalar multiplication on the twisted Edwards
+// curve has complete formulas, which allows for a precomputed comb without any special cases. The scalar is split
+// into COMB_BLOCKS blocks of 64 bits, each of which has a table of the sums of COMB_TEETH multiples of the base point
+// spaced COMB_SPACING bits apart. One pass over the columns of bits then takes COMB_SPACING - 1 doublings and
+// COMB_BLOCKS additions per column, instead of the 255 steps of the ladder.
+static constexpr size_t COMB_BLOCKS = 4;
+static constexpr size_t COMB_TEETH = 4;
+static constexpr size_t COMB_SIZE = 1 << COMB_TEETH;
+static constexpr size_t COMB_SPACING = 256 / COMB_BLOCKS / COMB_TEETH;
+
+using BasePointTable = Array<Array<PrecomputedPoint, COMB_SIZE>, COMB_BLOCKS>;
+
+static void point_double(ExtendedPoint& result, ExtendedPoint const& point)
+{
+    auto xx = modular_square(point.x);
+    auto yy = modular_square(point.y);
+    auto zz = modular_square(point.z);
+    auto b = modular_add(zz, zz);
+    auto a = modular_square(modular_add(point.x, point.y));
+
+    auto e = modular_add(yy, xx);
+    auto f = modular_subtract(yy, xx);
+    auto g = modular_subtract(a, e);
+    auto h = modular_subtract(b, f);
+
+    result.x = modular_multiply(g, h);
+    result.y = modular_multiply(e, f);
+    result.z = modular_multiply(f, h);
+    result.t = modular_multiply(g, e);
+}
+
+static void point_add(ExtendedPoint& result, ExtendedPoint const& p, ExtendedPoint const& q, FieldElement const& d2)
+{
+    // The same formula as Ed25519::point_add()
+    auto a = modular_multiply(modular_add(p.y, p.x), modular_add(q.y, q.x));
+    auto b = modular_multiply(modular_subtract(p.y, p.x), modular_subtract(q.y, q.x));
+    auto c = modular_multiply(p.z, q.z);
+    c = modular_add(c, c);
+    auto d = modular_multiply(modular_multiply(p.t, q.t), d2);
+
+    auto e = modular_add(a, b);
+    auto f = modular_subtract(a, b);
+    auto g = modular_add(c, d);
+    auto h = modular_subtract(c, d);
+
+    result.x = modular_multiply(f, h);
+    result.y = modular_multiply(e, g);
+    result.z = modular_multiply(g, h);
+    result.t = modular_multiply(e, f);
+}
+
+static void point_add(ExtendedPoint& result, ExtendedPoint const& p, PrecomputedPoint const& q)
+{
+    // point_add() with Z2 = 1 and the remaining products of the second point already computed.
+    auto a = modular_multiply(modular_add(p.y, p.x), q.y_plus_x);
+    auto b = modular_multiply(modular_subtract(p.y, p.x), q.y_minus_x);
+    auto c = modular_add(p.z, p.z);
+    auto d = modular_multiply(p.t, q.xy2d);
+
+    auto e = modular_add(a, b);
+    auto f = modular_subtract(a, b);
+    auto g = modular_add(c, d);
+    auto h = modular_subtract(c, d);
+
+    result.x = modular_multiply(f, h);
+    result.y = modular_multiply(e, g);
+    result.z = modular_multiply(g, h);
+    result.t = modular_multiply(e, f);
+}
+
+static BasePointTable const& base_point_table()
+{
+    static BasePointTable const s_table = [] {
+        auto d2 = import_field_element(Curve25519::CURVE_D_2);
+        ExtendedPoint identity { {}, { { 1 } }, { { 1 } }, {} };
+
+        // Sum up every combination of the base point multiples in a block, and then bring them all to Z=1
+        // together, which only takes a single inversion.
+        Array<Array<ExtendedPoint, COMB_SIZE>, COMB_BLOCKS> points;
+        ExtendedPoint multiple {
+            import_field_element(Ed25519::BASE_POINT.x),
+            import_field_element(Ed25519::BASE_POINT.y),
+            import_field_element(Ed25519::BASE_POINT.z),
+            import_field_element(Ed25519::BASE_POINT.t),
+        };
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            points[block][0] = identity;
+            for (size_t tooth = 0; tooth < COMB_TEETH; ++tooth) {
+                auto bit = 1u << tooth;
+                for (size_t digit = 0; digit < bit; ++digit)
+                    point_add(points[block][bit | digit], points[block][digit], multiple, d2);
+
+                for (size_t i = 0; i < COMB_SPACING; ++i)
+                    point_double(multiple, multiple);
+            }
+        }
+
+        Array<FieldElement, COMB_BLOCKS * COMB_SIZE> products;
+        FieldElement product { { 1 } };
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            for (size_t digit = 0; digit < COMB_SIZE; ++digit) {
+                products[block * COMB_SIZE + digit] = product;
+                product = modular_multiply(product, points[block][digit].z);
+            }
+        }
+
+        BasePointTable precomputed_points;
+        auto inverse = modular_multiply_inverse(product);
+        for (size_t block = COMB_BLOCKS; block-- > 0;) {
+            for (size_t digit = COMB_SIZE; digit-- > 0;) {
+                auto& point = points[block][digit];
+                // inverse is 1/(Z of this point and all before it), so multiplying out the others leaves 1/Z.
+                auto z_inverse = modular_multiply(inverse, products[block * COMB_SIZE + digit]);
+                inverse = modular_multiply(inverse, point.z);
+
+                auto x = modular_multiply(point.x, z_inverse);
+                auto y = modular_multiply(point.y, z_inverse);
+                auto& precomputed_point = precomputed_points[block][digit];
+                precomputed_point.y_plus_x = carry(modular_add(y, x));
+                precomputed_point.y_minus_x = modular_subtract(y, x);
+                precomputed_point.xy2d = modular_multiply(modular_multiply(x, y), d2);
+            }
+        }
+        return precomputed_points;
+    }();
+    return s_table;
+}
+
+ErrorOr<ByteBuffer> X25519::generate_public_key(ReadonlyBytes a)
+{
+    VERIFY(a.size() == BYTES);
+
+    u8 k[BYTES];
+    __builtin_memcpy(k, a.data(), BYTES);
+    k[0] &= 0xF8;
+    k[31] &= 0x7F;
+    k[31] |= 0x40;
+
+    auto const& table = base_point_table();
+    ExtendedPoint result { {}, { { 1 } }, { { 1 } }, {} };
+    for (size_t column = COMB_SPACING; column-- > 0;) {
+        point_double(result, result);
+
+        for (size_t block = 0; block < COMB_BLOCKS; ++block) {
+            size_t digit = 0;
+            for (size_t tooth = 0; tooth < COMB_TEETH; ++tooth) {
+                auto bit = block * 64 + tooth * COMB_SPACING + column;
+                digit |= ((k[bit / 8] >> (bit % 8)) & 1) << tooth;
+            }
+
+            // Look at every entry, so that the memory access pattern does not depend on the scalar
+            PrecomputedPoint entry;
+            for (size_t i = 0; i < COMB_SIZE; ++i)
+                conditional_move(entry, table[block][i], i == digit);
+
+            point_add(result, result, entry);
+        }
+    }
+
+    // Map the point to the Montgomery curve: u = (1 + y) / (1 - y) = (Z + Y) / (Z - Y)
+    auto u = modular_multiply(modular_add(result.z, result.y), modular_multiply_inverse(modular_subtract(result.z, result.y)));
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
+    export_field_element(u, buffer.data());
+    return buffer;
+}
+
+// https://datatracker.ietf.org/doc/html/rfc7748#section-5
+ErrorOr<ByteBuffer> X25519::compute_coordinate(ReadonlyBytes input_k, ReadonlyBytes input_u)
+{
+    u8 k[BYTES];
+    __builtin_memcpy(k, input_k.data(), BYTES);
+
+    // Set the three least significant bits of the first byte and the most significant bit of the last to zero,
+    // set the second most significant bit of the last byte to 1
+    k[0] &= 0xF8;
+    k[31] &= 0x7F;
+    k[31] |= 0x40;
+
+    // Implementations MUST accept non-canonical values and process them as if they had been reduced modulo the
+    // field prime, which the arithmetic does anyway. The most significant bit in the final byte is masked.
+    auto u = import_field_element(input_u.data());
+
+    FieldElement x1 { { 1 } };
+    FieldElement z1 {};
+    FieldElement x2 = u;
+    FieldElement z2 { { 1 } };
+
+    // Montgomery ladder
+    u64 swap = 0;
+    for (auto i = BITS - 1; i >= 0; i--) {
+        u64 b = (k[i / 8] >> (i % 8)) & 1;
+
+        conditional_swap(x1, x2, swap ^ b);
+        conditional_swap(z1, z2, swap ^ b);
+
+        swap = b;
+
+        auto t1 = modular_add(x2, z2);
+        x2 = modular_subtract(x2, z2);
+        z2 = modular_add(x1, z1);
+        x1 = modular_subtract(x1, z1);
+        t1 = modular_multiply(t1, x1);
+        x2 = modular_multiply(x2, z2);
+        z2 = modular_square(z2);
+        x1 = modular_square(x1);
+        auto t2 = modular_subtract(z2, x1);
+        z1 = modular_multiply_single(t2, A24);
+        z1 = modular_add(z1, x1);
+        z1 = modular_multiply(z1, t2);
+        x1 = modular_multiply(x1, z2);
+        z2 = modular_subtract(t1, x2);
+        z2 = modular_square(z2);
+        z2 = modular_multiply(z2, u);
+        x2 = modular_add(x2, t1);
+        x2 = modular_square(x2);
+    }
+
+    conditional_swap(x1, x2, swap);
+    conditional_swap(z1, z2, swap);
+
+    // Retrieve affine representation
+    u = modular_multiply(modular_multiply_inverse(z1), x1);
+
+    // Encode state for export
+    auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
+    export_field_element(u, buffer.data());
+
+    return buffer;
+}
+#else
 static void conditional_swap(u32* first, u32* second, u32 condition)
 {
     u32 mask = ~condition + 1;
@@ -27,13 +491,6 @@ static void conditional_swap(u32* first, u32* second, u32 condition)
     }
 }
 
-ErrorOr<ByteBuffer> X25519::generate_private_key()
-{
-    auto buffer = TRY(ByteBuffer::create_uninitialized(BYTES));
-    fill_with_random(buffer.data(), buffer.size());
-    return buffer;
-}
-
 ErrorOr<ByteBuffer> X25519::generate_public_key(ReadonlyBytes a)
 {
     u8 generator[BYTES] { 9 };
@@ -118,6 +575,7 @@ ErrorOr<ByteBuffer> X25519::compute_coordinate(ReadonlyBytes input_k, ReadonlyBy
 
     return buffer;
 }
+#endif
 
 ErrorOr<ByteBuffer> X25519::derive_premaster_key(ReadonlyBytes shared_point)
 {
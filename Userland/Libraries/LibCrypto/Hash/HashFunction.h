@@ -7,12 +7,41 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/StdLibExtras.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 
 namespace Crypto {
 namespace Hash {
 
+// Adds a message to a hash function that works on blocks. Whole blocks are hashed straight from the message with
+// transform_blocks(data, block_count), only the rest is buffered until the next update.
+template<size_t BlockSize, typename TransformBlocks>
+ALWAYS_INLINE void update_in_blocks(u8 (&data_buffer)[BlockSize], size_t& data_length, u64& bit_length, u8 const* message, size_t length, TransformBlocks transform_blocks)
+{
+    if (data_length > 0) {
+        auto size = min(length, BlockSize - data_length);
+        __builtin_memcpy(data_buffer + data_length, message, size);
+        data_length += size;
+        message += size;
+        length -= size;
+        if (data_length < BlockSize)
+            return;
+        transform_blocks(data_buffer, 1);
+        bit_length += BlockSize * 8;
+        data_length = 0;
+    }
+
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    bit_length += block_count * BlockSize * 8;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    __builtin_memcpy(data_buffer, message, length);
+    data_length = length;
+}
+
 template<size_t DigestS>
 struct Digest {
     static_assert(DigestS % 8 == 0);
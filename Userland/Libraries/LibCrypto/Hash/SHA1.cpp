@@ -4,11 +4,23 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/Endian.h>
 #include <AK/Memory.h>
+#include <AK/NumericLimits.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#ifndef KERNEL
+#    include <AK/SIMD.h>
+#    include <LibCrypto/CPUFeatures.h>
+#endif
+
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 
@@ -67,16 +79,93 @@ inline void SHA1::transform(u8 const* data)
     secure_zero(blocks, 16 * sizeof(u32));
 }
 
-void SHA1::update(u8 const* message, size_t length)
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool has_sha_ni()
+{
+    return cpu_features().sha && cpu_features().sse4_1;
+}
+
+// Runs the compression function with the SHA extensions, following Intel's "Intel SHA Extensions" paper.
+// SHA1RNDS4 does four rounds at a time, and SHA1NEXTE derives the next value of e while adding it to the
+// message words. The message schedule is completed four words at a time while the rounds go on.
+[[gnu::target("sha,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[5], u8 const* data, size_t block_count)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
+    auto const byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0])), 0x1b);
+    auto e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+    for (; block_count > 0; --block_count, data += SHA1::BlockSize) {
+        auto previous_abcd = abcd;
+        auto previous_e = e;
+
+        __m128i messages[4];
+        __m128i es[2] { e, {} };
+        // Unrolling keeps the message schedule in registers, and makes the round function a constant.
+#pragma GCC unroll 20
+        for (size_t group = 0; group < 20; ++group) {
+            auto& current = messages[group % 4];
+            if (group < 4)
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + group * 16)), byte_swap);
+
+            auto& e_with_words = es[group % 2];
+            if (group == 0)
+                e_with_words = _mm_add_epi32(e_with_words, current);
+            else
+                e_with_words = _mm_sha1nexte_epu32(e_with_words, current);
+            es[(group + 1) % 2] = abcd;
+
+            if (group >= 3 && group < 19)
+                messages[(group + 1) % 4] = _mm_sha1msg2_epu32(messages[(group + 1) % 4], current);
+
+            // The round function is an immediate operand.
+            switch (group / 5) {
+            case 0:
+                abcd = _mm_sha1rnds4_epu32(abcd, e_with_words, 0);
+                break;
+            case 1:
+                abcd = _mm_sha1rnds4_epu32(abcd, e_with_words, 1);
+                break;
+            case 2:
+                abcd = _mm_sha1rnds4_epu32(abcd, e_with_words, 2);
+                break;
+            default:
+                abcd = _mm_sha1rnds4_epu32(abcd, e_with_words, 3);
+                break;
+            }
+
+            if (group >= 1 && group < 17)
+                messages[(group + 3) % 4] = _mm_sha1msg1_epu32(messages[(group + 3) % 4], current);
+            if (group >= 2 && group < 18)
+                messages[(group + 2) % 4] = _mm_xor_si128(messages[(group + 2) % 4], current);
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        e = _mm_sha1nexte_epu32(es[0], previous_e);
+        abcd = _mm_add_epi32(abcd, previous_abcd);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<u32>(_mm_extract_epi32(e, 3));
+}
+#endif
+
+void SHA1::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_sha_ni()) {
+        transform_with_sha_ni(m_state, data, block_count);
+        return;
     }
+#endif
+    for (; block_count > 0; --block_count, data += BlockSize)
+        transform(data);
+}
+
+void SHA1::update(u8 const* message, size_t length)
+{
+    update_in_blocks(m_data_buffer, m_data_length, m_bit_length, message, length, [this](u8 const* data, size_t block_count) {
+        transform_blocks(data, block_count);
+    });
 }
 
 SHA1::DigestType SHA1::digest()
@@ -96,6 +185,8 @@ SHA1::DigestType SHA1::peek()
     u32 state[5];
     __builtin_memcpy(data, m_data_buffer, m_data_length);
     __builtin_memcpy(state, m_state, 20);
+    auto data_length = m_data_length;
+    auto bit_length = m_bit_length;
 
     if (BlockSize == m_data_length) {
         transform(m_data_buffer);
@@ -143,8 +234,131 @@ SHA1::DigestType SHA1::peek()
     // restore the data
     __builtin_memcpy(m_data_buffer, data, m_data_length);
     __builtin_memcpy(m_state, state, 20);
+    m_data_length = data_length;
+    m_bit_length = bit_length;
     return digest;
 }
 
+#ifndef KERNEL
+// Multi-buffer hashing runs the compression function for several messages at once, with every message in its
+// own lane of the vectors. The message words are gathered into the lanes one at a time.
+template<typename VectorType>
+static ALWAYS_INLINE void sha1_compress_in_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[5])
+{
+    constexpr size_t lane_count = sizeof(VectorType) / sizeof(u32);
+
+    VectorType state[5];
+    for (size_t i = 0; i < 5; ++i)
+        state[i] = VectorType {} + SHA1Constants::InitializationHashes[i];
+
+    for (size_t block = 0; block < block_count; ++block) {
+        VectorType w[80];
+        for (size_t i = 0; i < 16; ++i) {
+            for (size_t lane = 0; lane < lane_count; ++lane)
+                w[i][lane] = AK::convert_between_host_and_big_endian(ByteReader::load32(messages[lane] + block * SHA1::BlockSize + i * 4));
+        }
+        for (size_t i = 16; i < 80; ++i) {
+            auto value = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = (value << 1) | (value >> 31);
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (size_t i = 0; i < 80; ++i) {
+            VectorType f;
+            if (i <= 19)
+                f = (b & c) | (~b & d);
+            else if (i <= 39 || i >= 60)
+                f = b ^ c ^ d;
+            else
+                f = (b & c) | (b & d) | (c & d);
+            auto temp = ((a << 5) | (a >> 27)) + f + e + SHA1Constants::RoundConstants[i / 20] + w[i];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+
+    for (size_t lane = 0; lane < lane_count; ++lane) {
+        for (size_t i = 0; i < 5; ++i)
+            states[lane][i] = state[i][lane];
+    }
+}
+
+static void sha1_compress_in_four_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[5])
+{
+    sha1_compress_in_lanes<AK::SIMD::u32x4>(messages, block_count, states);
+}
+
+#    if ARCH(X86_64)
+[[gnu::target("avx2")]] static void sha1_compress_in_eight_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[5])
+{
+    sha1_compress_in_lanes<AK::SIMD::u32x8>(messages, block_count, states);
+}
+#    endif
+
+void SHA1::hash_many(Span<ReadonlyBytes const> messages, Span<DigestType> digests)
+{
+    VERIFY(digests.size() >= messages.size());
+
+#    if ARCH(X86_64)
+    // The SHA extensions beat even eight lanes of AVX2.
+    if (has_sha_ni()) {
+        for (size_t i = 0; i < messages.size(); ++i)
+            digests[i] = hash(messages[i].data(), messages[i].size());
+        return;
+    }
+#    endif
+
+    hash_many_in_lanes(messages, digests);
+}
+
+void SHA1::hash_many_in_lanes(Span<ReadonlyBytes const> messages, Span<DigestType> digests)
+{
+    VERIFY(digests.size() >= messages.size());
+
+    size_t lane_count = 4;
+    auto* compress = sha1_compress_in_four_lanes;
+#    if ARCH(X86_64)
+    if (cpu_features().avx2) {
+        lane_count = 8;
+        compress = sha1_compress_in_eight_lanes;
+    }
+#    endif
+
+    for (size_t first = 0; first < messages.size(); first += lane_count) {
+        auto count = min(lane_count, messages.size() - first);
+
+        // The lanes run for as many blocks as the shortest message has. Spare lanes repeat the first message.
+        u8 const* lanes[max_lane_count];
+        auto block_count = NumericLimits<size_t>::max();
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            auto message = messages[first + min(lane, count - 1)];
+            lanes[lane] = message.data();
+            block_count = min(block_count, message.size() / BlockSize);
+        }
+
+        u32 states[max_lane_count][5];
+        compress(lanes, block_count, states);
+
+        // The rest of every message, and its padding, is hashed on its own.
+        for (size_t lane = 0; lane < count; ++lane) {
+            SHA1 sha;
+            __builtin_memcpy(sha.m_state, states[lane], sizeof(sha.m_state));
+            sha.m_bit_length = block_count * BlockSize * 8;
+            sha.update(messages[first + lane].slice(block_count * BlockSize));
+            digests[first + lane] = sha.digest();
+        }
+    }
+}
+#endif
+
 }
 }
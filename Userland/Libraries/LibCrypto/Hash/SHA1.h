@@ -53,6 +53,11 @@ public:
     inline static DigestType hash(StringView buffer) { return hash((u8 const*)buffer.characters_without_null_termination(), buffer.length()); }
 
 #ifndef KERNEL
+    // Hashes several independent messages side by side, which is faster than one after another.
+    static void hash_many(Span<ReadonlyBytes const> messages, Span<DigestType> digests);
+    // What hash_many() does when there are no SHA extensions to hash each message faster on its own.
+    static void hash_many_in_lanes(Span<ReadonlyBytes const> messages, Span<DigestType> digests);
+
     virtual String class_name() const override
     {
         return "SHA1";
@@ -69,6 +74,9 @@ public:
 
 private:
     inline void transform(u8 const*);
+    void transform_blocks(u8 const*, size_t block_count);
+
+    static constexpr size_t max_lane_count = 8;
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
@@ -4,9 +4,22 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/NumericLimits.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#ifndef KERNEL
+#    include <AK/SIMD.h>
+#    include <LibCrypto/CPUFeatures.h>
+#endif
+
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
@@ -66,16 +79,79 @@ inline void SHA256::transform(u8 const* data)
     m_state[7] += h;
 }
 
-void SHA256::update(u8 const* message, size_t length)
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool has_sha_ni()
+{
+    return cpu_features().sha && cpu_features().sse4_1;
+}
+
+// Runs the compression function with the SHA extensions, following Intel's "Intel SHA Extensions" paper.
+// The instructions keep the state as ABEF and CDGH, and do two rounds at a time, so the message schedule and
+// round constants are fed in four words at a time.
+[[gnu::target("sha,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[8], u8 const* data, size_t block_count)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 512;
-            m_data_length = 0;
+    auto const byte_swap_words = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    auto dcba = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0]));
+    auto hgfe = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4]));
+    auto cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    auto efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    for (; block_count > 0; --block_count, data += SHA256::BlockSize) {
+        auto previous_abef = abef;
+        auto previous_cdgh = cdgh;
+
+        // Every group of four words of the message schedule starts out as the message itself, and is completed
+        // from the groups before it while the rounds go on. Unrolling keeps them in registers.
+        __m128i messages[4];
+#pragma GCC unroll 16
+        for (size_t group = 0; group < 16; ++group) {
+            auto& current = messages[group % 4];
+            if (group < 4)
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + group * 16)), byte_swap_words);
+
+            auto words = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[group * 4])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+            if (group >= 3 && group < 15) {
+                auto& next = messages[(group + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, messages[(group + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(words, 0x0e));
+            if (group >= 1 && group < 13)
+                messages[(group + 3) % 4] = _mm_sha256msg1_epu32(messages[(group + 3) % 4], current);
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        abef = _mm_add_epi32(abef, previous_abef);
+        cdgh = _mm_add_epi32(cdgh, previous_cdgh);
     }
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
+void SHA256::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_sha_ni()) {
+        transform_with_sha_ni(m_state, data, block_count);
+        return;
+    }
+#endif
+    for (; block_count > 0; --block_count, data += BlockSize)
+        transform(data);
+}
+
+void SHA256::update(u8 const* message, size_t length)
+{
+    update_in_blocks(m_data_buffer, m_data_length, m_bit_length, message, length, [this](u8 const* data, size_t block_count) {
+        transform_blocks(data, block_count);
+    });
 }
 
 SHA256::DigestType SHA256::digest()
@@ -90,6 +166,14 @@ SHA256::DigestType SHA256::peek()
     DigestType digest;
     size_t i = m_data_length;
 
+    // Padding the data clobbers the state, which has to survive for the hash to be updated further.
+    u8 data_buffer[BlockSize];
+    decltype(m_state) state;
+    __builtin_memcpy(data_buffer, m_data_buffer, BlockSize);
+    __builtin_memcpy(state, m_state, sizeof(m_state));
+    auto data_length = m_data_length;
+    auto bit_length = m_bit_length;
+
     if (BlockSize == m_data_length) {
         transform(m_data_buffer);
         m_bit_length += BlockSize * 8;
@@ -139,9 +223,140 @@ SHA256::DigestType SHA256::peek()
         digest.data[i + 24] = (m_state[6] >> (24 - i * 8)) & 0x000000ff;
         digest.data[i + 28] = (m_state[7] >> (24 - i * 8)) & 0x000000ff;
     }
+
+    __builtin_memcpy(m_data_buffer, data_buffer, BlockSize);
+    __builtin_memcpy(m_state, state, sizeof(m_state));
+    m_data_length = data_length;
+    m_bit_length = bit_length;
     return digest;
 }
 
+#ifndef KERNEL
+// Multi-buffer hashing runs the compression function for several messages at once, with every message in its
+// own lane of the vectors. The message words are gathered into the lanes one at a time.
+template<typename VectorType>
+static ALWAYS_INLINE void sha256_compress_in_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[8])
+{
+    constexpr size_t lane_count = sizeof(VectorType) / sizeof(u32);
+
+    VectorType state[8];
+    for (size_t i = 0; i < 8; ++i)
+        state[i] = VectorType {} + SHA256Constants::InitializationHashes[i];
+
+    for (size_t block = 0; block < block_count; ++block) {
+        VectorType m[64];
+        for (size_t i = 0; i < 16; ++i) {
+            for (size_t lane = 0; lane < lane_count; ++lane)
+                m[i][lane] = AK::convert_between_host_and_big_endian(ByteReader::load32(messages[lane] + block * SHA256::BlockSize + i * 4));
+        }
+        for (size_t i = 16; i < 64; ++i) {
+            auto w15 = m[i - 15];
+            auto w2 = m[i - 2];
+            auto sign0 = ((w15 >> 7) | (w15 << 25)) ^ ((w15 >> 18) | (w15 << 14)) ^ (w15 >> 3);
+            auto sign1 = ((w2 >> 17) | (w2 << 15)) ^ ((w2 >> 19) | (w2 << 13)) ^ (w2 >> 10);
+            m[i] = sign1 + m[i - 7] + sign0 + m[i - 16];
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+        for (size_t i = 0; i < 64; ++i) {
+            auto ep1 = ((e >> 6) | (e << 26)) ^ ((e >> 11) | (e << 21)) ^ ((e >> 25) | (e << 7));
+            auto temp0 = h + ep1 + ((e & f) ^ (g & ~e)) + SHA256Constants::RoundConstants[i] + m[i];
+            auto ep0 = ((a >> 2) | (a << 30)) ^ ((a >> 13) | (a << 19)) ^ ((a >> 22) | (a << 10));
+            auto temp1 = ep0 + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp0;
+            d = c;
+            c = b;
+            b = a;
+            a = temp0 + temp1;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+
+    for (size_t lane = 0; lane < lane_count; ++lane) {
+        for (size_t i = 0; i < 8; ++i)
+            states[lane][i] = state[i][lane];
+    }
+}
+
+static void sha256_compress_in_four_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[8])
+{
+    sha256_compress_in_lanes<AK::SIMD::u32x4>(messages, block_count, states);
+}
+
+#    if ARCH(X86_64)
+[[gnu::target("avx2")]] static void sha256_compress_in_eight_lanes(u8 const* const* messages, size_t block_count, u32 (*states)[8])
+{
+    sha256_compress_in_lanes<AK::SIMD::u32x8>(messages, block_count, states);
+}
+#    endif
+
+void SHA256::hash_many(Span<ReadonlyBytes const> messages, Span<DigestType> digests)
+{
+    VERIFY(digests.size() >= messages.size());
+
+#    if ARCH(X86_64)
+    // The SHA extensions beat even eight lanes of AVX2.
+    if (has_sha_ni()) {
+        for (size_t i = 0; i < messages.size(); ++i)
+            digests[i] = hash(messages[i].data(), messages[i].size());
+        return;
+    }
+#    endif
+
+    hash_many_in_lanes(messages, digests);
+}
+
+void SHA256::hash_many_in_lanes(Span<ReadonlyBytes const> messages, Span<DigestType> digests)
+{
+    VERIFY(digests.size() >= messages.size());
+
+    size_t lane_count = 4;
+    auto* compress = sha256_compress_in_four_lanes;
+#    if ARCH(X86_64)
+    if (cpu_features().avx2) {
+        lane_count = 8;
+        compress = sha256_compress_in_eight_lanes;
+    }
+#    endif
+
+    for (size_t first = 0; first < messages.size(); first += lane_count) {
+        auto count = min(lane_count, messages.size() - first);
+
+        // The lanes run for as many blocks as the shortest message has. Spare lanes repeat the first message.
+        u8 const* lanes[max_lane_count];
+        auto block_count = NumericLimits<size_t>::max();
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            auto message = messages[first + min(lane, count - 1)];
+            lanes[lane] = message.data();
+            block_count = min(block_count, message.size() / BlockSize);
+        }
+
+        u32 states[max_lane_count][8];
+        compress(lanes, block_count, states);
+
+        // The rest of every message, and its padding, is hashed on its own.
+        for (size_t lane = 0; lane < count; ++lane) {
+            SHA256 sha;
+            __builtin_memcpy(sha.m_state, states[lane], sizeof(sha.m_state));
+            sha.m_bit_length = block_count * BlockSize * 8;
+            sha.update(messages[first + lane].slice(block_count * BlockSize));
+            digests[first + lane] = sha.digest();
+        }
+    }
+}
+#endif
+
 inline void SHA384::transform(u8 const* data)
 {
     u64 m[80];
@@ -186,14 +401,10 @@ inline void SHA384::transform(u8 const* data)
 
 void SHA384::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 1024;
-            m_data_length = 0;
-        }
-        m_data_buffer[m_data_length++] = message[i];
-    }
+    update_in_blocks(m_data_buffer, m_data_length, m_bit_length, message, length, [this](u8 const* data, size_t block_count) {
+        for (; block_count > 0; --block_count, data += BlockSize)
+            transform(data);
+    });
 }
 
 SHA384::DigestType SHA384::digest()
@@ -208,6 +419,14 @@ SHA384::DigestType SHA384::peek()
     DigestType digest;
     size_t i = m_data_length;
 
+    // Padding the data clobbers the state, which has to survive for the hash to be updated further.
+    u8 data_buffer[BlockSize];
+    decltype(m_state) state;
+    __builtin_memcpy(data_buffer, m_data_buffer, BlockSize);
+    __builtin_memcpy(state, m_state, sizeof(m_state));
+    auto data_length = m_data_length;
+    auto bit_length = m_bit_length;
+
     if (BlockSize == m_data_length) {
         transform(m_data_buffer);
         m_bit_length += BlockSize * 8;
@@ -264,6 +483,11 @@ SHA384::DigestType SHA384::peek()
         digest.data[i + 32] = (m_state[4] >> (56 - i * 8)) & 0x000000ff;
         digest.data[i + 40] = (m_state[5] >> (56 - i * 8)) & 0x000000ff;
     }
+
+    __builtin_memcpy(m_data_buffer, data_buffer, BlockSize);
+    __builtin_memcpy(m_state, state, sizeof(m_state));
+    m_data_length = data_length;
+    m_bit_length = bit_length;
     return digest;
 }
 
@@ -310,14 +534,10 @@ inline void SHA512::transform(u8 const* data)
 
 void SHA512::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += 1024;
-            m_data_length = 0;
-        }
-        m_data_buffer[m_data_length++] = message[i];
-    }
+    update_in_blocks(m_data_buffer, m_data_length, m_bit_length, message, length, [this](u8 const* data, size_t block_count) {
+        for (; block_count > 0; --block_count, data += BlockSize)
+            transform(data);
+    });
 }
 
 SHA512::DigestType SHA512::digest()
@@ -332,6 +552,14 @@ SHA512::DigestType SHA512::peek()
     DigestType digest;
     size_t i = m_data_length;
 
+    // Padding the data clobbers the state, which has to survive for the hash to be updated further.
+    u8 data_buffer[BlockSize];
+    decltype(m_state) state;
+    __builtin_memcpy(data_buffer, m_data_buffer, BlockSize);
+    __builtin_memcpy(state, m_state, sizeof(m_state));
+    auto data_length = m_data_length;
+    auto bit_length = m_bit_length;
+
     if (BlockSize == m_data_length) {
         transform(m_data_buffer);
         m_bit_length += BlockSize * 8;
@@ -390,6 +618,11 @@ SHA512::DigestType SHA512::peek()
         digest.data[i + 48] = (m_state[6] >> (56 - i * 8)) & 0x000000ff;
         digest.data[i + 56] = (m_state[7] >> (56 - i * 8)) & 0x000000ff;
     }
+
+    __builtin_memcpy(m_data_buffer, data_buffer, BlockSize);
+    __builtin_memcpy(m_state, state, sizeof(m_state));
+    m_data_length = data_length;
+    m_bit_length = bit_length;
     return digest;
 }
 }
@@ -10,6 +10,7 @@
 #include <LibCompress/Brotli.h>
 #include <LibCompress/Gzip.h>
 #include <LibCompress/Zlib.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/Event.h>
 #include <LibCore/MemoryStream.h>
 #include <LibHTTP/HttpResponse.h>
@@ -98,6 +99,26 @@ static Optional<ByteBuffer> handle_content_encoding(ByteBuffer const& buf, Strin
             dbgln("  Output size: {}", uncompressed.value().size());
         }
 
+        return uncompressed.release_value();
+    } else if (content_encoding == "zstd") {
+        if (!Compress::ZstdDecompressor::is_likely_compressed(buf)) {
+            dbgln("Job::handle_content_encoding: buf is not zstd compressed!");
+        }
+
+        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is zstd compressed!");
+
+        auto uncompressed = Compress::ZstdDecompressor::decompress_all(buf);
+        if (!uncompressed.has_value()) {
+            dbgln("Job::handle_content_encoding: Zstd::decompress() failed.");
+            return {};
+        }
+
+        if constexpr (JOB_DEBUG) {
+            dbgln("Job::handle_content_encoding: Zstd::decompress() successful.");
+            dbgln("  Input size: {}", buf.size());
+            dbgln("  Output size: {}", uncompressed.value().size());
+        }
+
         return uncompressed.release_value();
     }
 
@@ -207,7 +228,8 @@ ErrorOr<ByteBuffer> Job::receive(size_t size)
         nread = TRY(result).size();
         break;
     } while (true);
-    return buffer.slice(0, nread);
+    buffer.resize(nread);
+    return buffer;
 }
 
 void Job::on_socket_connected()
@@ -523,9 +545,9 @@ void Job::on_socket_connected()
                 }
             }
 
-            m_received_buffers.append(make<ReceivedBuffer>(payload));
             m_buffered_size += payload.size();
             m_received_size += payload.size();
+            m_received_buffers.append(make<ReceivedBuffer>(move(payload)));
             flush_received_buffers();
 
             deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
@@ -26,6 +26,11 @@ private:
     ScopePusher(Parser& parser, ScopeNode* node, bool is_top_level)
         : m_parser(parser)
         , m_is_top_level(is_top_level)
+        , m_lexical_names(parser.m_scope_arena)
+        , m_var_names(parser.m_scope_arena)
+        , m_function_names(parser.m_scope_arena)
+        , m_forbidden_lexical_names(parser.m_scope_arena)
+        , m_forbidden_var_names(parser.m_scope_arena)
     {
         m_parent_scope = exchange(m_parser.m_state.current_scope_pusher, this);
         VERIFY(node || (m_parent_scope && !is_top_level));
@@ -260,12 +265,15 @@ private:
     ScopePusher* m_parent_scope { nullptr };
     ScopePusher* m_top_level_scope { nullptr };
 
-    HashTable<FlyString> m_lexical_names;
-    HashTable<FlyString> m_var_names;
-    HashTable<FlyString> m_function_names;
+    // These only live as long as the scope being parsed, so they are allocated from the parser's arena.
+    using NameTable = HashTable<FlyString, Traits<FlyString>, false, ArenaAllocator>;
 
-    HashTable<FlyString> m_forbidden_lexical_names;
-    HashTable<FlyString> m_forbidden_var_names;
+    NameTable m_lexical_names;
+    NameTable m_var_names;
+    NameTable m_function_names;
+
+    NameTable m_forbidden_lexical_names;
+    NameTable m_forbidden_var_names;
     NonnullRefPtrVector<FunctionDeclaration> m_functions_to_hoist;
 
     Optional<Vector<FunctionDeclaration::Parameter>> m_function_parameters;
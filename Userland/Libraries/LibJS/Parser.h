@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Arena.h>
 #include <AK/Assertions.h>
 #include <AK/HashTable.h>
 #include <AK/NonnullRefPtr.h>
@@ -336,6 +337,7 @@ private:
     };
 
     Vector<Position> m_rule_starts;
+    Arena m_scope_arena { 4 * KiB };
     ParserState m_state;
     FlyString m_filename;
     Vector<ParserState> m_saved_state;
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <AK/NonnullOwnPtr.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/RefCounted.h>
@@ -238,6 +239,17 @@ public:
     {
     }
 
+    TableOrSubquery(TableOrSubquery const& table_or_subquery, NonnullRefPtrVector<JoinClause> join_clauses)
+        : m_is_table(table_or_subquery.m_is_table)
+        , m_schema_name(table_or_subquery.m_schema_name)
+        , m_table_name(table_or_subquery.m_table_name)
+        , m_table_alias(table_or_subquery.m_table_alias)
+        , m_is_subquery(table_or_subquery.m_is_subquery)
+        , m_subqueries(table_or_subquery.m_subqueries)
+        , m_join_clauses(move(join_clauses))
+    {
+    }
+
     bool is_table() const { return m_is_table; }
     String const& schema_name() const { return m_schema_name; }
     String const& table_name() const { return m_table_name; }
@@ -246,6 +258,8 @@ public:
     bool is_subquery() const { return m_is_subquery; }
     NonnullRefPtrVector<TableOrSubquery> const& subqueries() const { return m_subqueries; }
 
+    NonnullRefPtrVector<JoinClause> const& join_clauses() const { return m_join_clauses; }
+
 private:
     bool m_is_table { false };
     String m_schema_name {};
@@ -254,6 +268,33 @@ private:
 
     bool m_is_subquery { false };
     NonnullRefPtrVector<TableOrSubquery> m_subqueries {};
+
+    NonnullRefPtrVector<JoinClause> m_join_clauses {};
+};
+
+enum class JoinOperator {
+    Inner,
+    Cross,
+    LeftOuter,
+};
+
+class JoinClause : public ASTNode {
+public:
+    JoinClause(JoinOperator join_operator, NonnullRefPtr<TableOrSubquery> table_or_subquery, RefPtr<Expression> join_constraint)
+        : m_join_operator(join_operator)
+        , m_table_or_subquery(move(table_or_subquery))
+        , m_join_constraint(move(join_constraint))
+    {
+    }
+
+    JoinOperator join_operator() const { return m_join_operator; }
+    NonnullRefPtr<TableOrSubquery> const& table_or_subquery() const { return m_table_or_subquery; }
+    RefPtr<Expression> const& join_constraint() const { return m_join_constraint; }
+
+private:
+    JoinOperator m_join_operator;
+    NonnullRefPtr<TableOrSubquery> m_table_or_subquery;
+    RefPtr<Expression> m_join_constraint;
 };
 
 class OrderingTerm : public ASTNode {
@@ -801,6 +842,36 @@ private:
     bool m_is_error_if_table_exists;
 };
 
+class CreateIndex : public Statement {
+public:
+    CreateIndex(String schema_name, String index_name, String table_name, NonnullRefPtrVector<OrderingTerm> indexed_columns, bool is_unique, bool is_error_if_index_exists)
+        : m_schema_name(move(schema_name))
+        , m_index_name(move(index_name))
+        , m_table_name(move(table_name))
+        , m_indexed_columns(move(indexed_columns))
+        , m_is_unique(is_unique)
+        , m_is_error_if_index_exists(is_error_if_index_exists)
+    {
+    }
+
+    String const& schema_name() const { return m_schema_name; }
+    String const& index_name() const { return m_index_name; }
+    String const& table_name() const { return m_table_name; }
+    NonnullRefPtrVector<OrderingTerm> const& indexed_columns() const { return m_indexed_columns; }
+    bool is_unique() const { return m_is_unique; }
+    bool is_error_if_index_exists() const { return m_is_error_if_index_exists; }
+
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    String m_schema_name;
+    String m_index_name;
+    String m_table_name;
+    NonnullRefPtrVector<OrderingTerm> m_indexed_columns;
+    bool m_is_unique;
+    bool m_is_error_if_index_exists;
+};
+
 class AlterTable : public Statement {
 public:
     String const& schema_name() const { return m_schema_name; }
@@ -1024,6 +1095,36 @@ private:
     RefPtr<ReturningClause> m_returning_clause;
 };
 
+enum class JoinStrategy {
+    NestedLoop,
+    Hash,
+    Merge,
+};
+
+struct TableAccessPlan {
+    NonnullRefPtr<TableDef> table;
+    RefPtr<IndexDef> index {};
+    Optional<Value> lower_bound {};
+    Optional<Value> upper_bound {};
+    BinaryOperator lower_bound_operator { BinaryOperator::GreaterThanEquals };
+    BinaryOperator upper_bound_operator { BinaryOperator::LessThanEquals };
+    NonnullRefPtrVector<Expression> filters {};
+
+    // How the rows of this table are joined with the rows of the tables before it. Hash
+    // and merge joins match outer_join_key, evaluated for the rows joined so far, with
+    // inner_join_key, evaluated for the rows of this table. The join filters are checked
+    // as soon as the rows are joined.
+    JoinStrategy join_strategy { JoinStrategy::NestedLoop };
+    RefPtr<Expression> outer_join_key {};
+    RefPtr<Expression> inner_join_key {};
+    NonnullRefPtrVector<Expression> join_filters {};
+};
+
+struct QueryPlan {
+    Vector<TableAccessPlan> tables;
+    NonnullRefPtrVector<Expression> filters;
+};
+
 class Select : public Statement {
 public:
     Select(RefPtr<CommonTableExpressionList> common_table_expression_list, bool select_all, NonnullRefPtrVector<ResultColumn> result_column_list, NonnullRefPtrVector<TableOrSubquery> table_or_subquery_list, RefPtr<Expression> where_clause, RefPtr<GroupByClause> group_by_clause, NonnullRefPtrVector<OrderingTerm> ordering_term_list, RefPtr<LimitClause> limit_clause)
@@ -1046,6 +1147,9 @@ public:
     RefPtr<GroupByClause> const& group_by_clause() const { return m_group_by_clause; }
     NonnullRefPtrVector<OrderingTerm> const& ordering_term_list() const { return m_ordering_term_list; }
     RefPtr<LimitClause> const& limit_clause() const { return m_limit_clause; }
+    ResultOr<QueryPlan> plan(ExecutionContext&) const;
+    ResultOr<NonnullOwnPtr<Operator>> open(ExecutionContext&) const;
+    ResultOr<NonnullOwnPtr<Cursor>> cursor(NonnullRefPtr<Database>) const;
     ResultOr<ResultSet> execute(ExecutionContext&) const override;
 
 private:
@@ -1073,4 +1177,18 @@ private:
     NonnullRefPtr<QualifiedTableName> m_qualified_table_name;
 };
 
+class Explain : public Statement {
+public:
+    explicit Explain(NonnullRefPtr<Statement> statement)
+        : m_statement(move(statement))
+    {
+    }
+
+    NonnullRefPtr<Statement> const& statement() const { return m_statement; }
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    NonnullRefPtr<Statement> m_statement;
+};
+
 }
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/ResultSet.h>
+
+namespace SQL::AST {
+
+static String describe_filters(StringView what, size_t count)
+{
+    return String::formatted("FILTER {} ({} {})", what, count, (count == 1) ? "TERM"sv : "TERMS"sv);
+}
+
+static String describe_table_access(TableAccessPlan const& table)
+{
+    auto table_name = String::formatted("{}.{}", table.table->parent()->name(), table.table->name());
+    if (!table.index)
+        return String::formatted("SCAN {}", table_name);
+
+    auto const& column_name = table.index->key_definition().first().name();
+    if (!table.lower_bound.has_value() && !table.upper_bound.has_value())
+        return String::formatted("SCAN {} USING {}INDEX {}", table_name, table.index->unique() ? "UNIQUE "sv : ""sv, table.index->name());
+
+    StringBuilder builder;
+    builder.appendff("SEARCH {} USING {}INDEX {} (", table_name, table.index->unique() ? "UNIQUE "sv : ""sv, table.index->name());
+    if (table.lower_bound_operator == BinaryOperator::Equals) {
+        builder.appendff("{}=?", column_name);
+    } else {
+        if (table.lower_bound.has_value())
+            builder.appendff("{}{}?", column_name, BinaryOperator_name(table.lower_bound_operator));
+        if (table.lower_bound.has_value() && table.upper_bound.has_value())
+            builder.append(" AND "sv);
+        if (table.upper_bound.has_value())
+            builder.appendff("{}{}?", column_name, BinaryOperator_name(table.upper_bound_operator));
+    }
+    builder.append(')');
+    return builder.build();
+}
+
+static String describe_column(Expression const& expression)
+{
+    auto const& column = static_cast<ColumnNameExpression const&>(expression);
+    if (column.table_name().is_empty())
+        return column.column_name();
+    return String::formatted("{}.{}", column.table_name(), column.column_name());
+}
+
+static String describe_join(TableAccessPlan const& table)
+{
+    auto table_name = String::formatted("{}.{}", table.table->parent()->name(), table.table->name());
+    switch (table.join_strategy) {
+    case JoinStrategy::NestedLoop:
+        return String::formatted("NESTED LOOP JOIN {}", table_name);
+    case JoinStrategy::Hash:
+        return String::formatted("HASH JOIN {} ON {} = {}", table_name, describe_column(*table.inner_join_key), describe_column(*table.outer_join_key));
+    case JoinStrategy::Merge:
+        return String::formatted("MERGE JOIN {} ON {} = {}", table_name, describe_column(*table.inner_join_key), describe_column(*table.outer_join_key));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ResultOr<ResultSet> Explain::execute(ExecutionContext& context) const
+{
+    if (!is<Select>(*m_statement))
+        return Result { SQLCommand::Explain, SQLErrorCode::NotYetImplemented, "Only SELECT statements can be explained"sv };
+
+    auto const& select = static_cast<Select const&>(*m_statement);
+    auto plan = TRY(select.plan(context));
+
+    NonnullRefPtr<TupleDescriptor> descriptor = adopt_ref(*new TupleDescriptor);
+    descriptor->append({ "", "", "plan", SQLType::Text, Order::Ascending });
+
+    ResultSet result { SQLCommand::Explain };
+    auto append_line = [&](String line) {
+        Tuple tuple(descriptor);
+        tuple[0] = move(line);
+        result.insert_row(tuple, Tuple {});
+    };
+
+    for (auto ix = 0u; ix < plan.tables.size(); ix++) {
+        auto const& table = plan.tables[ix];
+        append_line(describe_table_access(table));
+        if (!table.filters.is_empty())
+            append_line(describe_filters(String::formatted("{}.{}", table.table->parent()->name(), table.table->name()), table.filters.size()));
+        if (ix > 0)
+            append_line(describe_join(table));
+        if (!table.join_filters.is_empty())
+            append_line(describe_filters("JOIN"sv, table.join_filters.size()));
+    }
+    if (!plan.filters.is_empty())
+        append_line(describe_filters("RESULT"sv, plan.filters.size()));
+    if (!select.ordering_term_list().is_empty())
+        append_line("SORT FOR ORDER BY");
+    if (select.limit_clause())
+        append_line("LIMIT");
+
+    return result;
+}
+
+}
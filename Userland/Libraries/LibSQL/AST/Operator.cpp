@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/Operator.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+static ResultOr<bool> evaluate_filters(ExecutionContext& context, Tuple& row, NonnullRefPtrVector<Expression> const& filters)
+{
+    context.current_row = &row;
+    for (auto& filter : filters) {
+        auto value = TRY(filter.evaluate(context));
+        if (!value)
+            return false;
+    }
+    return true;
+}
+
+ResultOr<Optional<Tuple>> SingleRowOperator::next()
+{
+    if (m_done)
+        return Optional<Tuple> {};
+    m_done = true;
+    return Tuple {};
+}
+
+ResultOr<Optional<Tuple>> TableScanOperator::next()
+{
+    if (!m_pointer)
+        return Optional<Tuple> {};
+    auto row = m_context.database->read_row(*m_table, m_pointer);
+    m_pointer = row.next_pointer();
+    return Tuple { move(row) };
+}
+
+ResultOr<Optional<Tuple>> IndexScanOperator::next()
+{
+    if (!m_tree) {
+        m_tree = m_context.database->index_tree(*m_index);
+        if (m_upper_bound.has_value())
+            m_upper_key = Database::index_scan_bound(*m_index, m_upper_bound.value());
+    }
+    if (!m_iterator.has_value() || m_tree_version != m_tree->version()) {
+        // Rows inserted since the last call may have moved the entries of the
+        // index around, so the iterator has to find its place again.
+        m_tree_version = m_tree->version();
+        m_iterator = m_last_key.has_value()
+            ? m_tree->find_smallest_not_below(m_last_key.value())
+            : m_context.database->index_scan_start(*m_index, m_lower_bound);
+    }
+
+    auto& iterator = m_iterator.value();
+    for (; !iterator.is_end(); iterator++) {
+        auto const& key = *iterator;
+        if (m_upper_key.has_value() && (key.compare(m_upper_key.value()) > 0))
+            break;
+
+        if (!m_last_key.has_value() || (key.compare(m_last_key.value()) != 0)) {
+            m_last_key = key;
+            m_last_key_pointers.clear();
+        } else if (m_last_key_pointers.contains(key.pointer())) {
+            continue;
+        }
+        m_last_key_pointers.set(key.pointer());
+
+        auto pointer = key.pointer();
+        iterator++;
+        return Tuple { m_context.database->read_row(*m_table, pointer) };
+    }
+    return Optional<Tuple> {};
+}
+
+ResultOr<Optional<Tuple>> FilterOperator::next()
+{
+    while (true) {
+        auto row = TRY(m_input->next());
+        if (!row.has_value() || TRY(evaluate_filters(m_context, row.value(), m_filters)))
+            return row;
+    }
+}
+
+AbstractJoinOperator::AbstractJoinOperator(ExecutionContext& context, NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, RefPtr<Expression> outer_key, RefPtr<Expression> inner_key, NonnullRefPtrVector<Expression> join_filters)
+    : m_context(context)
+    , m_outer(move(outer))
+    , m_inner(move(inner))
+    , m_outer_key(move(outer_key))
+    , m_inner_key(move(inner_key))
+    , m_join_filters(move(join_filters))
+{
+    m_join_rows = [this](Tuple const& outer_row, Tuple const& inner_row) -> ResultOr<void> {
+        // All rows of an input have the same columns, so the descriptor of the
+        // joined rows is put together from the first pair of rows.
+        if (!m_descriptor) {
+            m_descriptor = adopt_ref(*new TupleDescriptor);
+            m_descriptor->extend(*outer_row.descriptor());
+            m_descriptor->extend(*inner_row.descriptor());
+        }
+
+        Tuple joined_row(*m_descriptor);
+        joined_row.clear();
+        for (auto ix = 0u; ix < outer_row.size(); ix++)
+            joined_row.append(outer_row[ix]);
+        for (auto ix = 0u; ix < inner_row.size(); ix++)
+            joined_row.append(inner_row[ix]);
+
+        if (TRY(evaluate_filters(m_context, joined_row, m_join_filters)))
+            m_joined_rows.append(move(joined_row));
+        return {};
+    };
+}
+
+ResultOr<Optional<Tuple>> AbstractJoinOperator::next()
+{
+    while (m_joined_row_index >= m_joined_rows.size()) {
+        m_joined_rows.clear();
+        m_joined_row_index = 0;
+        if (!TRY(join_next()))
+            return Optional<Tuple> {};
+    }
+    return move(m_joined_rows[m_joined_row_index++]);
+}
+
+ResultOr<Optional<JoinRow>> AbstractJoinOperator::next_join_row(Operator& input, RefPtr<Expression> const& key)
+{
+    auto row = TRY(input.next());
+    if (!row.has_value())
+        return Optional<JoinRow> {};
+
+    m_context.current_row = &row.value();
+    auto key_value = key ? TRY(key->evaluate(m_context)) : Value {};
+    return JoinRow { move(key_value), row.release_value() };
+}
+
+ResultOr<Vector<JoinRow>> AbstractJoinOperator::all_join_rows(Operator& input, RefPtr<Expression> const& key)
+{
+    Vector<JoinRow> rows;
+    while (true) {
+        auto row = TRY(next_join_row(input, key));
+        if (!row.has_value())
+            return rows;
+        rows.append(row.release_value());
+    }
+}
+
+ResultOr<bool> NestedLoopJoinOperator::join_next()
+{
+    if (!m_inner_rows.has_value()) {
+        m_inner_rows = Vector<Tuple> {};
+        while (true) {
+            auto row = TRY(m_inner->next());
+            if (!row.has_value())
+                break;
+            m_inner_rows->append(row.release_value());
+        }
+    }
+
+    auto outer_row = TRY(m_outer->next());
+    if (!outer_row.has_value())
+        return false;
+    for (auto& inner_row : m_inner_rows.value())
+        TRY(m_join_rows(outer_row.value(), inner_row));
+    return true;
+}
+
+ResultOr<bool> HashJoinOperator::join_next()
+{
+    if (!m_is_built) {
+        while (true) {
+            auto row = TRY(next_inner_row());
+            if (!row.has_value())
+                break;
+            TRY(m_hash_join.add_build_row(row.release_value()));
+        }
+        m_is_built = true;
+    }
+
+    if (!m_outer_exhausted) {
+        auto row = TRY(next_outer_row());
+        if (row.has_value()) {
+            TRY(m_hash_join.probe(row.release_value(), m_join_rows));
+            return true;
+        }
+        m_outer_exhausted = true;
+    }
+    return m_hash_join.join_next_partition(m_join_rows);
+}
+
+ResultOr<bool> MergeJoinOperator::join_next()
+{
+    if (!m_merge_join) {
+        auto outer_rows = TRY(all_join_rows(*m_outer, m_outer_key));
+        auto inner_rows = TRY(all_join_rows(*m_inner, m_inner_key));
+        m_merge_join = make<MergeJoin>(move(outer_rows), move(inner_rows));
+    }
+    return m_merge_join->join_next(m_join_rows);
+}
+
+ResultOr<Optional<Tuple>> SortOperator::next()
+{
+    if (!m_rows.has_value()) {
+        m_rows = ResultSet { SQLCommand::Select };
+
+        auto sort_descriptor = adopt_ref(*new TupleDescriptor);
+        for (auto& term : m_ordering_terms)
+            sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
+        Tuple sort_key(sort_descriptor);
+
+        while (true) {
+            auto row = TRY(m_input->next());
+            if (!row.has_value())
+                break;
+            m_context.current_row = &row.value();
+            sort_key.clear();
+            for (auto& term : m_ordering_terms) {
+                auto value = TRY(term.expression()->evaluate(m_context));
+                sort_key.append(value);
+            }
+            m_rows->insert_row(row.value(), sort_key);
+        }
+    }
+
+    if (m_row_index >= m_rows->size())
+        return Optional<Tuple> {};
+    return move(m_rows->at(m_row_index++).row);
+}
+
+ResultOr<Optional<Tuple>> LimitOperator::next()
+{
+    if (m_row_count >= m_limit)
+        return Optional<Tuple> {};
+    for (; m_offset > 0; m_offset--) {
+        if (!TRY(m_input->next()).has_value())
+            return Optional<Tuple> {};
+    }
+    m_row_count++;
+    return m_input->next();
+}
+
+ResultOr<Optional<Tuple>> ProjectOperator::next()
+{
+    auto row = TRY(m_input->next());
+    if (!row.has_value())
+        return Optional<Tuple> {};
+
+    m_context.current_row = &row.value();
+    Tuple tuple(m_descriptor);
+    tuple.clear();
+    for (auto& column : m_columns) {
+        auto value = TRY(column.expression()->evaluate(m_context));
+        tuple.append(value);
+    }
+    return tuple;
+}
+
+}
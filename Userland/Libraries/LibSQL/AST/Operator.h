@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Join.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/Tuple.h>
+
+namespace SQL::AST {
+
+/**
+ * Operators carry out a query plan. They form a tree, and every operator
+ * produces its rows one at a time, pulling rows from the operators below it
+ * only when it needs them. Operators that have to see all of their input
+ * before they can produce anything, like sorting, read it on the first call
+ * to next().
+ *
+ * Operators evaluate expressions in a shared ExecutionContext, which has to
+ * outlive them.
+ */
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns the next row, or nothing once all rows have been produced.
+    virtual ResultOr<Optional<Tuple>> next() = 0;
+};
+
+// Produces a single row without any columns, for SELECTs without tables.
+class SingleRowOperator final : public Operator {
+public:
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    bool m_done { false };
+};
+
+class TableScanOperator final : public Operator {
+public:
+    TableScanOperator(ExecutionContext& context, NonnullRefPtr<TableDef> table)
+        : m_context(context)
+        , m_table(move(table))
+        , m_pointer(m_table->pointer())
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    ExecutionContext& m_context;
+    NonnullRefPtr<TableDef> m_table;
+    u32 m_pointer { 0 };
+};
+
+// Reads the rows of a table in the order of an index, from the lower bound up
+// to and including the upper bound on the leading column of the index. Rows
+// that are inserted between two calls to next() are read if they come after
+// the last row in the order of the index.
+class IndexScanOperator final : public Operator {
+public:
+    IndexScanOperator(ExecutionContext& context, NonnullRefPtr<TableDef> table, NonnullRefPtr<IndexDef> index, Optional<Value> lower_bound, Optional<Value> upper_bound)
+        : m_context(context)
+        , m_table(move(table))
+        , m_index(move(index))
+        , m_lower_bound(move(lower_bound))
+        , m_upper_bound(move(upper_bound))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    ExecutionContext& m_context;
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtr<IndexDef> m_index;
+    Optional<Value> m_lower_bound;
+    Optional<Value> m_upper_bound;
+    RefPtr<BTree> m_tree;
+    u32 m_tree_version { 0 };
+    Optional<BTreeIterator> m_iterator;
+    Optional<Key> m_upper_key;
+    // The key of the last row, and the rows read with that key so far. Those
+    // are next to each other in the index, and are skipped when the scan has
+    // to find its place again.
+    Optional<Key> m_last_key;
+    HashTable<u32> m_last_key_pointers;
+};
+
+// Passes on the rows for which all filters are true.
+class FilterOperator final : public Operator {
+public:
+    FilterOperator(ExecutionContext& context, NonnullOwnPtr<Operator> input, NonnullRefPtrVector<Expression> filters)
+        : m_context(context)
+        , m_input(move(input))
+        , m_filters(move(filters))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    ExecutionContext& m_context;
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<Expression> m_filters;
+};
+
+/**
+ * Joins the rows of an outer input with the rows of an inner input, and passes
+ * on the joined rows for which all join filters are true. Joined rows have the
+ * columns of the outer row followed by those of the inner row.
+ *
+ * Subclasses produce the joined rows of the next step of the join in
+ * join_next(), and next() hands them out one at a time.
+ */
+class AbstractJoinOperator : public Operator {
+public:
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+protected:
+    AbstractJoinOperator(ExecutionContext&, NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, RefPtr<Expression> outer_key, RefPtr<Expression> inner_key, NonnullRefPtrVector<Expression> join_filters);
+
+    // Returns false once there are no more rows to join.
+    virtual ResultOr<bool> join_next() = 0;
+
+    ResultOr<Optional<JoinRow>> next_outer_row() { return next_join_row(*m_outer, m_outer_key); }
+    ResultOr<Optional<JoinRow>> next_inner_row() { return next_join_row(*m_inner, m_inner_key); }
+    ResultOr<Vector<JoinRow>> all_join_rows(Operator&, RefPtr<Expression> const& key);
+
+    ExecutionContext& m_context;
+    NonnullOwnPtr<Operator> m_outer;
+    NonnullOwnPtr<Operator> m_inner;
+    RefPtr<Expression> m_outer_key;
+    RefPtr<Expression> m_inner_key;
+    JoinCallback m_join_rows;
+
+private:
+    ResultOr<Optional<JoinRow>> next_join_row(Operator&, RefPtr<Expression> const& key);
+
+    NonnullRefPtrVector<Expression> m_join_filters;
+    RefPtr<TupleDescriptor> m_descriptor;
+    Vector<Tuple> m_joined_rows;
+    size_t m_joined_row_index { 0 };
+};
+
+// Reads the inner input into memory, and joins every outer row with all of it.
+class NestedLoopJoinOperator final : public AbstractJoinOperator {
+public:
+    NestedLoopJoinOperator(ExecutionContext& context, NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtrVector<Expression> join_filters)
+        : AbstractJoinOperator(context, move(outer), move(inner), nullptr, nullptr, move(join_filters))
+    {
+    }
+
+private:
+    virtual ResultOr<bool> join_next() override;
+
+    Optional<Vector<Tuple>> m_inner_rows;
+};
+
+// Builds a hash table from the inner input, and probes it with one outer row
+// at a time. Once the hash join has spilled to disk, the outer rows are all
+// partitioned before the partitions are joined one by one.
+class HashJoinOperator final : public AbstractJoinOperator {
+public:
+    HashJoinOperator(ExecutionContext& context, NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<Expression> outer_key, NonnullRefPtr<Expression> inner_key, NonnullRefPtrVector<Expression> join_filters)
+        : AbstractJoinOperator(context, move(outer), move(inner), move(outer_key), move(inner_key), move(join_filters))
+        , m_hash_join(context.database->join_memory_budget())
+    {
+    }
+
+private:
+    virtual ResultOr<bool> join_next() override;
+
+    HashJoin m_hash_join;
+    bool m_is_built { false };
+    bool m_outer_exhausted { false };
+};
+
+// Reads both inputs into memory, and joins them with a MergeJoin.
+class MergeJoinOperator final : public AbstractJoinOperator {
+public:
+    MergeJoinOperator(ExecutionContext& context, NonnullOwnPtr<Operator> outer, NonnullOwnPtr<Operator> inner, NonnullRefPtr<Expression> outer_key, NonnullRefPtr<Expression> inner_key, NonnullRefPtrVector<Expression> join_filters)
+        : AbstractJoinOperator(context, move(outer), move(inner), move(outer_key), move(inner_key), move(join_filters))
+    {
+    }
+
+private:
+    virtual ResultOr<bool> join_next() override;
+
+    OwnPtr<MergeJoin> m_merge_join;
+};
+
+// Reads all input rows, and produces them ordered on the ordering terms. Rows
+// that compare equal keep their input order.
+class SortOperator final : public Operator {
+public:
+    SortOperator(ExecutionContext& context, NonnullOwnPtr<Operator> input, NonnullRefPtrVector<OrderingTerm> ordering_terms)
+        : m_context(context)
+        , m_input(move(input))
+        , m_ordering_terms(move(ordering_terms))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    ExecutionContext& m_context;
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<OrderingTerm> m_ordering_terms;
+    Optional<ResultSet> m_rows;
+    size_t m_row_index { 0 };
+};
+
+// Skips the first `offset` rows and stops after `limit` more. Once the limit
+// is reached, no more rows are pulled from the input.
+class LimitOperator final : public Operator {
+public:
+    LimitOperator(NonnullOwnPtr<Operator> input, size_t offset, size_t limit)
+        : m_input(move(input))
+        , m_offset(offset)
+        , m_limit(limit)
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    size_t m_offset { 0 };
+    size_t m_limit { 0 };
+    size_t m_row_count { 0 };
+};
+
+// Evaluates the result columns for every input row.
+class ProjectOperator final : public Operator {
+public:
+    ProjectOperator(ExecutionContext& context, NonnullOwnPtr<Operator> input, NonnullRefPtrVector<ResultColumn> columns)
+        : m_context(context)
+        , m_input(move(input))
+        , m_columns(move(columns))
+        , m_descriptor(adopt_ref(*new TupleDescriptor))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next() override;
+
+private:
+    ExecutionContext& m_context;
+    NonnullOwnPtr<Operator> m_input;
+    NonnullRefPtrVector<ResultColumn> m_columns;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+};
+
+/**
+ * A Cursor produces the result rows of a SELECT statement one at a time. It
+ * keeps the statement and the execution context alive for as long as its
+ * operators need them.
+ */
+class Cursor {
+public:
+    ResultOr<Optional<Tuple>> next() { return m_root->next(); }
+
+private:
+    friend class Select;
+
+    Cursor(NonnullRefPtr<Select const> select, NonnullRefPtr<Database> database)
+        : m_select(move(select))
+        , m_context { move(database), m_select.ptr(), nullptr }
+    {
+    }
+
+    NonnullRefPtr<Select const> m_select;
+    ExecutionContext m_context;
+    OwnPtr<Operator> m_root;
+};
+
+}
@@ -41,6 +41,8 @@ NonnullRefPtr<Statement> Parser::parse_statement()
         consume();
         if (match(TokenType::Schema))
             return parse_create_schema_statement();
+        else if (match(TokenType::Unique) || match(TokenType::Index))
+            return parse_create_index_statement();
         else
             return parse_create_table_statement();
     case TokenType::Alter:
@@ -49,6 +51,8 @@ NonnullRefPtr<Statement> Parser::parse_statement()
         return parse_drop_table_statement();
     case TokenType::Describe:
         return parse_describe_table_statement();
+    case TokenType::Explain:
+        return parse_explain_statement();
     case TokenType::Insert:
         return parse_insert_statement({});
     case TokenType::Update:
@@ -58,7 +62,7 @@ NonnullRefPtr<Statement> Parser::parse_statement()
     case TokenType::Select:
         return parse_select_statement({});
     default:
-        expected("CREATE, ALTER, DROP, DESCRIBE, INSERT, UPDATE, DELETE, or SELECT");
+        expected("CREATE, ALTER, DROP, DESCRIBE, EXPLAIN, INSERT, UPDATE, DELETE, or SELECT");
         return create_ast_node<ErrorStatement>();
     }
 }
@@ -129,6 +133,35 @@ NonnullRefPtr<CreateTable> Parser::parse_create_table_statement()
     return create_ast_node<CreateTable>(move(schema_name), move(table_name), move(column_definitions), is_temporary, is_error_if_table_exists);
 }
 
+NonnullRefPtr<CreateIndex> Parser::parse_create_index_statement()
+{
+    // https://sqlite.org/lang_createindex.html
+
+    bool is_unique = consume_if(TokenType::Unique);
+    consume(TokenType::Index);
+
+    bool is_error_if_index_exists = true;
+    if (consume_if(TokenType::If)) {
+        consume(TokenType::Not);
+        consume(TokenType::Exists);
+        is_error_if_index_exists = false;
+    }
+
+    String schema_name;
+    String index_name;
+    parse_schema_and_table_name(schema_name, index_name);
+
+    consume(TokenType::On);
+    String table_name = consume(TokenType::Identifier).value();
+
+    NonnullRefPtrVector<OrderingTerm> indexed_columns;
+    parse_comma_separated_list(true, [&]() { indexed_columns.append(parse_ordering_term()); });
+
+    // FIXME: Parse the "WHERE" clause of partial indexes.
+
+    return create_ast_node<CreateIndex>(move(schema_name), move(index_name), move(table_name), move(indexed_columns), is_unique, is_error_if_index_exists);
+}
+
 NonnullRefPtr<AlterTable> Parser::parse_alter_table_statement()
 {
     // https://sqlite.org/lang_altertable.html
@@ -194,6 +227,17 @@ NonnullRefPtr<DescribeTable> Parser::parse_describe_table_statement()
     return create_ast_node<DescribeTable>(move(table_name));
 }
 
+NonnullRefPtr<Explain> Parser::parse_explain_statement()
+{
+    // https://sqlite.org/lang_explain.html
+    consume(TokenType::Explain);
+
+    if (consume_if(TokenType::Query))
+        consume(TokenType::Plan);
+
+    return create_ast_node<Explain>(parse_statement());
+}
+
 NonnullRefPtr<Insert> Parser::parse_insert_statement(RefPtr<CommonTableExpressionList> common_table_expression_list)
 {
     // https://sqlite.org/lang_insert.html
@@ -273,8 +317,7 @@ NonnullRefPtr<Update> Parser::parse_update_statement(RefPtr<CommonTableExpressio
 
     NonnullRefPtrVector<TableOrSubquery> table_or_subquery_list;
     if (consume_if(TokenType::From)) {
-        // FIXME: Parse join-clause.
-        parse_comma_separated_list(false, [&]() { table_or_subquery_list.append(parse_table_or_subquery()); });
+        parse_comma_separated_list(false, [&]() { table_or_subquery_list.append(parse_join_clause()); });
     }
 
     RefPtr<Expression> where_clause;
@@ -319,8 +362,7 @@ NonnullRefPtr<Select> Parser::parse_select_statement(RefPtr<CommonTableExpressio
 
     NonnullRefPtrVector<TableOrSubquery> table_or_subquery_list;
     if (consume_if(TokenType::From)) {
-        // FIXME: Parse join-clause.
-        parse_comma_separated_list(false, [&]() { table_or_subquery_list.append(parse_table_or_subquery()); });
+        parse_comma_separated_list(false, [&]() { table_or_subquery_list.append(parse_join_clause()); });
     }
 
     RefPtr<Expression> where_clause;
@@ -1015,14 +1057,46 @@ NonnullRefPtr<TableOrSubquery> Parser::parse_table_or_subquery()
         return create_ast_node<TableOrSubquery>(move(schema_name), move(table_name), move(table_alias));
     }
 
-    // FIXME: Parse join-clause.
-
     NonnullRefPtrVector<TableOrSubquery> subqueries;
-    parse_comma_separated_list(true, [&]() { subqueries.append(parse_table_or_subquery()); });
+    parse_comma_separated_list(true, [&]() { subqueries.append(parse_join_clause()); });
 
     return create_ast_node<TableOrSubquery>(move(subqueries));
 }
 
+NonnullRefPtr<TableOrSubquery> Parser::parse_join_clause()
+{
+    // https://sqlite.org/syntax/join-clause.html
+    auto table_or_subquery = parse_table_or_subquery();
+
+    NonnullRefPtrVector<JoinClause> join_clauses;
+    while (true) {
+        // https://sqlite.org/syntax/join-operator.html
+        JoinOperator join_operator = JoinOperator::Inner;
+        if (consume_if(TokenType::Left)) {
+            consume_if(TokenType::Outer); // OUTER is implied by LEFT, so ignore it if specified.
+            join_operator = JoinOperator::LeftOuter;
+        } else if (consume_if(TokenType::Cross)) {
+            join_operator = JoinOperator::Cross;
+        } else if (!consume_if(TokenType::Inner) && !match(TokenType::Join)) {
+            break;
+        }
+        consume(TokenType::Join);
+
+        auto joined_table_or_subquery = parse_table_or_subquery();
+
+        // https://sqlite.org/syntax/join-constraint.html
+        RefPtr<Expression> join_constraint;
+        if (consume_if(TokenType::On))
+            join_constraint = parse_expression();
+
+        join_clauses.append(create_ast_node<JoinClause>(join_operator, move(joined_table_or_subquery), move(join_constraint)));
+    }
+
+    if (join_clauses.is_empty())
+        return table_or_subquery;
+    return create_ast_node<TableOrSubquery>(*table_or_subquery, move(join_clauses));
+}
+
 NonnullRefPtr<OrderingTerm> Parser::parse_ordering_term()
 {
     // https://sqlite.org/syntax/ordering-term.html
@@ -58,9 +58,11 @@ private:
     NonnullRefPtr<Statement> parse_statement_with_expression_list(RefPtr<CommonTableExpressionList>);
     NonnullRefPtr<CreateSchema> parse_create_schema_statement();
     NonnullRefPtr<CreateTable> parse_create_table_statement();
+    NonnullRefPtr<CreateIndex> parse_create_index_statement();
     NonnullRefPtr<AlterTable> parse_alter_table_statement();
     NonnullRefPtr<DropTable> parse_drop_table_statement();
     NonnullRefPtr<DescribeTable> parse_describe_table_statement();
+    NonnullRefPtr<Explain> parse_explain_statement();
     NonnullRefPtr<Insert> parse_insert_statement(RefPtr<CommonTableExpressionList>);
     NonnullRefPtr<Update> parse_update_statement(RefPtr<CommonTableExpressionList>);
     NonnullRefPtr<Delete> parse_delete_statement(RefPtr<CommonTableExpressionList>);
@@ -93,6 +95,7 @@ private:
     NonnullRefPtr<ReturningClause> parse_returning_clause();
     NonnullRefPtr<ResultColumn> parse_result_column();
     NonnullRefPtr<TableOrSubquery> parse_table_or_subquery();
+    NonnullRefPtr<TableOrSubquery> parse_join_clause();
     NonnullRefPtr<OrderingTerm> parse_ordering_term();
     void parse_schema_and_table_name(String& schema_name, String& table_name);
     ConflictResolution parse_conflict_resolution();
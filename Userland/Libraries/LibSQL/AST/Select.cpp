@@ -5,143 +5,568 @@
  */
 
 #include <AK/NumericLimits.h>
+#include <AK/TypeCasts.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/Database.h>
+#include <LibSQL/Join.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
 
 namespace SQL::AST {
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+// Collects the columns referenced by an expression. Returns false if the
+// expression contains something the planner can't see through, like a
+// sub-select.
+static bool collect_column_references(Expression const& expression, Vector<ColumnNameExpression const*>& columns)
 {
-    NonnullRefPtrVector<ResultColumn> columns;
+    if (is<ColumnNameExpression>(expression)) {
+        columns.append(&static_cast<ColumnNameExpression const&>(expression));
+        return true;
+    }
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BlobLiteral>(expression) || is<NullLiteral>(expression))
+        return true;
+    if (is<BetweenExpression>(expression)) {
+        auto const& between = static_cast<BetweenExpression const&>(expression);
+        if (!collect_column_references(*between.expression(), columns))
+            return false;
+    }
+    if (is<MatchExpression>(expression)) {
+        auto const& match = static_cast<MatchExpression const&>(expression);
+        if (match.escape() && !collect_column_references(*match.escape(), columns))
+            return false;
+    }
+    if (is<NestedDoubleExpression>(expression)) {
+        auto const& nested = static_cast<NestedDoubleExpression const&>(expression);
+        return collect_column_references(*nested.lhs(), columns) && collect_column_references(*nested.rhs(), columns);
+    }
+    if (is<InSelectionExpression>(expression) || is<InTableExpression>(expression))
+        return false;
+    if (is<InChainedExpression>(expression)) {
+        auto const& in_chained = static_cast<InChainedExpression const&>(expression);
+        if (!collect_column_references(*in_chained.expression_chain(), columns))
+            return false;
+    }
+    if (is<NestedExpression>(expression))
+        return collect_column_references(*static_cast<NestedExpression const&>(expression).expression(), columns);
+    if (is<ChainedExpression>(expression)) {
+        for (auto& chained : static_cast<ChainedExpression const&>(expression).expressions()) {
+            if (!collect_column_references(chained, columns))
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
 
-    auto const& result_column_list = this->result_column_list();
-    VERIFY(!result_column_list.is_empty());
+// An expression in parentheses is parsed as a chained expression with a single element.
+static Expression const& strip_parentheses(Expression const& expression)
+{
+    if (is<ChainedExpression>(expression)) {
+        auto const& chained = static_cast<ChainedExpression const&>(expression);
+        if (chained.expressions().size() == 1)
+            return strip_parentheses(chained.expressions().first());
+    }
+    return expression;
+}
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+static void split_conjunction(Expression const& expression, NonnullRefPtrVector<Expression>& conjuncts)
+{
+    auto const& stripped = strip_parentheses(expression);
+    if (is<BinaryOperatorExpression>(stripped)) {
+        auto const& binary = static_cast<BinaryOperatorExpression const&>(stripped);
+        if (binary.type() == BinaryOperator::And) {
+            split_conjunction(*binary.lhs(), conjuncts);
+            split_conjunction(*binary.rhs(), conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(stripped);
+}
 
-        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
-        if (!table_def)
-            return Result { SQLCommand::Select, SQLErrorCode::TableDoesNotExist, table_descriptor.table_name() };
+// Finds the table a column reference resolves to, the same way ColumnNameExpression
+// does when it is evaluated. Unknown and ambiguous columns don't resolve.
+static Optional<size_t> table_for_column(Vector<TableAccessPlan> const& tables, ColumnNameExpression const& column)
+{
+    Optional<size_t> ret;
+    for (auto ix = 0u; ix < tables.size(); ix++) {
+        auto const& table = *tables[ix].table;
+        if (!column.table_name().is_empty() && table.name() != column.table_name())
+            continue;
+        for (auto& column_def : table.columns()) {
+            if (column_def.name() != column.column_name())
+                continue;
+            if (ret.has_value())
+                return {};
+            ret = ix;
+        }
+    }
+    return ret;
+}
 
-        if (result_column_list.size() == 1 && result_column_list[0].type() == ResultType::All) {
-            for (auto& col : table_def->columns()) {
-                columns.append(
-                    create_ast_node<ResultColumn>(
-                        create_ast_node<ColumnNameExpression>(table_def->parent()->name(), table_def->name(), col.name()),
-                        ""));
-            }
+// Converts a constant that a column is compared with into a key value for an
+// index on that column. The index may only be used if every row the comparison
+// accepts lies within the key range. Integer columns compare against the rounded
+// value of a float, but when the column is on the right-hand side the comparison
+// is done by the constant's type, so only exact type matches are safe there.
+static Optional<Value> index_key_value(SQLType column_type, Value const& constant, bool column_is_rhs)
+{
+    if (constant.is_null())
+        return {};
+
+    switch (column_type) {
+    case SQLType::Integer:
+        if (constant.type() == SQLType::Integer)
+            return constant;
+        if (constant.type() == SQLType::Float) {
+            auto value = constant.to_double().value();
+            if ((value < NumericLimits<int>::min()) || (value > NumericLimits<int>::max()))
+                return {};
+            return Value(constant.to_int().value());
+        }
+        return {};
+    case SQLType::Float:
+        if (constant.type() == SQLType::Float)
+            return constant;
+        if ((constant.type() == SQLType::Integer) && !column_is_rhs)
+            return Value(constant.to_double().value());
+        return {};
+    case SQLType::Text:
+        if (constant.type() == SQLType::Text)
+            return constant;
+        return {};
+    default:
+        return {};
+    }
+}
+
+struct IndexBound {
+    BinaryOperator op;
+    Value value;
+};
+
+static Optional<IndexBound> index_bound(ExecutionContext& context, Expression const& filter, KeyPartDef const& key_part)
+{
+    if (!is<BinaryOperatorExpression>(filter))
+        return {};
+    auto const& comparison = static_cast<BinaryOperatorExpression const&>(filter);
+
+    auto op = comparison.type();
+    switch (op) {
+    case BinaryOperator::LessThan:
+    case BinaryOperator::LessThanEquals:
+    case BinaryOperator::GreaterThan:
+    case BinaryOperator::GreaterThanEquals:
+    case BinaryOperator::Equals:
+        break;
+    default:
+        return {};
+    }
+
+    auto is_key_column = [&](Expression const& expression) {
+        auto const& stripped = strip_parentheses(expression);
+        return is<ColumnNameExpression>(stripped) && (static_cast<ColumnNameExpression const&>(stripped).column_name() == key_part.name());
+    };
+
+    Expression const* constant = comparison.rhs().ptr();
+    bool column_is_rhs = false;
+    if (!is_key_column(*comparison.lhs())) {
+        if (!is_key_column(*comparison.rhs()))
+            return {};
+        constant = comparison.lhs().ptr();
+        column_is_rhs = true;
+
+        // Turn "constant < column" into "column > constant":
+        switch (op) {
+        case BinaryOperator::LessThan:
+            op = BinaryOperator::GreaterThan;
+            break;
+        case BinaryOperator::LessThanEquals:
+            op = BinaryOperator::GreaterThanEquals;
+            break;
+        case BinaryOperator::GreaterThan:
+            op = BinaryOperator::LessThan;
+            break;
+        case BinaryOperator::GreaterThanEquals:
+            op = BinaryOperator::LessThanEquals;
+            break;
+        default:
+            break;
         }
     }
 
-    if (result_column_list.size() != 1 || result_column_list[0].type() != ResultType::All) {
-        for (auto& col : result_column_list) {
-            if (col.type() == ResultType::All) {
-                // FIXME can have '*' for example in conjunction with computed columns
-                return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, "*"sv };
+    Vector<ColumnNameExpression const*> columns;
+    if (!collect_column_references(*constant, columns) || !columns.is_empty())
+        return {};
+
+    // Evaluation errors are left for the filter to report when the rows are read.
+    auto constant_value = constant->evaluate(context);
+    if (constant_value.is_error())
+        return {};
+
+    auto key_value = index_key_value(key_part.type(), constant_value.value(), column_is_rhs);
+    if (!key_value.has_value())
+        return {};
+    return IndexBound { op, key_value.release_value() };
+}
+
+// Picks the index that narrows the rows of a table down the most, judging by the
+// filters that compare its leading column with a constant. The filters remain in
+// place to weed out the rows the key range can't exclude.
+static void choose_index(ExecutionContext& context, TableAccessPlan& table)
+{
+    int best_score = 0;
+
+    for (auto& index : table.table->indexes()) {
+        auto const& key_part = index.key_definition().first();
+        Optional<IndexBound> equality;
+        Optional<IndexBound> lower;
+        Optional<IndexBound> upper;
+
+        for (auto& filter : table.filters) {
+            auto bound = index_bound(context, filter, key_part);
+            if (!bound.has_value())
+                continue;
+
+            switch (bound->op) {
+            case BinaryOperator::Equals:
+                if (!equality.has_value())
+                    equality = bound;
+                break;
+            case BinaryOperator::LessThan:
+            case BinaryOperator::LessThanEquals:
+                if (!upper.has_value())
+                    upper = bound;
+                break;
+            default:
+                if (!lower.has_value())
+                    lower = bound;
+                break;
             }
+        }
 
-            columns.append(col);
+        int score = 0;
+        if (equality.has_value())
+            score = index.unique() ? 4 : 3;
+        else if (lower.has_value() && upper.has_value())
+            score = 2;
+        else if (lower.has_value() || upper.has_value())
+            score = 1;
+        if (score <= best_score)
+            continue;
+        best_score = score;
+
+        table.index = index;
+        table.lower_bound = {};
+        table.upper_bound = {};
+        if (equality.has_value()) {
+            table.lower_bound = equality->value;
+            table.upper_bound = equality->value;
+            table.lower_bound_operator = BinaryOperator::Equals;
+            table.upper_bound_operator = BinaryOperator::Equals;
+            continue;
+        }
+        if (lower.has_value()) {
+            table.lower_bound = lower->value;
+            table.lower_bound_operator = lower->op;
+        }
+        if (upper.has_value()) {
+            table.upper_bound = upper->value;
+            table.upper_bound_operator = upper->op;
         }
     }
+}
 
-    ResultSet result { SQLCommand::Select };
+static Optional<SQLType> column_type(TableDef const& table, String const& column_name)
+{
+    for (auto& column_def : table.columns()) {
+        if (column_def.name() == column_name)
+            return column_def.type();
+    }
+    return {};
+}
 
-    auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value(SQLType::Boolean, true));
-    rows.append(tuple);
+struct JoinKeys {
+    RefPtr<Expression> outer;
+    RefPtr<Expression> inner;
+};
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+// Recognizes a filter of the form "column = column" that matches a column of the table
+// with a column of one of the tables before it. Hash and merge joins compare the keys
+// by value, so both columns must have the same type, and one for which equality is exact.
+static Optional<JoinKeys> equi_join_keys(Vector<TableAccessPlan> const& tables, size_t table_index, Expression const& filter)
+{
+    if (!is<BinaryOperatorExpression>(filter))
+        return {};
+    auto const& comparison = static_cast<BinaryOperatorExpression const&>(filter);
+    if (comparison.type() != BinaryOperator::Equals)
+        return {};
 
-        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
-        if (table_def->num_columns() == 0)
+    auto const& lhs = strip_parentheses(*comparison.lhs());
+    auto const& rhs = strip_parentheses(*comparison.rhs());
+    if (!is<ColumnNameExpression>(lhs) || !is<ColumnNameExpression>(rhs))
+        return {};
+    auto const& lhs_column = static_cast<ColumnNameExpression const&>(lhs);
+    auto const& rhs_column = static_cast<ColumnNameExpression const&>(rhs);
+
+    auto lhs_table_index = table_for_column(tables, lhs_column);
+    auto rhs_table_index = table_for_column(tables, rhs_column);
+    if (!lhs_table_index.has_value() || !rhs_table_index.has_value())
+        return {};
+
+    auto lhs_type = column_type(*tables[lhs_table_index.value()].table, lhs_column.column_name());
+    auto rhs_type = column_type(*tables[rhs_table_index.value()].table, rhs_column.column_name());
+    if (lhs_type != rhs_type)
+        return {};
+    switch (lhs_type.value()) {
+    case SQLType::Integer:
+    case SQLType::Text:
+    case SQLType::Boolean:
+        break;
+    default:
+        return {};
+    }
+
+    if ((rhs_table_index.value() == table_index) && (lhs_table_index.value() < table_index))
+        return JoinKeys { lhs, rhs };
+    if ((lhs_table_index.value() == table_index) && (rhs_table_index.value() < table_index))
+        return JoinKeys { rhs, lhs };
+    return {};
+}
+
+// Joins a table on the first equality between one of its columns and a column of the
+// tables before it. The rows of the table are hashed, unless the table is read through an
+// index on its key column: then its rows come in key order, and a merge join only needs to
+// sort the outer rows.
+static void choose_join_strategy(Vector<TableAccessPlan>& tables, size_t table_index)
+{
+    auto& table = tables[table_index];
+
+    for (auto ix = 0u; ix < table.join_filters.size(); ix++) {
+        auto keys = equi_join_keys(tables, table_index, table.join_filters[ix]);
+        if (!keys.has_value())
             continue;
 
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table_def->to_tuple_descriptor());
+        table.outer_join_key = move(keys->outer);
+        table.inner_join_key = move(keys->inner);
+        table.join_filters.remove(ix);
 
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
+        auto const& key_column_name = static_cast<ColumnNameExpression const&>(*table.inner_join_key).column_name();
+        auto is_ordered_on_key = [&](IndexDef const& index) {
+            return index.key_definition().first().name() == key_column_name;
+        };
 
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
+        table.join_strategy = JoinStrategy::Hash;
+        if (table.index) {
+            if (is_ordered_on_key(*table.index))
+                table.join_strategy = JoinStrategy::Merge;
+            return;
+        }
+        for (auto& index : table.table->indexes()) {
+            if (is_ordered_on_key(index)) {
+                table.index = index;
+                table.join_strategy = JoinStrategy::Merge;
+                break;
             }
         }
+        return;
     }
+}
+
+// Lists the tables that are joined, in order, along with their join constraints.
+static ResultOr<void> flatten_join_clauses(TableOrSubquery const& table_descriptor, Vector<TableOrSubquery const*>& tables, NonnullRefPtrVector<Expression>& join_constraints)
+{
+    if (!table_descriptor.is_table())
+        return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+    tables.append(&table_descriptor);
 
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
-        has_ordering = true;
+    // An inner join is a cartesian product filtered by the join constraint, so the
+    // constraint is treated just like a term of the WHERE clause.
+    for (auto& join_clause : table_descriptor.join_clauses()) {
+        if (join_clause.join_operator() == JoinOperator::LeftOuter)
+            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Outer joins are not yet implemented"sv };
+
+        TRY(flatten_join_clauses(*join_clause.table_or_subquery(), tables, join_constraints));
+        if (join_clause.join_constraint())
+            join_constraints.append(*join_clause.join_constraint());
     }
-    Tuple sort_key(sort_descriptor);
+    return {};
+}
 
-    for (auto& row : rows) {
-        context.current_row = &row;
+ResultOr<QueryPlan> Select::plan(ExecutionContext& context) const
+{
+    QueryPlan plan;
 
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context));
-            if (!where_result)
-                continue;
-        }
+    Vector<TableOrSubquery const*> table_descriptors;
+    NonnullRefPtrVector<Expression> join_constraints;
+    for (auto& table_descriptor : table_or_subquery_list())
+        TRY(flatten_join_clauses(table_descriptor, table_descriptors, join_constraints));
 
-        tuple.clear();
+    for (auto const* table_descriptor : table_descriptors) {
+        auto table_def = TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name()));
+        if (!table_def)
+            return Result { SQLCommand::Select, SQLErrorCode::TableDoesNotExist, table_descriptor->table_name() };
+        if (table_def->num_columns() == 0)
+            continue;
 
-        for (auto& col : columns) {
-            auto value = TRY(col.expression()->evaluate(context));
-            tuple.append(value);
-        }
+        plan.tables.append(TableAccessPlan { table_def.release_nonnull() });
+    }
+
+    // Terms of the WHERE clause that only look at a single table are applied
+    // while that table is read, before it is joined with the other tables.
+    // Terms that look at several tables are applied as soon as the last of
+    // them is joined. Everything else is checked against the joined rows.
+    NonnullRefPtrVector<Expression> conjuncts;
+    for (auto& join_constraint : join_constraints)
+        split_conjunction(join_constraint, conjuncts);
+    if (where_clause())
+        split_conjunction(*where_clause(), conjuncts);
 
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term.expression()->evaluate(context));
-                sort_key.append(value);
+    for (auto& conjunct : conjuncts) {
+        Vector<ColumnNameExpression const*> columns;
+        Optional<size_t> first_table_index;
+        Optional<size_t> last_table_index;
+        bool is_resolved = collect_column_references(conjunct, columns) && !columns.is_empty();
+
+        for (auto const* column : columns) {
+            auto column_table_index = table_for_column(plan.tables, *column);
+            if (!column_table_index.has_value()) {
+                is_resolved = false;
+                break;
             }
+            if (!first_table_index.has_value() || (column_table_index.value() < first_table_index.value()))
+                first_table_index = column_table_index;
+            if (!last_table_index.has_value() || (column_table_index.value() > last_table_index.value()))
+                last_table_index = column_table_index;
         }
 
-        result.insert_row(tuple, sort_key);
+        if (!is_resolved)
+            plan.filters.append(conjunct);
+        else if (first_table_index == last_table_index)
+            plan.tables[first_table_index.value()].filters.append(conjunct);
+        else
+            plan.tables[last_table_index.value()].join_filters.append(conjunct);
     }
 
-    if (m_limit_clause != nullptr) {
-        size_t limit_value = NumericLimits<size_t>::max();
-        size_t offset_value = 0;
+    for (auto& table : plan.tables)
+        choose_index(context, table);
+    for (auto ix = 1u; ix < plan.tables.size(); ix++)
+        choose_join_strategy(plan.tables, ix);
 
-        auto limit = TRY(m_limit_clause->limit_expression()->evaluate(context));
-        if (!limit.is_null()) {
-            auto limit_value_maybe = limit.to_u32();
-            if (!limit_value_maybe.has_value())
-                return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, "LIMIT clause must evaluate to an integer value"sv };
+    return plan;
+}
 
-            limit_value = limit_value_maybe.value();
-        }
+// Evaluates the LIMIT or OFFSET expression of the limit clause, if there is one.
+static ResultOr<Optional<size_t>> evaluate_limit(ExecutionContext& context, RefPtr<Expression> const& expression, StringView error)
+{
+    if (!expression)
+        return Optional<size_t> {};
+
+    auto value = TRY(expression->evaluate(context));
+    if (value.is_null())
+        return Optional<size_t> {};
+    auto limit = value.to_u32();
+    if (!limit.has_value())
+        return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, error };
+    return limit.value();
+}
+
+ResultOr<NonnullOwnPtr<Operator>> Select::open(ExecutionContext& context) const
+{
+    NonnullRefPtrVector<ResultColumn> columns;
 
-        if (m_limit_clause->offset_expression() != nullptr) {
-            auto offset = TRY(m_limit_clause->offset_expression()->evaluate(context));
-            if (!offset.is_null()) {
-                auto offset_value_maybe = offset.to_u32();
-                if (!offset_value_maybe.has_value())
-                    return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, "OFFSET clause must evaluate to an integer value"sv };
+    auto const& result_column_list = this->result_column_list();
+    VERIFY(!result_column_list.is_empty());
+
+    auto plan = TRY(this->plan(context));
 
-                offset_value = offset_value_maybe.value();
+    if (result_column_list.size() == 1 && result_column_list[0].type() == ResultType::All) {
+        for (auto& table_plan : plan.tables) {
+            auto const& table_def = table_plan.table;
+            for (auto& col : table_def->columns()) {
+                columns.append(
+                    create_ast_node<ResultColumn>(
+                        create_ast_node<ColumnNameExpression>(table_def->parent()->name(), table_def->name(), col.name()),
+                        ""));
+            }
+        }
+    } else {
+        for (auto& col : result_column_list) {
+            if (col.type() == ResultType::All) {
+                // FIXME can have '*' for example in conjunction with computed columns
+                return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, "*"sv };
             }
+
+            columns.append(col);
         }
+    }
 
-        result.limit(offset_value, limit_value);
+    Optional<size_t> offset;
+    Optional<size_t> limit;
+    if (m_limit_clause != nullptr) {
+        context.current_row = nullptr;
+        limit = TRY(evaluate_limit(context, m_limit_clause->limit_expression(), "LIMIT clause must evaluate to an integer value"sv));
+        offset = TRY(evaluate_limit(context, m_limit_clause->offset_expression(), "OFFSET clause must evaluate to an integer value"sv));
     }
 
+    // The tables are joined left-deep: every table is joined with the rows
+    // joined so far, which are the outer side of the join.
+    OwnPtr<Operator> rows;
+    for (auto& table_plan : plan.tables) {
+        NonnullOwnPtr<Operator> table_rows = table_plan.index
+            ? NonnullOwnPtr<Operator> { make<IndexScanOperator>(context, table_plan.table, *table_plan.index, table_plan.lower_bound, table_plan.upper_bound) }
+            : NonnullOwnPtr<Operator> { make<TableScanOperator>(context, table_plan.table) };
+        if (!table_plan.filters.is_empty())
+            table_rows = make<FilterOperator>(context, move(table_rows), table_plan.filters);
+
+        if (!rows) {
+            rows = move(table_rows);
+            continue;
+        }
+
+        switch (table_plan.join_strategy) {
+        case JoinStrategy::NestedLoop:
+            rows = make<NestedLoopJoinOperator>(context, rows.release_nonnull(), move(table_rows), table_plan.join_filters);
+            break;
+        case JoinStrategy::Hash:
+            rows = make<HashJoinOperator>(context, rows.release_nonnull(), move(table_rows), *table_plan.outer_join_key, *table_plan.inner_join_key, table_plan.join_filters);
+            break;
+        case JoinStrategy::Merge:
+            rows = make<MergeJoinOperator>(context, rows.release_nonnull(), move(table_rows), *table_plan.outer_join_key, *table_plan.inner_join_key, table_plan.join_filters);
+            break;
+        }
+    }
+    if (!rows)
+        rows = make<SingleRowOperator>();
+
+    if (!plan.filters.is_empty())
+        rows = make<FilterOperator>(context, rows.release_nonnull(), move(plan.filters));
+    if (!m_ordering_term_list.is_empty())
+        rows = make<SortOperator>(context, rows.release_nonnull(), m_ordering_term_list);
+    if (offset.has_value() || limit.has_value())
+        rows = make<LimitOperator>(rows.release_nonnull(), offset.value_or(0), limit.value_or(NumericLimits<size_t>::max()));
+    return make<ProjectOperator>(context, rows.release_nonnull(), move(columns));
+}
+
+ResultOr<NonnullOwnPtr<Cursor>> Select::cursor(NonnullRefPtr<Database> database) const
+{
+    auto cursor = adopt_own(*new Cursor(*this, move(database)));
+    cursor->m_root = TRY(open(cursor->m_context));
+    return cursor;
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    auto rows = TRY(open(context));
+
+    ResultSet result { SQLCommand::Select };
+    Tuple no_sort_key;
+    while (true) {
+        auto row = TRY(rows->next());
+        if (!row.has_value())
+            break;
+        result.insert_row(row.value(), no_sort_key);
+    }
     return result;
 }
 
@@ -46,6 +46,9 @@ void BTree::initialize_root()
     } else {
         set_pointer(new_record_pointer());
         m_root = make<TreeNode>(*this, nullptr, pointer());
+        // Write the empty root right away; the heap can't be flushed with a
+        // hole where a block was handed out but never written.
+        serializer().serialize_and_write(*m_root.ptr(), m_root->pointer());
         if (on_new_root)
             on_new_root();
     }
@@ -67,6 +70,7 @@ bool BTree::insert(Key const& key)
     if (!m_root)
         initialize_root();
     VERIFY(m_root);
+    m_version++;
     return m_root->insert(key);
 }
 
@@ -103,6 +107,28 @@ BTreeIterator BTree::find(Key const& key)
     return end();
 }
 
+BTreeIterator BTree::find_smallest_not_below(Key const& key)
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+
+    // Walk down the tree, remembering the first entry that is not below the key
+    // on every level. The one found on the deepest level is the smallest.
+    auto result = end();
+    for (auto* node = m_root.ptr(); node;) {
+        auto ix = 0u;
+        while ((ix < node->size()) && ((*node)[ix].compare(key) < 0))
+            ix++;
+        if (ix < node->size())
+            result = BTreeIterator(node, (int)ix);
+        if (node->is_leaf())
+            break;
+        node = node->down_node(ix);
+    }
+    return result;
+}
+
 void BTree::list_tree()
 {
     if (!m_root)
@@ -100,10 +100,14 @@ public:
     ~BTree() override = default;
 
     u32 root() const { return (m_root) ? m_root->pointer() : 0; }
+    // Changes whenever a key is inserted, which can move entries around and
+    // leaves iterators pointing at the wrong entries.
+    [[nodiscard]] u32 version() const { return m_version; }
     bool insert(Key const&);
     bool update_key_pointer(Key const&);
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
+    BTreeIterator find_smallest_not_below(Key const& key);
     BTreeIterator begin();
     static BTreeIterator end();
     void list_tree();
@@ -116,6 +120,7 @@ private:
     void initialize_root();
     TreeNode* new_root();
     OwnPtr<TreeNode> m_root { nullptr };
+    u32 m_version { 0 };
 
     friend BTreeIterator;
     friend DownPointer;
@@ -6,6 +6,7 @@
  */
 
 #include <AK/Format.h>
+#include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 
@@ -42,6 +43,11 @@ ErrorOr<void> Database::open()
         m_heap->set_table_columns_root(m_table_columns->root());
     };
 
+    m_table_indexes = BTree::construct(m_serializer, IndexDef::index_def()->to_tuple_descriptor(), m_heap->table_indexes_root());
+    m_table_indexes->on_new_root = [&]() {
+        m_heap->set_table_indexes_root(m_table_indexes->root());
+    };
+
     m_open = true;
     auto default_schema = TRY(get_schema("default"));
     if (!default_schema) {
@@ -171,9 +177,83 @@ ErrorOr<RefPtr<TableDef>> Database::get_table(String const& schema, String const
          column_iterator++) {
         ret->append_column(*column_iterator);
     }
+    for (auto index_iterator = m_table_indexes->find(IndexDef::make_key(ret));
+         !index_iterator.is_end() && ((*index_iterator)["table_hash"].to_u32().value() == hash);
+         index_iterator++) {
+        auto index = IndexDef::construct(ret.ptr(), (*index_iterator)["index_name"].to_string(), (*index_iterator)["unique"].to_int().value() != 0, (*index_iterator).pointer());
+        auto index_hash = index->hash();
+        Key key_part_key(ColumnDef::index_def());
+        key_part_key["table_hash"] = index_hash;
+        for (auto key_part_iterator = m_table_columns->find(key_part_key);
+             !key_part_iterator.is_end() && ((*key_part_iterator)["table_hash"].to_u32().value() == index_hash);
+             key_part_iterator++) {
+            index->append_column((*key_part_iterator)["column_name"].to_string(), (SQLType)(*key_part_iterator)["column_type"].to_int().value());
+        }
+        ret->append_index(index);
+    }
     return RefPtr<TableDef>(ret);
 }
 
+ErrorOr<void> Database::add_index(IndexDef& index)
+{
+    VERIFY(is_open());
+    auto& table = verify_cast<TableDef>(*index.parent());
+    auto rows = TRY(select_all(table));
+
+    // Check the existing rows before anything is written, so that a failed
+    // CREATE UNIQUE INDEX doesn't leave half an index behind.
+    if (index.unique()) {
+        Vector<Key> keys;
+        for (auto& row : rows)
+            keys.append(index_key(index, row));
+        quick_sort(keys, [](auto& a, auto& b) { return a.compare(b) < 0; });
+        for (auto ix = 1u; ix < keys.size(); ix++) {
+            if (keys[ix - 1].compare(keys[ix]) == 0) {
+                warnln("Duplicate key {} in unique index '{}'"sv, keys[ix].to_string(), index.name());
+                return Error::from_string_literal("Duplicate key in unique index"sv);
+            }
+        }
+    }
+
+    if (!m_table_indexes->insert(index.key())) {
+        warnln("Duplicate index name '{}'.'{}'"sv, table.name(), index.name());
+        return Error::from_string_literal("Duplicate index name"sv);
+    }
+    for (auto& key_part : index.key_definition()) {
+        VERIFY(m_table_columns->insert(key_part.key()));
+    }
+    auto tree = index_tree(index);
+    for (auto& row : rows) {
+        VERIFY(tree->insert(index_key(index, row)));
+    }
+    table.append_index(index);
+    return {};
+}
+
+NonnullRefPtr<BTree> Database::index_tree(IndexDef const& index)
+{
+    auto key = index.key();
+    auto tree_opt = m_index_cache.get(key.hash());
+    if (tree_opt.has_value())
+        return *tree_opt.value();
+    auto tree = BTree::construct(m_serializer, index.to_tuple_descriptor(), index.unique(), index.pointer());
+    tree->on_new_root = [this, key, tree_ptr = tree.ptr()]() mutable {
+        key.set_pointer(tree_ptr->root());
+        VERIFY(m_table_indexes->update_key_pointer(key));
+    };
+    m_index_cache.set(key.hash(), tree);
+    return tree;
+}
+
+Key Database::index_key(IndexDef const& index, Row const& row)
+{
+    Key key(index.to_tuple_descriptor());
+    for (auto& key_part : index.key_definition())
+        key[key_part.name()] = row[key_part.name()];
+    key.set_pointer(row.pointer());
+    return key;
+}
+
 ErrorOr<Vector<Row>> Database::select_all(TableDef const& table)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -195,21 +275,77 @@ ErrorOr<Vector<Row>> Database::match(TableDef const& table, Key const& key)
         auto row = m_serializer.deserialize_block<Row>(pointer, table, pointer);
         if (row.match(key))
             ret.append(row);
-        pointer = ret.last().next_pointer();
+        pointer = row.next_pointer();
     }
     return ret;
 }
 
+ErrorOr<Vector<Row>> Database::select_range(TableDef const& table, IndexDef const& index, Optional<Value> const& lower, Optional<Value> const& upper)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+
+    Optional<Key> upper_bound;
+    if (upper.has_value())
+        upper_bound = index_scan_bound(index, upper.value());
+
+    Vector<Row> ret;
+    for (auto iterator = index_scan_start(index, lower); !iterator.is_end(); iterator++) {
+        if (upper_bound.has_value() && ((*iterator).compare(upper_bound.value()) > 0))
+            break;
+        ret.append(read_row(table, (*iterator).pointer()));
+    }
+    return ret;
+}
+
+Row Database::read_row(TableDef const& table, u32 pointer)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    return m_serializer.deserialize_block<Row>(pointer, table, pointer);
+}
+
+BTreeIterator Database::index_scan_start(IndexDef const& index, Optional<Value> const& lower)
+{
+    auto tree = index_tree(index);
+    if (!lower.has_value())
+        return tree->begin();
+    return tree->find_smallest_not_below(index_scan_bound(index, lower.value()));
+}
+
+// Bounds only constrain the leading column of an index, so they are one-part
+// keys. Tuple comparison stops after the shortest tuple, which makes them
+// compare against the prefix of every entry.
+Key Database::index_scan_bound(IndexDef const& index, Value const& value)
+{
+    NonnullRefPtr<TupleDescriptor> bound_descriptor = adopt_ref(*new TupleDescriptor);
+    bound_descriptor->append(index.to_tuple_descriptor()->first());
+    Key bound(bound_descriptor);
+    bound[0] = value;
+    return bound;
+}
+
 ErrorOr<void> Database::insert(Row& row)
 {
     VERIFY(m_table_cache.get(row.table()->key().hash()).has_value());
     // TODO Check constraints
 
+    for (auto& index : row.table()->indexes()) {
+        if (!index.unique())
+            continue;
+        auto key = index_key(index, row);
+        auto iterator = index_tree(index)->find_smallest_not_below(key);
+        if (!iterator.is_end() && ((*iterator).compare(key) == 0)) {
+            warnln("Duplicate key {} in unique index '{}'"sv, key.to_string(), index.name());
+            return Error::from_string_literal("Duplicate key in unique index"sv);
+        }
+    }
+
     row.set_pointer(m_heap->new_record_pointer());
     row.next_pointer(row.table()->pointer());
     TRY(update(row));
 
-    // TODO update indexes defined on table.
+    for (auto& index : row.table()->indexes()) {
+        VERIFY(index_tree(index)->insert(index_key(index, row)));
+    }
 
     auto table_key = row.table()->key();
     table_key.set_pointer(row.pointer());
@@ -10,6 +10,7 @@
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
+#include <LibSQL/BTree.h>
 #include <LibSQL/Forward.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Meta.h>
@@ -39,23 +40,50 @@ public:
     static Key get_table_key(String const&, String const&);
     ErrorOr<RefPtr<TableDef>> get_table(String const&, String const&);
 
+    ErrorOr<void> add_index(IndexDef&);
+
     ErrorOr<Vector<Row>> select_all(TableDef const&);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
+    ErrorOr<Vector<Row>> select_range(TableDef const&, IndexDef const&, Optional<Value> const& lower, Optional<Value> const& upper);
     ErrorOr<void> insert(Row&);
+
+    // Rows can also be read one at a time: by following the chain of a table
+    // from table.pointer() through Row::next_pointer(), or by walking the
+    // index_tree() of an index from index_scan_start() and reading the row
+    // each key points to. Rows that are inserted while an index is walked
+    // change the version() of its tree, after which the walk has to find its
+    // place again from the last key it saw.
+    Row read_row(TableDef const&, u32 pointer);
+    NonnullRefPtr<BTree> index_tree(IndexDef const&);
+    BTreeIterator index_scan_start(IndexDef const&, Optional<Value> const& lower);
+    static Key index_scan_bound(IndexDef const&, Value const&);
     ErrorOr<void> update(Row&);
 
+    void set_page_cache_capacity(size_t capacity) { m_heap->set_page_cache_capacity(capacity); }
+    PageCacheStatistics page_cache_statistics() const { return m_heap->page_cache_statistics(); }
+
+    // Hash joins keep up to this many bytes of rows in memory before they spill to temporary files.
+    static constexpr size_t default_join_memory_budget = 16 * MiB;
+    size_t join_memory_budget() const { return m_join_memory_budget; }
+    void set_join_memory_budget(size_t budget) { m_join_memory_budget = budget; }
+
 private:
     explicit Database(String);
 
+    static Key index_key(IndexDef const&, Row const&);
+
     bool m_open { false };
     NonnullRefPtr<Heap> m_heap;
     Serializer m_serializer;
     RefPtr<BTree> m_schemas;
     RefPtr<BTree> m_tables;
     RefPtr<BTree> m_table_columns;
+    RefPtr<BTree> m_table_indexes;
 
     HashMap<u32, RefPtr<SchemaDef>> m_schema_cache;
     HashMap<u32, RefPtr<TableDef>> m_table_cache;
+    HashMap<u32, NonnullRefPtr<BTree>> m_index_cache;
+    size_t m_join_memory_budget { default_join_memory_budget };
 };
 
 }
@@ -50,13 +50,16 @@ class ColumnDefinition;
 class ColumnNameExpression;
 class CommonTableExpression;
 class CommonTableExpressionList;
+class CreateIndex;
 class CreateTable;
+class Cursor;
 class Delete;
 class DropColumn;
 class DropTable;
 class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
+class Explain;
 class Expression;
 class GroupByClause;
 class InChainedExpression;
@@ -66,6 +69,7 @@ class InTableExpression;
 class InvertibleNestedDoubleExpression;
 class InvertibleNestedExpression;
 class IsExpression;
+class JoinClause;
 class Lexer;
 class LimitClause;
 class MatchExpression;
@@ -74,6 +78,7 @@ class NestedExpression;
 class NullExpression;
 class NullLiteral;
 class NumericLiteral;
+class Operator;
 class OrderingTerm;
 class Parser;
 class QualifiedTableName;
@@ -71,8 +71,15 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
         return Error::from_string_literal("Heap()::read_block(): Heap file not opened"sv);
     }
     auto buffer_or_empty = m_write_ahead_log.get(block);
-    if (buffer_or_empty.has_value())
+    if (buffer_or_empty.has_value()) {
+        m_write_ahead_log_reads++;
         return buffer_or_empty.release_value();
+    }
+    if (auto cached_buffer = cached_page(block); cached_buffer.has_value()) {
+        m_page_cache_hits++;
+        return cached_buffer.release_value();
+    }
+    m_page_cache_misses++;
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
@@ -90,6 +97,7 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
         *ret.offset_pointer(2), *ret.offset_pointer(3),
         *ret.offset_pointer(4), *ret.offset_pointer(5),
         *ret.offset_pointer(6), *ret.offset_pointer(7));
+    cache_page(block, ret);
     return ret;
 }
 
@@ -185,12 +193,95 @@ ErrorOr<void> Heap::flush()
         VERIFY(buffer_it != m_write_ahead_log.end());
         dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
         TRY(write_block(block, buffer_it->value));
+        cache_page(block, buffer_it->value);
     }
     m_write_ahead_log.clear();
     dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
     return {};
 }
 
+Optional<ByteBuffer> Heap::cached_page(u32 block)
+{
+    auto frame = m_page_cache_frames.get(block);
+    if (!frame.has_value())
+        return {};
+    auto& page = m_page_cache[*frame];
+    page.referenced = true;
+    return page.buffer;
+}
+
+void Heap::cache_page(u32 block, ByteBuffer const& buffer)
+{
+    if (m_page_cache_capacity == 0)
+        return;
+    if (auto frame = m_page_cache_frames.get(block); frame.has_value()) {
+        auto& page = m_page_cache[*frame];
+        page.buffer = buffer;
+        page.referenced = true;
+        return;
+    }
+    // New pages start out unreferenced, so that a single scan over many blocks doesn't push out the pages that
+    // are used over and over, like the upper levels of the indices.
+    if (m_page_cache.size() < m_page_cache_capacity) {
+        m_page_cache_frames.set(block, m_page_cache.size());
+        m_page_cache.append({ block, false, buffer });
+        return;
+    }
+    for (;;) {
+        auto& page = m_page_cache[m_clock_hand];
+        auto frame = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_page_cache.size();
+        if (page.referenced) {
+            page.referenced = false;
+            continue;
+        }
+        dbgln_if(SQL_DEBUG, "Evicting block {} from the page cache of {}", page.block, name());
+        m_page_cache_frames.remove(page.block);
+        m_page_cache_evictions++;
+        page = { block, false, buffer };
+        m_page_cache_frames.set(block, frame);
+        return;
+    }
+}
+
+void Heap::evict_page(u32 block)
+{
+    auto frame = m_page_cache_frames.get(block);
+    if (!frame.has_value())
+        return;
+    m_page_cache_frames.remove(block);
+    // Move the last frame into the hole, so the frames stay contiguous.
+    auto last_frame = m_page_cache.size() - 1;
+    if (*frame != last_frame) {
+        m_page_cache[*frame] = move(m_page_cache[last_frame]);
+        m_page_cache_frames.set(m_page_cache[*frame].block, *frame);
+    }
+    m_page_cache.take_last();
+    if (m_clock_hand >= m_page_cache.size())
+        m_clock_hand = 0;
+}
+
+void Heap::set_page_cache_capacity(size_t capacity)
+{
+    m_page_cache_capacity = capacity;
+    while (m_page_cache.size() > m_page_cache_capacity)
+        evict_page(m_page_cache.last().block);
+    if (m_clock_hand >= m_page_cache.size())
+        m_clock_hand = 0;
+}
+
+PageCacheStatistics Heap::page_cache_statistics() const
+{
+    return {
+        .hits = m_page_cache_hits,
+        .misses = m_page_cache_misses,
+        .write_ahead_log_reads = m_write_ahead_log_reads,
+        .evictions = m_page_cache_evictions,
+        .cached_pages = m_page_cache.size(),
+        .capacity = m_page_cache_capacity,
+    };
+}
+
 constexpr static StringView FILE_ID = "SerenitySQL "sv;
 constexpr static int VERSION_OFFSET = 12;
 constexpr static int SCHEMAS_ROOT_OFFSET = 16;
@@ -198,6 +289,7 @@ constexpr static int TABLES_ROOT_OFFSET = 20;
 constexpr static int TABLE_COLUMNS_ROOT_OFFSET = 24;
 constexpr static int FREE_LIST_OFFSET = 28;
 constexpr static int USER_VALUES_OFFSET = 32;
+constexpr static int TABLE_INDEXES_ROOT_OFFSET = 96;
 
 ErrorOr<void> Heap::read_zero_block()
 {
@@ -220,6 +312,8 @@ ErrorOr<void> Heap::read_zero_block()
     memcpy(&m_free_list, buffer.offset_pointer(FREE_LIST_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     memcpy(m_user_values.data(), buffer.offset_pointer(USER_VALUES_OFFSET), m_user_values.size() * sizeof(u32));
+    memcpy(&m_table_indexes_root, buffer.offset_pointer(TABLE_INDEXES_ROOT_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Table indexes root node: {}", m_table_indexes_root);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix]) {
             dbgln_if(SQL_DEBUG, "User value {}: {}", ix, m_user_values[ix]);
@@ -235,6 +329,7 @@ void Heap::update_zero_block()
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_schemas_root);
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     dbgln_if(SQL_DEBUG, "Table Columns root node: {}", m_table_columns_root);
+    dbgln_if(SQL_DEBUG, "Table Indexes root node: {}", m_table_indexes_root);
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix]) {
@@ -251,6 +346,7 @@ void Heap::update_zero_block()
     buffer.overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
     buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
     buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
+    buffer.overwrite(TABLE_INDEXES_ROOT_OFFSET, &m_table_indexes_root, sizeof(u32));
 
     add_to_wal(0, buffer);
 }
@@ -261,6 +357,7 @@ void Heap::initialize_zero_block()
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
+    m_table_indexes_root = 0;
     m_next_block = 1;
     m_free_list = 0;
     for (auto& user : m_user_values) {
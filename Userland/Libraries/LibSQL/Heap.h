@@ -18,6 +18,16 @@ namespace SQL {
 
 constexpr static u32 BLOCKSIZE = 1024;
 
+// Blocks that were written but not committed yet are read from the write-ahead log, which is counted on its own.
+struct PageCacheStatistics {
+    u64 hits { 0 };
+    u64 misses { 0 };
+    u64 write_ahead_log_reads { 0 };
+    u64 evictions { 0 };
+    size_t cached_pages { 0 };
+    size_t capacity { 0 };
+};
+
 /**
  * A Heap is a logical container for database (SQL) data. Conceptually a
  * Heap can be a database file, or a memory block, or another storage medium.
@@ -65,6 +75,14 @@ public:
         m_table_columns_root = root;
         update_zero_block();
     }
+
+    u32 table_indexes_root() const { return m_table_indexes_root; }
+
+    void set_table_indexes_root(u32 root)
+    {
+        m_table_indexes_root = root;
+        update_zero_block();
+    }
     u32 version() const { return m_version; }
 
     u32 user_value(size_t index) const
@@ -89,10 +107,18 @@ public:
             *buffer.offset_pointer(4), *buffer.offset_pointer(5),
             *buffer.offset_pointer(6), *buffer.offset_pointer(7));
         m_write_ahead_log.set(block, buffer);
+        // The write-ahead log has the newest version of the block now, and keeps it around until it is flushed.
+        evict_page(block);
     }
 
     ErrorOr<void> flush();
 
+    // The page cache keeps up to this many blocks that were read from or written to the file in memory.
+    // Blocks with pending writes are held by the write-ahead log instead, so they are never evicted.
+    static constexpr size_t default_page_cache_capacity = 1024;
+    void set_page_cache_capacity(size_t);
+    PageCacheStatistics page_cache_statistics() const;
+
 private:
     explicit Heap(String);
 
@@ -102,6 +128,18 @@ private:
     void initialize_zero_block();
     void update_zero_block();
 
+    Optional<ByteBuffer> cached_page(u32);
+    void cache_page(u32, ByteBuffer const&);
+    void evict_page(u32);
+
+    // A page cache frame. Frames are evicted using the CLOCK algorithm: the clock hand sweeps over the frames,
+    // clearing their referenced bit, and evicts the first frame that wasn't referenced since the last sweep.
+    struct CachedPage {
+        u32 block { 0 };
+        bool referenced { false };
+        ByteBuffer buffer;
+    };
+
     RefPtr<Core::File> m_file { nullptr };
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
@@ -109,9 +147,19 @@ private:
     u32 m_schemas_root { 0 };
     u32 m_tables_root { 0 };
     u32 m_table_columns_root { 0 };
+    u32 m_table_indexes_root { 0 };
     u32 m_version { 0x00000001 };
     Array<u32, 16> m_user_values { 0 };
     HashMap<u32, ByteBuffer> m_write_ahead_log;
+
+    Vector<CachedPage> m_page_cache;
+    HashMap<u32, size_t> m_page_cache_frames;
+    size_t m_page_cache_capacity { default_page_cache_capacity };
+    size_t m_clock_hand { 0 };
+    u64 m_page_cache_hits { 0 };
+    u64 m_page_cache_misses { 0 };
+    u64 m_page_cache_evictions { 0 };
+    u64 m_write_ahead_log_reads { 0 };
 };
 
 }
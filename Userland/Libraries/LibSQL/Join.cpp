@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashFunctions.h>
+#include <AK/QuickSort.h>
+#include <LibSQL/Join.h>
+
+namespace SQL {
+
+ErrorOr<NonnullOwnPtr<SpillFile>> SpillFile::create()
+{
+    auto temp_file = Core::TempFile::create();
+    auto file = TRY(Core::File::open(temp_file->path(), Core::OpenMode::ReadWrite));
+    return adopt_own(*new SpillFile(move(temp_file), move(file)));
+}
+
+SpillFile::SpillFile(NonnullOwnPtr<Core::TempFile> temp_file, NonnullRefPtr<Core::File> file)
+    : m_temp_file(move(temp_file))
+    , m_file(move(file))
+{
+}
+
+ErrorOr<void> SpillFile::write(JoinRow const& row)
+{
+    VERIFY(!m_reading);
+
+    m_serializer.reset();
+    m_serializer.serialize<Value>(row.key);
+    m_serializer.serialize<u32>((u32)row.row.size());
+    for (auto ix = 0u; ix < row.row.size(); ix++)
+        m_serializer.serialize<Value>(row.row[ix]);
+
+    auto const& record = m_serializer.buffer();
+    u32 record_size = record.size();
+    TRY(m_buffer.try_append(&record_size, sizeof(record_size)));
+    TRY(m_buffer.try_append(record.data(), record.size()));
+    m_row_count++;
+
+    if (m_buffer.size() >= buffer_size)
+        TRY(flush());
+    return {};
+}
+
+ErrorOr<void> SpillFile::flush()
+{
+    if (m_buffer.is_empty())
+        return {};
+    if (!m_file->write(m_buffer.data(), (int)m_buffer.size()))
+        return Error::from_errno(m_file->error());
+    m_buffer.clear();
+    return {};
+}
+
+ErrorOr<void> SpillFile::rewind()
+{
+    if (!m_reading)
+        TRY(flush());
+    if (!m_file->seek(0))
+        return Error::from_errno(m_file->error());
+    m_buffer.clear();
+    m_read_offset = 0;
+    m_reading = true;
+    return {};
+}
+
+// Makes sure that at least `size` unread bytes are buffered. Returns false if
+// the file ends before that.
+ErrorOr<bool> SpillFile::fill(size_t size)
+{
+    while (m_buffer.size() - m_read_offset < size) {
+        auto chunk = m_file->read(buffer_size);
+        if (chunk.is_empty()) {
+            if (m_file->error())
+                return Error::from_errno(m_file->error());
+            return false;
+        }
+        if (m_read_offset > 0) {
+            m_buffer = m_buffer.slice(m_read_offset, m_buffer.size() - m_read_offset);
+            m_read_offset = 0;
+        }
+        TRY(m_buffer.try_append(chunk.data(), chunk.size()));
+    }
+    return true;
+}
+
+ErrorOr<Optional<JoinRow>> SpillFile::read(Tuple const& prototype)
+{
+    VERIFY(m_reading);
+
+    if (!TRY(fill(sizeof(u32))))
+        return Optional<JoinRow> {};
+    u32 record_size;
+    memcpy(&record_size, m_buffer.offset_pointer(m_read_offset), sizeof(record_size));
+    if (!TRY(fill(sizeof(u32) + record_size)))
+        return Error::from_string_literal("Spill file ends in the middle of a row"sv);
+
+    m_serializer.set_buffer(m_buffer.slice(m_read_offset + sizeof(u32), record_size));
+    m_read_offset += sizeof(u32) + record_size;
+
+    auto key = m_serializer.deserialize<Value>();
+    auto size = m_serializer.deserialize<u32>();
+    VERIFY(size == prototype.size());
+    Tuple row = prototype;
+    for (auto ix = 0u; ix < size; ix++)
+        row[ix] = m_serializer.deserialize<Value>();
+    return JoinRow { move(key), move(row) };
+}
+
+// The join callbacks fail with SQL results, while spill files fail with plain errors.
+template<typename T>
+static ResultOr<T> to_result(ErrorOr<T> value_or_error)
+{
+    if (value_or_error.is_error())
+        return Result { value_or_error.release_error() };
+    return value_or_error.release_value();
+}
+
+static ResultOr<void> to_result(ErrorOr<void> error)
+{
+    if (error.is_error())
+        return Result { error.release_error() };
+    return {};
+}
+
+static size_t memory_size(JoinRow const& row)
+{
+    return row.key.length() + row.row.length();
+}
+
+// Every level of partitioning uses a different hash of the key, so that the
+// rows of one partition are spread over all partitions of the next level.
+static size_t partition_for(Value const& key, u32 depth)
+{
+    return pair_int_hash(key.hash(), depth) % HashJoin::spill_partition_count;
+}
+
+ResultOr<Vector<HashJoin::Partition>> HashJoin::create_partitions(u32 depth)
+{
+    Vector<Partition> partitions;
+    for (auto ix = 0u; ix < spill_partition_count; ix++) {
+        auto build = TRY(to_result(SpillFile::create()));
+        auto probe = TRY(to_result(SpillFile::create()));
+        partitions.append({ move(build), move(probe), 0, depth });
+    }
+    return partitions;
+}
+
+// All partitions in the vector have the same depth.
+ResultOr<void> HashJoin::write_build_row(Vector<Partition>& partitions, JoinRow const& row)
+{
+    auto& partition = partitions[partition_for(row.key, partitions.first().depth)];
+    partition.build_size += memory_size(row);
+    return to_result(partition.build->write(row));
+}
+
+ResultOr<void> HashJoin::add_build_row(JoinRow row)
+{
+    if (row.key.is_null())
+        return {};
+    if (!m_build_prototype.has_value())
+        m_build_prototype = row.row;
+
+    if (has_spilled())
+        return write_build_row(m_partitions, row);
+
+    add_to_hash_table(move(row));
+    if (m_memory_used > m_memory_budget)
+        TRY(spill());
+    return {};
+}
+
+ResultOr<void> HashJoin::spill()
+{
+    dbgln_if(SQL_DEBUG, "HashJoin: {} build rows take up {} bytes, spilling to {} partitions", m_build_rows.size(), m_memory_used, spill_partition_count);
+    m_partitions = TRY(create_partitions(0));
+    for (auto& row : m_build_rows)
+        TRY(write_build_row(m_partitions, row));
+    clear_hash_table();
+    return {};
+}
+
+ResultOr<Vector<HashJoin::Partition>> HashJoin::repartition(Partition& partition)
+{
+    dbgln_if(SQL_DEBUG, "HashJoin: {} build rows of a partition take up {} bytes, partitioning them again", partition.build->row_count(), partition.build_size);
+    auto depth = partition.depth + 1;
+    auto partitions = TRY(create_partitions(depth));
+
+    TRY(to_result(partition.build->rewind()));
+    while (true) {
+        auto row = TRY(to_result(partition.build->read(m_build_prototype.value())));
+        if (!row.has_value())
+            break;
+        TRY(write_build_row(partitions, row.value()));
+    }
+
+    TRY(to_result(partition.probe->rewind()));
+    while (true) {
+        auto row = TRY(to_result(partition.probe->read(m_probe_prototype.value())));
+        if (!row.has_value())
+            break;
+        TRY(to_result(partitions[partition_for(row->key, depth)].probe->write(row.value())));
+    }
+
+    // Partitioning again doesn't help if all build rows ended up in the same partition.
+    for (auto& new_partition : partitions) {
+        if (new_partition.build->row_count() == partition.build->row_count())
+            new_partition.depth = max_partition_depth;
+    }
+    return partitions;
+}
+
+void HashJoin::add_to_hash_table(JoinRow row)
+{
+    m_memory_used += memory_size(row);
+    m_peak_memory_used = max(m_peak_memory_used, m_memory_used);
+    m_hash_table.ensure(row.key.hash()).append(m_build_rows.size());
+    m_build_rows.append(move(row));
+}
+
+void HashJoin::clear_hash_table()
+{
+    m_build_rows.clear();
+    m_hash_table.clear();
+    m_memory_used = 0;
+}
+
+ResultOr<void> HashJoin::probe_hash_table(JoinRow const& row, JoinCallback const& callback) const
+{
+    auto bucket = m_hash_table.find(row.key.hash());
+    if (bucket == m_hash_table.end())
+        return {};
+    for (auto index : bucket->value) {
+        auto const& build_row = m_build_rows[index];
+        if (build_row.key == row.key)
+            TRY(callback(row.row, build_row.row));
+    }
+    return {};
+}
+
+ResultOr<void> HashJoin::probe(JoinRow row, JoinCallback const& callback)
+{
+    if (row.key.is_null())
+        return {};
+    if (!has_spilled())
+        return probe_hash_table(row, callback);
+
+    if (!m_probe_prototype.has_value())
+        m_probe_prototype = row.row;
+    TRY(to_result(m_partitions[partition_for(row.key, 0)].probe->write(row)));
+    return {};
+}
+
+ResultOr<void> HashJoin::finish(JoinCallback const& callback)
+{
+    while (TRY(join_next_partition(callback)))
+        ;
+    return {};
+}
+
+ResultOr<bool> HashJoin::join_next_partition(JoinCallback const& callback)
+{
+    while (!m_partitions.is_empty()) {
+        auto partition = m_partitions.take_first();
+        if ((partition.build->row_count() == 0) || (partition.probe->row_count() == 0))
+            continue;
+
+        if ((partition.build_size > m_memory_budget) && (partition.depth < max_partition_depth)) {
+            m_partitions.prepend(TRY(repartition(partition)));
+            continue;
+        }
+
+        TRY(join_partition(partition, callback));
+        return true;
+    }
+    return false;
+}
+
+// Builds a hash table from as many build rows of the partition as fit in the
+// memory budget, and probes it with all probe rows of the partition, until
+// all build rows have been in the hash table.
+ResultOr<void> HashJoin::join_partition(Partition& partition, JoinCallback const& callback)
+{
+    TRY(to_result(partition.build->rewind()));
+    while (true) {
+        while (m_memory_used <= m_memory_budget) {
+            auto row = TRY(to_result(partition.build->read(m_build_prototype.value())));
+            if (!row.has_value())
+                break;
+            add_to_hash_table(row.release_value());
+        }
+        if (m_build_rows.is_empty())
+            return {};
+
+        TRY(to_result(partition.probe->rewind()));
+        while (true) {
+            auto row = TRY(to_result(partition.probe->read(m_probe_prototype.value())));
+            if (!row.has_value())
+                break;
+            TRY(probe_hash_table(row.value(), callback));
+        }
+        clear_hash_table();
+    }
+}
+
+static void sort_on_key(Vector<JoinRow>& rows)
+{
+    rows.remove_all_matching([](auto const& row) { return row.key.is_null(); });
+    for (auto ix = 1u; ix < rows.size(); ix++) {
+        if (rows[ix].key.compare(rows[ix - 1].key) < 0) {
+            quick_sort(rows, [](auto const& a, auto const& b) { return a.key.compare(b.key) < 0; });
+            return;
+        }
+    }
+}
+
+MergeJoin::MergeJoin(Vector<JoinRow> outer, Vector<JoinRow> inner)
+    : m_outer(move(outer))
+    , m_inner(move(inner))
+{
+    sort_on_key(m_outer);
+    sort_on_key(m_inner);
+}
+
+ResultOr<bool> MergeJoin::join_next(JoinCallback const& callback)
+{
+    while ((m_outer_ix < m_outer.size()) && (m_inner_ix < m_inner.size())) {
+        auto const& key = m_inner[m_inner_ix].key;
+        auto comparison = m_outer[m_outer_ix].key.compare(key);
+        if (comparison < 0) {
+            m_outer_ix++;
+            continue;
+        }
+        if (comparison > 0) {
+            m_inner_ix = max(m_inner_ix + 1, m_inner_end);
+            continue;
+        }
+
+        // The group of inner rows with this key is found once, and joined with
+        // every outer row that has the same key.
+        if (m_inner_end <= m_inner_ix) {
+            m_inner_end = m_inner_ix + 1;
+            while ((m_inner_end < m_inner.size()) && (m_inner[m_inner_end].key.compare(key) == 0))
+                m_inner_end++;
+        }
+        auto const& outer_row = m_outer[m_outer_ix++].row;
+        for (auto ix = m_inner_ix; ix < m_inner_end; ix++)
+            TRY(callback(outer_row, m_inner[ix].row));
+        return true;
+    }
+    return false;
+}
+
+ResultOr<void> merge_join(Vector<JoinRow>& outer, Vector<JoinRow>& inner, JoinCallback const& callback)
+{
+    MergeJoin join(move(outer), move(inner));
+    while (TRY(join.join_next(callback)))
+        ;
+    return {};
+}
+
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <LibCore/File.h>
+#include <LibCore/TempFile.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/Serializer.h>
+#include <LibSQL/Tuple.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+/**
+ * A row taking part in an equi-join, together with the value of its join key.
+ * Rows with a NULL key never match anything.
+ */
+struct JoinRow {
+    Value key;
+    Tuple row;
+};
+
+using JoinCallback = Function<ResultOr<void>(Tuple const& outer, Tuple const& inner)>;
+
+/**
+ * A SpillFile is a temporary file that JoinRows are written to when they
+ * don't fit in memory, and read back from in the order they were written.
+ * Only the values of the rows are stored. Rows read back are copies of a
+ * prototype row with the stored values assigned to them, so they share
+ * its descriptor.
+ */
+class SpillFile {
+public:
+    static ErrorOr<NonnullOwnPtr<SpillFile>> create();
+
+    ErrorOr<void> write(JoinRow const&);
+    ErrorOr<void> rewind();
+    ErrorOr<Optional<JoinRow>> read(Tuple const& prototype);
+    size_t row_count() const { return m_row_count; }
+
+private:
+    SpillFile(NonnullOwnPtr<Core::TempFile>, NonnullRefPtr<Core::File>);
+
+    ErrorOr<void> flush();
+    ErrorOr<bool> fill(size_t);
+
+    static constexpr size_t buffer_size = 64 * KiB;
+
+    NonnullOwnPtr<Core::TempFile> m_temp_file;
+    NonnullRefPtr<Core::File> m_file;
+    Serializer m_serializer;
+    ByteBuffer m_buffer;
+    size_t m_read_offset { 0 };
+    bool m_reading { false };
+    size_t m_row_count { 0 };
+};
+
+/**
+ * A HashJoin matches the rows of a probe (outer) side against a hash table
+ * built from the rows of a build (inner) side.
+ *
+ * The build rows are kept in memory until they take up more than the memory
+ * budget. From then on, both sides are partitioned on the hash of their join
+ * key into spill files, and the partitions are joined one at a time by
+ * join_next_partition(), or all at once by finish(). Until then, probing only
+ * writes the probe row to its partition. All build rows have to be added
+ * before the first probe.
+ *
+ * A partition whose build rows still don't fit in the memory budget is
+ * partitioned again on a different hash. If that doesn't split it up, because
+ * most of its rows have the same key, it is joined a budget's worth of build
+ * rows at a time, and its probe rows are read again for every part.
+ */
+class HashJoin {
+public:
+    explicit HashJoin(size_t memory_budget)
+        : m_memory_budget(memory_budget)
+    {
+    }
+
+    ResultOr<void> add_build_row(JoinRow);
+    ResultOr<void> probe(JoinRow, JoinCallback const&);
+    ResultOr<void> finish(JoinCallback const&);
+
+    // Returns false once there are no more partitions to join.
+    ResultOr<bool> join_next_partition(JoinCallback const&);
+
+    bool has_spilled() const { return !m_partitions.is_empty(); }
+    // The most memory the build rows in the hash table have taken up at once.
+    size_t peak_memory_used() const { return m_peak_memory_used; }
+
+    static constexpr size_t spill_partition_count = 16;
+    static constexpr u32 max_partition_depth = 4;
+
+private:
+    struct Partition {
+        NonnullOwnPtr<SpillFile> build;
+        NonnullOwnPtr<SpillFile> probe;
+        size_t build_size { 0 };
+        u32 depth { 0 };
+    };
+
+    static ResultOr<Vector<Partition>> create_partitions(u32 depth);
+    static ResultOr<void> write_build_row(Vector<Partition>&, JoinRow const&);
+    ResultOr<void> spill();
+    ResultOr<Vector<Partition>> repartition(Partition&);
+    ResultOr<void> join_partition(Partition&, JoinCallback const&);
+    void add_to_hash_table(JoinRow);
+    ResultOr<void> probe_hash_table(JoinRow const&, JoinCallback const&) const;
+    void clear_hash_table();
+
+    size_t m_memory_budget;
+    size_t m_memory_used { 0 };
+    size_t m_peak_memory_used { 0 };
+    Vector<JoinRow> m_build_rows;
+    HashMap<u32, Vector<size_t>> m_hash_table;
+
+    Optional<Tuple> m_build_prototype;
+    Optional<Tuple> m_probe_prototype;
+    // The partitions that are still to be joined, in the order they will be.
+    Vector<Partition> m_partitions;
+};
+
+/**
+ * A MergeJoin joins two sides by sorting them on their join keys, unless they
+ * already are, and walking them in step. Every call to join_next() passes the
+ * matches of the next matching outer row to the callback, so the matches come
+ * in key order.
+ */
+class MergeJoin {
+public:
+    MergeJoin(Vector<JoinRow> outer, Vector<JoinRow> inner);
+
+    // Returns false once all matches have been passed to the callback.
+    ResultOr<bool> join_next(JoinCallback const&);
+
+private:
+    Vector<JoinRow> m_outer;
+    Vector<JoinRow> m_inner;
+    size_t m_outer_ix { 0 };
+    size_t m_inner_ix { 0 };
+    size_t m_inner_end { 0 };
+};
+
+ResultOr<void> merge_join(Vector<JoinRow>& outer, Vector<JoinRow>& inner, JoinCallback const&);
+
+}
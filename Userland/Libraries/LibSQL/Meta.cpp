@@ -129,6 +129,7 @@ Key IndexDef::key() const
     key["table_hash"] = parent_relation()->key().hash();
     key["index_name"] = name();
     key["unique"] = unique() ? 1 : 0;
+    key.set_pointer(pointer());
     return key;
 }
 
@@ -188,6 +189,12 @@ void TableDef::append_column(Key const& column)
         (SQLType)((int)column["column_type"]));
 }
 
+void TableDef::append_index(NonnullRefPtr<IndexDef> index)
+{
+    VERIFY(index->parent() == this);
+    m_indexes.append(move(index));
+}
+
 Key TableDef::make_key(SchemaDef const& schema_def)
 {
     return TableDef::make_key(schema_def.key());
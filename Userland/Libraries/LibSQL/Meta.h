@@ -136,6 +136,7 @@ public:
     Key key() const override;
     void append_column(String, SQLType);
     void append_column(Key const&);
+    void append_index(NonnullRefPtr<IndexDef>);
     size_t num_columns() { return m_columns.size(); }
     size_t num_indexes() { return m_indexes.size(); }
     NonnullRefPtrVector<ColumnDef> const& columns() const { return m_columns; }
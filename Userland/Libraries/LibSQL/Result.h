@@ -18,6 +18,7 @@ namespace SQL {
     S(Create)                     \
     S(Delete)                     \
     S(Describe)                   \
+    S(Explain)                    \
     S(Insert)                     \
     S(Select)                     \
     S(Update)
@@ -55,6 +56,7 @@ constexpr char const* command_tag(SQLCommand command)
     S(ColumnDoesNotExist, "Column '{}' does not exist")                                  \
     S(AmbiguousColumnName, "Column name '{}' is ambiguous")                              \
     S(TableExists, "Table '{}' already exist")                                           \
+    S(IndexExists, "Index '{}' already exist")                                           \
     S(InvalidType, "Invalid type '{}'")                                                  \
     S(InvalidDatabaseName, "Invalid database name '{}'")                                 \
     S(InvalidValueType, "Invalid type for attribute '{}'")                               \
@@ -92,7 +94,7 @@ public:
     }
 
     ALWAYS_INLINE Result(Error error)
-        : m_error(static_cast<SQLErrorCode>(error.code()))
+        : m_error(error.is_errno() ? static_cast<SQLErrorCode>(error.code()) : SQLErrorCode::InternalError)
         , m_error_message(error.string_literal())
     {
     }
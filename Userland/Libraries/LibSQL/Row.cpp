@@ -38,6 +38,15 @@ void Row::deserialize(Serializer& serializer)
 {
     Tuple::deserialize(serializer);
     m_next_pointer = serializer.deserialize<u32>();
+
+    // Only the names and types of the columns are stored with the row, so
+    // put back the table they belong to.
+    if (m_table) {
+        for (auto& element : *descriptor()) {
+            element.schema = m_table->parent()->name();
+            element.table = m_table->name();
+        }
+    }
 }
 
 void Row::serialize(Serializer& serializer) const
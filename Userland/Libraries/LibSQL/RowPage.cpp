@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/RowPage.h>
+
+namespace SQL {
+
+void RowPageWriter::append(Tuple const& row)
+{
+    m_serializer.serialize<u32>((u32)row.size());
+    for (auto ix = 0u; ix < row.size(); ix++)
+        m_serializer.serialize<Value>(row[ix]);
+    m_row_count++;
+}
+
+ByteBuffer RowPageWriter::finish()
+{
+    auto page = m_serializer.buffer();
+    m_serializer.reset();
+    m_row_count = 0;
+    return page;
+}
+
+Vector<Vector<Value>> read_row_page(ByteBuffer page)
+{
+    Serializer serializer;
+    serializer.set_buffer(move(page));
+
+    Vector<Vector<Value>> rows;
+    while (serializer.offset() < serializer.buffer().size()) {
+        auto size = serializer.deserialize<u32>();
+        Vector<Value> row;
+        row.ensure_capacity(size);
+        for (auto ix = 0u; ix < size; ix++)
+            row.unchecked_append(serializer.deserialize<Value>());
+        rows.append(move(row));
+    }
+    return rows;
+}
+
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Vector.h>
+#include <LibSQL/Serializer.h>
+#include <LibSQL/Tuple.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+/**
+ * A row page is a batch of result rows, the way SQLServer sends them to its
+ * clients. The values are serialized together with their types, so clients
+ * get typed rows, and only have to turn values into strings when they
+ * display them.
+ */
+class RowPageWriter {
+public:
+    void append(Tuple const&);
+    size_t row_count() const { return m_row_count; }
+
+    // Returns the page, and starts a new, empty one.
+    ByteBuffer finish();
+
+private:
+    Serializer m_serializer;
+    size_t m_row_count { 0 };
+};
+
+Vector<Vector<Value>> read_row_page(ByteBuffer);
+
+}
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibSQL/RowPage.h>
 #include <LibSQL/SQLClient.h>
 
 namespace SQL {
@@ -45,20 +46,25 @@ void SQLClient::execution_success(int statement_id, bool has_results, int create
         outln("{} row(s) created, {} updated, {} deleted", created, updated, deleted);
 }
 
-void SQLClient::next_result(int statement_id, Vector<String> const& row)
+void SQLClient::next_result_page(int statement_id, u32 execution_id, ByteBuffer const& rows)
 {
-    if (on_next_result) {
-        on_next_result(statement_id, row);
-        return;
+    for (auto& row : read_row_page(rows)) {
+        if (on_next_result) {
+            on_next_result(statement_id, row);
+            continue;
+        }
+        bool first = true;
+        for (auto& column : row) {
+            if (!first)
+                out(", ");
+            out("\"{}\"", column.to_string());
+            first = false;
+        }
+        outln();
     }
-    bool first = true;
-    for (auto& column : row) {
-        if (!first)
-            out(", ");
-        out("\"{}\"", column);
-        first = false;
-    }
-    outln();
+
+    // The server waits for this before it sends more than a few pages.
+    async_result_page_processed(statement_id, execution_id);
 }
 
 void SQLClient::results_exhausted(int statement_id, int total_rows)
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <LibIPC/ConnectionToServer.h>
+#include <LibSQL/Value.h>
 #include <SQLServer/SQLClientEndpoint.h>
 #include <SQLServer/SQLServerEndpoint.h>
 
@@ -24,9 +25,17 @@ class SQLClient
     Function<void(int, int, String const&)> on_connection_error;
     Function<void(int, int, String const&)> on_execution_error;
     Function<void(int, bool, int, int, int)> on_execution_success;
-    Function<void(int, Vector<String> const&)> on_next_result;
+    Function<void(int, Vector<Value> const&)> on_next_result;
     Function<void(int, int)> on_results_exhausted;
 
+    // Result rows arrive in pages of up to this many rows. The server only
+    // sends a few pages ahead of the pages the client has processed.
+    static constexpr u32 default_rows_per_page = 256;
+    u32 rows_per_page() const { return m_rows_per_page; }
+    void set_rows_per_page(u32 rows_per_page) { m_rows_per_page = max(rows_per_page, 1u); }
+
+    void execute_statement(int statement_id) { async_statement_execute(statement_id, m_rows_per_page); }
+
 private:
     SQLClient(NonnullOwnPtr<Core::Stream::LocalSocket> socket)
         : IPC::ConnectionToServer<SQLClientEndpoint, SQLServerEndpoint>(*this, move(socket))
@@ -36,10 +45,12 @@ private:
     virtual void connected(int connection_id, String const& connected_to_database) override;
     virtual void connection_error(int connection_id, int code, String const& message) override;
     virtual void execution_success(int statement_id, bool has_results, int created, int updated, int deleted) override;
-    virtual void next_result(int statement_id, Vector<String> const&) override;
+    virtual void next_result_page(int statement_id, u32 execution_id, ByteBuffer const&) override;
     virtual void results_exhausted(int statement_id, int total_rows) override;
     virtual void execution_error(int statement_id, int code, String const& message) override;
     virtual void disconnected(int connection_id) override;
+
+    u32 m_rows_per_page { default_rows_per_page };
 };
 
 }
@@ -47,6 +47,16 @@ public:
         m_current_offset = 0;
     }
 
+    // Serializing into and deserializing from a buffer that isn't a heap block,
+    // for data that lives outside of the database file.
+    ByteBuffer const& buffer() const { return m_buffer; }
+
+    void set_buffer(ByteBuffer buffer)
+    {
+        m_buffer = move(buffer);
+        m_current_offset = 0;
+    }
+
     template<typename T, typename... Args>
     T deserialize_block(u32 pointer, Args&&... args)
     {
@@ -141,6 +151,10 @@ private:
     {
         if constexpr (SQL_DEBUG)
             dump(ptr, sz, "(out) =>");
+        // ByteBuffer only grows to the size it is asked for. Growing it
+        // geometrically keeps serializing many values into one buffer linear.
+        if (m_buffer.size() + sz > m_buffer.capacity())
+            m_buffer.ensure_capacity(max(m_buffer.size() + sz, m_buffer.capacity() * 2));
         m_buffer.append(ptr, sz);
         m_current_offset += sz;
     }
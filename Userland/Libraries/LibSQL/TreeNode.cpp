@@ -113,6 +113,10 @@ TreeNode::TreeNode(BTree& tree, TreeNode* up, TreeNode* left, u32 pointer)
 
 void TreeNode::deserialize(Serializer& serializer)
 {
+    // Nodes below the root are constructed as an empty leaf before they are read, so start from scratch.
+    m_entries.clear();
+    m_down.clear();
+
     auto nodes = serializer.deserialize<u32>();
     dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes);
     if (nodes > 0) {
@@ -130,6 +134,9 @@ void TreeNode::deserialize(Serializer& serializer)
         dbgln_if(SQL_DEBUG, "Right {}", right);
         VERIFY((right == 0) == m_is_leaf);
         m_down.empend(this, right);
+    } else {
+        m_down.empend(this, nullptr);
+        m_is_leaf = true;
     }
 }
 
@@ -153,7 +160,8 @@ size_t TreeNode::length() const
 {
     if (!size())
         return 0;
-    size_t len = sizeof(u32);
+    // The entry count, the down pointer and key of every entry, and the rightmost down pointer.
+    size_t len = 2 * sizeof(u32);
     for (auto& key : m_entries) {
         len += sizeof(u32) + key.length();
     }
@@ -336,7 +344,7 @@ void TreeNode::split()
             down.m_node->m_up = new_node;
         }
         new_node->m_entries.append(entry);
-        new_node->m_down.append(down);
+        new_node->m_down.append(DownPointer(new_node, down));
     }
 
     // Move the median key in the node one level up. Its right node will
@@ -346,7 +354,7 @@ void TreeNode::split()
     dump_if(SQL_DEBUG, "Split Left To WAL");
     tree().serializer().serialize_and_write(*this, pointer());
     new_node->dump_if(SQL_DEBUG, "Split Right to WAL");
-    tree().serializer().serialize_and_write(*new_node, pointer());
+    tree().serializer().serialize_and_write(*new_node, new_node->pointer());
 
     m_up->just_insert(median, new_node);
 }
@@ -316,7 +316,10 @@ Value& Value::operator=(Vector<Value> const& vector)
 
 size_t Value::length() const
 {
-    return m_impl.visit([&](auto& impl) { return impl.length(); });
+    // Every value is serialized with its type flags, followed by the value itself unless it's NULL.
+    if (is_null())
+        return sizeof(u8);
+    return sizeof(u8) + m_impl.visit([&](auto& impl) { return impl.length(); });
 }
 
 u32 Value::hash() const
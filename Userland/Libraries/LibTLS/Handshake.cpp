@@ -5,10 +5,13 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/Memory.h>
 #include <AK/Random.h>
 
+#include <LibCore/DateTime.h>
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
@@ -35,6 +38,28 @@ ByteBuffer TLSv12::build_hello()
     builder.append(version);
     builder.append(m_context.local_random, sizeof(m_context.local_random));
 
+    // Offer to resume the last session with this server, which saves the server's certificates and the key exchange.
+    // Resuming skips the certificate checks too, so only sessions that went through exactly the checks we'd do now qualify.
+    m_context.offered_session.clear();
+    if (can_use_session_cache()) {
+        auto session = SessionCache::the().find(m_context.extensions.SNI, m_context.port);
+        if (session.has_value()
+            && session->host == m_context.extensions.SNI
+            && session->port == m_context.port
+            && session->trust == certificate_trust()
+            && m_context.options.usable_cipher_suites.contains_slow(session->cipher)) {
+            if (!session->session_id_size) {
+                // RFC 5077 section 3.4: The server accepts a ticket by echoing the session ID that comes with it,
+                //                       so we have to make one up.
+                fill_with_random(session->session_id, sizeof(session->session_id));
+                session->session_id_size = sizeof(session->session_id);
+            }
+            memcpy(m_context.session_id, session->session_id, session->session_id_size);
+            m_context.session_id_size = session->session_id_size;
+            m_context.offered_session = session.release_value();
+        }
+    }
+
     builder.append(m_context.session_id_size);
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
@@ -82,6 +107,14 @@ ByteBuffer TLSv12::build_hello()
     if (sni_length)
         extension_length += sni_length + 9;
 
+    // session_ticket: 2b extension ID, 2b extension length, and the ticket, if we have one (RFC 5077 section 3.2)
+    size_t session_ticket_length = 0;
+    if (m_context.options.use_session_cache) {
+        if (m_context.offered_session.has_value())
+            session_ticket_length = m_context.offered_session->ticket.size();
+        extension_length += 4 + session_ticket_length;
+    }
+
     // Only send elliptic_curves and ec_point_formats extensions if both are supported
     if (supports_elliptic_curves)
         extension_length += 6 + elliptic_curves_length + 5 + supported_ec_point_formats_length;
@@ -130,6 +163,14 @@ ByteBuffer TLSv12::build_hello()
             builder.append((u8)format);
     }
 
+    if (m_context.options.use_session_cache) {
+        // session_ticket extension
+        builder.append((u16)HandshakeExtension::SessionTicket);
+        builder.append((u16)session_ticket_length);
+        if (session_ticket_length)
+            builder.append(m_context.offered_session->ticket.bytes());
+    }
+
     if (alpn_length) {
         // TODO
         VERIFY_NOT_REACHED();
@@ -178,7 +219,8 @@ ByteBuffer TLSv12::build_handshake_finished()
     auto outbuffer = Bytes { out, verify_data_length };
     ByteBuffer dummy;
 
-    auto digest = m_context.handshake_hash.digest();
+    // The server's finished message covers ours, so the handshake hash has to live on.
+    auto digest = m_context.handshake_hash.peek();
     auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
     pseudorandom_function(outbuffer, m_context.master_key, (u8 const*)"client finished", 15, hashbuf, dummy);
 
@@ -216,8 +258,103 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         return (i8)Error::NeedMoreData;
     }
 
-    // TODO: Compare Hashes
-    dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+    // RFC 5246 section 7.4.9: verify_data = PRF(master_secret, finished_label, Hash(handshake_messages))
+    // Simplification: Assume that verify_data_length is always 12, like build_handshake_finished() does.
+    constexpr u32 verify_data_length = 12;
+    if (size != verify_data_length) {
+        dbgln("finished message has unexpected verify_data length {}", size);
+        return (i8)Error::BrokenPacket;
+    }
+
+    u8 expected_verify_data[verify_data_length];
+    auto digest = m_context.handshake_hash.peek();
+    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
+    pseudorandom_function(Bytes { expected_verify_data, verify_data_length }, m_context.master_key, (u8 const*)"server finished", 15, hashbuf, {});
+
+    if (!timing_safe_compare(expected_verify_data, buffer.offset_pointer(index), verify_data_length)) {
+        dbgln("server finished message failed verification");
+        return (i8)Error::NotSafe;
+    }
+
+    // The client certificate isn't part of the session, so sessions that needed one can't be resumed.
+    if (!m_context.handshake_messages[6])
+        store_session();
+
+    if (m_context.is_resumed_session) {
+        // The abbreviated handshake ends with our finished message instead of the server's.
+        write_packets = WritePacketStage::Finished;
+    } else {
+        finish_handshake();
+    }
+
+    return index + size;
+}
+
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3: struct { uint32 ticket_lifetime_hint; opaque ticket<0..2^16-1>; } NewSessionTicket;
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime_hint = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (ticket_length + 6 != size)
+        return (i8)Error::BrokenPacket;
+
+    auto ticket = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket.is_error())
+        return (i8)Error::OutOfMemory;
+
+    dbgln_if(TLS_DEBUG, "Received a session ticket of {} bytes, valid for {}s", ticket_length, lifetime_hint);
+    m_context.session_ticket = ticket.release_value();
+    m_context.session_ticket_lifetime_hint = lifetime_hint;
+
+    return size + 3;
+}
+
+void TLSv12::store_session()
+{
+    if (!can_use_session_cache())
+        return;
+
+    if (m_context.master_key.size() != 48)
+        return;
+
+    Session session;
+    session.host = m_context.extensions.SNI;
+    session.port = m_context.port;
+    session.cipher = m_context.cipher;
+    session.master_key = m_context.master_key;
+    memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+    session.session_id_size = m_context.session_id_size;
+    session.trust = certificate_trust();
+    session.expiry_timestamp = Core::DateTime::now().timestamp() + SessionCache::default_session_lifetime_in_seconds;
+
+    if (m_context.is_resumed_session) {
+        // A resumed session doesn't live any longer than it did the first time around.
+        auto& offered_session = *m_context.offered_session;
+        session.expiry_timestamp = offered_session.expiry_timestamp;
+        session.ticket = offered_session.ticket;
+    }
+
+    if (!m_context.session_ticket.is_empty()) {
+        session.ticket = m_context.session_ticket;
+        if (m_context.session_ticket_lifetime_hint)
+            session.expiry_timestamp = Core::DateTime::now().timestamp() + min<time_t>(m_context.session_ticket_lifetime_hint, SessionCache::max_session_lifetime_in_seconds);
+    }
+
+    SessionCache::the().store(move(session));
+}
+
+void TLSv12::finish_handshake()
+{
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -229,8 +366,6 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     if (on_connected)
         on_connected();
-
-    return index + size;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
@@ -299,6 +434,20 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case NewSessionTicket:
+            if (m_context.handshake_messages[11] >= 1) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[11];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            if (m_context.connection_status == ConnectionStatus::KeyExchange) {
+                payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            } else {
+                payload_res = (i8)Error::UnexpectedMessage;
+            }
+            break;
         case CertificateMessage:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -538,7 +687,7 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            finish_handshake();
             break;
         }
         payload_size++;
@@ -61,6 +61,13 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // RFC 5246 section 7.4.1.3: The server agrees to resume a session by echoing its ID.
+    auto& offered_session = m_context.offered_session;
+    bool is_resuming_session = offered_session.has_value()
+        && session_length
+        && session_length == offered_session->session_id_size
+        && memcmp(buffer.offset_pointer(res), offered_session->session_id, session_length) == 0;
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -84,6 +91,10 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
+    if (is_resuming_session && cipher != offered_session->cipher) {
+        dbgln("Server resumed a session with a different cipher suite");
+        return (i8)Error::NotSafe;
+    }
     m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", (u16)cipher);
 
@@ -104,6 +115,16 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         write_packets = WritePacketStage::ServerHandshake;
     }
 
+    if (is_resuming_session) {
+        dbgln_if(TLS_DEBUG, "Resuming session with {}", m_context.extensions.SNI);
+        m_context.is_resumed_session = true;
+        m_context.master_key = offered_session->master_key;
+        if (!expand_key())
+            return (i8)Error::NotUnderstood;
+        // There is no certificate or key exchange in an abbreviated handshake, the server's ChangeCipherSpec follows.
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+    }
+
     // Presence of extensions is determined by availability of bytes after compression_method
     if (buffer.size() - res >= 2) {
         auto extensions_bytes_total = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res += 2)));
@@ -187,6 +208,9 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
             // uncompressed points. Therefore, this extension can be safely ignored as it should always inform us
             // that the server supports uncompressed points.
             res += extension_length;
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // RFC 5077 section 3.2: The server announces a NewSessionTicket message with an empty extension.
+            res += extension_length;
         } else {
             dbgln("Encountered unknown extension {} with length {}", (u16)extension_type, extension_length);
             res += extension_length;
@@ -14,6 +14,14 @@
 
 namespace TLS {
 
+// Each record can hold at most 18432 bytes, leaving some headroom and rounding down to
+// a nice number gives us a maximum of 16 KiB for user-supplied application data,
+// which will be sent as a single record containing a single ApplicationData message.
+constexpr static size_t MaximumApplicationDataChunkSize = 16 * KiB;
+
+// What encryption adds after the plaintext: at most a SHA384 MAC and a block of padding.
+constexpr static size_t MaximumRecordTrailerSize = 48 + 16;
+
 ByteBuffer TLSv12::build_alert(bool critical, u8 code)
 {
     PacketBuilder builder(MessageType::Alert, (u16)m_context.options.version);
@@ -36,23 +44,26 @@ void TLSv12::alert(AlertLevel level, AlertDescription code)
     MUST(flush());
 }
 
-void TLSv12::write_packet(ByteBuffer& packet)
+void TLSv12::schedule_or_perform_flush(bool immediate)
 {
-    auto schedule_or_perform_flush = [&](bool immediate) {
-        if (m_context.connection_status > ConnectionStatus::Disconnected) {
-            if (!m_has_scheduled_write_flush && !immediate) {
-                dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
-                Core::deferred_invoke([this] { write_into_socket(); });
-                m_has_scheduled_write_flush = true;
-            } else {
-                // multiple packet are available, let's flush some out
-                dbgln_if(TLS_DEBUG, "Flushing scheduled write of {}", m_context.tls_buffer.size());
-                write_into_socket();
-                // the deferred invoke is still in place
-                m_has_scheduled_write_flush = true;
-            }
+    if (m_context.connection_status > ConnectionStatus::Disconnected) {
+        if (!m_has_scheduled_write_flush && !immediate) {
+            dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
+            Core::deferred_invoke([this] { write_into_socket(); });
+            m_has_scheduled_write_flush = true;
+        } else {
+            // multiple packet are available, let's flush some out
+            dbgln_if(TLS_DEBUG, "Flushing scheduled write of {}", m_context.tls_buffer.size());
+            auto has_scheduled_write_flush = m_has_scheduled_write_flush;
+            write_into_socket();
+            // the deferred invoke (if any) is still in place
+            m_has_scheduled_write_flush = has_scheduled_write_flush;
         }
-    };
+    }
+}
+
+void TLSv12::write_packet(ByteBuffer& packet)
+{
     // Record size limit is 18432 bytes, leave some headroom and flush at 16K.
     if (m_context.tls_buffer.size() + packet.size() > 16 * KiB)
         schedule_or_perform_flush(true);
@@ -64,8 +75,81 @@ void TLSv12::write_packet(ByteBuffer& packet)
     schedule_or_perform_flush(false);
 }
 
+ErrorOr<Bytes> TLSv12::reserve_space(ByteBuffer& buffer, size_t length)
+{
+    // Grow the buffer geometrically, so that filling it one record at a time doesn't reallocate (and copy) it every time.
+    auto needed_capacity = buffer.size() + length;
+    if (needed_capacity > buffer.capacity())
+        TRY(buffer.try_ensure_capacity(max(needed_capacity, buffer.capacity() * 2)));
+    return buffer.get_bytes_for_writing(length);
+}
+
+ErrorOr<size_t> TLSv12::append_to_open_record(ReadonlyBytes data)
+{
+    size_t header_size = 5;
+    if (!m_context.open_record_offset.has_value()) {
+        auto record_offset = m_context.tls_buffer.size();
+        // Make room for the whole record up front, so it never moves while it is filled up and encrypted.
+        auto record = TRY(reserve_space(m_context.tls_buffer, header_size + iv_length() + MaximumApplicationDataChunkSize + MaximumRecordTrailerSize));
+        record[0] = (u8)MessageType::ApplicationData;
+        ByteReader::store(record.offset(1), AK::convert_between_host_and_network_endian((u16)m_context.options.version));
+        m_context.tls_buffer.resize(record_offset + header_size + iv_length());
+        m_context.open_record_offset = record_offset;
+    }
+
+    auto plaintext_offset = *m_context.open_record_offset + header_size + iv_length();
+    auto plaintext_size = m_context.tls_buffer.size() - plaintext_offset;
+    auto size_to_append = min(data.size(), MaximumApplicationDataChunkSize - plaintext_size);
+    TRY(m_context.tls_buffer.try_append(data.data(), size_to_append));
+
+    if (plaintext_size + size_to_append == MaximumApplicationDataChunkSize)
+        seal_open_record();
+
+    return size_to_append;
+}
+
+void TLSv12::seal_open_record()
+{
+    if (!m_context.open_record_offset.has_value())
+        return;
+
+    encrypt_record(m_context.tls_buffer, m_context.open_record_offset.release_value());
+    ++m_context.local_sequence_number;
+}
+
+// AEAD AAD (13)
+// Seq. no (8)
+// content type (1)
+// version (2)
+// length (2)
+static void build_aead_additional_data(u8 (&aad)[13], u64 sequence_number, ReadonlyBytes type_and_version, u16 length)
+{
+    Bytes aad_bytes { aad, sizeof(aad) };
+    OutputMemoryStream aad_stream { aad_bytes };
+
+    u64 seq_no = AK::convert_between_host_and_network_endian(sequence_number);
+    u16 len = AK::convert_between_host_and_network_endian(length);
+
+    aad_stream.write({ &seq_no, sizeof(seq_no) });
+    aad_stream.write(type_and_version);
+    aad_stream.write({ &len, sizeof(len) });
+    VERIFY(aad_stream.is_end());
+}
+
+// The sequence number, padded to 12 bytes, XORed with the fixed IV (RFC 7905 section 2)
+static void build_chacha20_poly1305_nonce(u8 (&nonce)[12], u8 const (&fixed_iv)[12], u64 sequence_number)
+{
+    u64 seq_no = AK::convert_between_host_and_network_endian(sequence_number);
+    memcpy(nonce, fixed_iv, sizeof(nonce));
+    for (size_t i = 0; i < sizeof(seq_no); ++i)
+        nonce[4 + i] ^= reinterpret_cast<u8 const*>(&seq_no)[i];
+}
+
 void TLSv12::update_packet(ByteBuffer& packet)
 {
+    // Data passed to write() earlier has to go out (and use up its sequence number) first.
+    seal_open_record();
+
     u32 header_size = 5;
     ByteReader::store(packet.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size)));
 
@@ -76,163 +160,111 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 update_hash(packet.bytes(), header_size);
             }
         }
-        if (m_context.cipher_spec_set && m_context.crypto.created) {
-            size_t length = packet.size() - header_size;
-            size_t block_size = 0;
-            size_t padding = 0;
-            size_t mac_size = 0;
-
-            m_cipher_local.visit(
-                [&](Empty&) { VERIFY_NOT_REACHED(); },
-                [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
-                    VERIFY(is_aead());
-                    block_size = gcm.cipher().block_size();
-                    padding = 0;
-                    mac_size = 0; // AEAD provides its own authentication scheme.
-                },
-                [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
-                    VERIFY(!is_aead());
-                    block_size = cbc.cipher().block_size();
-                    // If the length is already a multiple a block_size,
-                    // an entire block of padding is added.
-                    // In short, we _never_ have no padding.
-                    mac_size = mac_length();
-                    length += mac_size;
-                    padding = block_size - length % block_size;
-                    length += padding;
-                });
-
-            if (m_context.crypto.created == 1) {
-                // `buffer' will continue to be encrypted
-                auto buffer_result = ByteBuffer::create_uninitialized(length);
-                if (buffer_result.is_error()) {
-                    dbgln("LibTLS: Failed to allocate enough memory");
-                    VERIFY_NOT_REACHED();
-                }
-                auto buffer = buffer_result.release_value();
-                size_t buffer_position = 0;
-                auto iv_size = iv_length();
-
-                // copy the packet, sans the header
-                buffer.overwrite(buffer_position, packet.offset_pointer(header_size), packet.size() - header_size);
-                buffer_position += packet.size() - header_size;
-
-                ByteBuffer ct;
-
-                m_cipher_local.visit(
-                    [&](Empty&) { VERIFY_NOT_REACHED(); },
-                    [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
-                        VERIFY(is_aead());
-                        // We need enough space for a header, the data, a tag, and the IV
-                        auto ct_buffer_result = ByteBuffer::create_uninitialized(length + header_size + iv_size + 16);
-                        if (ct_buffer_result.is_error()) {
-                            dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
-                            VERIFY_NOT_REACHED();
-                        }
-                        ct = ct_buffer_result.release_value();
-
-                        // copy the header over
-                        ct.overwrite(0, packet.data(), header_size - 2);
-
-                        // AEAD AAD (13)
-                        // Seq. no (8)
-                        // content type (1)
-                        // version (2)
-                        // length (2)
-                        u8 aad[13];
-                        Bytes aad_bytes { aad, 13 };
-                        OutputMemoryStream aad_stream { aad_bytes };
-
-                        u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
-                        u16 len = AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size));
-
-                        aad_stream.write({ &seq_no, sizeof(seq_no) });
-                        aad_stream.write(packet.bytes().slice(0, 3)); // content-type + version
-                        aad_stream.write({ &len, sizeof(len) });      // length
-                        VERIFY(aad_stream.is_end());
-
-                        // AEAD IV (12)
-                        // IV (4)
-                        // (Nonce) (8)
-                        // -- Our GCM impl takes 16 bytes
-                        // zero (4)
-                        u8 iv[16];
-                        Bytes iv_bytes { iv, 16 };
-                        Bytes { m_context.crypto.local_aead_iv, 4 }.copy_to(iv_bytes);
-                        fill_with_random(iv_bytes.offset(4), 8);
-                        memset(iv_bytes.offset(12), 0, 4);
-
-                        // write the random part of the iv out
-                        iv_bytes.slice(4, 8).copy_to(ct.bytes().slice(header_size));
-
-                        // Write the encrypted data and the tag
-                        gcm.encrypt(
-                            packet.bytes().slice(header_size, length),
-                            ct.bytes().slice(header_size + 8, length),
-                            iv_bytes,
-                            aad_bytes,
-                            ct.bytes().slice(header_size + 8 + length, 16));
-
-                        VERIFY(header_size + 8 + length + 16 == ct.size());
-                    },
-                    [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
-                        VERIFY(!is_aead());
-                        // We need enough space for a header, iv_length bytes of IV and whatever the packet contains
-                        auto ct_buffer_result = ByteBuffer::create_uninitialized(length + header_size + iv_size);
-                        if (ct_buffer_result.is_error()) {
-                            dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
-                            VERIFY_NOT_REACHED();
-                        }
-                        ct = ct_buffer_result.release_value();
-
-                        // copy the header over
-                        ct.overwrite(0, packet.data(), header_size - 2);
-
-                        // get the appropriate HMAC value for the entire packet
-                        auto mac = hmac_message(packet, {}, mac_size, true);
-
-                        // write the MAC
-                        buffer.overwrite(buffer_position, mac.data(), mac.size());
-                        buffer_position += mac.size();
-
-                        // Apply the padding (a packet MUST always be padded)
-                        memset(buffer.offset_pointer(buffer_position), padding - 1, padding);
-                        buffer_position += padding;
-
-                        VERIFY(buffer_position == buffer.size());
-
-                        auto iv_buffer_result = ByteBuffer::create_uninitialized(iv_size);
-                        if (iv_buffer_result.is_error()) {
-                            dbgln("LibTLS: Failed to allocate memory for IV");
-                            VERIFY_NOT_REACHED();
-                        }
-                        auto iv = iv_buffer_result.release_value();
-                        fill_with_random(iv.data(), iv.size());
-
-                        // write it into the ciphertext portion of the message
-                        ct.overwrite(header_size, iv.data(), iv.size());
-
-                        VERIFY(header_size + iv_size + length == ct.size());
-                        VERIFY(length % block_size == 0);
-
-                        // get a block to encrypt into
-                        auto view = ct.bytes().slice(header_size + iv_size, length);
-                        cbc.encrypt(buffer, view, iv);
-                    });
-
-                // store the correct ciphertext length into the packet
-                u16 ct_length = (u16)ct.size() - header_size;
-
-                ByteReader::store(ct.offset_pointer(header_size - 2), AK::convert_between_host_and_network_endian(ct_length));
-
-                // replace the packet with the ciphertext
-                packet = ct;
+        if (m_context.cipher_spec_set && m_context.crypto.created == 1) {
+            // Make room for the explicit nonce (or IV) between the header and the payload.
+            auto nonce_size = iv_length();
+            if (nonce_size > 0) {
+                auto payload_size = packet.size() - header_size;
+                packet.resize(packet.size() + nonce_size);
+                memmove(packet.offset_pointer(header_size + nonce_size), packet.offset_pointer(header_size), payload_size);
             }
+            encrypt_record(packet, 0);
         }
     }
     ++m_context.local_sequence_number;
 }
 
+void TLSv12::encrypt_record(ByteBuffer& buffer, size_t record_offset)
+{
+    // The record spans the rest of the buffer, and leaves iv_length() bytes between its header and
+    // the plaintext for the explicit nonce (or IV). It is encrypted where it lies, and the tag (or the MAC
+    // and the padding) is appended to the buffer.
+    size_t header_size = 5;
+    auto nonce_size = iv_length();
+    auto plaintext_offset = record_offset + header_size + nonce_size;
+    VERIFY(buffer.size() >= plaintext_offset);
+    auto plaintext_size = buffer.size() - plaintext_offset;
+
+    u8 header[5];
+    memcpy(header, buffer.offset_pointer(record_offset), 3);
+    ByteReader::store(header + 3, AK::convert_between_host_and_network_endian((u16)plaintext_size));
+
+    m_cipher_local.visit(
+        [&](Empty&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            VERIFY(is_aead());
+            size_t tag_size = 16;
+            buffer.resize(buffer.size() + tag_size);
+            auto record = buffer.bytes().slice(record_offset);
+
+            u8 aad[13];
+            build_aead_additional_data(aad, m_context.local_sequence_number, { header, 3 }, plaintext_size);
+
+            // AEAD IV (12)
+            // IV (4)
+            // (Nonce) (8)
+            // -- Our GCM impl takes 16 bytes
+            // zero (4)
+            u8 iv[16];
+            Bytes iv_bytes { iv, 16 };
+            Bytes { m_context.crypto.local_aead_iv, 4 }.copy_to(iv_bytes);
+            fill_with_random(iv_bytes.offset(4), 8);
+            memset(iv_bytes.offset(12), 0, 4);
+
+            // write the random part of the iv out
+            iv_bytes.slice(4, 8).copy_to(record.slice(header_size, nonce_size));
+
+            auto plaintext = record.slice(header_size + nonce_size, plaintext_size);
+            gcm.encrypt(plaintext, plaintext, iv_bytes, { aad, sizeof(aad) }, record.slice(header_size + nonce_size + plaintext_size, tag_size));
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            VERIFY(is_aead());
+            auto tag_size = Crypto::Cipher::ChaCha20Poly1305::tag_size;
+            buffer.resize(buffer.size() + tag_size);
+            auto record = buffer.bytes().slice(record_offset);
+
+            u8 aad[13];
+            build_aead_additional_data(aad, m_context.local_sequence_number, { header, 3 }, plaintext_size);
+
+            u8 nonce[12];
+            build_chacha20_poly1305_nonce(nonce, m_context.crypto.local_aead_iv, m_context.local_sequence_number);
+
+            auto plaintext = record.slice(header_size + nonce_size, plaintext_size);
+            chacha.encrypt(plaintext, plaintext, { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, record.slice(header_size + nonce_size + plaintext_size, tag_size));
+        },
+        [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
+            VERIFY(!is_aead());
+            auto block_size = cbc.cipher().block_size();
+            auto mac_size = mac_length();
+            // If the length is already a multiple a block_size,
+            // an entire block of padding is added.
+            // In short, we _never_ have no padding.
+            auto padding = block_size - (plaintext_size + mac_size) % block_size;
+
+            // get the appropriate HMAC value for the entire packet
+            auto mac = hmac_message({ header, sizeof(header) }, buffer.bytes().slice(plaintext_offset, plaintext_size), mac_size, true);
+
+            buffer.resize(plaintext_offset + plaintext_size + mac_size + padding);
+            auto record = buffer.bytes().slice(record_offset);
+
+            // write the MAC
+            mac.bytes().copy_to(record.slice(header_size + nonce_size + plaintext_size, mac_size));
+
+            // Apply the padding (a packet MUST always be padded)
+            memset(record.offset(header_size + nonce_size + plaintext_size + mac_size), padding - 1, padding);
+
+            auto iv = record.slice(header_size, nonce_size);
+            fill_with_random(iv.data(), iv.size());
+
+            auto data = record.slice(header_size + nonce_size);
+            VERIFY(data.size() % block_size == 0);
+            cbc.encrypt(data, data, iv);
+        });
+
+    // store the correct ciphertext length into the header
+    ByteReader::store(buffer.offset_pointer(record_offset + 3), AK::convert_between_host_and_network_endian((u16)(buffer.size() - record_offset - header_size)));
+}
+
 void TLSv12::update_hash(ReadonlyBytes message, size_t header_size)
 {
     dbgln_if(TLS_DEBUG, "Update hash with message of size {}", message.size());
@@ -344,7 +376,16 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
     dbgln_if(TLS_DEBUG, "message type: {}, length: {}", (u8)type, length);
     auto plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
+    // Application data is decrypted straight into the application buffer, everything else goes through a scratch buffer.
+    bool decrypt_into_application_buffer = type == MessageType::ApplicationData && m_context.connection_status == ConnectionStatus::Established;
+    bool plain_is_in_application_buffer = false;
     ByteBuffer decrypted;
+    auto reserve_decrypted = [&](size_t size) -> ErrorOr<Bytes> {
+        if (decrypt_into_application_buffer)
+            return reserve_application_data(size);
+        decrypted = TRY(ByteBuffer::create_uninitialized(size));
+        return decrypted.bytes();
+    };
 
     if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
         if constexpr (TLS_DEBUG) {
@@ -367,30 +408,17 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
                 auto packet_length = length - iv_length() - 16;
                 auto payload = plain;
-                auto decrypted_result = ByteBuffer::create_uninitialized(packet_length);
+                auto decrypted_result = reserve_decrypted(packet_length);
                 if (decrypted_result.is_error()) {
                     dbgln("Failed to allocate memory for the packet");
                     return_value = Error::DecryptionFailed;
                     return;
                 }
-                decrypted = decrypted_result.release_value();
+                auto decrypted_bytes = decrypted_result.release_value();
 
-                // AEAD AAD (13)
-                // Seq. no (8)
-                // content type (1)
-                // version (2)
-                // length (2)
                 u8 aad[13];
                 Bytes aad_bytes { aad, 13 };
-                OutputMemoryStream aad_stream { aad_bytes };
-
-                u64 seq_no = AK::convert_between_host_and_network_endian(m_context.remote_sequence_number);
-                u16 len = AK::convert_between_host_and_network_endian((u16)packet_length);
-
-                aad_stream.write({ &seq_no, sizeof(seq_no) });      // Sequence number
-                aad_stream.write(buffer.slice(0, header_size - 2)); // content-type + version
-                aad_stream.write({ &len, sizeof(u16) });
-                VERIFY(aad_stream.is_end());
+                build_aead_additional_data(aad, m_context.remote_sequence_number, buffer.slice(0, header_size - 2), packet_length);
 
                 auto nonce = payload.slice(0, iv_length());
                 payload = payload.slice(iv_length());
@@ -411,7 +439,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
                 auto consistency = gcm.decrypt(
                     ciphertext,
-                    decrypted,
+                    decrypted_bytes,
                     iv_bytes,
                     aad_bytes,
                     tag);
@@ -425,29 +453,80 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return;
                 }
 
-                plain = decrypted;
+                plain = decrypted_bytes;
+            },
+            [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                VERIFY(is_aead());
+                auto tag_size = Crypto::Cipher::ChaCha20Poly1305::tag_size;
+                if (length < tag_size) {
+                    dbgln("Invalid packet length");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
+
+                auto packet_length = length - tag_size;
+                auto decrypted_result = reserve_decrypted(packet_length);
+                if (decrypted_result.is_error()) {
+                    dbgln("Failed to allocate memory for the packet");
+                    return_value = Error::DecryptionFailed;
+                    return;
+                }
+                auto decrypted_bytes = decrypted_result.release_value();
+
+                u8 aad[13];
+                build_aead_additional_data(aad, m_context.remote_sequence_number, buffer.slice(0, header_size - 2), packet_length);
+
+                u8 nonce[12];
+                build_chacha20_poly1305_nonce(nonce, m_context.crypto.remote_aead_iv, m_context.remote_sequence_number);
+
+                auto consistency = chacha.decrypt(
+                    plain.slice(0, packet_length),
+                    decrypted_bytes,
+                    { nonce, sizeof(nonce) },
+                    { aad, sizeof(aad) },
+                    plain.slice(packet_length, tag_size));
+
+                if (consistency != Crypto::VerificationConsistency::Consistent) {
+                    dbgln("integrity check failed (tag length {})", tag_size);
+                    auto packet = build_alert(true, (u8)AlertDescription::BadRecordMAC);
+                    write_packet(packet);
+
+                    return_value = Error::IntegrityCheckFailed;
+                    return;
+                }
+
+                plain = decrypted_bytes;
             },
             [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                 VERIFY(!is_aead());
                 auto iv_size = iv_length();
+                auto block_size = cbc.cipher().block_size();
+                if (length < iv_size + block_size || (length - iv_size) % block_size != 0) {
+                    dbgln("Invalid packet length");
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
 
-                auto decrypted_result = cbc.create_aligned_buffer(length - iv_size);
+                auto decrypted_result = reserve_decrypted(length - iv_size);
                 if (decrypted_result.is_error()) {
                     dbgln("Failed to allocate memory for the packet");
                     return_value = Error::DecryptionFailed;
                     return;
                 }
-                decrypted = decrypted_result.release_value();
+                auto decrypted_span = decrypted_result.release_value();
                 auto iv = buffer.slice(header_size, iv_size);
 
-                Bytes decrypted_span = decrypted;
                 cbc.decrypt(buffer.slice(header_size + iv_size, length - iv_size), decrypted_span, iv);
 
                 length = decrypted_span.size();
 
                 if constexpr (TLS_DEBUG) {
                     dbgln("Decrypted: ");
-                    print_buffer(decrypted);
+                    print_buffer(decrypted_span);
                 }
 
                 auto mac_size = mac_length();
@@ -479,12 +558,19 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return_value = Error::IntegrityCheckFailed;
                     return;
                 }
-                plain = decrypted.bytes().slice(0, length);
+                plain = decrypted_span.slice(0, length);
             });
 
         if (return_value != Error::NoError) {
             return (i8)return_value;
         }
+
+        if (decrypt_into_application_buffer) {
+            // The plaintext is already where it belongs, it only has to be accounted for.
+            VERIFY(plain.data() == m_context.application_buffer.end_pointer());
+            m_context.application_buffer.resize(m_context.application_buffer.size() + plain.size());
+            plain_is_in_application_buffer = true;
+        }
     }
     m_context.remote_sequence_number++;
 
@@ -498,10 +584,16 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
         } else {
             dbgln_if(TLS_DEBUG, "application data message of size {}", plain.size());
 
-            if (m_context.application_buffer.try_append(plain.data(), plain.size()).is_error()) {
-                payload_res = (i8)Error::DecryptionFailed;
-                auto packet = build_alert(true, (u8)AlertDescription::DecryptionFailed);
-                write_packet(packet);
+            if (!plain_is_in_application_buffer) {
+                auto space = reserve_application_data(plain.size());
+                if (space.is_error()) {
+                    payload_res = (i8)Error::DecryptionFailed;
+                    auto packet = build_alert(true, (u8)AlertDescription::DecryptionFailed);
+                    write_packet(packet);
+                } else {
+                    plain.copy_to(space.value());
+                    m_context.application_buffer.resize(m_context.application_buffer.size() + plain.size());
+                }
             }
         }
         break;
@@ -540,7 +632,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CloseNotify) {
                 res += 2;
-                alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+                alert(AlertLevel::Warning, AlertDescription::CloseNotify);
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
                     dbgln("Server sent a close notify and we haven't agreed on a cipher suite. Treating it as a handshake failure.");
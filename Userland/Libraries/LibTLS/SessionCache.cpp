@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/DateTime.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+ByteBuffer CertificateTrust::digest_root_certificates(Vector<Certificate> const& certificates)
+{
+    Crypto::Hash::SHA256 digest;
+    for (auto& certificate : certificates)
+        digest.update(certificate.original_asn1.bytes());
+    return MUST(ByteBuffer::copy(digest.digest().bytes()));
+}
+
+Singleton<SessionCache> SessionCache::s_the;
+
+Optional<Session> SessionCache::find(String const& host, u16 port)
+{
+    auto it = m_sessions.find(key_for(host, port));
+    if (it == m_sessions.end())
+        return {};
+
+    if (it->value.expiry_timestamp <= Core::DateTime::now().timestamp()) {
+        m_sessions.remove(it);
+        return {};
+    }
+
+    return it->value;
+}
+
+void SessionCache::store(Session session)
+{
+    if (!session.is_resumable())
+        return;
+
+    auto key = key_for(session.host, session.port);
+    if (m_sessions.size() >= max_session_count && !m_sessions.contains(key)) {
+        // Make room by dropping whatever expires first, which is never worse than dropping an arbitrary session.
+        auto soonest_expiring = m_sessions.begin();
+        for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            if (it->value.expiry_timestamp < soonest_expiring->value.expiry_timestamp)
+                soonest_expiring = it;
+        }
+        m_sessions.remove(soonest_expiring);
+    }
+
+    m_sessions.set(key, move(session));
+}
+
+void SessionCache::remove(String const& host, u16 port)
+{
+    m_sessions.remove(key_for(host, port));
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Singleton.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibTLS/Certificate.h>
+#include <LibTLS/CipherSuite.h>
+
+namespace TLS {
+
+// How a server's certificate chain is checked. Resuming a session skips the checks, so a session is only offered
+// by connections that would have checked the certificates exactly like the one that established it.
+struct CertificateTrust {
+    bool validate_certificates { true };
+    bool allow_self_signed_certificates { false };
+    // A SHA-256 digest of the root certificates, which tells apart different sets of them.
+    ByteBuffer root_certificates_digest;
+
+    static ByteBuffer digest_root_certificates(Vector<Certificate> const&);
+
+    bool operator==(CertificateTrust const&) const = default;
+};
+
+// Everything a client needs to resume a session with an abbreviated handshake, see RFC 5246 section 7.3.
+struct Session {
+    String host;
+    u16 port { 0 };
+    CipherSuite cipher { CipherSuite::Invalid };
+    ByteBuffer master_key;
+    u8 session_id[32] {};
+    u8 session_id_size { 0 };
+    // A session ticket as per RFC 5077, which lets servers resume sessions without keeping any state.
+    ByteBuffer ticket;
+    // How the certificate chain was checked when the session was established.
+    CertificateTrust trust;
+    time_t expiry_timestamp { 0 };
+
+    bool is_resumable() const { return session_id_size || !ticket.is_empty(); }
+};
+
+// Remembers the sessions of recent connections by host name and port, so that all TLSv12 instances of a process
+// can skip the certificate verification and key exchange when they connect to a server again.
+// Like the event loop that drives TLSv12, the cache is meant to be used from a single thread, and isn't locked.
+class SessionCache {
+public:
+    static constexpr size_t max_session_count = 256;
+    // Used when a server hands out a session ID or a ticket without a lifetime hint.
+    static constexpr time_t default_session_lifetime_in_seconds = 5 * 60;
+    // RFC 5246 appendix F.1.4 suggests not to keep sessions around for longer than a day.
+    static constexpr time_t max_session_lifetime_in_seconds = 24 * 60 * 60;
+
+    static SessionCache& the() { return s_the; }
+
+    Optional<Session> find(String const& host, u16 port);
+    void store(Session);
+    void remove(String const& host, u16 port);
+    void clear() { m_sessions.clear(); }
+
+    size_t size() const { return m_sessions.size(); }
+
+private:
+    static String key_for(String const& host, u16 port) { return String::formatted("{}:{}", host, port); }
+
+    static Singleton<SessionCache> s_the;
+
+    HashMap<String, Session> m_sessions;
+};
+
+}
@@ -11,24 +11,25 @@
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
 
-// Each record can hold at most 18432 bytes, leaving some headroom and rounding down to
-// a nice number gives us a maximum of 16 KiB for user-supplied application data,
-// which will be sent as a single record containing a single ApplicationData message.
-constexpr static size_t MaximumApplicationDataChunkSize = 16 * KiB;
+// Stop reading from the socket once this much decrypted data is waiting to be read, so that a fast peer
+// can't make us buffer an entire download in memory. The rest stays in the socket until the client has
+// caught up.
+constexpr static size_t MaximumPendingApplicationDataSize = 256 * KiB;
 
 namespace TLS {
 
 ErrorOr<Bytes> TLSv12::read(Bytes bytes)
 {
     m_eof = false;
-    auto size_to_read = min(bytes.size(), m_context.application_buffer.size());
+    auto data = pending_application_data();
+    auto size_to_read = min(bytes.size(), data.size());
     if (size_to_read == 0) {
         m_eof = true;
         return Bytes {};
     }
 
-    m_context.application_buffer.span().slice(0, size_to_read).copy_to(bytes);
-    m_context.application_buffer = m_context.application_buffer.slice(size_to_read, m_context.application_buffer.size() - size_to_read);
+    data.slice(0, size_to_read).copy_to(bytes);
+    discard_application_data(size_to_read);
     return Bytes { bytes.data(), size_to_read };
 }
 
@@ -37,8 +38,9 @@ String TLSv12::read_line(size_t max_size)
     if (!can_read_line())
         return {};
 
-    auto* start = m_context.application_buffer.data();
-    auto* newline = (u8*)memchr(m_context.application_buffer.data(), '\n', m_context.application_buffer.size());
+    auto data = pending_application_data();
+    auto* start = data.data();
+    auto* newline = (u8 const*)memchr(data.data(), '\n', data.size());
     VERIFY(newline);
 
     size_t offset = newline - start;
@@ -47,11 +49,52 @@ String TLSv12::read_line(size_t max_size)
         return {};
 
     String line { bit_cast<char const*>(start), offset, Chomp };
-    m_context.application_buffer = m_context.application_buffer.slice(offset + 1, m_context.application_buffer.size() - offset - 1);
+    discard_application_data(offset + 1);
 
     return line;
 }
 
+ErrorOr<Bytes> TLSv12::reserve_application_data(size_t length)
+{
+    auto& buffer = m_context.application_buffer;
+    // Drop what has been read so far before making room for more.
+    if (m_context.application_buffer_offset > 0) {
+        auto unread_size = buffer.size() - m_context.application_buffer_offset;
+        memmove(buffer.data(), buffer.offset_pointer(m_context.application_buffer_offset), unread_size);
+        buffer.resize_and_keep_capacity(unread_size);
+        m_context.application_buffer_offset = 0;
+    }
+    return reserve_space(buffer, length);
+}
+
+void TLSv12::discard_application_data(size_t length)
+{
+    m_context.application_buffer_offset += length;
+    VERIFY(m_context.application_buffer_offset <= m_context.application_buffer.size());
+    if (m_context.application_buffer_offset == m_context.application_buffer.size()) {
+        m_context.application_buffer.clear_with_capacity();
+        m_context.application_buffer_offset = 0;
+    }
+    pause_or_resume_reading();
+}
+
+void TLSv12::set_notifications_enabled(bool enabled)
+{
+    m_client_wants_notifications = enabled;
+    underlying_stream().set_notifications_enabled(enabled && !m_is_reading_paused);
+}
+
+void TLSv12::pause_or_resume_reading()
+{
+    // The socket stays readable while we leave data in it, so its notifier has to be off until the client
+    // has read enough, or we'd be woken up over and over without doing anything.
+    auto should_pause = pending_application_data().size() >= MaximumPendingApplicationDataSize;
+    if (should_pause == m_is_reading_paused)
+        return;
+    m_is_reading_paused = should_pause;
+    underlying_stream().set_notifications_enabled(m_client_wants_notifications && !should_pause);
+}
+
 ErrorOr<size_t> TLSv12::write(ReadonlyBytes bytes)
 {
     if (m_context.connection_status != ConnectionStatus::Established) {
@@ -59,14 +102,16 @@ ErrorOr<size_t> TLSv12::write(ReadonlyBytes bytes)
         return AK::Error::from_string_literal("TLS write request while not connected");
     }
 
-    for (size_t offset = 0; offset < bytes.size(); offset += MaximumApplicationDataChunkSize) {
-        PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, bytes.size() - offset };
-        builder.append(bytes.slice(offset, min(bytes.size() - offset, MaximumApplicationDataChunkSize)));
-        auto packet = builder.build();
+    // The data is copied straight into a record in tls_buffer, and encrypted there once the record is full or
+    // about to be sent. This way, small writes in quick succession end up in a single record.
+    for (size_t offset = 0; offset < bytes.size();)
+        offset += TRY(append_to_open_record(bytes.slice(offset)));
 
-        update_packet(packet);
-        write_packet(packet);
-    }
+    // Full records go out right away, the open one has until the next event loop iteration to fill up.
+    if (m_context.open_record_offset.value_or(m_context.tls_buffer.size()) >= 16 * KiB)
+        MUST(flush(false));
+    if (!m_has_scheduled_write_flush)
+        schedule_or_perform_flush(false);
 
     return bytes.size();
 }
@@ -78,6 +123,7 @@ ErrorOr<NonnullOwnPtr<TLSv12>> TLSv12::connect(String const& host, u16 port, Opt
     TRY(tcp_socket->set_blocking(false));
     auto tls_socket = make<TLSv12>(move(tcp_socket), move(options));
     tls_socket->set_sni(host);
+    tls_socket->m_context.port = port;
     tls_socket->on_connected = [&] {
         loop.quit(0);
     };
@@ -155,7 +201,7 @@ void TLSv12::setup_connection()
 
 void TLSv12::notify_client_for_app_data()
 {
-    if (m_context.application_buffer.size() > 0) {
+    if (!pending_application_data().is_empty()) {
         if (on_ready_to_read)
             on_ready_to_read();
     } else {
@@ -184,12 +230,16 @@ ErrorOr<void> TLSv12::read_from_socket()
     if (!check_connection_state(true))
         return {};
 
-    u8 buffer[16 * KiB];
-    Bytes bytes { buffer, array_size(buffer) };
-    Bytes read_bytes {};
     auto& stream = underlying_stream();
-    do {
-        auto result = stream.read(bytes);
+    while (!m_context.critical_error && pending_application_data().size() < MaximumPendingApplicationDataSize) {
+        // Read straight into the message buffer, where the records are decrypted from. Reading a lot at once
+        // leaves fewer partial records that have to be moved to the front of the buffer afterwards.
+        auto bytes_or_error = reserve_space(m_context.message_buffer, 64 * KiB);
+        if (bytes_or_error.is_error()) {
+            dbgln("Not enough space in message buffer, not reading from the socket");
+            break;
+        }
+        auto result = stream.read(bytes_or_error.value());
         if (result.is_error()) {
             if (result.error().is_errno() && result.error().code() != EINTR) {
                 if (result.error().code() != EAGAIN)
@@ -198,9 +248,13 @@ ErrorOr<void> TLSv12::read_from_socket()
             }
             continue;
         }
-        read_bytes = result.release_value();
-        consume(read_bytes);
-    } while (!read_bytes.is_empty() && !m_context.critical_error);
+        auto read_bytes = result.release_value();
+        if (read_bytes.is_empty())
+            break;
+        m_context.message_buffer.resize(m_context.message_buffer.size() + read_bytes.size());
+        consume();
+    }
+    pause_or_resume_reading();
 
     return {};
 }
@@ -236,7 +290,7 @@ bool TLSv12::check_connection_state(bool read)
     }
 
     if (read && stream.is_eof()) {
-        if (m_context.application_buffer.size() == 0 && m_context.connection_status != ConnectionStatus::Disconnected) {
+        if (pending_application_data().is_empty() && m_context.connection_status != ConnectionStatus::Disconnected) {
             m_context.has_invoked_finish_or_error_callback = true;
             if (on_tls_finished)
                 on_tls_finished();
@@ -247,6 +301,10 @@ bool TLSv12::check_connection_state(bool read)
     if (m_context.critical_error) {
         dbgln_if(TLS_DEBUG, "CRITICAL ERROR {} :(", m_context.critical_error);
 
+        // Don't offer a session again if the handshake that tried to resume it failed.
+        if (m_context.offered_session.has_value() && m_context.connection_status != ConnectionStatus::Established)
+            SessionCache::the().remove(m_context.extensions.SNI, m_context.port);
+
         m_context.has_invoked_finish_or_error_callback = true;
         if (on_tls_error)
             on_tls_error((AlertDescription)m_context.critical_error);
@@ -256,8 +314,8 @@ bool TLSv12::check_connection_state(bool read)
         return false;
     }
 
-    if (((read && m_context.application_buffer.size() == 0) || !read) && m_context.connection_finished) {
-        if (m_context.application_buffer.size() == 0 && m_context.connection_status != ConnectionStatus::Disconnected) {
+    if (((read && pending_application_data().is_empty()) || !read) && m_context.connection_finished) {
+        if (pending_application_data().is_empty() && m_context.connection_status != ConnectionStatus::Disconnected) {
             m_context.has_invoked_finish_or_error_callback = true;
             if (on_tls_finished)
                 on_tls_finished();
@@ -265,18 +323,21 @@ bool TLSv12::check_connection_state(bool read)
         if (m_context.tls_buffer.size()) {
             dbgln_if(TLS_DEBUG, "connection closed without finishing data transfer, {} bytes still in buffer and {} bytes in application buffer",
                 m_context.tls_buffer.size(),
-                m_context.application_buffer.size());
+                pending_application_data().size());
         }
-        if (!m_context.application_buffer.size()) {
+        if (pending_application_data().is_empty()) {
             return false;
         }
     }
     return true;
 }
 
-ErrorOr<bool> TLSv12::flush()
+ErrorOr<bool> TLSv12::flush(bool include_open_record)
 {
-    auto out_bytes = m_context.tls_buffer.bytes();
+    if (include_open_record)
+        seal_open_record();
+
+    auto out_bytes = m_context.tls_buffer.bytes().trim(m_context.open_record_offset.value_or(m_context.tls_buffer.size()));
 
     if (out_bytes.is_empty())
         return true;
@@ -288,27 +349,45 @@ ErrorOr<bool> TLSv12::flush()
 
     auto& stream = underlying_stream();
     Optional<AK::Error> error;
-    size_t written;
-    do {
-        auto result = stream.write(out_bytes);
-        if (result.is_error() && result.error().code() != EINTR && result.error().code() != EAGAIN) {
-            error = result.release_error();
-            dbgln("TLS Socket write error: {}", *error);
+    size_t written = 0;
+    while (written < out_bytes.size()) {
+        auto result = stream.write(out_bytes.slice(written));
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            // If the socket is full, the rest has to wait for the next flush.
+            if (!result.error().is_errno() || result.error().code() != EAGAIN) {
+                error = result.release_error();
+                dbgln("TLS Socket write error: {}", *error);
+            }
             break;
         }
-        written = result.value();
-        out_bytes = out_bytes.slice(written);
-    } while (!out_bytes.is_empty());
+        written += result.value();
+    }
 
-    if (out_bytes.is_empty() && !error.has_value()) {
-        m_context.tls_buffer.clear();
+    if (written > 0) {
+        // Drop the records that went out, but keep the buffer around for the next ones.
+        auto remaining_size = m_context.tls_buffer.size() - written;
+        memmove(m_context.tls_buffer.data(), m_context.tls_buffer.offset_pointer(written), remaining_size);
+        m_context.tls_buffer.resize_and_keep_capacity(remaining_size);
+        if (m_context.open_record_offset.has_value())
+            *m_context.open_record_offset -= written;
+    }
+
+    if (written == out_bytes.size())
         return true;
+
+    if (!error.has_value()) {
+        if (!m_has_scheduled_write_flush)
+            schedule_or_perform_flush(false);
+        return false;
     }
 
     if (m_context.send_retries++ == 10) {
         // drop the records, we can't send
         dbgln_if(TLS_DEBUG, "Dropping {} bytes worth of TLS records as max retries has been reached", m_context.tls_buffer.size());
         m_context.tls_buffer.clear();
+        m_context.open_record_offset.clear();
         m_context.send_retries = 0;
     }
     return false;
@@ -316,7 +395,8 @@ ErrorOr<bool> TLSv12::flush()
 
 void TLSv12::close()
 {
-    alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+    // RFC 5246 section 7.2.2: A fatal alert would invalidate the session, which we might want to resume later.
+    alert(AlertLevel::Warning, AlertDescription::CloseNotify);
     // bye bye.
     m_context.connection_status = ConnectionStatus::Disconnected;
 }
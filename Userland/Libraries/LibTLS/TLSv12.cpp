@@ -24,23 +24,14 @@
 
 namespace TLS {
 
-void TLSv12::consume(ReadonlyBytes record)
+void TLSv12::consume()
 {
     if (m_context.critical_error) {
         dbgln("There has been a critical error ({}), refusing to continue", (i8)m_context.critical_error);
         return;
     }
 
-    if (record.size() == 0) {
-        return;
-    }
-
-    dbgln_if(TLS_DEBUG, "Consuming {} bytes", record.size());
-
-    if (m_context.message_buffer.try_append(record).is_error()) {
-        dbgln("Not enough space in message buffer, dropping the record");
-        return;
-    }
+    dbgln_if(TLS_DEBUG, "Consuming {} bytes", m_context.message_buffer.size());
 
     size_t index { 0 };
     size_t buffer_length = m_context.message_buffer.size();
@@ -92,7 +83,10 @@ void TLSv12::consume(ReadonlyBytes record)
     }
 
     if (index) {
-        m_context.message_buffer = m_context.message_buffer.slice(index, m_context.message_buffer.size() - index);
+        // Move the incomplete record that is left to the front, without giving up the buffer.
+        auto remaining_size = m_context.message_buffer.size() - index;
+        memmove(m_context.message_buffer.data(), m_context.message_buffer.offset_pointer(index), remaining_size);
+        m_context.message_buffer.resize_and_keep_capacity(remaining_size);
     }
 }
 
@@ -188,6 +182,7 @@ void TLSv12::set_root_certificates(Vector<Certificate> certificates)
 
         m_context.root_certificates.set(cert.subject_identifier_string(), cert);
     }
+    m_context.root_certificates_digest = CertificateTrust::digest_root_certificates(certificates);
     dbgln_if(TLS_DEBUG, "{}: Set {} root certificates", this, m_context.root_certificates.size());
 }
 
@@ -426,6 +421,15 @@ void TLSv12::pseudorandom_function(Bytes output, ReadonlyBytes secret, u8 const*
     }
 }
 
+CertificateTrust TLSv12::certificate_trust() const
+{
+    return {
+        .validate_certificates = m_context.options.validate_certificates,
+        .allow_self_signed_certificates = m_context.options.allow_self_signed_certificates,
+        .root_certificates_digest = m_context.root_certificates_digest,
+    };
+}
+
 TLSv12::TLSv12(StreamVariantType stream, Options options)
     : m_stream(move(stream))
 {
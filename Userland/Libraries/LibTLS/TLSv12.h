@@ -14,11 +14,14 @@
 #include <LibCore/Timer.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibCrypto/Curves/EllipticCurve.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -123,6 +126,7 @@ enum HandshakeType {
     ClientHello = 0x01,
     ServerHello = 0x02,
     HelloVerifyRequest = 0x03,
+    NewSessionTicket = 0x04,
     CertificateMessage = 0x0b,
     ServerKeyExchange = 0x0c,
     CertificateRequest = 0x0d,
@@ -138,6 +142,7 @@ enum class HandshakeExtension : u16 {
     ECPointFormats = 0x0b,
     SignatureAlgorithms = 0x0d,
     ApplicationLayerProtocolNegotiation = 0x10,
+    SessionTicket = 0x23,
 };
 
 enum class NameType : u8 {
@@ -172,17 +177,21 @@ enum class ECCurveType : u8 {
 // 4 bytes of fixed IV, 8 random (nonce) bytes, 4 bytes for counter
 // GCM specifically asks us to transmit only the nonce, the counter is zero
 // and the fixed IV is derived from the premaster key.
-#define ENUMERATE_CIPHERS(C)                                                                                                                              \
-    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                \
-    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                \
-    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)           \
-    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false)           \
-    C(true, CipherSuite::RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)             \
-    C(true, CipherSuite::RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)             \
-    C(true, CipherSuite::DHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)     \
-    C(true, CipherSuite::DHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)     \
-    C(true, CipherSuite::ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true) \
-    C(true, CipherSuite::ECDHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)
+// ChaCha20-Poly1305 doesn't transmit an IV at all, its nonce is the 12-byte
+// fixed IV XORed with the sequence number (RFC 7905 section 2).
+#define ENUMERATE_CIPHERS(C)                                                                                                                                          \
+    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)                         \
+    C(true, CipherSuite::RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)                         \
+    C(true, CipherSuite::DHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)                 \
+    C(true, CipherSuite::DHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)                 \
+    C(true, CipherSuite::ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)             \
+    C(true, CipherSuite::ECDHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)             \
+    C(true, CipherSuite::DHE_RSA_WITH_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true)     \
+    C(true, CipherSuite::ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true)
 
 constexpr KeyExchangeAlgorithm get_key_exchange_algorithm(CipherSuite suite)
 {
@@ -213,10 +222,18 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
+        // Without the AES instructions, ChaCha20-Poly1305 is a lot faster than AES, so we ask for it first.
+        bool prefer_chacha20 = !Crypto::cpu_features().aes_ni;
+        size_t preferred_count = 0;
+
         Vector<CipherSuite> cipher_suites;
 #define C(is_supported, suite, key_exchange, cipher, hash, iv_size, is_aead) \
-    if constexpr (is_supported)                                              \
-        cipher_suites.empend(suite);
+    if constexpr (is_supported) {                                            \
+        if (prefer_chacha20 && cipher == CipherAlgorithm::CHACHA20_POLY1305) \
+            cipher_suites.insert(preferred_count++, suite);                  \
+        else                                                                 \
+            cipher_suites.empend(suite);                                     \
+    }
         ENUMERATE_CIPHERS(C)
 #undef C
         return cipher_suites;
@@ -253,6 +270,7 @@ struct Options {
     OPTION_WITH_DEFAULTS(bool, use_compression, false)
     OPTION_WITH_DEFAULTS(bool, validate_certificates, true)
     OPTION_WITH_DEFAULTS(bool, allow_self_signed_certificates, false)
+    OPTION_WITH_DEFAULTS(bool, use_session_cache, true)
     OPTION_WITH_DEFAULTS(Optional<Vector<Certificate>>, root_certificates, )
     OPTION_WITH_DEFAULTS(Function<void(AlertDescription)>, alert_handler, [](auto) {})
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
@@ -285,8 +303,8 @@ struct Context {
         u8 local_mac[32];
         u8 local_iv[16];
         u8 remote_iv[16];
-        u8 local_aead_iv[4];
-        u8 remote_aead_iv[4];
+        u8 local_aead_iv[12];
+        u8 remote_aead_iv[12];
     } crypto;
 
     Crypto::Hash::Manager handshake_hash;
@@ -300,8 +318,12 @@ struct Context {
     Error error_code { Error::NoError };
 
     ByteBuffer tls_buffer;
+    // Where the ApplicationData record that write() is still filling up starts in tls_buffer, if there is one.
+    Optional<size_t> open_record_offset;
 
     ByteBuffer application_buffer;
+    // How much of application_buffer has been read already. The read part is only dropped once more data comes in.
+    size_t application_buffer_offset { 0 };
 
     bool is_child { false };
 
@@ -310,6 +332,9 @@ struct Context {
         String SNI; // I hate your existence
     } extensions;
 
+    // The port of the server, if connect() was told about it.
+    u16 port { 0 };
+
     u8 request_client_certificate { 0 };
 
     ByteBuffer cached_handshake;
@@ -321,9 +346,10 @@ struct Context {
     bool has_invoked_finish_or_error_callback { false };
 
     // message flags
-    u8 handshake_messages[11] { 0 };
+    u8 handshake_messages[12] { 0 };
     ByteBuffer user_data;
     HashMap<String, Certificate> root_certificates;
+    ByteBuffer root_certificates_digest;
 
     Vector<String> alpn;
     StringView negotiated_alpn;
@@ -339,6 +365,12 @@ struct Context {
     } server_diffie_hellman_params;
 
     OwnPtr<Crypto::Curves::EllipticCurve> server_key_exchange_curve;
+
+    // The cached session offered in the client hello, and whether the server agreed to resume it.
+    Optional<Session> offered_session;
+    bool is_resumed_session { false };
+    ByteBuffer session_ticket;
+    u32 session_ticket_lifetime_hint { 0 };
 };
 
 class TLSv12 final : public Core::Stream::Socket {
@@ -367,13 +399,13 @@ public:
     /// bytes written into the stream, or an errno in the case of failure.
     virtual ErrorOr<size_t> write(ReadonlyBytes) override;
 
-    virtual bool is_eof() const override { return m_context.application_buffer.is_empty() && (m_context.connection_finished || underlying_stream().is_eof()); }
+    virtual bool is_eof() const override { return pending_application_data().is_empty() && (m_context.connection_finished || underlying_stream().is_eof()); }
 
     virtual bool is_open() const override { return is_established(); }
     virtual void close() override;
 
-    virtual ErrorOr<size_t> pending_bytes() const override { return m_context.application_buffer.size(); }
-    virtual ErrorOr<bool> can_read_without_blocking(int = 0) const override { return !m_context.application_buffer.is_empty(); }
+    virtual ErrorOr<size_t> pending_bytes() const override { return pending_application_data().size(); }
+    virtual ErrorOr<bool> can_read_without_blocking(int = 0) const override { return !pending_application_data().is_empty(); }
     virtual ErrorOr<void> set_blocking(bool block) override
     {
         VERIFY(!block);
@@ -381,7 +413,7 @@ public:
     }
     virtual ErrorOr<void> set_close_on_exec(bool enabled) override { return underlying_stream().set_close_on_exec(enabled); }
 
-    virtual void set_notifications_enabled(bool enabled) override { underlying_stream().set_notifications_enabled(enabled); }
+    virtual void set_notifications_enabled(bool enabled) override;
 
     static ErrorOr<NonnullOwnPtr<TLSv12>> connect(String const& host, u16 port, Options = {});
     static ErrorOr<NonnullOwnPtr<TLSv12>> connect(String const& host, Core::Stream::Socket& underlying_stream, Options = {});
@@ -413,6 +445,8 @@ public:
     void add_alpn(StringView alpn);
     bool has_alpn(StringView alpn) const;
 
+    bool is_resumed_session() const { return m_context.is_resumed_session; }
+
     bool supports_cipher(CipherSuite suite) const
     {
         switch (suite) {
@@ -433,8 +467,12 @@ public:
 
     void alert(AlertLevel, AlertDescription);
 
-    bool can_read_line() const { return m_context.application_buffer.size() && memchr(m_context.application_buffer.data(), '\n', m_context.application_buffer.size()); }
-    bool can_read() const { return m_context.application_buffer.size() > 0; }
+    bool can_read_line() const
+    {
+        auto data = pending_application_data();
+        return !data.is_empty() && memchr(data.data(), '\n', data.size());
+    }
+    bool can_read() const { return !pending_application_data().is_empty(); }
     String read_line(size_t max_size);
 
     Function<void(AlertDescription)> on_tls_error;
@@ -444,16 +482,31 @@ public:
 
 private:
     void setup_connection();
+    void finish_handshake();
+    // Sessions are cached by host name and port, so they can't be used without SNI or when the port isn't known.
+    bool can_use_session_cache() const { return m_context.options.use_session_cache && m_context.options.use_sni && !m_context.extensions.SNI.is_null() && m_context.port; }
+    CertificateTrust certificate_trust() const;
+    void store_session();
 
-    void consume(ReadonlyBytes record);
+    static ErrorOr<Bytes> reserve_space(ByteBuffer&, size_t length);
+    void consume();
+
+    ReadonlyBytes pending_application_data() const { return m_context.application_buffer.bytes().slice(m_context.application_buffer_offset); }
+    ErrorOr<Bytes> reserve_application_data(size_t length);
+    void discard_application_data(size_t length);
 
     ByteBuffer hmac_message(ReadonlyBytes buf, Optional<ReadonlyBytes> const buf2, size_t mac_length, bool local = false);
     void ensure_hmac(size_t digest_size, bool local);
 
     void update_packet(ByteBuffer& packet);
     void update_hash(ReadonlyBytes in, size_t header_size);
+    void encrypt_record(ByteBuffer& buffer, size_t record_offset);
+
+    ErrorOr<size_t> append_to_open_record(ReadonlyBytes);
+    void seal_open_record();
 
     void write_packet(ByteBuffer& packet);
+    void schedule_or_perform_flush(bool immediate);
 
     ByteBuffer build_client_key_exchange();
     ByteBuffer build_server_key_exchange();
@@ -469,15 +522,17 @@ private:
     void build_dhe_rsa_pre_master_secret(PacketBuilder&);
     void build_ecdhe_rsa_pre_master_secret(PacketBuilder&);
 
-    ErrorOr<bool> flush();
+    ErrorOr<bool> flush(bool include_open_record = true);
     void write_into_socket();
     ErrorOr<void> read_from_socket();
 
+    void pause_or_resume_reading();
     bool check_connection_state(bool read);
     void notify_client_for_app_data();
 
     ssize_t handle_server_hello(ReadonlyBytes, WritePacketStage&);
     ssize_t handle_handshake_finished(ReadonlyBytes, WritePacketStage&);
+    ssize_t handle_new_session_ticket(ReadonlyBytes);
     ssize_t handle_certificate(ReadonlyBytes);
     ssize_t handle_server_key_exchange(ReadonlyBytes);
     ssize_t handle_dhe_rsa_server_key_exchange(ReadonlyBytes);
@@ -574,12 +629,15 @@ private:
     using CipherVariant = Variant<
         Empty,
         Crypto::Cipher::AESCipher::CBCMode,
-        Crypto::Cipher::AESCipher::GCMMode>;
+        Crypto::Cipher::AESCipher::GCMMode,
+        Crypto::Cipher::ChaCha20Poly1305>;
     CipherVariant m_cipher_local {};
     CipherVariant m_cipher_remote {};
 
     bool m_has_scheduled_write_flush { false };
     bool m_has_scheduled_app_data_flush { false };
+    bool m_client_wants_notifications { true };
+    bool m_is_reading_paused { false };
     i32 m_max_wait_time_for_handshake_in_seconds { 10 };
 
     RefPtr<Core::Timer> m_handshake_timeout_timer;
@@ -33,17 +33,17 @@ void Threading::Thread::start()
         nullptr,
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
+            // Name the thread from within, as a short-lived thread may already be gone by the time start() could do it.
+            if (!self->m_thread_name.is_empty()) {
+                [[maybe_unused]] auto rc = pthread_setname_np(pthread_self(), self->m_thread_name.characters());
+                VERIFY(rc == 0);
+            }
             auto exit_code = self->m_action();
-            self->m_tid = 0;
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
 
     VERIFY(rc == 0);
-    if (!m_thread_name.is_empty()) {
-        rc = pthread_setname_np(m_tid, m_thread_name.characters());
-        VERIFY(rc == 0);
-    }
     dbgln("Started thread \"{}\", tid = {}", m_thread_name, m_tid);
 }
 
@@ -65,16 +65,36 @@ Messages::SQLServer::SqlStatementResponse ConnectionFromClient::sql_statement(in
     }
 }
 
-void ConnectionFromClient::statement_execute(int statement_id)
+void ConnectionFromClient::statement_execute(int statement_id, u32 rows_per_page)
 {
-    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::statement_execute_query(statement_id: {})", statement_id);
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::statement_execute_query(statement_id: {}, rows_per_page: {})", statement_id, rows_per_page);
     auto statement = SQLStatement::statement_for(statement_id);
     if (statement && statement->connection()->client_id() == client_id()) {
-        statement->execute();
+        statement->execute(rows_per_page);
     } else {
         dbgln_if(SQLSERVER_DEBUG, "Statement has disappeared");
         async_execution_error(statement_id, (int)SQL::SQLErrorCode::StatementUnavailable, String::formatted("{}", statement_id));
     }
 }
 
+void ConnectionFromClient::result_page_processed(int statement_id, u32 execution_id)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::result_page_processed(statement_id: {}, execution_id: {})", statement_id, execution_id);
+    auto statement = SQLStatement::statement_for(statement_id);
+    if (statement && statement->connection()->client_id() == client_id())
+        statement->result_page_processed(execution_id);
+}
+
+Messages::SQLServer::PageCacheStatisticsResponse ConnectionFromClient::page_cache_statistics(int connection_id)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::page_cache_statistics(connection_id: {})", connection_id);
+    auto database_connection = DatabaseConnection::connection_for(connection_id);
+    if (!database_connection || !database_connection->database()) {
+        dbgln("Database connection has disappeared");
+        return { 0, 0, 0, 0, 0, 0 };
+    }
+    auto statistics = database_connection->database()->page_cache_statistics();
+    return { statistics.hits, statistics.misses, statistics.write_ahead_log_reads, statistics.evictions, statistics.cached_pages, statistics.capacity };
+}
+
 }
@@ -29,8 +29,10 @@ private:
 
     virtual Messages::SQLServer::ConnectResponse connect(String const&) override;
     virtual Messages::SQLServer::SqlStatementResponse sql_statement(int, String const&) override;
-    virtual void statement_execute(int) override;
+    virtual void statement_execute(int, u32) override;
+    virtual void result_page_processed(int, u32) override;
     virtual void disconnect(int) override;
+    virtual Messages::SQLServer::PageCacheStatisticsResponse page_cache_statistics(int) override;
 };
 
 }
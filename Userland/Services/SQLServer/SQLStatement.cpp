@@ -4,8 +4,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/TypeCasts.h>
 #include <LibCore/Object.h>
+#include <LibSQL/AST/Operator.h>
 #include <LibSQL/AST/Parser.h>
+#include <LibSQL/RowPage.h>
 #include <SQLServer/ConnectionFromClient.h>
 #include <SQLServer/DatabaseConnection.h>
 #include <SQLServer/SQLStatement.h>
@@ -47,19 +50,31 @@ void SQLStatement::report_error(SQL::Result result)
     else
         warnln("Cannot return execution error. Client disconnected");
 
+    m_cursor = nullptr;
+    m_next_row = {};
     m_statement = nullptr;
     m_result = {};
 }
 
-void SQLStatement::execute()
+void SQLStatement::execute(u32 rows_per_page)
 {
-    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::execute(statement_id {}", statement_id());
+    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::execute(statement_id {}, rows_per_page {})", statement_id(), rows_per_page);
     auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
     if (!client_connection) {
         warnln("Cannot yield next result. Client disconnected");
         return;
     }
 
+    // Pages and their acknowledgements carry the execution they belong to, so
+    // that the client can't hold up this execution by acknowledging pages of
+    // an earlier one late.
+    m_execution_id++;
+    m_rows_per_page = clamp(rows_per_page, 1u, max_rows_per_page);
+    m_pages_in_flight = 0;
+    // A page of the earlier execution may still be scheduled, and must not be sent.
+    m_cursor = nullptr;
+    m_next_row = {};
+
     deferred_invoke([this]() mutable {
         auto parse_result = parse();
         if (parse_result.is_error()) {
@@ -69,10 +84,22 @@ void SQLStatement::execute()
 
         VERIFY(!connection()->database().is_null());
 
-        auto execution_result = m_statement->execute(connection()->database().release_nonnull());
-        if (execution_result.is_error()) {
-            report_error(execution_result.release_error());
-            return;
+        // The rows of a SELECT are produced while they are sent, so the client
+        // gets the first one without waiting for the whole result.
+        if (is<SQL::AST::Select>(*m_statement)) {
+            auto cursor = verify_cast<SQL::AST::Select>(*m_statement).cursor(connection()->database().release_nonnull());
+            if (cursor.is_error()) {
+                report_error(cursor.release_error());
+                return;
+            }
+            m_cursor = cursor.release_value();
+        } else {
+            auto execution_result = m_statement->execute(connection()->database().release_nonnull());
+            if (execution_result.is_error()) {
+                report_error(execution_result.release_error());
+                return;
+            }
+            m_result = execution_result.release_value();
         }
 
         auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
@@ -81,15 +108,25 @@ void SQLStatement::execute()
             return;
         }
 
-        m_result = execution_result.release_value();
-
-        if (should_send_result_rows()) {
-            client_connection->async_execution_success(statement_id(), true, 0, 0, 0);
-            m_index = 0;
-            next();
-        } else {
+        if (!should_send_result_rows()) {
             client_connection->async_execution_success(statement_id(), false, 0, m_result->size(), 0);
+            return;
+        }
+
+        m_index = 0;
+        auto first_row = next_row();
+        if (first_row.is_error()) {
+            report_error(first_row.release_error());
+            return;
         }
+        m_next_row = first_row.release_value();
+        if (!m_next_row.has_value()) {
+            client_connection->async_execution_success(statement_id(), false, 0, 0, 0);
+            return;
+        }
+
+        client_connection->async_execution_success(statement_id(), true, 0, 0, 0);
+        send_next_page();
     });
 }
 
@@ -105,6 +142,9 @@ SQL::ResultOr<void> SQLStatement::parse()
 
 bool SQLStatement::should_send_result_rows() const
 {
+    if (m_cursor)
+        return true;
+
     VERIFY(m_result.has_value());
 
     if (m_result->is_empty())
@@ -112,6 +152,7 @@ bool SQLStatement::should_send_result_rows() const
 
     switch (m_result->command()) {
     case SQL::SQLCommand::Describe:
+    case SQL::SQLCommand::Explain:
     case SQL::SQLCommand::Select:
         return true;
     default:
@@ -119,23 +160,72 @@ bool SQLStatement::should_send_result_rows() const
     }
 }
 
-void SQLStatement::next()
+SQL::ResultOr<Optional<SQL::Tuple>> SQLStatement::next_row()
+{
+    if (m_cursor)
+        return m_cursor->next();
+    if (m_index < m_result->size())
+        return m_result->at(m_index).row;
+    return Optional<SQL::Tuple> {};
+}
+
+void SQLStatement::send_next_page()
 {
-    VERIFY(!m_result->is_empty());
+    if (!m_next_row.has_value())
+        return;
     auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
     if (!client_connection) {
         warnln("Cannot yield next result. Client disconnected");
         return;
     }
-    if (m_index < m_result->size()) {
-        auto& tuple = m_result->at(m_index++).row;
-        client_connection->async_next_result(statement_id(), tuple.to_string_vector());
-        deferred_invoke([this]() {
-            next();
-        });
+
+    SQL::RowPageWriter page;
+    while (m_next_row.has_value() && (page.row_count() < m_rows_per_page)) {
+        page.append(m_next_row.value());
+        m_index++;
+
+        auto next_row = this->next_row();
+        if (next_row.is_error()) {
+            report_error(next_row.release_error());
+            return;
+        }
+        m_next_row = next_row.release_value();
+    }
+
+    client_connection->async_next_result_page(statement_id(), m_execution_id, page.finish());
+    m_pages_in_flight++;
+
+    if (m_next_row.has_value()) {
+        schedule_next_page();
     } else {
+        m_cursor = nullptr;
         client_connection->async_results_exhausted(statement_id(), (int)m_index);
     }
 }
 
+// Pages are sent one per pass through the event loop, and only while the
+// client hasn't fallen more than max_pages_in_flight pages behind. The client
+// acknowledges every page it has processed.
+void SQLStatement::schedule_next_page()
+{
+    if (m_is_page_scheduled || (m_pages_in_flight >= max_pages_in_flight))
+        return;
+    m_is_page_scheduled = true;
+    deferred_invoke([this]() {
+        m_is_page_scheduled = false;
+        send_next_page();
+    });
+}
+
+void SQLStatement::result_page_processed(u32 execution_id)
+{
+    if (execution_id != m_execution_id) {
+        dbgln_if(SQLSERVER_DEBUG, "Ignoring a page of execution {} of statement_id {}", execution_id, statement_id());
+        return;
+    }
+    if (m_pages_in_flight > 0)
+        m_pages_in_flight--;
+    if (m_next_row.has_value())
+        schedule_next_page();
+}
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/NonnullRefPtr.h>
+#include <AK/OwnPtr.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
 #include <LibSQL/AST/AST.h>
@@ -27,20 +28,34 @@ public:
     int statement_id() const { return m_statement_id; }
     String const& sql() const { return m_sql; }
     DatabaseConnection* connection() { return dynamic_cast<DatabaseConnection*>(parent()); }
-    void execute();
+    void execute(u32 rows_per_page);
+    void result_page_processed(u32 execution_id);
+
+    // The number of result pages that are sent ahead of the client.
+    static constexpr size_t max_pages_in_flight = 4;
+    // Clients ask for a number of rows per page, but pages are never larger than this.
+    static constexpr u32 max_rows_per_page = 4096;
 
 private:
     SQLStatement(DatabaseConnection&, String sql);
     SQL::ResultOr<void> parse();
     bool should_send_result_rows() const;
-    void next();
+    SQL::ResultOr<Optional<SQL::Tuple>> next_row();
+    void send_next_page();
+    void schedule_next_page();
     void report_error(SQL::Result);
 
     int m_statement_id;
     String m_sql;
     size_t m_index { 0 };
+    u32 m_execution_id { 0 };
+    u32 m_rows_per_page { 1 };
+    size_t m_pages_in_flight { 0 };
+    bool m_is_page_scheduled { false };
     RefPtr<SQL::AST::Statement> m_statement { nullptr };
     Optional<SQL::ResultSet> m_result {};
+    OwnPtr<SQL::AST::Cursor> m_cursor { nullptr };
+    Optional<SQL::Tuple> m_next_row {};
 };
 
 }
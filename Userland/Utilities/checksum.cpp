@@ -4,17 +4,134 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/LexicalPath.h>
+#include <AK/Optional.h>
+#include <AK/ScopeGuard.h>
 #include <LibCore/ArgsParser.h>
-#include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibMain/Main.h>
+#include <LibThreading/Thread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+// Files that can't be mapped, like pipes, are read this much at a time. Smaller files are read as well, since
+// mapping and unmapping them costs more than reading them in one go.
+static constexpr size_t read_buffer_size = 64 * KiB;
+
+// Mapped files are hashed a window at a time, while the kernel is asked to read in the next window.
+static constexpr size_t read_ahead_window_size = 8 * MiB;
+
+// SHA-1 and SHA-256 can hash several messages side by side, so small files are read whole and hashed this many at
+// a time.
+static constexpr size_t small_file_batch_size = 8;
+
+// NOTE: This may run on several threads at once, so it must not use Core::File, which is a Core::Object.
+static ErrorOr<Crypto::Hash::Manager::DigestType> hash_file(Crypto::Hash::HashKind hash_kind, StringView path)
+{
+    Crypto::Hash::Manager hash { hash_kind };
+
+    int fd = STDIN_FILENO;
+    if (path != "-"sv)
+        fd = TRY(Core::System::open(path, O_RDONLY | O_CLOEXEC));
+    ArmedScopeGuard fd_close_guard = [fd] {
+        if (fd != STDIN_FILENO)
+            (void)Core::System::close(fd);
+    };
+
+    auto stat = TRY(Core::System::fstat(fd));
+    if (S_ISREG(stat.st_mode) && static_cast<size_t>(stat.st_size) > read_buffer_size) {
+        fd_close_guard.disarm();
+        auto mapped_file = TRY(Core::MappedFile::map_from_fd_and_close(fd, path));
+        auto bytes = mapped_file->bytes();
+        for (size_t offset = 0; offset < bytes.size(); offset += read_ahead_window_size) {
+            auto window_size = min(read_ahead_window_size, bytes.size() - offset);
+            if (auto next_offset = offset + window_size; next_offset < bytes.size())
+                (void)madvise(const_cast<u8*>(bytes.offset_pointer(next_offset)), min(read_ahead_window_size, bytes.size() - next_offset), MADV_WILLNEED);
+            hash.update(bytes.slice(offset, window_size));
+        }
+        return hash.digest();
+    }
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(read_buffer_size));
+    for (;;) {
+        auto nread = TRY(Core::System::read(fd, buffer));
+        if (nread == 0)
+            break;
+        hash.update(buffer.span().trim(nread));
+    }
+    return hash.digest();
+}
+
+// Returns the contents of a regular file that is small enough to be read in one go, or nothing for any other file.
+static ErrorOr<Optional<ByteBuffer>> read_small_file(StringView path)
+{
+    if (path == "-"sv)
+        return Optional<ByteBuffer> {};
+
+    int fd = TRY(Core::System::open(path, O_RDONLY | O_CLOEXEC));
+    ScopeGuard fd_close_guard = [fd] { (void)Core::System::close(fd); };
+
+    auto stat = TRY(Core::System::fstat(fd));
+    if (!S_ISREG(stat.st_mode) || static_cast<size_t>(stat.st_size) > read_buffer_size)
+        return Optional<ByteBuffer> {};
+
+    // Read one byte more than the file should have, to notice if it has grown since.
+    auto buffer = TRY(ByteBuffer::create_uninitialized(stat.st_size + 1));
+    size_t size = 0;
+    for (;;) {
+        auto nread = TRY(Core::System::read(fd, buffer.bytes().slice(size)));
+        if (nread == 0)
+            break;
+        size += nread;
+        if (size == buffer.size())
+            return Optional<ByteBuffer> {};
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+// Hashes the small files with hash_many() and the others with hash_file(), and returns the digests in order.
+template<typename Hash>
+static Vector<ErrorOr<Crypto::Hash::Manager::DigestType>> hash_files_side_by_side(Crypto::Hash::HashKind hash_kind, Span<StringView const> paths)
+{
+    Vector<Optional<ErrorOr<Crypto::Hash::Manager::DigestType>>> digests;
+    digests.resize(paths.size());
+    Vector<ByteBuffer> small_files;
+    Vector<size_t> small_file_indices;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        auto small_file = read_small_file(paths[i]);
+        if (small_file.is_error())
+            digests[i] = ErrorOr<Crypto::Hash::Manager::DigestType> { small_file.release_error() };
+        else if (!small_file.value().has_value())
+            digests[i] = hash_file(hash_kind, paths[i]);
+        else {
+            small_files.append(small_file.release_value().release_value());
+            small_file_indices.append(i);
+        }
+    }
+
+    Vector<ReadonlyBytes> messages;
+    for (auto& small_file : small_files)
+        messages.append(small_file);
+    Vector<typename Hash::DigestType> small_file_digests;
+    small_file_digests.resize(messages.size());
+    Hash::hash_many(messages, small_file_digests);
+    for (size_t i = 0; i < small_file_indices.size(); ++i)
+        digests[small_file_indices[i]] = ErrorOr<Crypto::Hash::Manager::DigestType> { small_file_digests[i] };
+
+    Vector<ErrorOr<Crypto::Hash::Manager::DigestType>> results;
+    for (auto& digest : digests)
+        results.append(digest.release_value());
+    return results;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath"));
+    TRY(Core::System::pledge("stdio rpath thread"));
 
     auto program_name = LexicalPath::basename(arguments.strings[0]);
     auto hash_kind = Crypto::Hash::HashKind::None;
@@ -37,34 +154,77 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     auto paths_help_string = String::formatted("File(s) to print {} checksum of", hash_name);
 
     Vector<StringView> paths;
+    unsigned job_count { 1 };
 
     Core::ArgsParser args_parser;
+    args_parser.add_option(job_count, "Hash this many files at once", "jobs", 'j', "count");
     args_parser.add_positional_argument(paths, paths_help_string.characters(), "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
     if (paths.is_empty())
         paths.append("-");
 
-    Crypto::Hash::Manager hash;
-    hash.initialize(hash_kind);
+    auto thread_count = min<size_t>(job_count, paths.size());
+    if (thread_count <= 1)
+        TRY(Core::System::pledge("stdio rpath"));
 
     auto has_error = false;
+    auto print_result = [&](StringView path, ErrorOr<Crypto::Hash::Manager::DigestType> const& digest) {
+        if (digest.is_error()) {
+            warnln("{}: {}: {}", program_name, path, digest.error());
+            has_error = true;
+            return;
+        }
+        outln("{:hex-dump}  {}", digest.value().bytes(), path);
+    };
+
+    if (thread_count <= 1 && (hash_kind == Crypto::Hash::HashKind::SHA1 || hash_kind == Crypto::Hash::HashKind::SHA256)) {
+        for (size_t first = 0; first < paths.size(); first += small_file_batch_size) {
+            auto batch = paths.span().slice(first, min(small_file_batch_size, paths.size() - first));
+            auto digests = hash_kind == Crypto::Hash::HashKind::SHA1
+                ? hash_files_side_by_side<Crypto::Hash::SHA1>(hash_kind, batch)
+                : hash_files_side_by_side<Crypto::Hash::SHA256>(hash_kind, batch);
+            for (size_t i = 0; i < batch.size(); ++i)
+                print_result(batch[i], digests[i]);
+        }
+        return has_error ? 1 : 0;
+    }
 
-    for (auto const& path : paths) {
-        NonnullRefPtr<Core::File> file = Core::File::standard_input();
-        if (path != "-"sv) {
-            auto file_or_error = Core::File::open(path, Core::OpenMode::ReadOnly);
-            if (file_or_error.is_error()) {
-                warnln("{}: {}: {}", program_name, path, file->error_string());
-                has_error = true;
-                continue;
-            }
-            file = file_or_error.release_value();
+    if (thread_count <= 1) {
+        for (auto const& path : paths)
+            print_result(path, hash_file(hash_kind, path));
+        return has_error ? 1 : 0;
+    }
+
+    // Files are handed out to the workers one at a time, and printed in order once all of them have been hashed.
+    Vector<Optional<ErrorOr<Crypto::Hash::Manager::DigestType>>> digests;
+    digests.resize(paths.size());
+    Atomic<size_t> next_path_index { 0 };
+    auto hash_files = [&] {
+        for (;;) {
+            auto index = next_path_index.fetch_add(1);
+            if (index >= paths.size())
+                return;
+            digests[index] = hash_file(hash_kind, paths[index]);
         }
+    };
 
-        while (!file->eof() && !file->has_error())
-            hash.update(file->read(PAGE_SIZE));
-        outln("{:hex-dump}  {}", hash.digest().bytes(), path);
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto worker = Threading::Thread::construct([&] {
+            hash_files();
+            return 0;
+        },
+            "Checksum worker"sv);
+        worker->start();
+        workers.append(move(worker));
     }
+    hash_files();
+
+    for (auto& worker : workers)
+        (void)worker->join();
+
+    for (size_t i = 0; i < paths.size(); ++i)
+        print_result(paths[i], *digests[i]);
     return has_error ? 1 : 0;
 }
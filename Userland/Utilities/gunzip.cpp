@@ -5,24 +5,34 @@
  */
 
 #include <LibCompress/Gzip.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/FileStream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <unistd.h>
 
-static bool decompress_file(Buffered<Core::InputFileStream>& input_stream, Buffered<Core::OutputFileStream>& output_stream)
+static bool decompress_stream(InputStream& decompressor, Buffered<Core::OutputFileStream>& output_stream)
 {
-    auto gzip_stream = Compress::GzipDecompressor { input_stream };
-
     u8 buffer[4096];
 
-    while (!gzip_stream.has_any_error() && !gzip_stream.unreliable_eof()) {
-        auto const nread = gzip_stream.read({ buffer, sizeof(buffer) });
+    while (!decompressor.has_any_error() && !decompressor.unreliable_eof()) {
+        auto const nread = decompressor.read({ buffer, sizeof(buffer) });
         output_stream.write_or_error({ buffer, nread });
     }
 
-    return !gzip_stream.handle_any_error();
+    return !decompressor.handle_any_error();
+}
+
+static bool decompress_file(Buffered<Core::InputFileStream>& input_stream, Buffered<Core::OutputFileStream>& output_stream, bool zstd)
+{
+    if (zstd) {
+        auto zstd_stream = Compress::ZstdDecompressor { input_stream };
+        return decompress_stream(zstd_stream, output_stream);
+    }
+
+    auto gzip_stream = Compress::GzipDecompressor { input_stream };
+    return decompress_stream(gzip_stream, output_stream);
 }
 
 ErrorOr<int> serenity_main(Main::Arguments args)
@@ -44,7 +54,12 @@ ErrorOr<int> serenity_main(Main::Arguments args)
 
         String input_filename;
         String output_filename;
-        if (filename.ends_with(".gz")) {
+        bool zstd = false;
+        if (filename.ends_with(".zst")) {
+            input_filename = filename;
+            output_filename = filename.substring_view(0, filename.length() - 4);
+            zstd = true;
+        } else if (filename.ends_with(".gz")) {
             input_filename = filename;
             output_filename = filename.substring_view(0, filename.length() - 3);
         } else {
@@ -57,14 +72,14 @@ ErrorOr<int> serenity_main(Main::Arguments args)
         auto success = false;
         if (write_to_stdout) {
             auto stdout = Core::OutputFileStream::stdout_buffered();
-            success = decompress_file(input_stream_result, stdout);
+            success = decompress_file(input_stream_result, stdout, zstd);
         } else {
             auto output_stream_result = TRY(Core::OutputFileStream::open_buffered(output_filename));
 
-            success = decompress_file(input_stream_result, output_stream_result);
+            success = decompress_file(input_stream_result, output_stream_result, zstd);
         }
         if (!success) {
-            warnln("Failed gzip decompressing input file");
+            warnln("Failed {} decompressing input file", zstd ? "zstd" : "gzip");
             return 1;
         }
 
@@ -9,6 +9,7 @@
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
 #include <LibCore/StandardPaths.h>
 #include <LibLine/Editor.h>
@@ -92,14 +93,23 @@ public:
             }
         };
 
-        m_sql_client->on_next_result = [](int, Vector<String> const& row) {
+        m_sql_client->on_next_result = [](int, Vector<SQL::Value> const& row) {
             StringBuilder builder;
-            builder.join(", ", row);
+            for (auto& value : row) {
+                if (!builder.is_empty())
+                    builder.append(", ");
+                builder.append(value.to_string());
+            }
             outln("{}", builder.build());
         };
 
         m_sql_client->on_results_exhausted = [this](int, int total_rows) {
-            outln("{} row(s)", total_rows);
+            if (m_show_timing) {
+                auto elapsed_ms = max(m_statement_timer.elapsed(), 1);
+                outln("{} row(s) in {} ms, {} row(s)/s", total_rows, elapsed_ms, (i64)total_rows * 1000 / elapsed_ms);
+            } else {
+                outln("{} row(s)", total_rows);
+            }
             read_sql();
         };
 
@@ -155,6 +165,11 @@ public:
         m_quit_when_files_read = true;
     }
 
+    void set_rows_per_page(u32 rows_per_page)
+    {
+        m_sql_client->set_rows_per_page(rows_per_page);
+    }
+
     auto run()
     {
         return m_loop.exec();
@@ -169,6 +184,8 @@ private:
     String m_current_database {};
     AK::RefPtr<SQL::SQLClient> m_sql_client { nullptr };
     int m_connection_id { 0 };
+    bool m_show_timing { false };
+    Core::ElapsedTimer m_statement_timer;
     Core::EventLoop m_loop;
     RefPtr<Core::File> m_input_file { nullptr };
     bool m_quit_when_files_read { false };
@@ -279,7 +296,8 @@ private:
                 });
         } else {
             auto statement_id = m_sql_client->sql_statement(m_connection_id, piece);
-            m_sql_client->async_statement_execute(statement_id);
+            m_statement_timer.start();
+            m_sql_client->execute_statement(statement_id);
         }
 
         // ...But m_keep_running can also be set to false by a command handler.
@@ -315,6 +333,14 @@ private:
             } else {
                 outln("\033[33;1mUsage: .connect <database name>\033[0m");
             }
+        } else if (command == ".stats") {
+            auto statistics = m_sql_client->page_cache_statistics(m_connection_id);
+            outln("Page cache: {} hit(s), {} miss(es), {} eviction(s), {} of {} block(s) cached",
+                statistics.hits(), statistics.misses(), statistics.evictions(), statistics.cached_pages(), statistics.capacity());
+            outln("Write-ahead log: {} read(s)", statistics.write_ahead_log_reads());
+        } else if (command == ".timing") {
+            m_show_timing = !m_show_timing;
+            outln("Timing is {}", m_show_timing ? "on" : "off");
         } else if (command.starts_with(".read ")) {
             if (!m_input_file) {
                 auto parts = command.split_view(' ');
@@ -339,6 +365,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     String file_to_source;
     String file_to_read;
     bool suppress_sqlrc = false;
+    u32 rows_per_page = SQL::SQLClient::default_rows_per_page;
     auto sqlrc_path = String::formatted("{}/.sqlrc", Core::StandardPaths::home_directory());
 
     Core::ArgsParser args_parser;
@@ -347,9 +374,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(file_to_read, "File to read", "read", 'r', "file");
     args_parser.add_option(file_to_source, "File to source", "source", 's', "file");
     args_parser.add_option(suppress_sqlrc, "Don't read ~/.sqlrc", "no-sqlrc", 'n');
+    args_parser.add_option(rows_per_page, "Number of result rows the server sends at a time", "rows-per-page", 'p', "rows");
     args_parser.parse(arguments);
 
     SQLRepl repl(database_name);
+    repl.set_rows_per_page(rows_per_page);
 
     if (!suppress_sqlrc && Core::File::exists(sqlrc_path))
         repl.source_file(sqlrc_path);
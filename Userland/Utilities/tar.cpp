@@ -11,10 +11,12 @@
 #include <AK/Vector.h>
 #include <LibArchive/TarStream.h>
 #include <LibCompress/Gzip.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibCore/FileStream.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <fcntl.h>
@@ -22,7 +24,65 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
-constexpr size_t buffer_size = 4096;
+constexpr size_t buffer_size = 64 * KiB;
+
+// An index lists the members of an archive, so that listing a large archive again doesn't have to read it at all.
+// The first line identifies the archive by its size and modification time, then there is one line per member.
+constexpr StringView index_signature = "tar-index 1"sv;
+
+static String index_identity(struct stat const& archive_stat)
+{
+    return String::formatted("{} {} {}", index_signature, archive_stat.st_size, archive_stat.st_mtime);
+}
+
+// Prints the members listed in the index, or returns false if there is no index for this version of the archive.
+static bool list_from_index(StringView index_path, struct stat const& archive_stat)
+{
+    auto index_file_or_error = Core::File::open(index_path, Core::OpenMode::ReadOnly);
+    if (index_file_or_error.is_error())
+        return false;
+
+    auto index_contents = index_file_or_error.value()->read_all();
+    auto lines = StringView { index_contents }.lines();
+    if (lines.is_empty() || lines[0] != index_identity(archive_stat))
+        return false;
+
+    for (size_t i = 1; i < lines.size(); ++i) {
+        // Every member is listed as "<header offset> <size> <path>".
+        auto offset_end = lines[i].find(' ');
+        if (!offset_end.has_value())
+            return false;
+        auto size_end = lines[i].find(' ', *offset_end + 1);
+        if (!size_end.has_value())
+            return false;
+        outln("{}", lines[i].substring_view(*size_end + 1));
+    }
+    return true;
+}
+
+static ErrorOr<void> write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty())
+        bytes = bytes.slice(TRY(Core::System::write(fd, bytes)));
+    return {};
+}
+
+// Writes every data region where it belongs, leaving holes in between and after the last one.
+static ErrorOr<void> write_sparse_file(int fd, Archive::TarFileStream& file_stream, Archive::TarSparseMap const& map, Bytes buffer)
+{
+    for (auto const& region : map.regions) {
+        TRY(Core::System::lseek(fd, region.offset, SEEK_SET));
+        for (u64 remaining = region.size; remaining > 0;) {
+            auto bytes_read = file_stream.read(buffer.trim(min<u64>(remaining, buffer.size())));
+            if (bytes_read == 0)
+                return Error::from_string_literal("Sparse file data ends early");
+            TRY(write_all(fd, buffer.trim(bytes_read)));
+            remaining -= bytes_read;
+        }
+    }
+    TRY(Core::System::ftruncate(fd, map.real_size));
+    return {};
+}
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -31,9 +91,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool list = false;
     bool verbose = false;
     bool gzip = false;
+    bool zstd = false;
     bool no_auto_compress = false;
     StringView archive_file;
     char const* directory = nullptr;
+    StringView index_file;
     Vector<String> paths;
 
     Core::ArgsParser args_parser;
@@ -42,9 +104,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(list, "List contents", "list", 't');
     args_parser.add_option(verbose, "Print paths", "verbose", 'v');
     args_parser.add_option(gzip, "Compress or decompress file using gzip", "gzip", 'z');
+    args_parser.add_option(zstd, "Decompress file using zstd", "zstd", 0);
     args_parser.add_option(no_auto_compress, "Do not use the archive suffix to select the compression algorithm", "no-auto-compress", 0);
     args_parser.add_option(directory, "Directory to extract to/create from", "directory", 'C', "DIRECTORY");
     args_parser.add_option(archive_file, "Archive file", "file", 'f', "FILE");
+    args_parser.add_option(index_file, "List from this index of the archive, creating it if needed", "index", 0, "INDEX");
     args_parser.add_positional_argument(paths, "Paths", "PATHS", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -56,6 +120,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (!no_auto_compress && !archive_file.is_empty()) {
         if (archive_file.ends_with(".gz"sv) || archive_file.ends_with(".tgz"sv))
             gzip = true;
+        else if (archive_file.ends_with(".zst"sv) || archive_file.ends_with(".tzst"sv))
+            zstd = true;
+    }
+
+    if (gzip && zstd) {
+        warnln("only one of -z and --zstd can be used");
+        return 1;
+    }
+
+    if (!index_file.is_empty() && (!list || archive_file.is_empty())) {
+        warnln("--index can only be used with -t and -f");
+        return 1;
     }
 
     if (list || extract) {
@@ -64,15 +140,27 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (!archive_file.is_empty())
             file = TRY(Core::File::open(archive_file, Core::OpenMode::ReadOnly));
 
+        Optional<struct stat> archive_stat;
+        StringBuilder index_builder;
+        if (!index_file.is_empty()) {
+            archive_stat = TRY(Core::System::fstat(file->fd()));
+            if (list_from_index(index_file, *archive_stat))
+                return 0;
+            index_builder.append(index_identity(*archive_stat));
+            index_builder.append('\n');
+        }
+
         if (directory)
             TRY(Core::System::chdir(directory));
 
         Core::InputFileStream file_stream(file);
         Compress::GzipDecompressor gzip_stream(file_stream);
+        Compress::ZstdDecompressor zstd_stream(file_stream);
 
         InputStream& file_input_stream = file_stream;
         InputStream& gzip_input_stream = gzip_stream;
-        Archive::TarInputStream tar_stream((gzip) ? gzip_input_stream : file_input_stream);
+        InputStream& zstd_input_stream = zstd_stream;
+        Archive::TarInputStream tar_stream((gzip) ? gzip_input_stream : (zstd) ? zstd_input_stream : file_input_stream);
         // FIXME: implement ErrorOr<TarInputStream>?
         if (!tar_stream.valid()) {
             warnln("the provided file is not a well-formatted ustar file");
@@ -81,6 +169,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         HashMap<String, String> global_overrides;
         HashMap<String, String> local_overrides;
+        Archive::TarPaxSparseHeader pax_sparse_header;
 
         auto get_override = [&](StringView key) -> Optional<String> {
             Optional<String> maybe_local = local_overrides.get(key);
@@ -114,6 +203,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
                 case Archive::TarFileType::ExtendedHeader: {
                     TRY(tar_stream.for_each_extended_header([&](StringView key, StringView value) {
                         local_overrides.set(key, value);
+                        pax_sparse_header.add(key, value);
                     }));
                     break;
                 }
@@ -128,11 +218,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             LexicalPath path = LexicalPath(header.filename());
             if (!header.prefix().is_empty())
                 path = path.prepend(header.prefix());
-            String filename = get_override("path"sv).value_or(path.string());
+            String filename = pax_sparse_header.name().value_or(get_override("path"sv).value_or(path.string()));
 
             if (list || verbose)
                 outln("{}", filename);
 
+            if (archive_stat.has_value())
+                index_builder.appendff("{} {} {}\n", tar_stream.header_offset(), header.size(), filename);
+
             if (extract) {
                 Archive::TarFileStream file_stream = tar_stream.file_contents();
 
@@ -141,15 +234,22 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
                 switch (header.type_flag()) {
                 case Archive::TarFileType::NormalFile:
-                case Archive::TarFileType::AlternateNormalFile: {
+                case Archive::TarFileType::AlternateNormalFile:
+                case Archive::TarFileType::GNUSparseFile: {
                     MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
 
                     int fd = TRY(Core::System::open(absolute_path, O_CREAT | O_WRONLY, header.mode()));
 
-                    Array<u8, buffer_size> buffer;
-                    size_t bytes_read;
-                    while ((bytes_read = file_stream.read(buffer)) > 0)
-                        TRY(Core::System::write(fd, buffer.span().slice(0, bytes_read)));
+                    auto buffer = TRY(ByteBuffer::create_uninitialized(buffer_size));
+                    if (tar_stream.gnu_sparse_map().has_value()) {
+                        TRY(write_sparse_file(fd, file_stream, *tar_stream.gnu_sparse_map(), buffer));
+                    } else if (pax_sparse_header.is_sparse()) {
+                        TRY(write_sparse_file(fd, file_stream, TRY(pax_sparse_header.read_map(file_stream)), buffer));
+                    } else {
+                        size_t bytes_read;
+                        while ((bytes_read = file_stream.read(buffer)) > 0)
+                            TRY(write_all(fd, buffer.span().slice(0, bytes_read)));
+                    }
 
                     TRY(Core::System::close(fd));
                     break;
@@ -177,9 +277,16 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
             // Non-global headers should be cleared after every file.
             local_overrides.clear();
+            pax_sparse_header = {};
         }
         file_stream.close();
 
+        if (archive_stat.has_value()) {
+            auto index = TRY(Core::File::open(index_file, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate));
+            if (!index->write(index_builder.string_view()))
+                warnln("Failed to write index {}: {}", index_file, index->error_string());
+        }
+
         return 0;
     }
 
@@ -189,6 +296,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return 1;
         }
 
+        if (zstd) {
+            warnln("creating zstd compressed archives is not supported");
+            return 1;
+        }
+
         auto file = Core::File::standard_output();
 
         if (!archive_file.is_empty())
@@ -217,7 +329,13 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
             auto statbuf = statbuf_or_error.value();
             auto canonicalized_path = LexicalPath::canonicalized_path(path);
-            tar_stream.add_file(canonicalized_path, statbuf.st_mode, file->read_all());
+            // Map the file instead of reading it into memory, as it may be large. Empty files can't be mapped.
+            if (statbuf.st_size == 0) {
+                tar_stream.add_file(canonicalized_path, statbuf.st_mode, {});
+            } else {
+                auto mapped_file = TRY(Core::MappedFile::map_from_fd_and_close(file->leak_fd(), path));
+                tar_stream.add_file(canonicalized_path, statbuf.st_mode, mapped_file->bytes());
+            }
             if (verbose)
                 outln("{}", canonicalized_path);
 
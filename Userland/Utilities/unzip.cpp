@@ -4,19 +4,22 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/NumberFormat.h>
 #include <AK/StringUtils.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/Directory.h>
-#include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
+#include <LibCore/Stream.h>
 #include <LibCore/System.h>
+#include <LibThreading/Thread.h>
 #include <sys/stat.h>
 
-static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
+static bool unpack_zip_member(Archive::ZipMember const& zip_member, bool quiet)
 {
     if (zip_member.is_directory) {
         if (mkdir(zip_member.name.characters(), 0755) < 0) {
@@ -28,11 +31,13 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
         return true;
     }
     MUST(Core::Directory::create(LexicalPath(zip_member.name).parent(), Core::Directory::CreateDirectories::Yes));
-    auto new_file = Core::File::construct(zip_member.name);
-    if (!new_file->open(Core::OpenMode::WriteOnly)) {
-        warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
+    // NOTE: Members may be extracted on several threads, so this can't use Core::File, which is a Core::Object.
+    auto maybe_new_file = Core::Stream::File::open(zip_member.name, Core::Stream::OpenMode::Write);
+    if (maybe_new_file.is_error()) {
+        warnln("Can't write file {}: {}", zip_member.name, maybe_new_file.error());
         return false;
     }
+    auto new_file = maybe_new_file.release_value();
 
     if (!quiet)
         outln(" extracting: {}", zip_member.name);
@@ -40,8 +45,8 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
     // TODO: verify CRC32s match!
     switch (zip_member.compression_method) {
     case Archive::ZipCompressionMethod::Store: {
-        if (!new_file->write(zip_member.compressed_data.data(), zip_member.compressed_data.size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!new_file->write_or_error(zip_member.compressed_data)) {
+            warnln("Can't write file contents in {}", zip_member.name);
             return false;
         }
         break;
@@ -56,8 +61,8 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
             warnln("Failed decompressing file {}", zip_member.name);
             return false;
         }
-        if (!new_file->write(decompressed_data.value().data(), decompressed_data.value().size())) {
-            warnln("Can't write file contents in {}: {}", zip_member.name, new_file->error_string());
+        if (!new_file->write_or_error(decompressed_data.value())) {
+            warnln("Can't write file contents in {}", zip_member.name);
             return false;
         }
         break;
@@ -66,11 +71,7 @@ static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
         VERIFY_NOT_REACHED();
     }
 
-    if (!new_file->close()) {
-        warnln("Can't close file {}: {}", zip_member.name, new_file->error_string());
-        return false;
-    }
-
+    new_file->close();
     return true;
 }
 
@@ -79,6 +80,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     char const* path;
     int map_size_limit = 32 * MiB;
     bool quiet { false };
+    unsigned job_count { 1 };
     String output_directory_path;
     Vector<StringView> file_filters;
 
@@ -86,6 +88,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(map_size_limit, "Maximum chunk size to map", "map-size-limit", 0, "size");
     args_parser.add_option(output_directory_path, "Directory to receive the archive content", "output-directory", 'd', "path");
     args_parser.add_option(quiet, "Be less verbose", "quiet", 'q');
+    args_parser.add_option(job_count, "Extract on this many threads", "jobs", 'j', "count");
     args_parser.add_positional_argument(path, "File to unzip", "path", Core::ArgsParser::Required::Yes);
     args_parser.add_positional_argument(file_filters, "Files or filters in the archive to extract", "files", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
@@ -125,29 +128,85 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         TRY(Core::System::chdir(output_directory_path));
     }
 
-    auto success = zip_file->for_each_member([&](auto zip_member) {
-        bool keep_file = false;
-
-        if (!file_filters.is_empty()) {
-            for (auto& filter : file_filters) {
-                // Convert underscore wildcards (usual unzip convention) to question marks (as used by StringUtils)
-                auto string_filter = filter.replace("_", "?", true);
-                if (zip_member.name.matches(string_filter, CaseSensitivity::CaseSensitive)) {
-                    keep_file = true;
-                    break;
+    Vector<Archive::ZipMember> members_to_extract;
+    auto is_literal_name = [](StringView filter) {
+        return !filter.contains('*') && !filter.contains('?') && !filter.contains('_');
+    };
+    if (!file_filters.is_empty() && all_of(file_filters, is_literal_name)) {
+        // Names without wildcards are looked up in the archive's index, so the other members are never touched.
+        for (auto& filter : file_filters) {
+            if (auto zip_member = zip_file->find_member(filter); zip_member.has_value())
+                members_to_extract.append(zip_member.release_value());
+        }
+    } else {
+        for (size_t i = 0; i < zip_file->member_count(); ++i) {
+            auto zip_member = zip_file->member_at(i);
+            bool keep_file = false;
+
+            if (!file_filters.is_empty()) {
+                for (auto& filter : file_filters) {
+                    // Convert underscore wildcards (usual unzip convention) to question marks (as used by StringUtils)
+                    auto string_filter = filter.replace("_", "?", true);
+                    if (zip_member.name.matches(string_filter, CaseSensitivity::CaseSensitive)) {
+                        keep_file = true;
+                        break;
+                    }
                 }
+            } else {
+                keep_file = true;
             }
-        } else {
-            keep_file = true;
+
+            if (keep_file)
+                members_to_extract.append(move(zip_member));
         }
+    }
 
-        if (keep_file) {
+    if (job_count <= 1) {
+        for (auto& zip_member : members_to_extract) {
             if (!unpack_zip_member(zip_member, quiet))
-                return IterationDecision::Break;
+                return 1;
         }
+        return 0;
+    }
+
+    // Members are independent of each other, so they can be decompressed in parallel once the directories exist.
+    Vector<Archive::ZipMember const*> files_to_extract;
+    for (auto& zip_member : members_to_extract) {
+        if (!zip_member.is_directory) {
+            files_to_extract.append(&zip_member);
+            continue;
+        }
+        if (!unpack_zip_member(zip_member, quiet))
+            return 1;
+    }
+
+    Atomic<size_t> next_file_index { 0 };
+    Atomic<bool> failed { false };
+    auto extract_files = [&] {
+        while (!failed) {
+            auto index = next_file_index.fetch_add(1);
+            if (index >= files_to_extract.size())
+                return;
+            if (!unpack_zip_member(*files_to_extract[index], quiet))
+                failed = true;
+        }
+    };
+
+    auto thread_count = min<size_t>(job_count, files_to_extract.size());
+    Vector<NonnullRefPtr<Threading::Thread>> workers;
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto worker = Threading::Thread::construct([&] {
+            extract_files();
+            return 0;
+        },
+            "unzip worker"sv);
+        worker->start();
+        workers.append(move(worker));
+    }
+    extract_files();
 
-        return IterationDecision::Continue;
-    });
+    for (auto& worker : workers)
+        (void)worker->join();
 
-    return success ? 0 : 1;
+    return failed ? 1 : 0;
 }